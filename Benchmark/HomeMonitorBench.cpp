@@ -0,0 +1,407 @@
+// HomeMonitor Benchmarks: Headless micro-benchmarks of the ingest and
+// plotting hot paths, run against recorded ThingSpeak feeds
+//
+//     HomeMonitorBench --benchmark_filter=Parse
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <filesystem>
+
+#include <benchmark/benchmark.h>
+#include <cpr/cpr.h>
+#include <nlohmann/json.hpp>
+
+#include "ThingSpeak/ThingSpeak.h"
+#include "ThingSpeak/ThingSpeakTime.h"
+
+#include "HomeMonitor.h"
+
+#ifndef HOMEMONITOR_BENCH_FIXTURE_DIR
+#define HOMEMONITOR_BENCH_FIXTURE_DIR   "Fixtures"
+#endif
+
+#define HOMEMONITOR_BENCH_PLOT_WIDTH    1920.0f   // Pixels spanned by the X-axis
+#define HOMEMONITOR_BENCH_PLOT_HEIGHT   1080.0f   // Pixels spanned by the Y-axis
+
+// Series plotted by the plot benchmarks
+static HomeMonitorPlotSeries_t const benchPlotSeries = HomeMonitorGetFieldSeries(ThingSpeakField::Temperature);
+
+/**
+ * @brief Get a recorded feeds.json response, read from disk once per size
+ * 
+ * @param numEntries - Number of entries in the fixture (100, 1000 or 8000)
+ * 
+ * @return cpr::Response const & - Successful response holding the fixture
+ */
+static cpr::Response const & HomeMonitorBenchGetFixture(int64_t numEntries)
+{
+    static std::map<int64_t, cpr::Response> fixtures;
+
+    auto found = fixtures.find(numEntries);
+    if (found != fixtures.end())
+    {
+        return found->second;
+    }
+
+    std::filesystem::path path = std::filesystem::path(HOMEMONITOR_BENCH_FIXTURE_DIR) /
+                                 ("feeds_" + std::to_string(numEntries) + ".json");
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cerr << "[ERROR] Couldn't open fixture " << path.string() << std::endl;
+    }
+
+    std::stringstream text;
+    text << file.rdbuf();
+
+    cpr::Response& response = fixtures[numEntries];
+    response.status_code = static_cast<long>(HttpStatusCode::OK);
+    response.text = text.str();
+
+    return response;
+}
+
+/**
+ * @brief Create a HomeMonitor object holding the field data of a fixture
+ * 
+ * @param numEntries - Number of entries in the fixture
+ * @param channel - ThingSpeak API channel to assign
+ * 
+ * @return HomeMonitor_t - Displayed HomeMonitor object with fixture data
+ */
+static HomeMonitor_t HomeMonitorBenchCreateHomeMonitor(int64_t numEntries, std::string const & channel)
+{
+    HomeMonitor_t homeMonitor = {ThingSpeak(channel, channel, "")};
+    homeMonitor.displayData = true;
+
+    ThingSpeakFetchResult_t result = homeMonitor.thingSpeak.ParseFieldData(HomeMonitorBenchGetFixture(numEntries));
+    homeMonitor.thingSpeak.SetFieldData(result);
+
+    return homeMonitor;
+}
+
+/**
+ * @brief Parse a recorded response into field data, as done by the fetcher
+ *        thread for every request
+ * 
+ * @param state - Range(0) is the number of entries in the fixture
+ */
+static void BM_ParseFieldData(benchmark::State& state)
+{
+    cpr::Response const & response = HomeMonitorBenchGetFixture(state.range(0));
+    ThingSpeak thingSpeak("Bench", "0", "");
+
+    for (auto _ : state)
+    {
+        ThingSpeakFetchResult_t result = thingSpeak.ParseFieldData(response);
+        benchmark::DoNotOptimize(result);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(response.text.size()));
+}
+BENCHMARK(BM_ParseFieldData)->Arg(100)->Arg(1000)->Arg(8000);
+
+/**
+ * @brief Parse a recorded response and apply it to an empty object, as done
+ *        for the first fetch of a channel
+ * 
+ * @param state - Range(0) is the number of entries in the fixture
+ */
+static void BM_IngestFieldData(benchmark::State& state)
+{
+    cpr::Response const & response = HomeMonitorBenchGetFixture(state.range(0));
+
+    for (auto _ : state)
+    {
+        ThingSpeak thingSpeak("Bench", "0", "");
+        thingSpeak.SetFieldData(thingSpeak.ParseFieldData(response));
+        benchmark::DoNotOptimize(thingSpeak.GetFeedData()->series.Size());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_IngestFieldData)->Arg(100)->Arg(1000)->Arg(8000);
+
+/**
+ * @brief Convert the created_at strings of a fixture to epoch seconds
+ * 
+ * @param state - Range(0) is the number of entries in the fixture
+ */
+static void BM_ParseDateTime(benchmark::State& state)
+{
+    std::vector<std::string> dateTimes;
+    nlohmann::json feed = nlohmann::json::parse(HomeMonitorBenchGetFixture(state.range(0)).text);
+    for (auto const & entry : feed["feeds"])
+    {
+        dateTimes.push_back(entry["created_at"].get<std::string>());
+    }
+
+    for (auto _ : state)
+    {
+        for (std::string const & dateTime : dateTimes)
+        {
+            int64_t epochSeconds;
+            benchmark::DoNotOptimize(ThingSpeakParseDateTime(dateTime, epochSeconds));
+            benchmark::DoNotOptimize(epochSeconds);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(dateTimes.size()));
+}
+BENCHMARK(BM_ParseDateTime)->Arg(100)->Arg(1000)->Arg(8000);
+
+/**
+ * @brief Convert the timestamps of a fixture to local date/time strings, as
+ *        shown in the hover tooltip
+ * 
+ * @param state - Range(0) is the number of entries in the fixture
+ */
+static void BM_FormatLocalDateTime(benchmark::State& state)
+{
+    HomeMonitor_t homeMonitor = HomeMonitorBenchCreateHomeMonitor(state.range(0), "0");
+    ThingSpeakSeries const & series = homeMonitor.thingSpeak.GetFeedData()->series;
+
+    ThingSpeakTimeZone localTimeZone;
+    char dateTime[THINGSPEAK_DATE_TIME_BUFFER_SIZE];
+
+    for (auto _ : state)
+    {
+        for (int i = 0; i < series.Size(); i++)
+        {
+            localTimeZone.FormatLocal(series.Timestamp(i), dateTime);
+            benchmark::DoNotOptimize(dateTime);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * series.Size());
+}
+BENCHMARK(BM_FormatLocalDateTime)->Arg(100)->Arg(1000)->Arg(8000);
+
+/**
+ * @brief Shared setup of the plotting benchmarks: a number of channels each
+ *        holding the same fixture
+ */
+class HomeMonitorBenchPlot : public benchmark::Fixture
+{
+public:
+    void SetUp(benchmark::State const & state) override
+    {
+        homeMonitors.clear();
+        visibleHomeMonitors.clear();
+
+        for (int64_t i = 0; i < state.range(1); i++)
+        {
+            homeMonitors.push_back(HomeMonitorBenchCreateHomeMonitor(state.range(0), std::to_string(i)));
+        }
+        for (HomeMonitor_t& homeMonitor : homeMonitors)
+        {
+            visibleHomeMonitors.push_back(&homeMonitor);
+        }
+
+        HomeMonitorUpdateRollups(benchPlotSeries, visibleHomeMonitors);
+    }
+
+    void TearDown(benchmark::State const & state) override
+    {
+        visibleHomeMonitors.clear();
+        homeMonitors.clear();
+    }
+
+protected:
+    // Member Variables
+    std::vector<HomeMonitor_t> homeMonitors;
+    std::vector<HomeMonitor_t*> visibleHomeMonitors;
+};
+
+/**
+ * @brief Find the point nearest the cursor, swept across the plot, as done
+ *        every frame the plot is hovered
+ * 
+ * @param state - Range(0) is the number of entries per channel, Range(1)
+ *                the number of channels
+ */
+BENCHMARK_DEFINE_F(HomeMonitorBenchPlot, BM_GetClosestPointToMouse)(benchmark::State& state)
+{
+    HomeMonitorView_t view(visibleHomeMonitors);
+    std::pair<float, float> xLimits = HomeMonitorGetXAxisBoundaries(benchPlotSeries, view);
+    std::pair<float, float> yLimits = HomeMonitorGetYAxisBoundaries(benchPlotSeries, view, NAN, NAN);
+
+    ImVec2 pixelsPerUnit(HOMEMONITOR_BENCH_PLOT_WIDTH / (xLimits.second - xLimits.first + 1.0f),
+                         HOMEMONITOR_BENCH_PLOT_HEIGHT / (yLimits.second - yLimits.first + 1.0f));
+    ImPlotPoint mousePos(xLimits.first, (yLimits.first + yLimits.second) / 2.0);
+    double const step = (xLimits.second - xLimits.first) / 997.0;
+
+    for (auto _ : state)
+    {
+        std::pair<int, int> closest = HomeMonitorGetClosestPointToMouse(benchPlotSeries, view,
+                                                                        mousePos, pixelsPerUnit);
+        benchmark::DoNotOptimize(closest);
+
+        mousePos.x += step;
+        if (mousePos.x > xLimits.second)
+        {
+            mousePos.x = xLimits.first;
+        }
+    }
+}
+BENCHMARK_REGISTER_F(HomeMonitorBenchPlot, BM_GetClosestPointToMouse)
+    ->ArgsProduct({{100, 1000, 8000}, {1, 4, 16, 64}});
+
+/**
+ * @brief Determine the Y-axis limits of the plot, as done every frame
+ * 
+ * @param state - Range(0) is the number of entries per channel, Range(1)
+ *                the number of channels
+ */
+BENCHMARK_DEFINE_F(HomeMonitorBenchPlot, BM_GetYAxisBoundaries)(benchmark::State& state)
+{
+    HomeMonitorView_t view(visibleHomeMonitors);
+
+    for (auto _ : state)
+    {
+        std::pair<float, float> yLimits = HomeMonitorGetYAxisBoundaries(benchPlotSeries, view, NAN, NAN);
+        benchmark::DoNotOptimize(yLimits);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(1));
+}
+BENCHMARK_REGISTER_F(HomeMonitorBenchPlot, BM_GetYAxisBoundaries)
+    ->ArgsProduct({{100, 1000, 8000}, {1, 4, 16, 64}});
+
+/**
+ * @brief Compute the statistics of the visible range of every channel, as
+ *        done every frame for the legend below each plot. The window is
+ *        panned across the data so ranges start at different alignments
+ * 
+ * @param state - Range(0) is the number of entries per channel, Range(1)
+ *                the number of channels
+ */
+BENCHMARK_DEFINE_F(HomeMonitorBenchPlot, BM_GetVisibleStats)(benchmark::State& state)
+{
+    double const width = static_cast<double>(state.range(0)) / 4.0;
+    double xMin = 0.0;
+
+    for (auto _ : state)
+    {
+        for (HomeMonitor_t const * homeMonitor : visibleHomeMonitors)
+        {
+            ThingSpeakSeriesStats_t stats =
+                HomeMonitorGetVisibleStats(benchPlotSeries, *homeMonitor, xMin, (xMin + width));
+            benchmark::DoNotOptimize(stats);
+        }
+
+        xMin += 7.0;
+        if ((xMin + width) > state.range(0))
+        {
+            xMin = 0.0;
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+BENCHMARK_REGISTER_F(HomeMonitorBenchPlot, BM_GetVisibleStats)
+    ->ArgsProduct({{100, 1000, 8000}, {1, 4, 16, 64}});
+
+/**
+ * @brief Compute the statistics of a whole channel with each kernel the CPU
+ *        supports
+ * 
+ * @param state - Range(0) is the number of entries, Range(1) the number of
+ *                channels (1) and Range(2) the ThingSpeakStatsKernel
+ */
+BENCHMARK_DEFINE_F(HomeMonitorBenchPlot, BM_GetSeriesStats)(benchmark::State& state)
+{
+    ThingSpeakStatsKernel detected = ThingSpeakGetStatsKernel();
+    if (!ThingSpeakSetStatsKernel(static_cast<ThingSpeakStatsKernel>(state.range(2))))
+    {
+        state.SkipWithError("Kernel not supported by this CPU");
+        return;
+    }
+
+    ThingSpeakSeries const & series = visibleHomeMonitors.front()->thingSpeak.GetFeedData()->series;
+    int const fieldNumber = static_cast<int>(ThingSpeakField::Temperature);
+
+    for (auto _ : state)
+    {
+        ThingSpeakSeriesStats_t stats = ThingSpeakGetSeriesStats(series, fieldNumber, 0, series.Size());
+        benchmark::DoNotOptimize(stats);
+    }
+
+    ThingSpeakSetStatsKernel(detected);
+    state.SetItemsProcessed(state.iterations() * series.Size());
+    state.SetLabel(ThingSpeakGetStatsKernelName(static_cast<ThingSpeakStatsKernel>(state.range(2))));
+}
+BENCHMARK_REGISTER_F(HomeMonitorBenchPlot, BM_GetSeriesStats)
+    ->ArgsProduct({{100, 1000, 8000}, {1},
+                   {static_cast<int64_t>(ThingSpeakStatsKernel::Scalar),
+                    static_cast<int64_t>(ThingSpeakStatsKernel::Sse2),
+                    static_cast<int64_t>(ThingSpeakStatsKernel::Avx2)}});
+
+/**
+ * @brief Derive the default series (dew point, heat index and moving
+ *        averages) of a whole channel, as done when first viewed or after
+ *        the channel is reloaded
+ * 
+ * @param state - Range(0) is the number of entries, Range(1) the number of
+ *                channels (1)
+ */
+BENCHMARK_DEFINE_F(HomeMonitorBenchPlot, BM_DeriveSeries)(benchmark::State& state)
+{
+    ThingSpeakSeries const & series = visibleHomeMonitors.front()->thingSpeak.GetFeedData()->series;
+    ThingSpeakDerivedSeries derivedSeries;
+
+    for (auto _ : state)
+    {
+        derivedSeries.Invalidate();
+        derivedSeries.Update(series);
+        benchmark::DoNotOptimize(derivedSeries.GetFeedData().series.Size());
+    }
+
+    state.SetItemsProcessed(state.iterations() * series.Size());
+}
+BENCHMARK_REGISTER_F(HomeMonitorBenchPlot, BM_DeriveSeries)
+    ->ArgsProduct({{100, 1000, 8000}, {1}});
+
+/**
+ * @brief Derive the default series of one newly appended entry, as done
+ *        every frame an entry arrives while a derived viewer is shown.
+ *        Should not depend on the number of entries held
+ * 
+ * @param state - Range(0) is the number of entries, Range(1) the number of
+ *                channels (1)
+ */
+BENCHMARK_DEFINE_F(HomeMonitorBenchPlot, BM_DeriveAppendedEntry)(benchmark::State& state)
+{
+    ThingSpeakSeries series = visibleHomeMonitors.front()->thingSpeak.GetFeedData()->series;
+    series.SetCapacity(series.Size());
+
+    ThingSpeakDerivedSeries derivedSeries;
+    derivedSeries.Update(series);
+
+    int64_t entryId = series.EntryId(series.Size() - 1);
+    int64_t timestamp = series.Timestamp(series.Size() - 1);
+    float fields[THINGSPEAK_NUM_FIELDS] = {70.0f, 50.0f};
+
+    for (auto _ : state)
+    {
+        entryId++;
+        timestamp += 20;
+        series.Append(entryId, timestamp, fields, 0b11);
+
+        bool changed = derivedSeries.Update(series);
+        benchmark::DoNotOptimize(changed);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_REGISTER_F(HomeMonitorBenchPlot, BM_DeriveAppendedEntry)
+    ->ArgsProduct({{100, 1000, 8000}, {1}});
+
+BENCHMARK_MAIN();
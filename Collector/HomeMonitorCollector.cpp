@@ -0,0 +1,382 @@
+// HomeMonitor Collector: Headless process which keeps the on-disk cache of
+// every configured channel up to date. HomeMonitor instances started with
+// --shared-cache display these caches instead of polling ThingSpeak
+//
+//     HomeMonitorCollector [--base-url URL] [--report-seconds N] [ThingSpeakObjects.json] [cache directory]
+//
+// Pointed at a HomeMonitorMockServer, the collector doubles as the load
+// generator of a scale test, reporting its ingest throughput every N seconds
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+#include <algorithm>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+
+#include "ThingSpeak/ThingSpeak.h"
+#include "ThingSpeak/ThingSpeakFetcher.h"
+#include "ThingSpeak/ThingSpeakCache.h"
+#include "ThingSpeak/ThingSpeakScheduler.h"
+
+#define DEBUG_HOMEMONITOR_COLLECTOR   false
+
+#define HOMEMONITOR_COLLECTOR_DEFAULT_OBJECTS_PATH   "ThingSpeakObjects.json"
+#define HOMEMONITOR_COLLECTOR_DEFAULT_CACHE_PATH     "Cache"
+#define HOMEMONITOR_COLLECTOR_WAKE_MS                1000   // Longest sleep, bounding shutdown and config reload latency
+
+typedef struct
+{
+    ThingSpeak thingSpeak;
+    std::unique_ptr<ThingSpeakCache> cache;
+} HomeMonitorCollectorChannel_t;
+
+// Set by the signal handler; the main loop exits once it wakes
+static std::atomic<bool> stopRequested = false;
+
+// Fetcher results waiting to be collected
+static std::mutex resultsMutex;
+static std::condition_variable resultsCondition;
+static bool resultsReady = false;
+
+// Ingest counters of the running report period
+typedef struct
+{
+    int64_t numResults;
+    int64_t numNotModified;
+    int64_t numFailed;
+    int64_t numEntries;          // New entries appended to the channels
+    int64_t bytesDownloaded;
+    double requestSeconds;       // Summed over every result
+    double parseSeconds;
+} HomeMonitorCollectorStats_t;
+
+static HomeMonitorCollectorStats_t collectorStats = {};
+
+void HomeMonitorCollectorHandleSignal(int signal);
+bool HomeMonitorCollectorLoadObjects(std::filesystem::path const & objectsPath,
+                                     std::filesystem::path const & cachePath,
+                                     std::map<std::string, HomeMonitorCollectorChannel_t>& channels,
+                                     ThingSpeakScheduler& thingSpeakScheduler);
+void HomeMonitorCollectorRequestDueFieldData(std::map<std::string, HomeMonitorCollectorChannel_t>& channels,
+                                             ThingSpeakScheduler& thingSpeakScheduler,
+                                             ThingSpeakFetcher& thingSpeakFetcher);
+void HomeMonitorCollectorCollectFieldData(std::map<std::string, HomeMonitorCollectorChannel_t>& channels,
+                                          ThingSpeakScheduler& thingSpeakScheduler,
+                                          ThingSpeakFetcher& thingSpeakFetcher);
+void HomeMonitorCollectorReport(double elapsedSeconds);
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> paths;
+    int reportSeconds = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument(argv[i]);
+        if ((argument == "--base-url") && ((i + 1) < argc))
+        {
+            ThingSpeak::SetBaseUrl(argv[++i]);
+        }
+        else if ((argument == "--report-seconds") && ((i + 1) < argc))
+        {
+            reportSeconds = std::atoi(argv[++i]);
+        }
+        else
+        {
+            paths.push_back(argument);
+        }
+    }
+
+    std::filesystem::path objectsPath = (paths.size() > 0) ? paths[0] : HOMEMONITOR_COLLECTOR_DEFAULT_OBJECTS_PATH;
+    std::filesystem::path cachePath = (paths.size() > 1) ? paths[1] : HOMEMONITOR_COLLECTOR_DEFAULT_CACHE_PATH;
+
+    std::signal(SIGINT, HomeMonitorCollectorHandleSignal);
+    std::signal(SIGTERM, HomeMonitorCollectorHandleSignal);
+
+    std::map<std::string, HomeMonitorCollectorChannel_t> channels;
+    ThingSpeakScheduler thingSpeakScheduler;
+
+    std::error_code error;
+    auto objectsWriteTime = std::filesystem::last_write_time(objectsPath, error);
+    if (!HomeMonitorCollectorLoadObjects(objectsPath, cachePath, channels, thingSpeakScheduler))
+    {
+        return -1;
+    }
+
+    ThingSpeakFetcher thingSpeakFetcher([] {
+        {
+            std::lock_guard<std::mutex> lock(resultsMutex);
+            resultsReady = true;
+        }
+        resultsCondition.notify_one();
+    });
+
+    std::cout << "Collecting " << channels.size() << " channel(s) from " << ThingSpeak::GetBaseUrl()
+              << " into " << cachePath.string() << std::endl;
+
+    auto reportTime = std::chrono::steady_clock::now();
+
+    while (!stopRequested)
+    {
+        HomeMonitorCollectorRequestDueFieldData(channels, thingSpeakScheduler, thingSpeakFetcher);
+
+        // Sleep until a result arrives or the next channel is due
+        auto wakeTime = std::min(thingSpeakScheduler.NextDueTime(),
+                                 std::chrono::steady_clock::now() +
+                                 std::chrono::milliseconds(HOMEMONITOR_COLLECTOR_WAKE_MS));
+        {
+            std::unique_lock<std::mutex> lock(resultsMutex);
+            resultsCondition.wait_until(lock, wakeTime, [] { return resultsReady; });
+            resultsReady = false;
+        }
+
+        HomeMonitorCollectorCollectFieldData(channels, thingSpeakScheduler, thingSpeakFetcher);
+
+        // Objects added/edited by a HomeMonitor GUI are picked up without a restart
+        auto writeTime = std::filesystem::last_write_time(objectsPath, error);
+        if (!error && (writeTime != objectsWriteTime))
+        {
+            objectsWriteTime = writeTime;
+            HomeMonitorCollectorLoadObjects(objectsPath, cachePath, channels, thingSpeakScheduler);
+        }
+
+        std::chrono::duration<double> sinceReport = std::chrono::steady_clock::now() - reportTime;
+        if ((reportSeconds > 0) && (sinceReport.count() >= reportSeconds))
+        {
+            HomeMonitorCollectorReport(sinceReport.count());
+            reportTime = std::chrono::steady_clock::now();
+        }
+    }
+
+    std::cout << "Stopping collector" << std::endl;
+
+    return 0;
+}
+
+/**
+ * @brief Request the main loop to exit on SIGINT/SIGTERM
+ * 
+ * @param signal - Signal received
+ */
+void HomeMonitorCollectorHandleSignal([[maybe_unused]] int signal)
+{
+    stopRequested = true;
+}
+
+/**
+ * @brief Read the configured ThingSpeak objects, adding channels which are
+ *        new and dropping channels which are no longer configured. Added
+ *        channels are restored from their cache and due straight away
+ * 
+ * @param objectsPath - Path of ThingSpeakObjects.json
+ * @param cachePath - Directory holding the cache files
+ * @param channels - Collected channels, keyed by API channel
+ * @param thingSpeakScheduler - Schedule of every collected channel
+ * 
+ * @return bool - True if the objects file was read
+ */
+bool HomeMonitorCollectorLoadObjects(std::filesystem::path const & objectsPath,
+                                     std::filesystem::path const & cachePath,
+                                     std::map<std::string, HomeMonitorCollectorChannel_t>& channels,
+                                     ThingSpeakScheduler& thingSpeakScheduler)
+{
+    std::ifstream objectsFile(objectsPath);
+    if (!objectsFile.is_open())
+    {
+        std::cerr << "[ERROR] Could not open " << objectsPath.string() << std::endl;
+        return false;
+    }
+
+    json objectsJson = json::parse(objectsFile, nullptr, false);
+    if (objectsJson.is_discarded() || !objectsJson.is_array())
+    {
+        // May be caught mid-write by the GUI; read again on the next change
+        std::cerr << "[ERROR] Could not parse " << objectsPath.string() << std::endl;
+        return false;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    std::map<std::string, HomeMonitorCollectorChannel_t> configuredChannels;
+
+    for (auto& object : objectsJson)
+    {
+        std::string name = object.value("name", "");
+        std::string channel = object.value("channel", "");
+        std::string key = object.value("key", "");
+
+        // Each cache file has a single writer, so a channel is collected once
+        if (channel.empty() || configuredChannels.contains(channel))
+        {
+            continue;
+        }
+
+        auto existing = channels.find(channel);
+        if ((existing != channels.end()) && (existing->second.thingSpeak.GetKey() == key))
+        {
+            existing->second.thingSpeak.SetName(name);
+            configuredChannels[channel] = std::move(existing->second);
+            channels.erase(existing);
+            continue;
+        }
+        if (existing != channels.end())
+        {
+            // Key changed; release the cache file before it is reopened
+            thingSpeakScheduler.Remove(channel, existing->second.thingSpeak.GetKey());
+            channels.erase(existing);
+        }
+
+        HomeMonitorCollectorChannel_t& collected = configuredChannels[channel];
+        collected.thingSpeak = {name, channel, key};
+        collected.cache = std::make_unique<ThingSpeakCache>();
+
+        if (collected.cache->Open(cachePath, channel))
+        {
+            // Only entries newer than those cached are fetched
+            ThingSpeakFetchResult_t cachedData;
+            if (collected.cache->Load(cachedData))
+            {
+                collected.thingSpeak.RestoreFieldData(cachedData);
+            }
+        }
+        else
+        {
+            collected.cache.reset();
+        }
+
+        thingSpeakScheduler.Add(channel, key, now);
+
+        #if (DEBUG_HOMEMONITOR_COLLECTOR)
+        std::cout << "Collecting " << name << " (" << channel << ")" << std::endl;
+        #endif
+    }
+
+    // Whatever is left is no longer configured
+    for (auto& [channel, collected] : channels)
+    {
+        thingSpeakScheduler.Remove(channel, collected.thingSpeak.GetKey());
+    }
+    channels = std::move(configuredChannels);
+
+    return true;
+}
+
+/**
+ * @brief Queue a background refresh for every channel whose schedule is due
+ * 
+ * @param channels - Collected channels
+ * @param thingSpeakScheduler - Schedule of every channel
+ * @param thingSpeakFetcher - Background fetcher servicing the requests
+ */
+void HomeMonitorCollectorRequestDueFieldData(std::map<std::string, HomeMonitorCollectorChannel_t>& channels,
+                                             ThingSpeakScheduler& thingSpeakScheduler,
+                                             ThingSpeakFetcher& thingSpeakFetcher)
+{
+    auto now = std::chrono::steady_clock::now();
+    std::vector<ThingSpeak*> thingSpeaks;
+    ThingSpeakSchedule_t schedule;
+
+    while (thingSpeakScheduler.PopDue(now, schedule))
+    {
+        auto found = channels.find(schedule.channel);
+        if ((found == channels.end()) || (found->second.thingSpeak.GetKey() != schedule.key))
+        {
+            thingSpeakScheduler.Remove(schedule.channel, schedule.key);
+            continue;
+        }
+
+        thingSpeaks.push_back(&found->second.thingSpeak);
+    }
+
+    if (!thingSpeaks.empty())
+    {
+        thingSpeakFetcher.FetchAll(thingSpeaks);
+    }
+}
+
+/**
+ * @brief Apply data finished by the background fetcher, append it to each
+ *        channel's cache and schedule the channel's next refresh
+ * 
+ * @param channels - Collected channels
+ * @param thingSpeakScheduler - Schedule of every channel
+ * @param thingSpeakFetcher - Background fetcher to collect results from
+ */
+void HomeMonitorCollectorCollectFieldData(std::map<std::string, HomeMonitorCollectorChannel_t>& channels,
+                                          ThingSpeakScheduler& thingSpeakScheduler,
+                                          ThingSpeakFetcher& thingSpeakFetcher)
+{
+    static std::vector<ThingSpeakFetchResult_t> results;
+
+    if (!thingSpeakFetcher.Collect(results))
+    {
+        return;
+    }
+
+    for (auto& result : results)
+    {
+        // Channels may have been reconfigured while the request was in flight
+        auto found = channels.find(result.channel);
+        if ((found == channels.end()) || (found->second.thingSpeak.GetKey() != result.key))
+        {
+            continue;
+        }
+
+        HomeMonitorCollectorChannel_t& collected = found->second;
+        int64_t lastEntryId = collected.thingSpeak.GetLastEntry().entryId;
+        collected.thingSpeak.SetFieldData(result);
+
+        collectorStats.numResults++;
+        collectorStats.numNotModified += (result.notModified ? 1 : 0);
+        collectorStats.numFailed += (result.validDataFetched ? 0 : 1);
+        collectorStats.numEntries += (collected.thingSpeak.GetLastEntry().entryId - lastEntryId);
+        collectorStats.bytesDownloaded += result.bytesDownloaded;
+        collectorStats.requestSeconds += result.requestSeconds;
+        collectorStats.parseSeconds += result.parseSeconds;
+
+        if (collected.cache)
+        {
+            collected.cache->Store(collected.thingSpeak);
+        }
+
+        if (!result.validDataFetched)
+        {
+            std::cerr << "[ERROR] Couldn't fetch " << collected.thingSpeak.GetName()
+                      << " (HTTP " << result.statusCode << ")" << std::endl;
+        }
+
+        thingSpeakScheduler.OnResult(result, collected.thingSpeak, std::chrono::steady_clock::now());
+    }
+}
+
+/**
+ * @brief Print the ingest throughput of the period just ended, then start
+ *        the next period
+ * 
+ * @param elapsedSeconds - Length of the period
+ */
+void HomeMonitorCollectorReport(double elapsedSeconds)
+{
+    HomeMonitorCollectorStats_t const & stats = collectorStats;
+    double const numResults = static_cast<double>(std::max<int64_t>(stats.numResults, 1));
+
+    char report[256];
+    std::snprintf(report, sizeof(report),
+                  "%.1f results/s (304: %lld, failed: %lld)  %.0f entries/s  %.2f MB/s  "
+                  "request %.1f ms  parse %.2f ms",
+                  (stats.numResults / elapsedSeconds), static_cast<long long>(stats.numNotModified),
+                  static_cast<long long>(stats.numFailed), (stats.numEntries / elapsedSeconds),
+                  (stats.bytesDownloaded / elapsedSeconds / 1e6),
+                  (stats.requestSeconds * 1000.0 / numResults), (stats.parseSeconds * 1000.0 / numResults));
+    std::cout << report << std::endl;
+
+    collectorStats = {};
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <span>
+#include <memory>
+#include <utility>
+
+#include "Imgui/imgui.h"
+#include "Imgui/implot.h"
+
+#include "ThingSpeak/ThingSpeak.h"
+#include "ThingSpeak/ThingSpeakCache.h"
+#include "ThingSpeak/ThingSpeakDerivedSeries.h"
+#include "ThingSpeak/ThingSpeakSeriesLod.h"
+#include "ThingSpeak/ThingSpeakSeriesRollup.h"
+#include "ThingSpeak/ThingSpeakSeriesStats.h"
+
+#include "HomeMonitorLineGeometry.h"
+
+#define HOMEMONITOR_HOVER_RADIUS_PIXELS   20.0f
+
+// Field viewers, followed by one per derived series. See HomeMonitorGetPlotIndex()
+#define HOMEMONITOR_NUM_PLOT_SERIES       (THINGSPEAK_NUM_FIELDS + THINGSPEAK_MAX_DERIVED_SERIES)
+
+// Series plotted by a viewer: fieldN of the channel's feed, or column N of
+// the series derived from it. Both are plotted the same way
+typedef struct
+{
+    int fieldNumber;
+    bool derived;
+} HomeMonitorPlotSeries_t;
+
+struct HomeMonitorAssignedColor_t
+{
+    unsigned int rgba;   // RGBA Color. E.g. (255, 255, 255, 0)
+    ImVec4 rgb;          // RGB Color. E.g. (1.0, 1.0, 1.0, 0.0)
+
+    bool operator==(const HomeMonitorAssignedColor_t& color) const
+    {
+        bool sameRgba = (rgba == color.rgba);
+        bool sameRgb = ((rgb.x == color.rgb.x) && (rgb.y == color.rgb.y)
+                        && (rgb.z == color.rgb.z) && (rgb.w == color.rgb.w));
+
+        return (sameRgba && sameRgb);
+    }
+};
+
+struct HomeMonitorColorOption_t
+{
+    HomeMonitorAssignedColor_t color;
+    bool available;
+};
+
+struct HomeMonitor_t
+{
+    ThingSpeak thingSpeak;
+    HomeMonitorAssignedColor_t assignedColor;
+
+    // Display properties
+    bool displayData;
+
+    // Dew point, heat index and moving averages of the fields. Derived once
+    // a viewer first shows them, then only for new entries
+    ThingSpeakDerivedSeries derivedSeries;
+
+    // Minute/hour/day aggregates, one per viewer. fieldRollups[N - 1]
+    // follows fieldN; see HomeMonitorGetPlotIndex()
+    ThingSpeakSeriesRollup fieldRollups[HOMEMONITOR_NUM_PLOT_SERIES];
+
+    // Decimated plot data, one per viewer. plotLods[N - 1] plots fieldN
+    ThingSpeakSeriesLod plotLods[HOMEMONITOR_NUM_PLOT_SERIES];
+
+    // Tessellated lines of plotLods, replayed while unchanged
+    HomeMonitorLineGeometry plotGeometries[HOMEMONITOR_NUM_PLOT_SERIES];
+
+    // On-disk copy of fetched data. Shared as the mapping cannot be copied
+    std::shared_ptr<ThingSpeakCache> cache;
+};
+
+// Non-owning view over HomeMonitor objects, e.g. those currently visible
+typedef std::span<HomeMonitor_t* const> HomeMonitorView_t;
+
+// HomeMonitor Plot Data Functions. Independent of the renderer so they can
+// be benchmarked headless
+HomeMonitorPlotSeries_t HomeMonitorGetFieldSeries(ThingSpeakField field);
+HomeMonitorPlotSeries_t HomeMonitorGetDerivedSeries(ThingSpeakDerivedField derivedField);
+int HomeMonitorGetPlotIndex(HomeMonitorPlotSeries_t plotSeries);
+ThingSpeakFeedData_t const * HomeMonitorGetPlotData(HomeMonitor_t const & homeMonitor,
+                                                    HomeMonitorPlotSeries_t plotSeries);
+void HomeMonitorUpdateRollups(HomeMonitorPlotSeries_t plotSeries, HomeMonitorView_t homeMonitors);
+std::pair<int, int> HomeMonitorGetClosestPointToMouse(HomeMonitorPlotSeries_t plotSeries,
+                                                      HomeMonitorView_t homeMonitors,
+                                                      ImPlotPoint mousePos,
+                                                      ImVec2 pixelsPerUnit);
+std::pair<int, int> HomeMonitorGetClosestPointByTime(std::span<ThingSpeakSeries const * const> seriesList,
+                                                     int fieldNumber,
+                                                     ImPlotPoint mousePos,
+                                                     ImVec2 pixelsPerUnit);
+std::pair<float, float> HomeMonitorGetXAxisBoundaries(HomeMonitorPlotSeries_t plotSeries,
+                                                      HomeMonitorView_t homeMonitors);
+std::pair<float, float> HomeMonitorGetYAxisBoundaries(HomeMonitorPlotSeries_t plotSeries,
+                                                      HomeMonitorView_t homeMonitors,
+                                                      double xMin, double xMax);
+ThingSpeakSeriesStats_t HomeMonitorGetVisibleStats(HomeMonitorPlotSeries_t plotSeries,
+                                                   HomeMonitor_t const & homeMonitor,
+                                                   double xMin, double xMax);
+std::string HomeMonitorGetFieldName(ThingSpeakField field,
+                                    std::vector<HomeMonitor_t> const & homeMonitors);
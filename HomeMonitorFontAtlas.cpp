@@ -0,0 +1,287 @@
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+
+#include "HomeMonitorFontAtlas.h"
+
+// Printable ASCII and the degree sign used by temperature fields
+static ImWchar const trimmedGlyphRanges[] =
+{
+    0x0020, 0x007E,
+    0x00B0, 0x00B0,
+    0,
+};
+
+/**
+ * @brief Fold bytes into an FNV-1a hash
+ * 
+ * @param hash - Hash to update
+ * @param data - Bytes to add
+ * @param size - Number of bytes
+ * 
+ * @return uint64_t - Updated hash
+ */
+static uint64_t HomeMonitorFontAtlasHash(uint64_t hash, void const * data, size_t size)
+{
+    unsigned char const * bytes = static_cast<unsigned char const *>(data);
+
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ULL;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief Add a font to the atlas and build the atlas, restoring it from the
+ *        cache file instead of rasterizing when one matching the font exists
+ * 
+ * @param atlas - Atlas to add the font to. Expected to hold no other fonts
+ * @param fontData - TTF/OTF data. Copied, so it may be freed on return
+ * @param fontDataSize - Size of the font data in bytes
+ * @param sizePixels - Font size in pixels
+ * @param glyphRanges - Zero terminated pairs of codepoints to bake. Null for
+ *                      the Dear ImGui default ranges
+ * @param cachePath - Directory holding the cache file
+ * 
+ * @return ImFont* - Added font. Null if the font data could not be built
+ */
+ImFont* HomeMonitorFontAtlas::AddFont(ImFontAtlas* atlas, void const * fontData, int fontDataSize, float sizePixels,
+                                      ImWchar const * glyphRanges, std::filesystem::path const & cachePath)
+{
+    restored = false;
+
+    // The OS draws the mouse cursor, so its shapes are not baked either way
+    atlas->Flags |= ImFontAtlasFlags_NoMouseCursors;
+
+    // The atlas reads the font data again on every rebuild, e.g. after the
+    // device is recreated, so it is handed its own copy to free
+    void* ownedFontData = IM_ALLOC(fontDataSize);
+    memcpy(ownedFontData, fontData, fontDataSize);
+
+    ImFontConfig fontConfig;
+    fontConfig.FontDataOwnedByAtlas = true;
+    ImFont* font = atlas->AddFontFromMemoryTTF(ownedFontData, fontDataSize, sizePixels,
+                                               &fontConfig, glyphRanges);
+
+    uint64_t key = GetKey(atlas, fontData, fontDataSize, sizePixels, glyphRanges);
+    std::filesystem::path filePath = cachePath / HOMEMONITOR_FONT_ATLAS_FILE_NAME;
+
+    if (Load(atlas, font, key, filePath))
+    {
+        restored = true;
+        return font;
+    }
+
+    if (!atlas->Build())
+    {
+        std::cerr << "[ERROR] Could not build the font atlas" << std::endl;
+        atlas->Clear();
+        return nullptr;
+    }
+
+    Store(atlas, font, key, filePath);
+
+    return font;
+}
+
+/**
+ * @brief Determines if the atlas built by the last AddFont() was restored
+ *        from the cache file
+ * 
+ * @return True if rasterization was skipped. False otherwise
+ */
+bool HomeMonitorFontAtlas::Restored() const { return restored; }
+
+/**
+ * @brief Returns the glyph ranges the UI needs
+ * 
+ * @return ImWchar const * - Ranges to pass to AddFont(). Null for the
+ *                           Dear ImGui default ranges if trimming is disabled
+ */
+ImWchar const * HomeMonitorFontAtlas::GetGlyphRanges()
+{
+    #if (HOMEMONITOR_FONT_TRIM_GLYPH_RANGES)
+    return trimmedGlyphRanges;
+    #else
+    return nullptr;
+    #endif
+}
+
+/**
+ * @brief Restore the atlas texture and the font's glyphs from the cache file.
+ *        Leaves the atlas untouched if the file does not match the font
+ * 
+ * @param atlas - Atlas holding the font, not yet built
+ * @param font - Font added to the atlas
+ * @param key - Hash of the font, see GetKey()
+ * @param filePath - Path of the cache file
+ * 
+ * @return bool - True if the atlas was restored and is ready for use
+ */
+bool HomeMonitorFontAtlas::Load(ImFontAtlas* atlas, ImFont* font, uint64_t key, std::filesystem::path const & filePath)
+{
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    HomeMonitorFontAtlasHeader_t header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        (header.magic != HOMEMONITOR_FONT_ATLAS_MAGIC) ||
+        (header.version != HOMEMONITOR_FONT_ATLAS_VERSION) ||
+        (header.key != key) ||
+        (header.texWidth <= 0) || (header.texHeight <= 0) || (header.numGlyphs <= 0))
+    {
+        return false;
+    }
+
+    size_t numPixels = static_cast<size_t>(header.texWidth) * static_cast<size_t>(header.texHeight);
+    std::vector<ImFontGlyph> glyphs(header.numGlyphs);
+    unsigned int* pixels = static_cast<unsigned int*>(IM_ALLOC(numPixels * 4));
+
+    if (!file.read(reinterpret_cast<char*>(glyphs.data()), (glyphs.size() * sizeof(ImFontGlyph))) ||
+        !file.read(reinterpret_cast<char*>(pixels), (numPixels * 4)))
+    {
+        IM_FREE(pixels);
+        return false;
+    }
+
+    // Same state ImFontAtlas::Build() would leave behind
+    atlas->ClearTexData();
+    atlas->TexPixelsRGBA32 = pixels;
+    atlas->TexWidth = header.texWidth;
+    atlas->TexHeight = header.texHeight;
+    atlas->TexUvScale = ImVec2((1.0f / header.texWidth), (1.0f / header.texHeight));
+    atlas->TexUvWhitePixel = header.texUvWhitePixel;
+    memcpy(atlas->TexUvLines, header.texUvLines, sizeof(atlas->TexUvLines));
+
+    font->ClearOutputData();
+    font->ContainerAtlas = atlas;
+    font->FontSize = header.fontSize;
+    font->Ascent = header.ascent;
+    font->Descent = header.descent;
+    font->MetricsTotalSurface = header.metricsTotalSurface;
+    font->Glyphs.resize(header.numGlyphs);
+    memcpy(font->Glyphs.Data, glyphs.data(), (glyphs.size() * sizeof(ImFontGlyph)));
+    font->BuildLookupTable();
+
+    atlas->TexReady = true;
+
+    return true;
+}
+
+/**
+ * @brief Write the built atlas texture and the font's glyphs to the cache
+ *        file. The file is replaced whole, so a concurrent reader never sees
+ *        a partial atlas
+ * 
+ * @param atlas - Built atlas holding the font
+ * @param font - Font added to the atlas
+ * @param key - Hash of the font, see GetKey()
+ * @param filePath - Path of the cache file
+ * 
+ * @return bool - True if the file was written
+ */
+bool HomeMonitorFontAtlas::Store(ImFontAtlas* atlas, ImFont* font, uint64_t key, std::filesystem::path const & filePath)
+{
+    unsigned char* pixels = nullptr;
+    int texWidth = 0;
+    int texHeight = 0;
+    atlas->GetTexDataAsRGBA32(&pixels, &texWidth, &texHeight);
+
+    HomeMonitorFontAtlasHeader_t header = {};
+    header.magic = HOMEMONITOR_FONT_ATLAS_MAGIC;
+    header.version = HOMEMONITOR_FONT_ATLAS_VERSION;
+    header.key = key;
+    header.texWidth = texWidth;
+    header.texHeight = texHeight;
+    header.texUvWhitePixel = atlas->TexUvWhitePixel;
+    memcpy(header.texUvLines, atlas->TexUvLines, sizeof(header.texUvLines));
+    header.fontSize = font->FontSize;
+    header.ascent = font->Ascent;
+    header.descent = font->Descent;
+    header.metricsTotalSurface = font->MetricsTotalSurface;
+    header.numGlyphs = font->Glyphs.Size;
+
+    std::error_code error;
+    std::filesystem::path tempPath = filePath;
+    tempPath += ".tmp";
+
+    {
+        std::ofstream file(tempPath, (std::ios::binary | std::ios::trunc));
+        if (!file.is_open())
+        {
+            std::cerr << "[ERROR] Could not open " << tempPath.string() << std::endl;
+            return false;
+        }
+
+        file.write(reinterpret_cast<char const *>(&header), sizeof(header));
+        file.write(reinterpret_cast<char const *>(font->Glyphs.Data), (font->Glyphs.Size * sizeof(ImFontGlyph)));
+        file.write(reinterpret_cast<char const *>(pixels), (static_cast<size_t>(texWidth) * texHeight * 4));
+        if (!file)
+        {
+            std::cerr << "[ERROR] Could not write " << tempPath.string() << std::endl;
+            file.close();
+            std::filesystem::remove(tempPath, error);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tempPath, filePath, error);
+    if (error)
+    {
+        std::cerr << "[ERROR] Could not write " << filePath.string() << std::endl;
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Hash everything the baked atlas depends on: the font data, its
+ *        size, the glyph ranges, the atlas settings and the Dear ImGui build
+ * 
+ * @param atlas - Atlas the font is added to
+ * @param fontData - TTF/OTF data
+ * @param fontDataSize - Size of the font data in bytes
+ * @param sizePixels - Font size in pixels
+ * @param glyphRanges - Zero terminated pairs of codepoints. Null for the
+ *                      Dear ImGui default ranges
+ * 
+ * @return uint64_t - Key stored in the cache file
+ */
+uint64_t HomeMonitorFontAtlas::GetKey(ImFontAtlas const * atlas, void const * fontData, int fontDataSize,
+                                      float sizePixels, ImWchar const * glyphRanges)
+{
+    uint64_t hash = 0xCBF29CE484222325ULL;
+
+    // Glyph and texture layout may change between versions
+    int const version[] = {IMGUI_VERSION_NUM, static_cast<int>(sizeof(ImFontGlyph)), static_cast<int>(sizeof(ImWchar))};
+    hash = HomeMonitorFontAtlasHash(hash, version, sizeof(version));
+
+    hash = HomeMonitorFontAtlasHash(hash, &atlas->Flags, sizeof(atlas->Flags));
+    hash = HomeMonitorFontAtlasHash(hash, &atlas->TexDesiredWidth, sizeof(atlas->TexDesiredWidth));
+    hash = HomeMonitorFontAtlasHash(hash, &atlas->TexGlyphPadding, sizeof(atlas->TexGlyphPadding));
+    hash = HomeMonitorFontAtlasHash(hash, &sizePixels, sizeof(sizePixels));
+
+    if (glyphRanges == nullptr)
+    {
+        glyphRanges = const_cast<ImFontAtlas*>(atlas)->GetGlyphRangesDefault();
+    }
+    for (; glyphRanges[0] != 0; glyphRanges += 2)
+    {
+        hash = HomeMonitorFontAtlasHash(hash, glyphRanges, (2 * sizeof(ImWchar)));
+    }
+
+    hash = HomeMonitorFontAtlasHash(hash, &fontDataSize, sizeof(fontDataSize));
+    hash = HomeMonitorFontAtlasHash(hash, fontData, fontDataSize);
+
+    return hash;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+#include "Imgui/imgui.h"
+
+#define HOMEMONITOR_FONT_ATLAS_MAGIC        0x41464D48   // "HMFA"
+#define HOMEMONITOR_FONT_ATLAS_VERSION      1
+#define HOMEMONITOR_FONT_ATLAS_FILE_NAME    "FontAtlas.bin"
+#define HOMEMONITOR_FONT_TRIM_GLYPH_RANGES  true         // Only bake the characters the UI displays
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;                     // Hash of everything the baked atlas depends on
+
+    int32_t texWidth;
+    int32_t texHeight;
+    ImVec2 texUvWhitePixel;
+    ImVec4 texUvLines[IM_DRAWLIST_TEX_LINES_WIDTH_MAX + 1];
+
+    float fontSize;
+    float ascent;
+    float descent;
+    int32_t metricsTotalSurface;
+    int32_t numGlyphs;
+} HomeMonitorFontAtlasHeader_t;
+
+/**
+ * Font atlas baked once and restored from disk on later launches.
+ * 
+ * Rasterizing a TTF through stb_truetype and packing the atlas is a
+ * noticeable part of startup. AddFont() adds the font to the atlas as
+ * usual, then looks for a cache file holding the RGBA atlas texture and the
+ * glyph metrics baked from the same font data, size, glyph ranges and
+ * Dear ImGui version. If one is found, the atlas is marked as built from
+ * it and rasterization is skipped entirely. Otherwise the atlas is built
+ * and the result stored for the next launch:
+ * 
+ *     HomeMonitorFontAtlas fontAtlas;
+ *     fontAtlas.AddFont(io.Fonts, fontData, fontDataSize, 16.0f,
+ *                       HomeMonitorFontAtlas::GetGlyphRanges(), cachePath);
+ * 
+ * Must be called before the renderer backend creates the font texture,
+ * i.e. before the first frame.
+ */
+class HomeMonitorFontAtlas
+{
+public:
+    ImFont* AddFont(ImFontAtlas* atlas, void const * fontData, int fontDataSize, float sizePixels,
+                    ImWchar const * glyphRanges, std::filesystem::path const & cachePath);
+    bool Restored() const;
+
+    static ImWchar const * GetGlyphRanges();
+
+private:
+    // Member Variables
+    bool restored = false;   // Last atlas came from the cache file
+
+    // Member Functions
+    bool Load(ImFontAtlas* atlas, ImFont* font, uint64_t key, std::filesystem::path const & filePath);
+    bool Store(ImFontAtlas* atlas, ImFont* font, uint64_t key, std::filesystem::path const & filePath);
+
+    static uint64_t GetKey(ImFontAtlas const * atlas, void const * fontData, int fontDataSize, float sizePixels,
+                           ImWchar const * glyphRanges);
+};
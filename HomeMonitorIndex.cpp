@@ -0,0 +1,70 @@
+#include "HomeMonitorIndex.h"
+
+// Returned for channels no object uses
+static std::vector<int> const noHomeMonitors;
+
+/**
+ * @brief Index every object of a collection. O(N); only needed when the
+ *        collection changes
+ * 
+ * @param homeMonitors - Collection of HomeMonitor objects to index
+ */
+void HomeMonitorIndex::Rebuild(std::vector<HomeMonitor_t> const & homeMonitors)
+{
+    names.clear();
+    channels.clear();
+    names.reserve(homeMonitors.size());
+    channels.reserve(homeMonitors.size());
+
+    for (int index = 0; index < static_cast<int>(homeMonitors.size()); index++)
+    {
+        ThingSpeak const & thingSpeak = homeMonitors[index].thingSpeak;
+
+        // Names are unique when added from the GUI; the first one wins otherwise
+        names.try_emplace(thingSpeak.GetName(), index);
+        channels[GetChannelKey(thingSpeak.GetChannel(), thingSpeak.GetKey())].push_back(index);
+    }
+}
+
+/**
+ * @brief Find the object with a display name
+ * 
+ * @param name - Display name to look up
+ * 
+ * @return int - Position of the object within the collection. -1 if none
+ */
+int HomeMonitorIndex::FindName(std::string const & name) const
+{
+    auto found = names.find(name);
+
+    return (found != names.end()) ? found->second : -1;
+}
+
+/**
+ * @brief Find the objects reading a channel with a key
+ * 
+ * @param channel - ThingSpeak channel ID
+ * @param key - Read key of the channel
+ * 
+ * @return std::vector<int> const & - Positions of the objects within the
+ *                                    collection, in ascending order. Empty if none
+ */
+std::vector<int> const & HomeMonitorIndex::FindChannel(std::string const & channel, std::string const & key) const
+{
+    auto found = channels.find(GetChannelKey(channel, key));
+
+    return (found != channels.end()) ? found->second : noHomeMonitors;
+}
+
+/**
+ * @brief Key identifying a channel read with a key
+ * 
+ * @param channel - ThingSpeak channel ID
+ * @param key - Read key of the channel
+ * 
+ * @return std::string - "channel/key"
+ */
+std::string HomeMonitorIndex::GetChannelKey(std::string const & channel, std::string const & key)
+{
+    return (channel + "/" + key);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "HomeMonitor.h"
+
+/**
+ * Hash index over a collection of HomeMonitor objects, by display name and
+ * by channel. Lookups cost O(1) regardless of how many objects are
+ * monitored, instead of a scan of the collection per name or per fetched
+ * channel.
+ * 
+ * The index holds positions within the collection, so Rebuild() must be
+ * called whenever objects are added, removed or edited:
+ * 
+ *     homeMonitors.push_back(homeMonitor);
+ *     homeMonitorIndex.Rebuild(homeMonitors);
+ * 
+ *     for (int index : homeMonitorIndex.FindChannel(result.channel, result.key)) { ... }
+ */
+class HomeMonitorIndex
+{
+public:
+    void Rebuild(std::vector<HomeMonitor_t> const & homeMonitors);
+
+    int FindName(std::string const & name) const;
+    std::vector<int> const & FindChannel(std::string const & channel, std::string const & key) const;
+
+private:
+    // Member Variables
+    std::unordered_map<std::string, int> names;
+    std::unordered_map<std::string, std::vector<int>> channels;   // Keyed by "channel/key"
+
+    // Member Functions
+    static std::string GetChannelKey(std::string const & channel, std::string const & key);
+};
@@ -0,0 +1,141 @@
+#include <cstring>
+
+#include "HomeMonitorLineGeometry.h"
+
+#include "Imgui/implot_internal.h"
+
+/**
+ * @brief Plot a line, replaying the geometry of the previous call if
+ *        nothing it depends on changed. Must be called between
+ *        ImPlot::BeginPlot() and ImPlot::EndPlot()
+ * 
+ * @param label - Label of the line. Identifies its legend entry
+ * @param xs - X coordinates of the points
+ * @param ys - Y coordinates of the points
+ * @param count - Number of points
+ * @param flags - Line flags, as passed to ImPlot::PlotLine()
+ * @param dataRevision - Changes whenever the points change
+ */
+void HomeMonitorLineGeometry::PlotLine(char const * label, double const * xs, double const * ys, int count,
+                                       ImPlotLineFlags flags, uint64_t dataRevision)
+{
+    ImPlotPlot& plot = *ImPlot::GetCurrentPlot();
+    ImDrawList& drawList = *ImPlot::GetPlotDrawList();
+    ImPlotRect limits = ImPlot::GetPlotLimits();
+    ImPlotItem const * item = plot.Items.GetItem(label);
+
+    HomeMonitorLineKey_t current = {};
+    current.dataRevision = dataRevision;
+    current.flags = flags;
+    current.plotSize = plot.PlotRect.GetSize();
+    current.xMin = limits.X.Min;
+    current.xMax = limits.X.Max;
+    current.yMin = limits.Y.Min;
+    current.yMax = limits.Y.Max;
+    current.lineWeight = ImPlot::GetStyle().LineWeight;
+    current.lineColor = ImGui::GetColorU32(ImPlot::GetStyle().Colors[ImPlotCol_Line]);
+    current.itemColor = (item != nullptr) ? item->Color : 0;
+    current.highlighted = (item != nullptr) && item->LegendHovered;
+    current.drawListFlags = drawList.Flags;
+    current.whitePixelUv = ImGui::GetFontTexUvWhitePixel();
+
+    replayed = false;
+
+    // Fitting needs the points themselves, which only ImPlot looks at
+    if (valid && (item != nullptr) && !plot.FitThisFrame && Matches(current))
+    {
+        if (!ImPlot::BeginItem(label, flags, ImPlotCol_Line))
+        {
+            return;
+        }
+
+        // Starts a new draw command itself if the indices would overflow
+        int numVertices = static_cast<int>(vertices.size());
+        int numIndices = static_cast<int>(indices.size());
+        drawList.PrimReserve(numIndices, numVertices);
+
+        ImVec2 offset(plot.PlotRect.Min.x - origin.x, plot.PlotRect.Min.y - origin.y);
+        for (ImDrawVert const & vertex : vertices)
+        {
+            drawList._VtxWritePtr->pos = ImVec2(vertex.pos.x + offset.x, vertex.pos.y + offset.y);
+            drawList._VtxWritePtr->uv = vertex.uv;
+            drawList._VtxWritePtr->col = vertex.col;
+            drawList._VtxWritePtr++;
+        }
+
+        unsigned int base = drawList._VtxCurrentIdx;
+        for (unsigned int index : indices)
+        {
+            *drawList._IdxWritePtr++ = static_cast<ImDrawIdx>(base + index);
+        }
+        drawList._VtxCurrentIdx += numVertices;
+
+        ImPlot::EndItem();
+
+        replayed = true;
+        return;
+    }
+
+    int firstVertex = drawList.VtxBuffer.Size;
+    int firstIndex = drawList.IdxBuffer.Size;
+    unsigned int firstVertexIndex = drawList._VtxCurrentIdx;
+
+    ImPlot::PlotLine(label, xs, ys, count, flags);
+
+    int numVertices = drawList.VtxBuffer.Size - firstVertex;
+    int numIndices = drawList.IdxBuffer.Size - firstIndex;
+
+    // Lines split across draw commands restart their indices; not retained
+    valid = (drawList._VtxCurrentIdx == (firstVertexIndex + numVertices));
+    if (!valid)
+    {
+        return;
+    }
+
+    key = current;
+    origin = plot.PlotRect.Min;
+
+    vertices.resize(numVertices);
+    if (numVertices > 0)
+    {
+        std::memcpy(vertices.data(), (drawList.VtxBuffer.Data + firstVertex), (numVertices * sizeof(ImDrawVert)));
+    }
+
+    indices.resize(numIndices);
+    for (int i = 0; i < numIndices; i++)
+    {
+        indices[i] = static_cast<unsigned int>(drawList.IdxBuffer[firstIndex + i]) - firstVertexIndex;
+    }
+}
+
+/**
+ * @brief Force the line to be plotted through ImPlot on the next call
+ * 
+ */
+void HomeMonitorLineGeometry::Invalidate() { valid = false; }
+
+/**
+ * @brief Determine if the last PlotLine() call replayed retained geometry
+ * 
+ * @return bool - True if replayed. False if ImPlot tessellated the line
+ */
+bool HomeMonitorLineGeometry::Replayed() const { return replayed; }
+
+/**
+ * @brief Compare a key against the key the geometry was captured with
+ * 
+ * @param other - Key of the line about to be plotted
+ * 
+ * @return bool - True if the captured geometry can be replayed
+ */
+bool HomeMonitorLineGeometry::Matches(HomeMonitorLineKey_t const & other) const
+{
+    return ((key.dataRevision == other.dataRevision) && (key.flags == other.flags) &&
+            (key.plotSize.x == other.plotSize.x) && (key.plotSize.y == other.plotSize.y) &&
+            (key.xMin == other.xMin) && (key.xMax == other.xMax) &&
+            (key.yMin == other.yMin) && (key.yMax == other.yMax) &&
+            (key.lineWeight == other.lineWeight) && (key.lineColor == other.lineColor) &&
+            (key.itemColor == other.itemColor) && (key.highlighted == other.highlighted) &&
+            (key.drawListFlags == other.drawListFlags) &&
+            (key.whitePixelUv.x == other.whitePixelUv.x) && (key.whitePixelUv.y == other.whitePixelUv.y));
+}
\ No newline at end of file
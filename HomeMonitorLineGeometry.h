@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Imgui/imgui.h"
+#include "Imgui/implot.h"
+
+// Everything the tessellated geometry of a line depends on, other than the
+// position of the plot on screen
+typedef struct
+{
+    uint64_t dataRevision;    // Revision of the plotted points, e.g. ThingSpeakSeriesLod::Revision()
+    ImPlotLineFlags flags;
+    ImVec2 plotSize;          // Pixels
+    double xMin;
+    double xMax;
+    double yMin;
+    double yMax;
+    float lineWeight;
+    ImU32 lineColor;
+    ImU32 itemColor;
+    bool highlighted;         // Legend entry hovered, which thickens the line
+    ImDrawListFlags drawListFlags;
+    ImVec2 whitePixelUv;      // Moves if the font atlas is rebuilt
+} HomeMonitorLineKey_t;
+
+/**
+ * Retained geometry of one plotted line.
+ * 
+ * ImPlot tessellates a line into anti-aliased triangles in the window's
+ * draw list on every call, even when nothing about the line changed. The
+ * first time a line is plotted, the vertices and indices ImPlot appended
+ * are copied out. On later frames with an identical key, the copy is
+ * replayed into the draw list instead, which is a copy of the buffers with
+ * the plot's screen offset and the draw list's index base applied. The
+ * legend entry and item state are still registered with ImPlot each frame.
+ * 
+ * Lines are plotted through ImPlot whenever the key changes, the plot is
+ * fitting its axes this frame, or the geometry did not fit in one draw
+ * command, so the result on screen is always what ImPlot would draw:
+ * 
+ *     geometry.PlotLine(label, lod.Xs(), lod.Ys(), lod.Size(), flags, lod.Revision());
+ */
+class HomeMonitorLineGeometry
+{
+public:
+    void PlotLine(char const * label, double const * xs, double const * ys, int count,
+                  ImPlotLineFlags flags, uint64_t dataRevision);
+    void Invalidate();
+    bool Replayed() const;
+
+private:
+    // Member Variables
+    bool valid = false;
+    bool replayed = false;
+    HomeMonitorLineKey_t key = {};
+    ImVec2 origin;                       // Top left of the plot area when captured
+
+    std::vector<ImDrawVert> vertices;
+    std::vector<unsigned int> indices;   // Relative to the first vertex
+
+    // Member Functions
+    bool Matches(HomeMonitorLineKey_t const & other) const;
+};
\ No newline at end of file
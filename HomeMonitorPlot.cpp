@@ -0,0 +1,390 @@
+#include <algorithm>
+#include <ranges>
+#include <cmath>
+#include <cfloat>
+
+#include "HomeMonitor.h"
+
+/**
+ * @brief Get the plot series of a field as fetched
+ * 
+ * @param field - Type of field data
+ * 
+ * @return HomeMonitorPlotSeries_t - Plot series of the field
+ */
+HomeMonitorPlotSeries_t HomeMonitorGetFieldSeries(ThingSpeakField field)
+{
+    return {static_cast<int>(field), false};
+}
+
+/**
+ * @brief Get the plot series of one of the default derived series
+ * 
+ * @param derivedField - Derived series
+ * 
+ * @return HomeMonitorPlotSeries_t - Plot series of the derived series
+ */
+HomeMonitorPlotSeries_t HomeMonitorGetDerivedSeries(ThingSpeakDerivedField derivedField)
+{
+    return {static_cast<int>(derivedField), true};
+}
+
+/**
+ * @brief Get the index of a plot series into per-viewer arrays, e.g.
+ *        HomeMonitor_t::plotLods. Fields come first, then derived series
+ * 
+ * @param plotSeries - Series plotted
+ * 
+ * @return int - Index from 0 to HOMEMONITOR_NUM_PLOT_SERIES - 1
+ */
+int HomeMonitorGetPlotIndex(HomeMonitorPlotSeries_t plotSeries)
+{
+    return ((plotSeries.derived ? THINGSPEAK_NUM_FIELDS : 0) +
+            (plotSeries.fieldNumber - THINGSPEAK_LOWEST_FIELD_NUMBER));
+}
+
+/**
+ * @brief Get the feed holding a plot series, plotted at column
+ *        plotSeries.fieldNumber. Derived series are as of the last
+ *        ThingSpeakDerivedSeries::Update()
+ * 
+ * @param homeMonitor - HomeMonitor object plotted
+ * @param plotSeries - Series plotted
+ * 
+ * @return ThingSpeakFeedData_t const* - Fetched or derived feed
+ */
+ThingSpeakFeedData_t const * HomeMonitorGetPlotData(HomeMonitor_t const & homeMonitor,
+                                                    HomeMonitorPlotSeries_t plotSeries)
+{
+    return (plotSeries.derived ? &homeMonitor.derivedSeries.GetFeedData()
+                               : homeMonitor.thingSpeak.GetFeedData());
+}
+
+/**
+ * @brief Bring the aggregates of a series up to date for every HomeMonitor
+ *        object provided. Only entries received since the last call are
+ *        added, so this is cheap to call every frame
+ * 
+ * @param plotSeries - Series plotted
+ * @param homeMonitors - Collection of HomeMonitor objects plotted
+ */
+void HomeMonitorUpdateRollups(HomeMonitorPlotSeries_t plotSeries, HomeMonitorView_t homeMonitors)
+{
+    for (HomeMonitor_t* homeMonitor : homeMonitors)
+    {
+        ThingSpeakSeriesRollup& rollup = homeMonitor->fieldRollups[HomeMonitorGetPlotIndex(plotSeries)];
+        rollup.Update(HomeMonitorGetPlotData(*homeMonitor, plotSeries)->series, plotSeries.fieldNumber);
+    }
+}
+
+/**
+ * @brief Compare a point against the closest found so far, by its distance
+ *        from the cursor on screen
+ * 
+ * @param x - Plot X coordinate of the point
+ * @param value - Field value of the point. NaN values are never closest
+ * @param sameColumn - Point is the nearer of the two samples either side of
+ *                     the cursor, so it is considered however far away
+ * @param mousePos - Cursor position in plot coordinates
+ * @param pixelsPerUnit - Size of one plot unit on screen, per axis
+ * @param minDistance - Squared distance of the closest point so far.
+ *                      Updated if this point is closer
+ * 
+ * @return bool - True if this point is now the closest
+ */
+static bool HomeMonitorIsCloserToMouse(double x, float value, bool sameColumn, ImPlotPoint mousePos,
+                                       ImVec2 pixelsPerUnit, float& minDistance)
+{
+    float xDistance = std::abs(static_cast<float>(mousePos.x - x) * pixelsPerUnit.x);
+
+    // Point must be in the same column as cursor, or close to it on screen
+    if ((!sameColumn && (xDistance > HOMEMONITOR_HOVER_RADIUS_PIXELS)) || std::isnan(value))
+    {
+        return false;
+    }
+
+    float yDistance = std::abs(static_cast<float>(mousePos.y - value) * pixelsPerUnit.y);
+    float distance = (xDistance * xDistance) + (yDistance * yDistance);
+    if (distance >= minDistance)
+    {
+        return false;
+    }
+
+    minDistance = distance;
+
+    return true;
+}
+
+/**
+ * @brief Determine the closest point to the cursor from the set of points
+ *        currently marked visible in the graph
+ * 
+ *        Sample j of every series is plotted at x = j, so the only samples
+ *        which can be horizontally nearest are the two either side of the
+ *        cursor. Each series is therefore checked in constant time, and the
+ *        candidates are compared by their distance on screen.
+ * 
+ * @param plotSeries - Series to search
+ * @param homeMonitors - Collection of HomeMonitor objects to traverse
+ * @param mousePos - Cursor position in plot coordinates
+ * @param pixelsPerUnit - Size of one plot unit on screen, per axis
+ * @return std::pair<int, int> - Pair containing:
+ *                               (1) The HomeMonitor object with the nearest point,
+ *                               (2) The index of the closest point from the
+ *                                   points stored in the HomeMonitor object
+ *                               Or a negative pair {-1, -1} if not point exists
+ */
+std::pair<int, int> HomeMonitorGetClosestPointToMouse(HomeMonitorPlotSeries_t plotSeries,
+                                                      HomeMonitorView_t homeMonitors,
+                                                      ImPlotPoint mousePos,
+                                                      ImVec2 pixelsPerUnit)
+{
+    float minDistance = FLT_MAX;
+
+    std::pair<int, int> closestValue = {-1, -1};
+    int fieldNumber = plotSeries.fieldNumber;
+    ThingSpeakFeedData_t const * dataset;
+
+    for (int i = 0; i < homeMonitors.size(); i++)
+    {
+        dataset = HomeMonitorGetPlotData(*homeMonitors[i], plotSeries);
+
+        int numDataPoints = dataset->series.Size();
+        if (numDataPoints == 0)
+        {
+            continue;
+        }
+
+        int left = std::clamp(static_cast<int>(std::floor(mousePos.x)), 0, (numDataPoints - 1));
+        int right = std::clamp(static_cast<int>(std::ceil(mousePos.x)), 0, (numDataPoints - 1));
+
+        for (int j : {left, right})
+        {
+            bool sameColumn = (std::abs(mousePos.x - j) <= 0.5);
+            if (HomeMonitorIsCloserToMouse(j, dataset->series.Value(fieldNumber, j), sameColumn,
+                                           mousePos, pixelsPerUnit, minDistance))
+            {
+                closestValue.first = i;
+                closestValue.second = j;
+            }
+        }
+    }
+
+    return closestValue;
+}
+
+/**
+ * @brief Determine the closest point to the cursor on a time axis, where
+ *        samples are plotted at their timestamp
+ * 
+ *        Timestamps of a series are sorted, so the two samples either side
+ *        of the cursor are found by binary search, and compared by their
+ *        distance on screen like HomeMonitorGetClosestPointToMouse().
+ * 
+ * @param seriesList - Series plotted, e.g. the fetched tiles of a range
+ * @param fieldNumber - ThingSpeak field number plotted
+ * @param mousePos - Cursor position in plot coordinates. X is UTC epoch seconds
+ * @param pixelsPerUnit - Size of one plot unit on screen, per axis
+ * 
+ * @return std::pair<int, int> - Pair containing:
+ *                               (1) The index into seriesList of the series
+ *                                   with the nearest point,
+ *                               (2) The sample index of the nearest point
+ *                               Or a negative pair {-1, -1} if not point exists
+ */
+std::pair<int, int> HomeMonitorGetClosestPointByTime(std::span<ThingSpeakSeries const * const> seriesList,
+                                                     int fieldNumber,
+                                                     ImPlotPoint mousePos,
+                                                     ImVec2 pixelsPerUnit)
+{
+    float minDistance = FLT_MAX;
+    std::pair<int, int> closestValue = {-1, -1};
+
+    for (int i = 0; i < static_cast<int>(seriesList.size()); i++)
+    {
+        ThingSpeakSeries const & series = *seriesList[i];
+        int numDataPoints = series.Size();
+        if (numDataPoints == 0)
+        {
+            continue;
+        }
+
+        // First sample at or after the cursor. The column may be wrapped, so
+        // samples are searched by index
+        auto indices = std::views::iota(0, numDataPoints);
+        int right = *std::ranges::lower_bound(indices, static_cast<int64_t>(std::ceil(mousePos.x)), {},
+                                              [&series](int index) { return series.Timestamp(index); });
+        int left = std::max(right - 1, 0);
+        right = std::min(right, (numDataPoints - 1));
+
+        // The nearer of the two is in the cursor's column
+        double leftGap = std::abs(mousePos.x - static_cast<double>(series.Timestamp(left)));
+        double rightGap = std::abs(mousePos.x - static_cast<double>(series.Timestamp(right)));
+
+        for (int j : {left, right})
+        {
+            bool sameColumn = ((j == left) ? (leftGap <= rightGap) : (rightGap <= leftGap));
+            if (HomeMonitorIsCloserToMouse(static_cast<double>(series.Timestamp(j)), series.Value(fieldNumber, j),
+                                           sameColumn, mousePos, pixelsPerUnit, minDistance))
+            {
+                closestValue.first = i;
+                closestValue.second = j;
+            }
+        }
+    }
+
+    return closestValue;
+}
+
+/**
+ * @brief Determine left and right X-axis (horizontal) boundaries based on
+ *        the longest series of the HomeMonitor objects provided
+ * 
+ * @param plotSeries - Series plotted
+ * @param homeMonitors - Collection of HomeMonitor objects plotted
+ * 
+ * @return std::pair<float, float> - Min, Max X-Axis boundaries
+ */
+std::pair<float, float> HomeMonitorGetXAxisBoundaries(HomeMonitorPlotSeries_t plotSeries,
+                                                      HomeMonitorView_t homeMonitors)
+{
+    int numDataPoints = 1;
+
+    ThingSpeakFeedData_t const * dataset;
+
+    for (HomeMonitor_t const * homeMonitor : homeMonitors)
+    {
+        dataset = HomeMonitorGetPlotData(*homeMonitor, plotSeries);
+        numDataPoints = std::max(dataset->series.Size(), numDataPoints);
+    }
+
+    return {0.0f, static_cast<float>(numDataPoints - 1)};
+}
+
+/**
+ * @brief Map an X-axis range of the plot onto the sample indices it shows.
+ *        Samples are plotted at x = sample index
+ * 
+ * @param series - Series plotted
+ * @param xMin - Left X-axis limit of the plot, in samples. Non-finite for
+ *               the whole series
+ * @param xMax - Right X-axis limit of the plot, in samples. Non-finite for
+ *               the whole series
+ * 
+ * @return std::pair<int, int> - First sample index and one past the last
+ */
+static std::pair<int, int> HomeMonitorGetVisibleIndices(ThingSpeakSeries const & series,
+                                                        double xMin, double xMax)
+{
+    if (!std::isfinite(xMin) || !std::isfinite(xMax))
+    {
+        return {0, series.Size()};
+    }
+
+    int first = static_cast<int>(std::clamp(std::ceil(xMin), 0.0, static_cast<double>(series.Size())));
+    int end = static_cast<int>(std::clamp(std::floor(xMax) + 1.0, 0.0, static_cast<double>(series.Size())));
+
+    return {first, end};
+}
+
+/**
+ * @brief Determine upper and lower Y-axis (vertical) boundaries based on
+ *        data within an X-axis range. Uses the field's aggregates, which
+ *        must be up to date; see HomeMonitorUpdateRollups()
+ * 
+ * @param plotSeries - Series plotted
+ * @param homeMonitors - Collection of HomeMonitor objects plotted
+ * @param xMin - Left X-axis limit, in samples. NAN for all samples
+ * @param xMax - Right X-axis limit, in samples. NAN for all samples
+ * 
+ * @return std::pair<float, float> - Min, Max Y-Axis boundaries. Min exceeds
+ *                                   Max if no values lie within the range
+ */
+std::pair<float, float> HomeMonitorGetYAxisBoundaries(HomeMonitorPlotSeries_t plotSeries,
+                                                      HomeMonitorView_t homeMonitors,
+                                                      double xMin, double xMax)
+{
+    float yMin = FLT_MAX;
+    float yMax = -FLT_MAX;
+
+    ThingSpeakFeedData_t const * dataset;
+
+    for (HomeMonitor_t const * homeMonitor : homeMonitors)
+    {
+        if (homeMonitor->displayData)
+        {
+            dataset = HomeMonitorGetPlotData(*homeMonitor, plotSeries);
+            std::pair<int, int> visible = HomeMonitorGetVisibleIndices(dataset->series, xMin, xMax);
+
+            // Entries which did not provide the field are excluded
+            ThingSpeakRollupSummary_t summary =
+                homeMonitor->fieldRollups[HomeMonitorGetPlotIndex(plotSeries)].Query(
+                    dataset->series, visible.first, visible.second);
+            if (summary.numValues == 0)
+            {
+                continue;
+            }
+
+            yMin = std::min(summary.minValue, yMin);
+            yMax = std::max(summary.maxValue, yMax);
+        }
+    }
+
+    return {yMin, yMax};
+}
+
+/**
+ * @brief Compute statistics of the values of a field within the visible
+ *        X-axis range
+ * 
+ * @param plotSeries - Series plotted
+ * @param homeMonitor - HomeMonitor object plotted
+ * @param xMin - Left X-axis limit of the plot, in samples
+ * @param xMax - Right X-axis limit of the plot, in samples
+ * 
+ * @return ThingSpeakSeriesStats_t - Number of values, min, max, sum and sum
+ *                                   of squares of samples within the limits
+ */
+ThingSpeakSeriesStats_t HomeMonitorGetVisibleStats(HomeMonitorPlotSeries_t plotSeries,
+                                                   HomeMonitor_t const & homeMonitor,
+                                                   double xMin, double xMax)
+{
+    ThingSpeakSeries const & series = HomeMonitorGetPlotData(homeMonitor, plotSeries)->series;
+    std::pair<int, int> visible = HomeMonitorGetVisibleIndices(series, xMin, xMax);
+
+    return ThingSpeakGetSeriesStats(series, plotSeries.fieldNumber, visible.first, visible.second);
+}
+
+/**
+ * @brief Determine the name to display a field under. The name assigned
+ *        by the first channel publishing the field is used
+ * 
+ * @param field - Type of field data
+ * @param homeMonitors - Collection of HomeMonitor objects to traverse
+ * 
+ * @return std::string - Name of the field, "Field N" if no channel named it,
+ *                       or empty if no channel publishes the field
+ */
+std::string HomeMonitorGetFieldName(ThingSpeakField field,
+                                    std::vector<HomeMonitor_t> const & homeMonitors)
+{
+    int fieldNumber = static_cast<int>(field);
+    bool published = false;
+
+    for (HomeMonitor_t const & homeMonitor : homeMonitors)
+    {
+        if (!homeMonitor.thingSpeak.GetFeedData()->series.HasField(fieldNumber))
+        {
+            continue;
+        }
+
+        std::string const & fieldName = homeMonitor.thingSpeak.GetFieldName(field);
+        if (!fieldName.empty())
+        {
+            return fieldName;
+        }
+        published = true;
+    }
+
+    return (published ? ("Field " + std::to_string(fieldNumber)) : std::string());
+}
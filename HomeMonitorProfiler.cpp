@@ -0,0 +1,562 @@
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+
+#include "Imgui/imgui.h"
+#include "Imgui/implot.h"
+
+#include "HomeMonitorProfiler.h"
+
+// Heap allocations made by the current thread. A plain thread_local keeps
+// counting to a single increment per allocation
+static thread_local uint64_t threadAllocationCount = 0;
+
+/**
+ * @brief Replacement global allocator which counts allocations made by
+ *        each thread. Array and nothrow forms forward to this by default
+ * 
+ * @param size - Number of bytes to allocate
+ * 
+ * @return void* - Allocated memory
+ */
+void* operator new(std::size_t size)
+{
+    threadAllocationCount++;
+
+    void* memory = std::malloc((size > 0) ? size : 1);
+    if (memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    return memory;
+}
+
+/**
+ * @brief Release memory from the replacement global allocator
+ * 
+ * @param memory - Memory to release
+ */
+void operator delete(void* memory) noexcept { std::free(memory); }
+
+/**
+ * @brief Release memory from the replacement global allocator
+ * 
+ * @param memory - Memory to release
+ * @param size - Size originally requested
+ */
+void operator delete(void* memory, [[maybe_unused]] std::size_t size) noexcept { std::free(memory); }
+
+/**
+ * @brief Add a measurement, overwriting the oldest if full
+ * 
+ * @param value - Measurement to add
+ */
+void HomeMonitorRingBuffer::Push(float value)
+{
+    values[head] = value;
+    head = ((head + 1) == HOMEMONITOR_PROFILER_HISTORY_SIZE) ? 0 : (head + 1);
+    size = std::min((size + 1), HOMEMONITOR_PROFILER_HISTORY_SIZE);
+}
+
+/**
+ * @brief Number of measurements held
+ * 
+ * @return int - Number of measurements
+ */
+int HomeMonitorRingBuffer::Size() const { return size; }
+
+/**
+ * @brief Slot of the oldest measurement within Data(). Used as the offset
+ *        argument of ImPlot plotting functions
+ * 
+ * @return int - Offset of oldest measurement
+ */
+int HomeMonitorRingBuffer::Offset() const { return (size < HOMEMONITOR_PROFILER_HISTORY_SIZE) ? 0 : head; }
+
+/**
+ * @brief Raw measurements. May be wrapped; see Offset()
+ * 
+ * @return float const* - Measurements
+ */
+float const * HomeMonitorRingBuffer::Data() const { return values.data(); }
+
+/**
+ * @brief Get a measurement
+ * 
+ * @param index - Measurement index. 0 is the oldest measurement
+ * 
+ * @return float - Measurement
+ */
+float HomeMonitorRingBuffer::Value(int index) const
+{
+    return values[(Offset() + index) % HOMEMONITOR_PROFILER_HISTORY_SIZE];
+}
+
+/**
+ * @brief Get the newest measurement
+ * 
+ * @return float - Newest measurement. 0 if empty
+ */
+float HomeMonitorRingBuffer::Latest() const { return (size > 0) ? Value(size - 1) : 0.0f; }
+
+/**
+ * @brief Get the mean of the measurements held
+ * 
+ * @return float - Mean measurement. 0 if empty
+ */
+float HomeMonitorRingBuffer::Mean() const
+{
+    if (size == 0)
+    {
+        return 0.0f;
+    }
+
+    double sum = 0.0;
+    for (int i = 0; i < size; i++)
+    {
+        sum += values[i];
+    }
+
+    return static_cast<float>(sum / size);
+}
+
+/**
+ * @brief Get the largest of the measurements held
+ * 
+ * @return float - Largest measurement. 0 if empty
+ */
+float HomeMonitorRingBuffer::Max() const
+{
+    return (size > 0) ? *std::max_element(values.begin(), (values.begin() + size)) : 0.0f;
+}
+
+/**
+ * @brief Create a profiler with no recorded frames or fetches
+ * 
+ */
+HomeMonitorProfiler::HomeMonitorProfiler() :
+    createdTime(HomeMonitorProfilerClock::now()), frameStartTime(createdTime)
+{
+    startupMs.fill(-1.0f);
+}
+
+/**
+ * @brief Mark the start of a frame
+ * 
+ */
+void HomeMonitorProfiler::BeginFrame()
+{
+    frameStartTime = HomeMonitorProfilerClock::now();
+    frameStartAllocations = threadAllocationCount;
+    stageTimes.fill(HomeMonitorProfilerClock::duration::zero());
+}
+
+/**
+ * @brief Mark the end of a frame, recording its stage times and allocations.
+ *        Time not attributed to another stage is counted as Build
+ * 
+ */
+void HomeMonitorProfiler::EndFrame()
+{
+    HomeMonitorProfilerClock::duration frameTime = HomeMonitorProfilerClock::now() - frameStartTime;
+
+    HomeMonitorProfilerClock::duration buildTime = frameTime;
+    for (int stage = 0; stage < static_cast<int>(HomeMonitorFrameStage::Count); stage++)
+    {
+        if (stage != static_cast<int>(HomeMonitorFrameStage::Build))
+        {
+            buildTime -= stageTimes[stage];
+        }
+    }
+    stageTimes[static_cast<int>(HomeMonitorFrameStage::Build)] += buildTime;
+
+    for (int stage = 0; stage < static_cast<int>(HomeMonitorFrameStage::Count); stage++)
+    {
+        std::chrono::duration<float, std::milli> stageMs = stageTimes[stage];
+        frameStageMs[stage].Push(stageMs.count());
+    }
+
+    std::chrono::duration<float> startSeconds = frameStartTime - createdTime;
+    frameStartSeconds.Push(startSeconds.count());
+    frameAllocations.Push(static_cast<float>(threadAllocationCount - frameStartAllocations));
+
+    numFrames++;
+}
+
+/**
+ * @brief Attribute time to a stage of the current frame
+ * 
+ * @param stage - Stage the time was spent in
+ * @param duration - Time spent
+ */
+void HomeMonitorProfiler::AddStageTime(HomeMonitorFrameStage stage, HomeMonitorProfilerClock::duration duration)
+{
+    stageTimes[static_cast<int>(stage)] += duration;
+}
+
+/**
+ * @brief Record the measurements of a fetch
+ * 
+ * @param result - Result of the fetch
+ * @param name - Display name of the channel
+ * @param ingestDuration - Time taken to apply and cache the result
+ */
+void HomeMonitorProfiler::RecordFetch(ThingSpeakFetchResult_t const & result, std::string const & name,
+                                      HomeMonitorProfilerClock::duration ingestDuration)
+{
+    std::chrono::duration<float> timeSeconds = HomeMonitorProfilerClock::now() - createdTime;
+    std::chrono::duration<float, std::milli> ingestMs = ingestDuration;
+
+    HomeMonitorFetchSample_t& sample = fetches[fetchHead];
+    sample.timeSeconds = timeSeconds.count();
+    sample.channel = result.channel;
+    sample.requestMs = static_cast<float>(result.requestSeconds * 1000.0);
+    sample.parseMs = static_cast<float>(result.parseSeconds * 1000.0);
+    sample.ingestMs = ingestMs.count();
+    sample.bytes = result.bytesDownloaded;
+    sample.points = result.feedData.series.Size();
+
+    fetchHead = ((fetchHead + 1) == HOMEMONITOR_PROFILER_HISTORY_SIZE) ? 0 : (fetchHead + 1);
+    numFetchSamples = std::min((numFetchSamples + 1), HOMEMONITOR_PROFILER_HISTORY_SIZE);
+
+    HomeMonitorChannelProfile_t& channel = channels[result.channel];
+    channel.name = name;
+    channel.numFetches++;
+    channel.numFailures += result.validDataFetched ? 0 : 1;
+    channel.numNotModified += result.notModified ? 1 : 0;
+    channel.totalBytes += sample.bytes;
+    channel.totalPoints += sample.points;
+    channel.requestMs.Push(sample.requestMs);
+    channel.parseMs.Push(sample.parseMs);
+    channel.ingestMs.Push(sample.ingestMs);
+}
+
+/**
+ * @brief Record the time a startup milestone was reached. Only the first
+ *        time a stage is marked is kept
+ * 
+ * @param stage - Milestone reached
+ * @param time - Time the milestone was reached, e.g. on another thread
+ */
+void HomeMonitorProfiler::MarkStartup(HomeMonitorStartupStage stage, HomeMonitorProfilerClock::time_point time)
+{
+    float& stageMs = startupMs[static_cast<int>(stage)];
+    if (stageMs < 0.0f)
+    {
+        stageMs = std::chrono::duration<float, std::milli>(time - createdTime).count();
+    }
+}
+
+/**
+ * @brief Determines if a startup milestone has been reached
+ * 
+ * @param stage - Milestone to check
+ * 
+ * @return True if marked. False otherwise
+ */
+bool HomeMonitorProfiler::StartupMarked(HomeMonitorStartupStage stage) const
+{
+    return (startupMs[static_cast<int>(stage)] >= 0.0f);
+}
+
+/**
+ * @brief Determines if every startup milestone has been reached
+ * 
+ * @return True if all stages are marked. False otherwise
+ */
+bool HomeMonitorProfiler::StartupComplete() const
+{
+    return std::all_of(startupMs.begin(), startupMs.end(), [](float stageMs) { return (stageMs >= 0.0f); });
+}
+
+/**
+ * @brief Append the startup timeline to a CSV file, writing the header if
+ *        the file is new. Only the first call does anything; milestones not
+ *        reached by then are left empty
+ * 
+ * @param path - File to append to
+ * 
+ * @return bool - True if the timeline was written, now or by an earlier call
+ */
+bool HomeMonitorProfiler::LogStartup(std::filesystem::path const & path)
+{
+    if (startupLogged)
+    {
+        return true;
+    }
+    startupLogged = true;
+
+    std::error_code error;
+    bool newFile = !std::filesystem::exists(path, error);
+
+    std::ofstream file(path, std::ios::app);
+    if (!file.is_open())
+    {
+        std::cerr << "[ERROR] Couldn't open " << path.string() << std::endl;
+        return false;
+    }
+
+    if (newFile)
+    {
+        file << "launched_utc,window_ms,backends_ms,first_frame_ms,config_ms,"
+                "first_data_ms,caches_ms,first_fetch_ms\n";
+    }
+
+    auto launchTime = std::chrono::system_clock::now() - (HomeMonitorProfilerClock::now() - createdTime);
+    file << std::chrono::duration_cast<std::chrono::seconds>(launchTime.time_since_epoch()).count();
+    for (float stageMs : startupMs)
+    {
+        file << ",";
+        if (stageMs >= 0.0f)
+        {
+            file << stageMs;
+        }
+    }
+    file << "\n";
+
+    return file.good();
+}
+
+/**
+ * @brief Create "Performance" window showing the recorded measurements
+ * 
+ * @param open - Cleared if the window is closed
+ * @param tracePath - File written when a CSV trace is requested
+ */
+void HomeMonitorProfiler::Draw(bool* open, std::filesystem::path const & tracePath)
+{
+    if (!ImGui::Begin("Performance", open))
+    {
+        ImGui::End();
+        return;
+    }
+
+    ImGuiIO& io = ImGui::GetIO();
+    ImGui::Text("Averaging %.1f FPS (%.3f ms/frame)", io.Framerate, (1000.0f / io.Framerate));
+    ImGui::Text("Frames recorded: %lld", numFrames);
+
+    if (ImGui::Button("Dump CSV Trace"))
+    {
+        traceStatus = DumpCsv(tracePath) ? ("Wrote " + tracePath.string())
+                                         : ("Couldn't write " + tracePath.string());
+    }
+    if (!traceStatus.empty())
+    {
+        ImGui::SameLine();
+        ImGui::TextUnformatted(traceStatus.c_str());
+    }
+
+    DrawStartup();
+    DrawFrameTimes();
+    DrawChannels();
+
+    ImGui::End();   // Performance
+}
+
+/**
+ * @brief Write every recorded frame and fetch to a CSV file, oldest first
+ * 
+ * @param path - File to write
+ * 
+ * @return bool - True if the file was written
+ */
+bool HomeMonitorProfiler::DumpCsv(std::filesystem::path const & path) const
+{
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        std::cerr << "[ERROR] Couldn't open " << path.string() << std::endl;
+        return false;
+    }
+
+    file << "event,time_s,channel,build_ms,wait_ms,present_ms,allocations,"
+            "request_ms,parse_ms,ingest_ms,bytes,points\n";
+
+    for (int i = 0; i < frameStartSeconds.Size(); i++)
+    {
+        file << "frame," << frameStartSeconds.Value(i) << ",,"
+             << frameStageMs[static_cast<int>(HomeMonitorFrameStage::Build)].Value(i) << ","
+             << frameStageMs[static_cast<int>(HomeMonitorFrameStage::Wait)].Value(i) << ","
+             << frameStageMs[static_cast<int>(HomeMonitorFrameStage::Present)].Value(i) << ","
+             << frameAllocations.Value(i) << ",,,,,\n";
+    }
+
+    int firstFetch = (numFetchSamples < HOMEMONITOR_PROFILER_HISTORY_SIZE) ? 0 : fetchHead;
+    for (int i = 0; i < numFetchSamples; i++)
+    {
+        HomeMonitorFetchSample_t const & sample = fetches[(firstFetch + i) % HOMEMONITOR_PROFILER_HISTORY_SIZE];
+
+        file << "fetch," << sample.timeSeconds << "," << sample.channel << ",,,,,"
+             << sample.requestMs << "," << sample.parseMs << "," << sample.ingestMs << ","
+             << sample.bytes << "," << sample.points << "\n";
+    }
+
+    return file.good();
+}
+
+/**
+ * @brief Get the number of heap allocations made by the calling thread
+ * 
+ * @return uint64_t - Allocations made since the thread started
+ */
+uint64_t HomeMonitorProfiler::GetThreadAllocationCount() { return threadAllocationCount; }
+
+/**
+ * @brief Show the time each startup milestone was reached
+ * 
+ */
+void HomeMonitorProfiler::DrawStartup()
+{
+    static char const * const stageNames[] = {"Window", "Backends", "First Frame", "Config",
+                                              "First Data", "Caches", "First Fetch"};
+    static_assert(IM_ARRAYSIZE(stageNames) == static_cast<int>(HomeMonitorStartupStage::Count));
+
+    if (!ImGui::CollapsingHeader("Startup"))
+    {
+        return;
+    }
+
+    for (int stage = 0; stage < static_cast<int>(HomeMonitorStartupStage::Count); stage++)
+    {
+        if (startupMs[stage] >= 0.0f)
+        {
+            ImGui::BulletText("%s: %.1f ms", stageNames[stage], startupMs[stage]);
+        }
+        else
+        {
+            ImGui::BulletText("%s: pending", stageNames[stage]);
+        }
+    }
+}
+
+/**
+ * @brief Plot frame stage timelines, histograms and allocations
+ * 
+ */
+void HomeMonitorProfiler::DrawFrameTimes()
+{
+    static char const * const stageNames[] = {"Build", "Wait", "Present"};
+    static_assert(IM_ARRAYSIZE(stageNames) == static_cast<int>(HomeMonitorFrameStage::Count));
+
+    if (!ImGui::CollapsingHeader("Frames", ImGuiTreeNodeFlags_DefaultOpen))
+    {
+        return;
+    }
+
+    for (int stage = 0; stage < static_cast<int>(HomeMonitorFrameStage::Count); stage++)
+    {
+        HomeMonitorRingBuffer const & stageMs = frameStageMs[stage];
+        ImGui::BulletText("%s: %.3f ms (mean %.3f ms, max %.3f ms)", stageNames[stage],
+                          stageMs.Latest(), stageMs.Mean(), stageMs.Max());
+    }
+    ImGui::BulletText("Allocations: %.0f (mean %.1f, max %.0f)",
+                      frameAllocations.Latest(), frameAllocations.Mean(), frameAllocations.Max());
+
+    if (ImPlot::BeginPlot("Frame Times", ImVec2(-1, 200)))
+    {
+        ImPlot::SetupAxes("Frame", "Time (ms)", ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit);
+        for (int stage = 0; stage < static_cast<int>(HomeMonitorFrameStage::Count); stage++)
+        {
+            HomeMonitorRingBuffer const & stageMs = frameStageMs[stage];
+            ImPlot::PlotLine(stageNames[stage], stageMs.Data(), stageMs.Size(),
+                             1.0, 0.0, ImPlotLineFlags_None, stageMs.Offset());
+        }
+        ImPlot::EndPlot();
+    }
+
+    if (ImPlot::BeginPlot("Frame Time Distribution", ImVec2(-1, 200)))
+    {
+        ImPlot::SetupAxes("Time (ms)", "Frames", ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit);
+        for (int stage = 0; stage < static_cast<int>(HomeMonitorFrameStage::Count); stage++)
+        {
+            HomeMonitorRingBuffer const & stageMs = frameStageMs[stage];
+            ImPlot::SetNextFillStyle(IMPLOT_AUTO_COL, 0.5f);
+            ImPlot::PlotHistogram(stageNames[stage], stageMs.Data(), stageMs.Size(),
+                                  HOMEMONITOR_PROFILER_HISTOGRAM_BINS);
+        }
+        ImPlot::EndPlot();
+    }
+
+    if (ImPlot::BeginPlot("Allocations", ImVec2(-1, 150)))
+    {
+        ImPlot::SetupAxes("Frame", "Allocations", ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit);
+        ImPlot::PlotBars("Per Frame", frameAllocations.Data(), frameAllocations.Size(),
+                         0.67, 0.0, ImPlotBarsFlags_None, frameAllocations.Offset());
+        ImPlot::EndPlot();
+    }
+}
+
+/**
+ * @brief Show per-channel fetch measurements and plot request latency
+ * 
+ */
+void HomeMonitorProfiler::DrawChannels()
+{
+    if (!ImGui::CollapsingHeader("Channels", ImGuiTreeNodeFlags_DefaultOpen))
+    {
+        return;
+    }
+
+    if (channels.empty())
+    {
+        ImGui::Text("No fetches recorded");
+        return;
+    }
+
+    ImGuiTableFlags tableFlags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit;
+    if (ImGui::BeginTable("##channelProfiles", 9, tableFlags))
+    {
+        ImGui::TableSetupColumn("Channel");
+        ImGui::TableSetupColumn("Fetches");
+        ImGui::TableSetupColumn("Failures");
+        ImGui::TableSetupColumn("Unchanged");
+        ImGui::TableSetupColumn("Request (ms)");
+        ImGui::TableSetupColumn("Parse (ms)");
+        ImGui::TableSetupColumn("Ingest (ms)");
+        ImGui::TableSetupColumn("Downloaded (bytes)");
+        ImGui::TableSetupColumn("Points");
+        ImGui::TableHeadersRow();
+
+        for (auto const & [id, channel] : channels)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s (%s)", channel.name.c_str(), id.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%lld", channel.numFetches);
+            ImGui::TableNextColumn();
+            ImGui::Text("%lld", channel.numFailures);
+            ImGui::TableNextColumn();
+            ImGui::Text("%lld", channel.numNotModified);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f (mean %.1f)", channel.requestMs.Latest(), channel.requestMs.Mean());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f (mean %.3f)", channel.parseMs.Latest(), channel.parseMs.Mean());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f (mean %.3f)", channel.ingestMs.Latest(), channel.ingestMs.Mean());
+            ImGui::TableNextColumn();
+            ImGui::Text("%lld", channel.totalBytes);
+            ImGui::TableNextColumn();
+            ImGui::Text("%lld", channel.totalPoints);
+        }
+
+        ImGui::EndTable();
+    }
+
+    if (ImPlot::BeginPlot("Request Latency", ImVec2(-1, 200)))
+    {
+        ImPlot::SetupAxes("Fetch", "Time (ms)", ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit);
+        for (auto const & [id, channel] : channels)
+        {
+            // Channels may share a display name
+            ImGui::PushID(id.c_str());
+            ImPlot::PlotLine(channel.name.c_str(), channel.requestMs.Data(), channel.requestMs.Size(),
+                             1.0, 0.0, ImPlotLineFlags_None, channel.requestMs.Offset());
+            ImGui::PopID();
+        }
+        ImPlot::EndPlot();
+    }
+}
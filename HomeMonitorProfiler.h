@@ -0,0 +1,182 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <array>
+#include <map>
+#include <chrono>
+#include <filesystem>
+
+#include "ThingSpeak/ThingSpeak.h"
+
+#define HOMEMONITOR_PROFILER_HISTORY_SIZE     512   // Frames/fetches kept for plotting and tracing
+#define HOMEMONITOR_PROFILER_HISTOGRAM_BINS   40
+
+typedef std::chrono::steady_clock HomeMonitorProfilerClock;
+
+// Portions of a frame timed separately. Build is the remainder of the frame
+enum class HomeMonitorFrameStage
+{
+    Build = 0,
+    Wait,       // WaitForNextFrameResources()
+    Present,
+    Count
+};
+
+/**
+ * Fixed size ring buffer of measurements. Never allocates once constructed.
+ * Like ThingSpeakSeries, the raw data may be wrapped; pass Offset() to
+ * ImPlot so it is read oldest first.
+ */
+class HomeMonitorRingBuffer
+{
+public:
+    void Push(float value);
+
+    int Size() const;
+    int Offset() const;
+    float const * Data() const;
+
+    float Value(int index) const;
+    float Latest() const;
+    float Mean() const;
+    float Max() const;
+
+private:
+    // Member Variables
+    std::array<float, HOMEMONITOR_PROFILER_HISTORY_SIZE> values = {};
+    int head = 0;    // Slot the next value is written to
+    int size = 0;
+};
+
+// Milestones of startup, each recorded once
+enum class HomeMonitorStartupStage
+{
+    Window = 0,     // Window and D3D12 device created
+    Backends,       // Dear ImGui backends and font atlas ready
+    FirstFrame,     // First frame presented
+    Config,         // ThingSpeakObjects.json parsed
+    FirstData,      // First channel with data shown, cached or fetched
+    Caches,         // Every configured channel restored from its cache
+    FirstFetch,     // First fetch result received
+    Count
+};
+
+typedef struct
+{
+    float timeSeconds;   // Time since profiler was created
+    std::string channel;
+    float requestMs;
+    float parseMs;
+    float ingestMs;      // Applying and caching the result on the render thread
+    int64_t bytes;
+    int points;
+} HomeMonitorFetchSample_t;
+
+typedef struct
+{
+    std::string name;
+    int64_t numFetches;
+    int64_t numFailures;
+    int64_t numNotModified;    // Fetches answered with 304; nothing downloaded or parsed
+    int64_t totalBytes;
+    int64_t totalPoints;
+
+    HomeMonitorRingBuffer requestMs;
+    HomeMonitorRingBuffer parseMs;
+    HomeMonitorRingBuffer ingestMs;
+} HomeMonitorChannelProfile_t;
+
+/**
+ * Always-compiled instrumentation of the render loop and of fetched data.
+ * 
+ * Frames are bracketed by BeginFrame()/EndFrame(), with the stages of
+ * interest timed by a HomeMonitorScopedTimer. Each frame also records the
+ * number of heap allocations made on the render thread. Fetch results are
+ * recorded per channel. Everything is kept in fixed size ring buffers, so
+ * recording a frame costs a few clock reads and no allocations. Not thread
+ * safe; owned by the render loop.
+ * 
+ * Startup milestones are timed from the profiler's creation, which as a
+ * global happens before main() runs. The timeline is appended to a CSV file
+ * by LogStartup(), one row per launch, so regressions show up across runs.
+ */
+class HomeMonitorProfiler
+{
+public:
+    HomeMonitorProfiler();
+
+    void BeginFrame();
+    void EndFrame();
+    void AddStageTime(HomeMonitorFrameStage stage, HomeMonitorProfilerClock::duration duration);
+    void RecordFetch(ThingSpeakFetchResult_t const & result, std::string const & name,
+                     HomeMonitorProfilerClock::duration ingestDuration);
+    void MarkStartup(HomeMonitorStartupStage stage,
+                     HomeMonitorProfilerClock::time_point time = HomeMonitorProfilerClock::now());
+    bool StartupMarked(HomeMonitorStartupStage stage) const;
+    bool StartupComplete() const;
+    bool LogStartup(std::filesystem::path const & path);
+
+    void Draw(bool* open, std::filesystem::path const & tracePath);
+    bool DumpCsv(std::filesystem::path const & path) const;
+
+    static uint64_t GetThreadAllocationCount();
+
+private:
+    // Member Variables
+    HomeMonitorProfilerClock::time_point createdTime;
+    HomeMonitorProfilerClock::time_point frameStartTime;
+    std::array<HomeMonitorProfilerClock::duration,
+               static_cast<int>(HomeMonitorFrameStage::Count)> stageTimes = {};
+    uint64_t frameStartAllocations = 0;
+    int64_t numFrames = 0;
+
+    std::array<HomeMonitorRingBuffer, static_cast<int>(HomeMonitorFrameStage::Count)> frameStageMs;
+    HomeMonitorRingBuffer frameStartSeconds;
+    HomeMonitorRingBuffer frameAllocations;
+
+    std::map<std::string, HomeMonitorChannelProfile_t> channels;
+    std::array<HomeMonitorFetchSample_t, HOMEMONITOR_PROFILER_HISTORY_SIZE> fetches = {};
+    int fetchHead = 0;
+    int numFetchSamples = 0;
+
+    std::array<float, static_cast<int>(HomeMonitorStartupStage::Count)> startupMs;   // -1 until marked
+    bool startupLogged = false;
+
+    std::string traceStatus;
+
+    // Member Functions
+    void DrawStartup();
+    void DrawFrameTimes();
+    void DrawChannels();
+};
+
+/**
+ * Adds the time between its construction and destruction to a stage of
+ * the current frame.
+ * 
+ *     {
+ *         HomeMonitorScopedTimer timer(profiler, HomeMonitorFrameStage::Present);
+ *         g_pSwapChain->Present(0, 0);
+ *     }
+ */
+class HomeMonitorScopedTimer
+{
+public:
+    HomeMonitorScopedTimer(HomeMonitorProfiler& profiler, HomeMonitorFrameStage stage) :
+        profiler(profiler), stage(stage), startTime(HomeMonitorProfilerClock::now()) {}
+
+    ~HomeMonitorScopedTimer()
+    {
+        profiler.AddStageTime(stage, (HomeMonitorProfilerClock::now() - startTime));
+    }
+
+    HomeMonitorScopedTimer(HomeMonitorScopedTimer const &) = delete;
+    HomeMonitorScopedTimer& operator=(HomeMonitorScopedTimer const &) = delete;
+
+private:
+    // Member Variables
+    HomeMonitorProfiler& profiler;
+    HomeMonitorFrameStage stage;
+    HomeMonitorProfilerClock::time_point startTime;
+};
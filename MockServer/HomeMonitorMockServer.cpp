@@ -0,0 +1,842 @@
+// HomeMonitor Mock Server: Local stand-in for api.thingspeak.com serving
+// synthetic channels, so HomeMonitor and HomeMonitorCollector can be load
+// tested without being rate limited or touching real devices. Each channel
+// publishes an entry every --update-seconds, generated on request rather
+// than stored, so thousands of channels cost no memory:
+//
+//     HomeMonitorMockServer --channels 1000 --update-seconds 15 --objects MockObjects.json
+//     HomeMonitorCollector --base-url http://localhost:8080 MockObjects.json MockCache
+//
+// Supports the results, start and end parameters, average/median/timescale
+// aggregation and ETag validation of /channels/<id>/feeds.json. Latency and
+// 429/503 responses can be injected to exercise the scheduler's backoff.
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#endif
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <memory>
+#include <charconv>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <cmath>
+#include <cctype>
+#include <csignal>
+#include <cstdio>
+#include <nlohmann/json.hpp>
+
+#include "ThingSpeak/ThingSpeakTime.h"
+
+using json = nlohmann::json;
+
+#define DEBUG_HOMEMONITOR_MOCK_SERVER   false
+
+#define HOMEMONITOR_MOCK_DEFAULT_PORT             8080
+#define HOMEMONITOR_MOCK_DEFAULT_CHANNELS         10
+#define HOMEMONITOR_MOCK_DEFAULT_FIRST_CHANNEL    9000001   // Clear of real channel IDs, so caches do not collide
+#define HOMEMONITOR_MOCK_DEFAULT_UPDATE_S         15        // ThingSpeak's fastest update rate
+#define HOMEMONITOR_MOCK_DEFAULT_HISTORY          8000      // Entries published before startup
+#define HOMEMONITOR_MOCK_DEFAULT_REPORT_S         5
+#define HOMEMONITOR_MOCK_DEFAULT_RESULTS          100       // Entries returned without a results parameter
+#define HOMEMONITOR_MOCK_MAX_RESULTS              8000
+#define HOMEMONITOR_MOCK_MAX_REQUEST_SIZE         16384     // Longer request headers close the connection
+#define HOMEMONITOR_MOCK_ACCEPT_POLL_MS           250       // Longest wait for a connection, bounding shutdown latency
+#define HOMEMONITOR_MOCK_KEY                      "MOCKKEY"
+
+#ifdef _WIN32
+typedef SOCKET HomeMonitorMockSocket_t;
+#define HOMEMONITOR_MOCK_SEND_FLAGS   0
+#else
+typedef int HomeMonitorMockSocket_t;
+#define HOMEMONITOR_MOCK_SEND_FLAGS   MSG_NOSIGNAL   // Clients hanging up are reported, not raised as SIGPIPE
+#endif
+
+// Synthetic channels served and the faults injected into responses
+typedef struct
+{
+    int port;
+    int numChannels;
+    int64_t firstChannel;          // Channel IDs are firstChannel to firstChannel + numChannels - 1
+    int64_t updateSeconds;         // Spacing of every channel's entries
+    int64_t firstEntryTime;        // UTC epoch seconds of entry 0, which is not published
+    int latencyMs;                 // Added to every response
+    int jitterMs;                  // Up to this much more is added at random
+    double errorRate;              // Fraction of requests answered with errorStatus
+    int errorStatus;               // 429 or 503
+    int retryAfterSeconds;         // Sent with injected errors. 0 to omit
+    int reportSeconds;             // Period of the throughput report. 0 to disable
+    std::string objectsPath;       // ThingSpeakObjects.json listing the channels. Empty to skip
+} HomeMonitorMockScenario_t;
+
+typedef struct
+{
+    std::string method;
+    std::string path;
+    std::string query;
+    std::string ifNoneMatch;
+    bool keepAlive;
+} HomeMonitorMockRequest_t;
+
+// Counters of the running report period
+typedef struct
+{
+    std::atomic<int64_t> numRequests;
+    std::atomic<int64_t> numOk;
+    std::atomic<int64_t> numNotModified;
+    std::atomic<int64_t> numInjected;
+    std::atomic<int64_t> numFailed;        // Unknown channels and malformed requests
+    std::atomic<int64_t> numEntries;       // Entries sent in feeds
+    std::atomic<int64_t> bytesSent;
+    std::atomic<int> numConnections;       // Currently open
+} HomeMonitorMockStats_t;
+
+// Set by the signal handler; the accept loop exits once it wakes
+static std::atomic<bool> stopRequested = false;
+
+static HomeMonitorMockStats_t mockStats = {};
+
+void HomeMonitorMockHandleSignal(int signal);
+bool HomeMonitorMockParseArguments(int argc, char** argv, HomeMonitorMockScenario_t& scenario);
+bool HomeMonitorMockWriteObjects(HomeMonitorMockScenario_t const & scenario);
+void HomeMonitorMockServeConnection(HomeMonitorMockSocket_t client,
+                                    std::shared_ptr<HomeMonitorMockScenario_t const> scenario);
+void HomeMonitorMockCloseSocket(HomeMonitorMockSocket_t socket);
+bool HomeMonitorMockReadRequest(HomeMonitorMockSocket_t client, std::string& buffer,
+                                HomeMonitorMockRequest_t& request);
+std::string HomeMonitorMockRespond(HomeMonitorMockRequest_t const & request,
+                                   HomeMonitorMockScenario_t const & scenario, std::mt19937& random);
+std::string HomeMonitorMockBuildFeed(int64_t channel, std::string_view query,
+                                     HomeMonitorMockScenario_t const & scenario, std::string& eTag);
+void HomeMonitorMockReport(HomeMonitorMockScenario_t const & scenario, double elapsedSeconds);
+
+int main(int argc, char** argv)
+{
+    HomeMonitorMockScenario_t parsedScenario;
+    if (!HomeMonitorMockParseArguments(argc, argv, parsedScenario))
+    {
+        return -1;
+    }
+    if (!parsedScenario.objectsPath.empty() && !HomeMonitorMockWriteObjects(parsedScenario))
+    {
+        return -1;
+    }
+
+    // Shared with the detached connection threads, which may outlive main()
+    auto scenario = std::make_shared<HomeMonitorMockScenario_t const>(std::move(parsedScenario));
+
+    std::signal(SIGINT, HomeMonitorMockHandleSignal);
+    std::signal(SIGTERM, HomeMonitorMockHandleSignal);
+
+    #ifdef _WIN32
+    WSADATA wsaData;
+    ::WSAStartup(MAKEWORD(2, 2), &wsaData);
+    #endif
+
+    HomeMonitorMockSocket_t listener = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    int reuseAddress = 1;
+    ::setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<char const *>(&reuseAddress),
+                 sizeof(reuseAddress));
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(static_cast<uint16_t>(scenario->port));
+
+    if ((::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) ||
+        (::listen(listener, SOMAXCONN) != 0))
+    {
+        std::cerr << "[ERROR] Could not listen on port " << scenario->port << std::endl;
+
+        HomeMonitorMockCloseSocket(listener);
+        #ifdef _WIN32
+        ::WSACleanup();
+        #endif
+        return -1;
+    }
+
+    std::cout << "Serving " << scenario->numChannels << " channel(s) from " << scenario->firstChannel
+              << ", an entry every " << scenario->updateSeconds << " s, at http://localhost:"
+              << scenario->port << std::endl;
+
+    auto reportTime = std::chrono::steady_clock::now();
+
+    while (!stopRequested)
+    {
+        fd_set readySet;
+        FD_ZERO(&readySet);
+        FD_SET(listener, &readySet);
+
+        timeval timeout = {0, (HOMEMONITOR_MOCK_ACCEPT_POLL_MS * 1000)};
+        if (::select(static_cast<int>(listener + 1), &readySet, nullptr, nullptr, &timeout) > 0)
+        {
+            HomeMonitorMockSocket_t client = ::accept(listener, nullptr, nullptr);
+            #ifdef _WIN32
+            bool accepted = (client != INVALID_SOCKET);
+            #else
+            bool accepted = (client >= 0);
+            #endif
+
+            // Every connection gets a thread, so injected latency delays only its own responses
+            if (accepted)
+            {
+                std::thread(HomeMonitorMockServeConnection, client, scenario).detach();
+            }
+        }
+
+        std::chrono::duration<double> sinceReport = std::chrono::steady_clock::now() - reportTime;
+        if ((scenario->reportSeconds > 0) && (sinceReport.count() >= scenario->reportSeconds))
+        {
+            HomeMonitorMockReport(*scenario, sinceReport.count());
+            reportTime = std::chrono::steady_clock::now();
+        }
+    }
+
+    std::cout << "Stopping mock server" << std::endl;
+
+    HomeMonitorMockCloseSocket(listener);
+    #ifdef _WIN32
+    ::WSACleanup();
+    #endif
+
+    return 0;
+}
+
+/**
+ * @brief Request the accept loop to exit on SIGINT/SIGTERM
+ * 
+ * @param signal - Signal received
+ */
+void HomeMonitorMockHandleSignal([[maybe_unused]] int signal)
+{
+    stopRequested = true;
+}
+
+/**
+ * @brief Read the scenario from "--option value" arguments. Options not
+ *        given keep their defaults
+ * 
+ * @param argc - Number of arguments
+ * @param argv - Arguments, starting with the program name
+ * @param scenario - Resulting scenario
+ * 
+ * @return bool - True if every argument was understood
+ */
+bool HomeMonitorMockParseArguments(int argc, char** argv, HomeMonitorMockScenario_t& scenario)
+{
+    int64_t historyEntries = HOMEMONITOR_MOCK_DEFAULT_HISTORY;
+
+    scenario.port = HOMEMONITOR_MOCK_DEFAULT_PORT;
+    scenario.numChannels = HOMEMONITOR_MOCK_DEFAULT_CHANNELS;
+    scenario.firstChannel = HOMEMONITOR_MOCK_DEFAULT_FIRST_CHANNEL;
+    scenario.updateSeconds = HOMEMONITOR_MOCK_DEFAULT_UPDATE_S;
+    scenario.latencyMs = 0;
+    scenario.jitterMs = 0;
+    scenario.errorRate = 0.0;
+    scenario.errorStatus = 429;
+    scenario.retryAfterSeconds = 0;
+    scenario.reportSeconds = HOMEMONITOR_MOCK_DEFAULT_REPORT_S;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string option(argv[i]);
+        if ((i + 1) >= argc)
+        {
+            std::cerr << "[ERROR] Missing value of " << option << std::endl;
+            return false;
+        }
+        std::string value(argv[++i]);
+
+        try
+        {
+            if (option == "--port")                scenario.port = std::stoi(value);
+            else if (option == "--channels")       scenario.numChannels = std::stoi(value);
+            else if (option == "--first-channel")  scenario.firstChannel = std::stoll(value);
+            else if (option == "--update-seconds") scenario.updateSeconds = std::stoll(value);
+            else if (option == "--history")        historyEntries = std::stoll(value);
+            else if (option == "--latency-ms")     scenario.latencyMs = std::stoi(value);
+            else if (option == "--jitter-ms")      scenario.jitterMs = std::stoi(value);
+            else if (option == "--error-rate")     scenario.errorRate = std::stod(value);
+            else if (option == "--error-status")   scenario.errorStatus = std::stoi(value);
+            else if (option == "--retry-after")    scenario.retryAfterSeconds = std::stoi(value);
+            else if (option == "--report-seconds") scenario.reportSeconds = std::stoi(value);
+            else if (option == "--objects")        scenario.objectsPath = value;
+            else
+            {
+                std::cerr << "[ERROR] Unknown option " << option << std::endl;
+                return false;
+            }
+        }
+        catch (std::exception const &)
+        {
+            std::cerr << "[ERROR] Invalid value of " << option << ": " << value << std::endl;
+            return false;
+        }
+    }
+
+    if ((scenario.numChannels < 1) || (scenario.updateSeconds < 1) || (historyEntries < 0) ||
+        ((scenario.errorStatus != 429) && (scenario.errorStatus != 503)))
+    {
+        std::cerr << "[ERROR] --channels and --update-seconds must be positive, "
+                  << "and --error-status 429 or 503" << std::endl;
+        return false;
+    }
+
+    // Entry N of every channel is published at firstEntryTime + N * updateSeconds
+    int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    scenario.firstEntryTime = now - (historyEntries * scenario.updateSeconds);
+
+    return true;
+}
+
+/**
+ * @brief Write a ThingSpeakObjects.json listing every mock channel, for
+ *        HomeMonitor --objects or HomeMonitorCollector to load
+ * 
+ * @param scenario - Channels served
+ * 
+ * @return bool - True if the file was written
+ */
+bool HomeMonitorMockWriteObjects(HomeMonitorMockScenario_t const & scenario)
+{
+    json objects = json::array();
+
+    for (int i = 0; i < scenario.numChannels; i++)
+    {
+        objects.push_back({
+            {"name", "Mock " + std::to_string(i + 1)},
+            {"channel", std::to_string(scenario.firstChannel + i)},
+            {"key", HOMEMONITOR_MOCK_KEY}
+        });
+    }
+
+    std::ofstream objectsFile(scenario.objectsPath);
+    if (!objectsFile.is_open())
+    {
+        std::cerr << "[ERROR] Could not write " << scenario.objectsPath << std::endl;
+        return false;
+    }
+    objectsFile << objects.dump(4);
+
+    return true;
+}
+
+/**
+ * @brief Answer the requests of one client until it hangs up. Connections
+ *        are kept alive, as ThingSpeakFetcher reuses a session per channel
+ * 
+ * @param client - Accepted connection. Closed on return
+ * @param scenario - Channels served. Owned jointly, as the thread is detached
+ */
+void HomeMonitorMockServeConnection(HomeMonitorMockSocket_t client,
+                                    std::shared_ptr<HomeMonitorMockScenario_t const> scenario)
+{
+    mockStats.numConnections++;
+
+    std::mt19937 random(std::random_device{}());
+    std::string buffer;
+    HomeMonitorMockRequest_t request;
+
+    while (!stopRequested && HomeMonitorMockReadRequest(client, buffer, request))
+    {
+        std::string response = HomeMonitorMockRespond(request, *scenario, random);
+
+        size_t numSent = 0;
+        while (numSent < response.size())
+        {
+            int sent = ::send(client, (response.data() + numSent), static_cast<int>(response.size() - numSent),
+                              HOMEMONITOR_MOCK_SEND_FLAGS);
+            if (sent <= 0)
+            {
+                break;
+            }
+            numSent += static_cast<size_t>(sent);
+        }
+        mockStats.bytesSent += static_cast<int64_t>(numSent);
+
+        if ((numSent < response.size()) || !request.keepAlive)
+        {
+            break;
+        }
+    }
+
+    HomeMonitorMockCloseSocket(client);
+
+    mockStats.numConnections--;
+}
+
+/**
+ * @brief Close a socket
+ * 
+ * @param socket - Socket to close
+ */
+void HomeMonitorMockCloseSocket(HomeMonitorMockSocket_t socket)
+{
+    #ifdef _WIN32
+    ::closesocket(socket);
+    #else
+    ::close(socket);
+    #endif
+}
+
+/**
+ * @brief Read the next request of a connection. Requests are GETs without
+ *        a body, so only the request line and headers are read
+ * 
+ * @param client - Connection to read from
+ * @param buffer - Bytes received but not yet parsed. Holds any pipelined
+ *                 requests which follow
+ * @param request - Resulting request
+ * 
+ * @return bool - False once the client hung up or sent a malformed request
+ */
+bool HomeMonitorMockReadRequest(HomeMonitorMockSocket_t client, std::string& buffer,
+                                HomeMonitorMockRequest_t& request)
+{
+    size_t headerEnd;
+    while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos)
+    {
+        char chunk[4096];
+        int numReceived = ::recv(client, chunk, sizeof(chunk), 0);
+        if ((numReceived <= 0) || (buffer.size() > HOMEMONITOR_MOCK_MAX_REQUEST_SIZE))
+        {
+            return false;
+        }
+        buffer.append(chunk, static_cast<size_t>(numReceived));
+    }
+
+    std::string_view header(buffer.data(), headerEnd);
+    size_t lineEnd = header.find("\r\n");
+    std::string_view requestLine = header.substr(0, lineEnd);
+
+    // "GET /channels/<id>/feeds.json?<query> HTTP/1.1"
+    size_t methodEnd = requestLine.find(' ');
+    size_t targetEnd = requestLine.rfind(' ');
+    if ((methodEnd == std::string_view::npos) || (targetEnd <= methodEnd))
+    {
+        return false;
+    }
+    std::string_view target = requestLine.substr((methodEnd + 1), (targetEnd - methodEnd - 1));
+    size_t queryStart = target.find('?');
+
+    request.method = requestLine.substr(0, methodEnd);
+    request.path = target.substr(0, queryStart);
+    request.query = (queryStart != std::string_view::npos) ? target.substr(queryStart + 1) : "";
+    request.ifNoneMatch.clear();
+    request.keepAlive = (requestLine.substr(targetEnd + 1) != "HTTP/1.0");
+
+    while (lineEnd != std::string_view::npos)
+    {
+        size_t nextLine = header.find("\r\n", (lineEnd + 2));
+        std::string_view line = header.substr((lineEnd + 2), (nextLine - lineEnd - 2));
+        lineEnd = nextLine;
+
+        size_t colon = line.find(':');
+        if (colon == std::string_view::npos)
+        {
+            continue;
+        }
+
+        std::string name(line.substr(0, colon));
+        std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::tolower(c); });
+        std::string_view value = line.substr(colon + 1);
+        value.remove_prefix(std::min(value.find_first_not_of(' '), value.size()));
+
+        if (name == "if-none-match")
+        {
+            request.ifNoneMatch = value;
+        }
+        else if (name == "connection")
+        {
+            request.keepAlive = (value != "close");
+        }
+    }
+
+    buffer.erase(0, (headerEnd + 4));
+
+    return true;
+}
+
+/**
+ * @brief Find a parameter of a query string, decoding %XX escapes and '+'
+ * 
+ * @param query - Query string, without the leading '?'
+ * @param name - Parameter to find
+ * @param value - Decoded value of the parameter
+ * 
+ * @return bool - True if the parameter was present
+ */
+static bool HomeMonitorMockGetParameter(std::string_view query, std::string_view name, std::string& value)
+{
+    while (!query.empty())
+    {
+        size_t parameterEnd = query.find('&');
+        std::string_view parameter = query.substr(0, parameterEnd);
+        query = (parameterEnd != std::string_view::npos) ? query.substr(parameterEnd + 1) : "";
+
+        size_t equals = parameter.find('=');
+        if (parameter.substr(0, equals) != name)
+        {
+            continue;
+        }
+
+        std::string_view encoded = (equals != std::string_view::npos) ? parameter.substr(equals + 1) : "";
+        value.clear();
+        for (size_t i = 0; i < encoded.size(); i++)
+        {
+            unsigned escaped = 0;
+            if ((encoded[i] == '%') && ((i + 2) < encoded.size()) &&
+                (std::from_chars(&encoded[i + 1], &encoded[i + 3], escaped, 16).ptr == &encoded[i + 3]))
+            {
+                value.push_back(static_cast<char>(escaped));
+                i += 2;
+            }
+            else
+            {
+                value.push_back((encoded[i] == '+') ? ' ' : encoded[i]);
+            }
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Build the complete HTTP response to a request, after waiting out
+ *        any injected latency
+ * 
+ * @param request - Request received
+ * @param scenario - Channels served and faults to inject
+ * @param random - Generator of the connection's injected faults
+ * 
+ * @return std::string - Status line, headers and body
+ */
+std::string HomeMonitorMockRespond(HomeMonitorMockRequest_t const & request,
+                                   HomeMonitorMockScenario_t const & scenario, std::mt19937& random)
+{
+    mockStats.numRequests++;
+
+    int delayMs = scenario.latencyMs;
+    if (scenario.jitterMs > 0)
+    {
+        delayMs += std::uniform_int_distribution<int>(0, scenario.jitterMs)(random);
+    }
+    if (delayMs > 0)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+    }
+
+    std::string header;
+    std::string body;
+    char const * status = "200 OK";
+
+    // "/channels/<id>/feeds.json"
+    std::string_view path(request.path);
+    std::string_view const prefix = "/channels/";
+    std::string_view const suffix = "/feeds.json";
+    int64_t channel = 0;
+    bool validPath = (path.size() > (prefix.size() + suffix.size())) &&
+                     path.starts_with(prefix) && path.ends_with(suffix);
+    if (validPath)
+    {
+        std::string_view id = path.substr(prefix.size(), (path.size() - prefix.size() - suffix.size()));
+        validPath = (std::from_chars(id.data(), (id.data() + id.size()), channel).ptr == (id.data() + id.size()));
+    }
+    bool knownChannel = validPath && (channel >= scenario.firstChannel) &&
+                        (channel < (scenario.firstChannel + scenario.numChannels));
+
+    if ((request.method != "GET") || !knownChannel)
+    {
+        mockStats.numFailed++;
+        status = "404 Not Found";
+        body = "-1";
+    }
+    else if ((scenario.errorRate > 0.0) &&
+             (std::uniform_real_distribution<double>(0.0, 1.0)(random) < scenario.errorRate))
+    {
+        mockStats.numInjected++;
+        status = (scenario.errorStatus == 503) ? "503 Service Unavailable" : "429 Too Many Requests";
+        if (scenario.retryAfterSeconds > 0)
+        {
+            header += "Retry-After: " + std::to_string(scenario.retryAfterSeconds) + "\r\n";
+        }
+    }
+    else
+    {
+        std::string eTag;
+        body = HomeMonitorMockBuildFeed(channel, request.query, scenario, eTag);
+        header += "Content-Type: application/json; charset=utf-8\r\n";
+        header += "ETag: " + eTag + "\r\n";
+
+        if (request.ifNoneMatch == eTag)
+        {
+            mockStats.numNotModified++;
+            status = "304 Not Modified";
+            body.clear();
+        }
+        else
+        {
+            mockStats.numOk++;
+        }
+    }
+
+    #if (DEBUG_HOMEMONITOR_MOCK_SERVER)
+    std::cout << request.method << " " << request.path << "?" << request.query << " -> " << status << std::endl;
+    #endif
+
+    std::string response = "HTTP/1.1 ";
+    response += status;
+    response += "\r\n";
+    response += header;
+    response += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+    response += (request.keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n");
+    response += body;
+
+    return response;
+}
+
+/**
+ * @brief Generate the value of a field of an entry. Temperature and
+ *        humidity follow a daily cycle, offset per channel, with noise
+ *        which is the same every time the entry is generated
+ * 
+ * @param channel - Channel ID
+ * @param entryId - Entry of the channel
+ * @param createdAt - UTC epoch seconds of the entry
+ * @param fieldNumber - 1 for temperature, 2 for humidity
+ * 
+ * @return double - Field value
+ */
+static double HomeMonitorMockGetValue(int64_t channel, int64_t entryId, int64_t createdAt, int fieldNumber)
+{
+    // SplitMix64 of the entry, scaled to [-0.5, 0.5)
+    uint64_t hash = (static_cast<uint64_t>(channel) << 32) ^ static_cast<uint64_t>(entryId) ^
+                    (static_cast<uint64_t>(fieldNumber) << 60);
+    hash += 0x9E3779B97F4A7C15ull;
+    hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+    hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBull;
+    hash ^= (hash >> 31);
+    double noise = (static_cast<double>(hash >> 11) / 9007199254740992.0) - 0.5;
+
+    double phase = (6.283185307179586 * static_cast<double>(createdAt % 86400) / 86400.0) +
+                   static_cast<double>(channel % 24);
+
+    return (fieldNumber == 1) ? (68.0 + (4.0 * std::sin(phase)) + noise)
+                              : (45.0 + (5.0 * std::cos(phase)) + (2.0 * noise));
+}
+
+/**
+ * @brief Generate the feeds.json body a ThingSpeak channel would return
+ *        for a query. Entries are numbered from 1 and published every
+ *        updateSeconds, up to the current time
+ * 
+ * @param channel - Channel ID, which must be served
+ * @param query - Query string of the request
+ * @param scenario - Channels served
+ * @param eTag - Resulting validator of the body, changing whenever a new
+ *               entry falls within the query
+ * 
+ * @return std::string - JSON body
+ */
+std::string HomeMonitorMockBuildFeed(int64_t channel, std::string_view query,
+                                     HomeMonitorMockScenario_t const & scenario, std::string& eTag)
+{
+    int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    int64_t lastEntryId = (now - scenario.firstEntryTime) / scenario.updateSeconds;
+
+    std::string value;
+    int64_t numResults = HOMEMONITOR_MOCK_DEFAULT_RESULTS;
+    if (HomeMonitorMockGetParameter(query, "results", value))
+    {
+        std::from_chars(value.data(), (value.data() + value.size()), numResults);
+        numResults = std::clamp<int64_t>(numResults, 0, HOMEMONITOR_MOCK_MAX_RESULTS);
+    }
+
+    // Entries created within [start, end]
+    int64_t firstId = 1;
+    int64_t lastId = lastEntryId;
+    int64_t epochSeconds;
+    if (HomeMonitorMockGetParameter(query, "start", value) && ThingSpeakParseDateTime(value, epochSeconds))
+    {
+        int64_t sinceFirst = std::max<int64_t>((epochSeconds - scenario.firstEntryTime), 0);
+        firstId = std::max<int64_t>(firstId, ((sinceFirst + scenario.updateSeconds - 1) / scenario.updateSeconds));
+    }
+    if (HomeMonitorMockGetParameter(query, "end", value) && ThingSpeakParseDateTime(value, epochSeconds))
+    {
+        lastId = std::min(lastId, ((epochSeconds - scenario.firstEntryTime) / scenario.updateSeconds));
+    }
+
+    // Aggregated entries combine every entry of an interval and carry no entry ID
+    int resolutionMinutes = 0;
+    char aggregate = 'a';
+    for (char const * parameter : {"average", "median", "timescale"})
+    {
+        if (HomeMonitorMockGetParameter(query, parameter, value) &&
+            (std::from_chars(value.data(), (value.data() + value.size()), resolutionMinutes).ec == std::errc()))
+        {
+            aggregate = parameter[0];
+            break;
+        }
+    }
+
+    std::vector<int64_t> entryIds;
+    std::vector<int64_t> entryTimes;
+    std::vector<double> entryValues[2];
+
+    if (resolutionMinutes <= 0)
+    {
+        // Only the newest results entries are returned, as by ThingSpeak
+        for (int64_t id = std::max(firstId, (lastId - numResults + 1)); id <= lastId; id++)
+        {
+            int64_t createdAt = scenario.firstEntryTime + (id * scenario.updateSeconds);
+            entryIds.push_back(id);
+            entryTimes.push_back(createdAt);
+            entryValues[0].push_back(HomeMonitorMockGetValue(channel, id, createdAt, 1));
+            entryValues[1].push_back(HomeMonitorMockGetValue(channel, id, createdAt, 2));
+        }
+    }
+    else
+    {
+        int64_t const interval = static_cast<int64_t>(resolutionMinutes) * 60;
+        std::vector<double> intervalValues[2];
+
+        for (int64_t id = firstId; id <= (lastId + 1); id++)
+        {
+            int64_t createdAt = scenario.firstEntryTime + (id * scenario.updateSeconds);
+            bool intervalEnded = !intervalValues[0].empty() &&
+                                 ((id > lastId) || ((createdAt / interval) != (entryTimes.back() / interval)));
+            if (intervalEnded)
+            {
+                for (int n = 0; n < 2; n++)
+                {
+                    std::vector<double>& values = intervalValues[n];
+                    double combined = values.front();
+                    if (aggregate == 'a')
+                    {
+                        double sum = 0.0;
+                        for (double v : values)
+                        {
+                            sum += v;
+                        }
+                        combined = sum / static_cast<double>(values.size());
+                    }
+                    else if (aggregate == 'm')
+                    {
+                        std::nth_element(values.begin(), (values.begin() + (values.size() / 2)), values.end());
+                        combined = values[values.size() / 2];
+                    }
+                    entryValues[n].push_back(combined);
+                    values.clear();
+                }
+            }
+            if (id > lastId)
+            {
+                break;
+            }
+
+            if (intervalValues[0].empty())
+            {
+                entryIds.push_back(id);
+                entryTimes.push_back(createdAt - (createdAt % interval));
+            }
+            intervalValues[0].push_back(HomeMonitorMockGetValue(channel, id, createdAt, 1));
+            intervalValues[1].push_back(HomeMonitorMockGetValue(channel, id, createdAt, 2));
+        }
+
+        // The newest intervals are kept
+        size_t numDropped = (entryIds.size() > static_cast<size_t>(numResults)) ?
+                            (entryIds.size() - static_cast<size_t>(numResults)) : 0;
+        entryIds.erase(entryIds.begin(), (entryIds.begin() + numDropped));
+        entryTimes.erase(entryTimes.begin(), (entryTimes.begin() + numDropped));
+        for (std::vector<double>& values : entryValues)
+        {
+            values.erase(values.begin(), (values.begin() + numDropped));
+        }
+    }
+
+    char dateTime[THINGSPEAK_DATE_TIME_BUFFER_SIZE];
+    char number[32];
+
+    // Written by hand; building a json object per entry would dominate the load test
+    std::string body;
+    body.reserve(256 + (entryIds.size() * 80));
+    body += "{\"channel\":{\"id\":" + std::to_string(channel);
+    body += ",\"name\":\"Mock " + std::to_string(channel - scenario.firstChannel + 1) + "\"";
+    body += ",\"field1\":\"Temperature\",\"field2\":\"Humidity\"";
+    ThingSpeakFormatDateTime(scenario.firstEntryTime, dateTime, 'T');
+    body += ",\"created_at\":\"" + std::string(dateTime) + "Z\"";
+    ThingSpeakFormatDateTime((scenario.firstEntryTime + (lastEntryId * scenario.updateSeconds)), dateTime, 'T');
+    body += ",\"updated_at\":\"" + std::string(dateTime) + "Z\"";
+    body += ",\"last_entry_id\":" + std::to_string(lastEntryId) + "},\"feeds\":[";
+
+    for (size_t i = 0; i < entryIds.size(); i++)
+    {
+        ThingSpeakFormatDateTime(entryTimes[i], dateTime, 'T');
+        body += (i == 0) ? "{\"created_at\":\"" : ",{\"created_at\":\"";
+        body += dateTime;
+        body += "Z\"";
+        if (resolutionMinutes <= 0)
+        {
+            body += ",\"entry_id\":" + std::to_string(entryIds[i]);
+        }
+        for (int n = 0; n < 2; n++)
+        {
+            std::snprintf(number, sizeof(number), ",\"field%d\":\"%.2f\"", (n + 1), entryValues[n][i]);
+            body += number;
+        }
+        body += "}";
+    }
+    body += "]}";
+
+    mockStats.numEntries += static_cast<int64_t>(entryIds.size());
+
+    // The body only changes when an entry is published within the range
+    eTag = "\"" + std::to_string(channel) + "-" + std::to_string(entryIds.empty() ? 0 : entryIds.back()) +
+           "-" + std::to_string(entryIds.size()) + "\"";
+
+    return body;
+}
+
+/**
+ * @brief Print the request rate and throughput of the period just ended,
+ *        then start the next period
+ * 
+ * @param scenario - Channels served
+ * @param elapsedSeconds - Length of the period
+ */
+void HomeMonitorMockReport(HomeMonitorMockScenario_t const & scenario, double elapsedSeconds)
+{
+    int64_t numRequests = mockStats.numRequests.exchange(0);
+    int64_t numOk = mockStats.numOk.exchange(0);
+    int64_t numNotModified = mockStats.numNotModified.exchange(0);
+    int64_t numInjected = mockStats.numInjected.exchange(0);
+    int64_t numFailed = mockStats.numFailed.exchange(0);
+    int64_t numEntries = mockStats.numEntries.exchange(0);
+    int64_t bytesSent = mockStats.bytesSent.exchange(0);
+
+    char report[256];
+    std::snprintf(report, sizeof(report),
+                  "%.1f req/s (200: %lld, 304: %lld, %d: %lld, 404: %lld)  %.0f entries/s  %.2f MB/s  %d connections",
+                  (numRequests / elapsedSeconds), static_cast<long long>(numOk),
+                  static_cast<long long>(numNotModified), scenario.errorStatus, static_cast<long long>(numInjected),
+                  static_cast<long long>(numFailed), (numEntries / elapsedSeconds),
+                  (bytesSent / elapsedSeconds / 1e6), mockStats.numConnections.load());
+    std::cout << report << std::endl;
+}
@@ -1 +1,4 @@
 #define IDI_ICON   105
+
+// Fonts embedded as raw TTF data
+#define IDR_FONT_ROBOTO_REGULAR   201
@@ -1,32 +1,38 @@
 #include <cpr/cpr.h>
 #include <nlohmann/json.hpp>
 #include <assert.h>
+#include <charconv>
 
 #include "ThingSpeak.h"
+#include "ThingSpeakFeedParser.h"
 
 #define DEBUG_THINGSPEAK false
 
-#define THINGSPEAK_LOWEST_FIELD_NUMBER    1
-#define THINGSPEAK_HIGHEST_FIELD_NUMBER   8
+// Resolutions accepted by the average, median and timescale parameters
+static int const rangeResolutions[] = {10, 15, 20, 30, 60, 240, 720, 1440};
 
-enum class HttpStatusCode
+// Server every channel is requested from. Only changed at startup
+static std::string thingSpeakBaseUrl = THINGSPEAK_DEFAULT_BASE_URL;
+
+/**
+ * @brief Format a UTC timestamp the way ThingSpeak expects it in a URL,
+ *        e.g. "2024-12-24%2007:10:39"
+ * 
+ * @param epochSeconds - UTC epoch seconds
+ * 
+ * @return std::string - Date/Time for a start or end parameter
+ */
+static std::string ThingSpeakFormatUrlDateTime(int64_t epochSeconds)
 {
-    OK = 200,
-    Created = 201,
-    Accepted = 202,
-    NoContent = 204,
-    MovedPermanently = 301,
-    Found = 302,
-    NotModified = 304,
-    BadRequest = 400,
-    Unauthorized = 401,
-    Forbidden = 403,
-    NotFound = 404,
-    InternalServerError = 500,
-    NotImplemented = 501,
-    BadGateway = 502,
-    ServiceUnavailable = 503
-};
+    char dateTime[THINGSPEAK_DATE_TIME_BUFFER_SIZE];
+    ThingSpeakFormatDateTime(epochSeconds, dateTime);
+
+    std::string urlDateTime(dateTime, 10);
+    urlDateTime.append("%20");
+    urlDateTime.append(dateTime + 11);
+
+    return urlDateTime;
+}
 
 /**
  * @brief Get/Update ThingSpeak object with latest ThingSpeak data
@@ -35,83 +41,526 @@ enum class HttpStatusCode
  */
 int ThingSpeak::GetFieldData()
 {
-    int i;
+    ThingSpeakFetchResult_t result = FetchFieldData();
+
+    SetFieldData(result);
+
+    return ((result.validDataFetched) ? 0 : -1);
+}
+
+/**
+ * @brief Fetch latest ThingSpeak data without modifying this object.
+ *        Safe to call from a worker thread while the object is in use
+ * 
+ * @return ThingSpeakFetchResult_t - Parsed field data for this channel
+ */
+ThingSpeakFetchResult_t ThingSpeak::FetchFieldData() const
+{
+    std::string url = GetFieldDataUrl(lastEntry);
+    cpr::Response response = cpr::Get(cpr::Url{url}, GetAcceptEncoding(),
+                                      GetConditionalHeader(url, validators));
+
+    return ParseFieldData(response);
+}
 
-    json thingSpeakData = GetChannelData(MAX_THINGSPEAK_REQUEST_SIZE);
-    if (thingSpeakData == NULL)
+/**
+ * @brief Create URL used to request the latest field data of this object.
+ *        Used by callers which perform the HTTP request themselves.
+ *        Only entries created at or after the cursor are requested
+ * 
+ * @param since - Last entry already received. Use GetLastEntry()
+ * 
+ * @return std::string - a string representing the URL to query
+ */
+std::string ThingSpeak::GetFieldDataUrl(ThingSpeakFeedCursor_t const & since) const
+{
+    std::string start;
+    if (since.entryId > 0)
     {
-        return -1;
+        start = ThingSpeakFormatUrlDateTime(since.createdAt);
     }
 
-    // New data fetched; Update internal structures
-    std::string temperature = "field1";
-    std::string humidity = "field2";
+    return BuildThingSpeakHttpGetUrl(MAX_THINGSPEAK_REQUEST_SIZE, start);
+}
+
+/**
+ * @brief Convert a response to a GetFieldDataUrl() request into field data
+ * 
+ * @param response - HTTP response obtained from ThingSpeak
+ * 
+ * @return ThingSpeakFetchResult_t - Parsed field data for this channel
+ */
+ThingSpeakFetchResult_t ThingSpeak::ParseFieldData(cpr::Response const & response) const
+{
+    return ParseResponse(response, false);
+}
+
+/**
+ * @brief Fetch the entries of a time range without modifying this object.
+ *        Long ranges should be requested at a coarser resolution, letting
+ *        ThingSpeak combine the entries of each interval server-side so
+ *        only one entry per interval is downloaded and parsed.
+ *        Safe to call from a worker thread while the object is in use
+ * 
+ * @param start - UTC epoch seconds of the first entry
+ * @param end - UTC epoch seconds of the last entry
+ * @param resolutionMinutes - Minutes per returned entry. Rounded up to a
+ *                            resolution ThingSpeak supports. THINGSPEAK_RANGE_RAW
+ *                            to fetch entries as captured
+ * @param aggregate - How the entries of each interval are combined
+ * 
+ * @return ThingSpeakFetchResult_t - Entries of the range for this channel
+ */
+ThingSpeakFetchResult_t ThingSpeak::Fetch(int64_t start, int64_t end, int resolutionMinutes,
+                                          ThingSpeakAggregate aggregate) const
+{
+    ThingSpeakRange_t range = {start, end, GetRangeResolution(resolutionMinutes), aggregate};
+
+    cpr::Response response = cpr::Get(cpr::Url{GetRangeUrl(range)}, GetAcceptEncoding());
 
-    temperatureData.numDataPoints = 0;
-    humidityData.numDataPoints = 0;
+    return ParseRangeData(response, range);
+}
 
-    for (auto& feed : thingSpeakData["feeds"])
+/**
+ * @brief Create URL used to request the entries of a time range. Used by
+ *        callers which perform the HTTP request themselves
+ * 
+ * @param range - Range to request. The resolution must be one returned
+ *                by GetRangeResolution()
+ * 
+ * @return std::string - a string representing the URL to query
+ */
+std::string ThingSpeak::GetRangeUrl(ThingSpeakRange_t const & range) const
+{
+    std::string aggregation;
+    if (range.resolutionMinutes != THINGSPEAK_RANGE_RAW)
     {
-        // Update temperature data
-        if (feed[temperature] == nullptr)
+        switch (range.aggregate)
         {
-            #if (DEBUG_THINGSPEAK)
-            std::cout << "Skipping a temperature data point" << std::endl;
-            #endif
-            continue;
+            case ThingSpeakAggregate::Median:    aggregation = "median=";    break;
+            case ThingSpeakAggregate::Timescale: aggregation = "timescale="; break;
+            default:                             aggregation = "average=";   break;
+        }
+        aggregation += std::to_string(range.resolutionMinutes);
+    }
+
+    // Tiles are sized well below the per-request limit
+    return BuildThingSpeakHttpGetUrl(MAX_THINGSPEAK_REQUEST_SIZE, ThingSpeakFormatUrlDateTime(range.start),
+                                     ThingSpeakFormatUrlDateTime(range.end), aggregation);
+}
+
+/**
+ * @brief Convert a response to a GetRangeUrl() request into field data.
+ *        Aggregated entries carry no entry ID and are numbered from 1
+ * 
+ * @param response - HTTP response obtained from ThingSpeak
+ * @param range - Range which was requested
+ * 
+ * @return ThingSpeakFetchResult_t - Entries of the range for this channel
+ */
+ThingSpeakFetchResult_t ThingSpeak::ParseRangeData(cpr::Response const & response,
+                                                   ThingSpeakRange_t const & range) const
+{
+    ThingSpeakFetchResult_t result = ParseResponse(response, (range.resolutionMinutes != THINGSPEAK_RANGE_RAW));
+    result.rangeQuery = true;
+    result.range = range;
+
+    return result;
+}
+
+/**
+ * @brief Convert an entry published to the channel's MQTT subscribe topic
+ *        into field data. The payload is a single feed entry, e.g.
+ *        {"channel_id":1277292,"created_at":"...","entry_id":42,"field1":"71.6"}
+ * 
+ * @param payload - Body of the PUBLISH packet
+ * 
+ * @return ThingSpeakFetchResult_t - Field data holding the one entry. Field
+ *                                   names are not published and left empty
+ */
+ThingSpeakFetchResult_t ThingSpeak::ParsePublishedEntry(std::string_view payload) const
+{
+    ThingSpeakFetchResult_t result;
+    result.channel = thingSpeakChannel;
+    result.key = thingSpeakKey;
+    result.statusCode = 0;
+    result.notModified = false;
+    result.retryAfterSeconds = 0;
+    result.channelLastEntryId = 0;
+    result.lastEntry = {0, 0};
+    result.rangeQuery = false;
+    result.range = {0, 0, THINGSPEAK_RANGE_RAW, ThingSpeakAggregate::Average};
+    result.requestSeconds = 0.0;
+    result.parseSeconds = 0.0;
+    result.bytesDownloaded = static_cast<int64_t>(payload.size());
+
+    ThingSpeakFeedParser parser([&](ThingSpeakFeedEntry_t const & entry) {
+        result.lastEntry = {entry.entryId, entry.createdAt};
+
+        if (entry.validFields != 0)
+        {
+            result.feedData.series.Append(entry.entryId, entry.createdAt, entry.fields, entry.validFields);
         }
-        i = temperatureData.numDataPoints;
+    });
+
+    // Parsed as a feeds response holding one entry, so both are decoded alike
+    std::string feed = "{\"feeds\":[";
+    feed.append(payload);
+    feed.append("]}");
 
-        temperatureData.fieldName = thingSpeakData["channel"][temperature];
-        temperatureData.entryId[i] = feed["entry_id"];
-        temperatureData.timestamp[i] = feed["created_at"];
-        temperatureData.xAxisData[i] = i;
-        temperatureData.yAxisData[i] = std::stof(static_cast<std::string>(feed[temperature]));
+    auto parseStartTime = std::chrono::steady_clock::now();
+    result.validDataFetched = parser.Parse(feed) && (result.lastEntry.entryId > 0);
 
-        temperatureData.numDataPoints++;
+    std::chrono::duration<double> parseDuration = std::chrono::steady_clock::now() - parseStartTime;
+    result.parseSeconds = parseDuration.count();
 
-        // Update humidity data
-        if (feed[humidity] == nullptr)
+    // No channel object is published; the entry is the latest one
+    result.channelLastEntryId = result.lastEntry.entryId;
+
+    return result;
+}
+
+/**
+ * @brief Determine if applying a result leaves no gap after the entries
+ *        already held. Entries published while a push transport was
+ *        disconnected are never delivered, so a result skipping entry IDs
+ *        must be preceded by a fetch of the missed entries
+ * 
+ * @param result - Result holding the entries following GetLastEntry(),
+ *                 e.g. from ParsePublishedEntry()
+ * 
+ * @return bool - True if the result's first entry immediately follows, or
+ *                is already held. False if entries are missing or no field
+ *                data is held yet
+ */
+bool ThingSpeak::ContinuesFieldData(ThingSpeakFetchResult_t const & result) const
+{
+    if (!HasFieldData())
+    {
+        return false;
+    }
+
+    ThingSpeakSeries const & series = result.feedData.series;
+    int64_t firstEntryId = (series.Size() > 0) ? series.EntryId(0) : result.lastEntry.entryId;
+
+    return (firstEntryId <= (lastEntry.entryId + 1));
+}
+
+/**
+ * @brief Round a resolution up to the nearest one ThingSpeak supports
+ * 
+ * @param resolutionMinutes - Requested minutes per entry
+ * 
+ * @return int - Supported minutes per entry. THINGSPEAK_RANGE_RAW if 0 or less
+ */
+int ThingSpeak::GetRangeResolution(int resolutionMinutes)
+{
+    if (resolutionMinutes <= THINGSPEAK_RANGE_RAW)
+    {
+        return THINGSPEAK_RANGE_RAW;
+    }
+
+    for (int resolution : rangeResolutions)
+    {
+        if (resolution >= resolutionMinutes)
+        {
+            return resolution;
+        }
+    }
+
+    return rangeResolutions[std::size(rangeResolutions) - 1];
+}
+
+/**
+ * @brief Create the headers making a request conditional on the feed having
+ *        changed since an earlier response to the same URL
+ * 
+ * @param url - URL about to be requested
+ * @param validators - Validators of the earlier response. Use GetValidators()
+ * 
+ * @return cpr::Header - If-None-Match/If-Modified-Since headers. Empty if
+ *                       the validators were received for a different URL
+ */
+cpr::Header ThingSpeak::GetConditionalHeader(std::string const & url, ThingSpeakValidators_t const & validators)
+{
+    cpr::Header header;
+    if (validators.url != url)
+    {
+        return header;
+    }
+
+    if (!validators.eTag.empty())
+    {
+        header["If-None-Match"] = validators.eTag;
+    }
+    if (!validators.lastModified.empty())
+    {
+        header["If-Modified-Since"] = validators.lastModified;
+    }
+
+    return header;
+}
+
+/**
+ * @brief Response encodings accepted from ThingSpeak. Feeds are JSON text,
+ *        which compresses to a fraction of its size
+ * 
+ * @return cpr::AcceptEncoding - Encodings cpr decodes before returning the body
+ */
+cpr::AcceptEncoding ThingSpeak::GetAcceptEncoding()
+{
+    return cpr::AcceptEncoding{cpr::AcceptEncodingMethods::gzip, cpr::AcceptEncodingMethods::deflate};
+}
+
+/**
+ * @brief Set the server channels are requested from, e.g. a
+ *        HomeMonitorMockServer for load testing. Not synchronized with
+ *        requests in flight, so must be set before any fetch is started
+ * 
+ * @param baseUrl - Scheme and host, e.g. "http://localhost:8080". Empty
+ *                  for THINGSPEAK_DEFAULT_BASE_URL
+ */
+void ThingSpeak::SetBaseUrl(std::string baseUrl)
+{
+    while (!baseUrl.empty() && (baseUrl.back() == '/'))
+    {
+        baseUrl.pop_back();
+    }
+
+    thingSpeakBaseUrl = baseUrl.empty() ? THINGSPEAK_DEFAULT_BASE_URL : std::move(baseUrl);
+}
+
+/**
+ * @brief Get the server channels are requested from
+ * 
+ * @return std::string const & - Scheme and host, without a trailing slash
+ */
+std::string const & ThingSpeak::GetBaseUrl() { return thingSpeakBaseUrl; }
+
+/**
+ * @brief Decode a feeds response into a fetch result
+ * 
+ * @param response - HTTP response obtained from ThingSpeak
+ * @param numberEntries - Number entries from 1 when the feed has no entry IDs
+ * 
+ * @return ThingSpeakFetchResult_t - Parsed field data for this channel
+ */
+ThingSpeakFetchResult_t ThingSpeak::ParseResponse(cpr::Response const & response, bool numberEntries) const
+{
+    ThingSpeakFetchResult_t result;
+    result.channel = thingSpeakChannel;
+    result.key = thingSpeakKey;
+    result.statusCode = response.status_code;
+    result.notModified = false;
+    result.retryAfterSeconds = 0;
+    result.channelLastEntryId = 0;
+    result.lastEntry = {0, 0};
+    result.rangeQuery = false;
+    result.range = {0, 0, THINGSPEAK_RANGE_RAW, ThingSpeakAggregate::Average};
+    result.requestSeconds = response.elapsed;
+    result.parseSeconds = 0.0;
+    result.bytesDownloaded = static_cast<int64_t>(response.downloaded_bytes);
+
+    // Sent with 429/503 responses when ThingSpeak throttles requests
+    auto retryAfter = response.header.find("Retry-After");
+    if (retryAfter != response.header.end())
+    {
+        std::string const & value = retryAfter->second;
+        std::from_chars(value.data(), (value.data() + value.size()), result.retryAfterSeconds);
+    }
+
+    // Nothing to parse; the entries already held are current
+    if (response.status_code == static_cast<long>(HttpStatusCode::NotModified))
+    {
+        #if (DEBUG_THINGSPEAK)
+        std::cout << "\nNo new entries at " << response.url.str() << std::endl;
+        #endif
+
+        result.validDataFetched = true;
+        result.notModified = true;
+        return result;
+    }
+
+    auto eTag = response.header.find("ETag");
+    auto lastModified = response.header.find("Last-Modified");
+    result.validators.url = response.url.str();
+    result.validators.eTag = (eTag != response.header.end()) ? eTag->second : "";
+    result.validators.lastModified = (lastModified != response.header.end()) ? lastModified->second : "";
+
+    // New data is decoded straight into the result as the response is parsed
+    ThingSpeakFeedData_t& feedData = result.feedData;
+
+    ThingSpeakFeedParser parser([&](ThingSpeakFeedEntry_t const & entry) {
+        // Track newest entry, including entries without field data
+        result.lastEntry = {entry.entryId, entry.createdAt};
+
+        if (entry.validFields == 0)
         {
             #if (DEBUG_THINGSPEAK)
-            std::cout << "Skipping a humidity data point" << std::endl;
+            std::cout << "Skipping an entry without field data" << std::endl;
             #endif
-            continue;
+            return;
+        }
+
+        // Fields missing from the entry are stored as gaps in their column
+        feedData.series.Append(entry.entryId, entry.createdAt, entry.fields, entry.validFields);
+    }, numberEntries);
+
+    auto parseStartTime = std::chrono::steady_clock::now();
+    result.validDataFetched = ParseChannelData(response, parser);
+
+    std::chrono::duration<double> parseDuration = std::chrono::steady_clock::now() - parseStartTime;
+    result.parseSeconds = parseDuration.count();
+    if (!result.validDataFetched)
+    {
+        return result;
+    }
+
+    result.channelLastEntryId = parser.GetLastEntryId();
+    for (int n = THINGSPEAK_LOWEST_FIELD_NUMBER; n <= THINGSPEAK_HIGHEST_FIELD_NUMBER; n++)
+    {
+        feedData.fieldNames[n - THINGSPEAK_LOWEST_FIELD_NUMBER] = parser.GetFieldName(n);
+    }
+
+    return result;
+}
+
+/**
+ * @brief Update this object with data obtained through FetchFieldData().
+ *        Entries newer than the last entry received are appended to the
+ *        existing data. Previously fetched data is kept if the fetch failed
+ * 
+ * @param result - Fetch result for this object's channel
+ */
+void ThingSpeak::SetFieldData(ThingSpeakFetchResult_t const & result)
+{
+    validDataFetched = result.validDataFetched;
+    if (!validDataFetched)
+    {
+        return;
+    }
+
+    ApplyFieldData(result);
+}
+
+/**
+ * @brief Update this object with previously saved data, e.g. from a
+ *        ThingSpeakCache. Unlike SetFieldData(), whether the last fetch
+ *        succeeded is left unchanged
+ * 
+ * @param result - Saved field data for this object's channel
+ */
+void ThingSpeak::RestoreFieldData(ThingSpeakFetchResult_t const & result)
+{
+    if (!result.validDataFetched)
+    {
+        return;
+    }
+
+    ApplyFieldData(result);
+}
+
+/**
+ * @brief Merge field data into this object. Entries newer than the last
+ *        entry received are appended to the existing data
+ * 
+ * @param result - Field data for this object's channel
+ */
+void ThingSpeak::ApplyFieldData(ThingSpeakFetchResult_t const & result)
+{
+    if (result.notModified)
+    {
+        return;
+    }
+    validators = result.validators;
+
+    // Channel was cleared on ThingSpeak; entry IDs restarted
+    if (result.channelLastEntryId < lastEntry.entryId)
+    {
+        ClearFieldData();
+    }
+
+    for (int f = 0; f < THINGSPEAK_NUM_FIELDS; f++)
+    {
+        if (!result.feedData.fieldNames[f].empty())
+        {
+            feedData.fieldNames[f] = result.feedData.fieldNames[f];
         }
-        i = humidityData.numDataPoints;
+    }
 
-        humidityData.fieldName = thingSpeakData["channel"][humidity];
-        humidityData.entryId[i] = feed["entry_id"];
-        humidityData.timestamp[i] = feed["created_at"];
-        humidityData.xAxisData[i] = i;
-        humidityData.yAxisData[i] = std::stof(static_cast<std::string>(feed[humidity]));
+    // Results may overlap if requests were made with the same cursor
+    AppendFeedData(feedData, result.feedData, lastEntry.entryId);
 
-        humidityData.numDataPoints++;
+    if (result.lastEntry.entryId > lastEntry.entryId)
+    {
+        lastEntry = result.lastEntry;
     }
+}
 
-    return 0;
+/**
+ * @brief Discard all fetched data. The next fetch requests full history
+ * 
+ */
+void ThingSpeak::ClearFieldData()
+{
+    lastEntry = {0, 0};
+    validators = {};
+    feedData.series.Clear();
+}
+
+/**
+ * @brief Append newly fetched entries to existing feed data. Once the
+ *        series is full, the oldest entries are overwritten
+ * 
+ * @param feedData - Existing feed data to update
+ * @param newFeedData - Fetched feed data, sorted by entry ID
+ * @param afterEntryId - Only entries with a greater entry ID are appended
+ */
+void ThingSpeak::AppendFeedData(ThingSpeakFeedData_t& feedData,
+                                ThingSpeakFeedData_t const & newFeedData, int64_t afterEntryId)
+{
+    ThingSpeakSeries const & newSeries = newFeedData.series;
+
+    // Entries beyond capacity would be overwritten immediately
+    int first = std::max(newSeries.Size() - feedData.series.Capacity(), 0);
+    while ((first < newSeries.Size()) && (newSeries.EntryId(first) <= afterEntryId))
+    {
+        first++;
+    }
+
+    float fields[THINGSPEAK_NUM_FIELDS];
+    for (int i = first; i < newSeries.Size(); i++)
+    {
+        for (int f = 0; f < THINGSPEAK_NUM_FIELDS; f++)
+        {
+            fields[f] = newSeries.Value((f + THINGSPEAK_LOWEST_FIELD_NUMBER), i);
+        }
+
+        feedData.series.Append(newSeries.EntryId(i), newSeries.Timestamp(i),
+                               fields, newSeries.ValidFields(i));
+    }
 }
 
 /**
  * @brief Returns the name assigned to object
  * 
- * @return std::string const - Name of object
+ * @return std::string const & - Name of object
  */
-std::string const ThingSpeak::GetName() { return objectName; }
+std::string const & ThingSpeak::GetName() const { return objectName; }
 
 /**
  * @brief Returns the API channel assigned to object
  * 
- * @return std::string const - Name of object
+ * @return std::string const & - Name of object
  */
-std::string const ThingSpeak::GetChannel() { return thingSpeakChannel; }
+std::string const & ThingSpeak::GetChannel() const { return thingSpeakChannel; }
 
 /**
  * @brief Returns the API key assigned to object
  * 
- * @return std::string const - Name of object
+ * @return std::string const & - Name of object
  */
-std::string const ThingSpeak::GetKey() { return thingSpeakKey; }
+std::string const & ThingSpeak::GetKey() const { return thingSpeakKey; }
 
 /**
  * @brief Set the name assigned to object
@@ -125,145 +574,153 @@ void ThingSpeak::SetName(std::string name) { objectName = name; }
  * 
  * @param channel - ThingSpeak API channel
  */
-void ThingSpeak::SetChannel(std::string channel) { thingSpeakChannel = channel; }
+void ThingSpeak::SetChannel(std::string channel)
+{
+    if (channel != thingSpeakChannel)
+    {
+        ClearFieldData();
+    }
+    thingSpeakChannel = channel;
+}
 
 /**
  * @brief Set the API key assigned to object
  * 
  * @param key - ThingSpeak API key
  */
-void ThingSpeak::SetKey(std::string key) { thingSpeakKey = key; }
+void ThingSpeak::SetKey(std::string key)
+{
+    if (key != thingSpeakKey)
+    {
+        ClearFieldData();
+    }
+    thingSpeakKey = key;
+}
 
 /**
- * @brief Get current temperature data from this object
+ * @brief Get current field data from this object
  * 
- * @return ThingSpeakFeedData_t const* const - Array of temperature data
+ * @return ThingSpeakFeedData_t const* - Field names and data of every field
  */
-ThingSpeakFeedData_t const * const ThingSpeak::GetTemperature() { return &temperatureData; }
+ThingSpeakFeedData_t const * ThingSpeak::GetFeedData() const { return &feedData; }
 
 /**
- * @brief Get current humidity data from this object
+ * @brief Get the name the channel assigned to a field
+ * 
+ * @param field - Field to get name of
  * 
- * @return ThingSpeakFeedData_t const* const - Array of humidity data
+ * @return std::string const & - Name of field. Empty if not yet known
  */
-ThingSpeakFeedData_t const * const ThingSpeak::GetHumidity() { return &humidityData; }
+std::string const & ThingSpeak::GetFieldName(ThingSpeakField field) const
+{
+    int f = static_cast<int>(field) - THINGSPEAK_LOWEST_FIELD_NUMBER;
+    assert((f >= 0) && (f < THINGSPEAK_NUM_FIELDS));
+
+    return feedData.fieldNames[f];
+}
 
 /**
  * @brief Determines if valid data was fetched from ThingSpeak
  * 
  * @return True if data was successfully fetched. False otherwise
  */
-bool const ThingSpeak::ValidData() { return validDataFetched; }
+bool ThingSpeak::ValidData() const { return validDataFetched; }
 
 /**
- * @brief Perform an HTTP GET call to ThingSpeak endpoint to obtain
- *        data in JSON format
+ * @brief Determines if any field data is held, whether fetched or restored
  * 
- * @param numEntries - The number of entries to obtain from ThingSpeak
+ * @return True if at least one entry has been received. False otherwise
+ */
+bool ThingSpeak::HasFieldData() const { return (lastEntry.entryId > 0); }
+
+/**
+ * @brief Get the newest entry received from ThingSpeak. Only entries newer
+ *        than this are requested on the next fetch
  * 
- * @return json - JSON object containing response from ThingSpeak
- *                NULL if data could not be obtained
+ * @return ThingSpeakFeedCursor_t - Last entry received
  */
-json ThingSpeak::GetChannelData(uint32_t numEntries)
-{
-    std::string thingSpeakUrl = BuildThingSpeakHttpGetUrl(numEntries);
+ThingSpeakFeedCursor_t ThingSpeak::GetLastEntry() const { return lastEntry; }
 
-    cpr::Response result = cpr::Get(cpr::Url{thingSpeakUrl});
+/**
+ * @brief Get the validators of the last response applied to this object.
+ *        Sent with the next fetch so an unchanged feed is not downloaded again
+ * 
+ * @return ThingSpeakValidators_t const & - ETag/Last-Modified of the last response
+ */
+ThingSpeakValidators_t const & ThingSpeak::GetValidators() const { return validators; }
 
-    json thingSpeakData = NULL;
+/**
+ * @brief Validate and decode the JSON body of an HTTP GET call made to
+ *        the ThingSpeak endpoint
+ * 
+ * @param result - HTTP response obtained from ThingSpeak
+ * @param parser - Streaming parser to decode the response with
+ * 
+ * @return bool - True if the response was successfully decoded
+ */
+bool ThingSpeak::ParseChannelData(cpr::Response const & result, ThingSpeakFeedParser& parser) const
+{
+    std::string const & thingSpeakUrl = result.url.str();
 
-    validDataFetched = (result.status_code == static_cast<long>(HttpStatusCode::OK));
-    if (validDataFetched)
+    if (result.status_code != static_cast<long>(HttpStatusCode::OK))
     {
-        std::cout << "\nGot successful response from " << thingSpeakUrl << std::endl;
-        
-        thingSpeakData = json::parse(result.text);
+        std::cerr << "[ERROR] Couldn't GET from " << thingSpeakUrl << ".\n"
+                  << "        Return code: " << result.status_code << std::endl;
+        return false;
+    }
 
-        for (auto& feed : thingSpeakData["feeds"])
-        {
-            feed["created_at"] = ConvertUtcDateTimeToPstDateTime(feed["created_at"]);
+    #if (DEBUG_THINGSPEAK)
+    std::cout << "\nGot successful response from " << thingSpeakUrl << std::endl;
+    std::cout << "\nFeed Data:\n" << result.text << std::endl;
+    #endif
 
-            #if (DEBUG_THINGSPEAK)
-            std::cout << "\nFeed Data:\n" << feed << std::endl;
-            #endif
-        }
-    }
-    else
+    if (!parser.Parse(result.text))
     {
-        std::cerr << "[ERROR] Couldn't GET from " << thingSpeakUrl << ".\n"
-                  << "        Return code: " << result.status_code << std::endl;
+        std::cerr << "[ERROR] Malformed response from " << thingSpeakUrl << std::endl;
+        return false;
     }
 
-    return thingSpeakData;
+    return true;
 }
 
 /**
  * @brief Create URL used to perform HTTP get request to ThingSpeak
  * 
  * @param numEntries - The number of entries to obtain from ThingSpeak
+ * @param start - Earliest UTC Date/Time to obtain ("YYYY-MM-DD%20HH:NN:SS").
+ *                Empty to obtain the latest numEntries entries
+ * @param end - Latest UTC Date/Time to obtain. Empty for no limit
+ * @param aggregation - Aggregation parameter, e.g. "average=60". Empty for
+ *                      entries as captured
  * 
  * @return std::string - a string representing the URL to query
  */
-std::string ThingSpeak::BuildThingSpeakHttpGetUrl(uint32_t numEntries)
+std::string ThingSpeak::BuildThingSpeakHttpGetUrl(uint32_t numEntries, std::string const & start,
+                                                  std::string const & end,
+                                                  std::string const & aggregation) const
 {
-    std::string url = "https://api.thingspeak.com/channels/";
+    std::string url = thingSpeakBaseUrl;
+    url += "/channels/";
     url += thingSpeakChannel;
     url += "/feeds.json?api_key=";
     url += thingSpeakKey;
     url += "&results=";
     url += std::to_string(numEntries);
-
-    return url;
-}
-
-/**
- * @brief Functionality to convert the date and time provided by
- *        ThingSpeak (UTC) to its corresponding date and time PST
- * 
- * @param utcDateTimeStr - UTC Date/Time string (e.g. "2024-12-24T07:10:39Z")
- * 
- * @return std::string - PST Date/Time string
- */
-std::string ThingSpeak::ConvertUtcDateTimeToPstDateTime(std::string utcDateTimeStr)
-{
-    // Parse the UTC time string to std::chrono::system_clock::time_point
-    std::istringstream ss(utcDateTimeStr);
-    std::chrono::sys_time<std::chrono::seconds> utcTimePoint;
-    ss >> std::chrono::parse("%Y-%m-%dT%H:%M:%SZ", utcTimePoint);
-
-    // Define the PST offset and perform conversion
-    auto pstOffset = std::chrono::hours(GetPstTimeOffset());
-    auto pstTimePoint = utcTimePoint + pstOffset;
-
-    // Convert time_point back to std::tm
-    std::time_t pstTime = std::chrono::system_clock::to_time_t(pstTimePoint);
-    std::tm* pstTm = std::gmtime(&pstTime);
-
-    // Convert timestamp to string
-    std::ostringstream oss;
-    oss << std::put_time(pstTm, "%Y-%m-%d %H:%M:%S");
-    std::string pstDateTimeStr = oss.str();
-
-    return pstDateTimeStr;
-}
-
-/**
- * @brief Compute PST time offset based on Daylight savings
- * 
- * @return int - Offset, in hours, to convert UTC time to PST
- */
-int ThingSpeak::GetPstTimeOffset(void)
-{
-    int pstOffset = -8;
-
-    auto now = std::chrono::system_clock::now();
-    auto local_time = std::chrono::zoned_time{std::chrono::current_zone(), now};
-
-    bool daylightSavings = (local_time.get_info().save != std::chrono::seconds{0});
-    if (daylightSavings)
+    if (!start.empty())
+    {
+        url += "&start=";
+        url += start;
+    }
+    if (!end.empty())
+    {
+        url += "&end=";
+        url += end;
+    }
+    if (!aggregation.empty())
     {
-        pstOffset += 1;
+        url += "&";
+        url += aggregation;
     }
 
-    return pstOffset;
+    return url;
 }
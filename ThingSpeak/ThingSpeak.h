@@ -1,5 +1,8 @@
+#pragma once
+
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <vector>
 #include <exception>
@@ -9,29 +12,117 @@
 #include <cpr/cpr.h>
 #include <nlohmann/json.hpp>
 
+#include "ThingSpeakSeries.h"
+#include "ThingSpeakTime.h"
+
 using json = nlohmann::json;
 
-#define MAX_THINGSPEAK_REQUEST_SIZE   100
+#define MAX_THINGSPEAK_REQUEST_SIZE   8000
+#define THINGSPEAK_DEFAULT_BASE_URL   "https://api.thingspeak.com"   // See ThingSpeak::SetBaseUrl()
 
+#define THINGSPEAK_RANGE_RAW          0      // Resolution of entries as captured, without aggregation
+
+enum class HttpStatusCode
+{
+    OK = 200,
+    Created = 201,
+    Accepted = 202,
+    NoContent = 204,
+    MovedPermanently = 301,
+    Found = 302,
+    NotModified = 304,
+    BadRequest = 400,
+    Unauthorized = 401,
+    Forbidden = 403,
+    NotFound = 404,
+    TooManyRequests = 429,
+    InternalServerError = 500,
+    NotImplemented = 501,
+    BadGateway = 502,
+    ServiceUnavailable = 503
+};
+
+// Value is the ThingSpeak field number the data is published on
 enum class ThingSpeakField
 {
     Temperature = 1,
-    Humidity
+    Humidity,
+    Field3,
+    Field4,
+    Field5,
+    Field6,
+    Field7,
+    Field8
 };
 
 typedef std::map<std::string, std::string> thingSpeakEntry;
 
+// How ThingSpeak combines the entries of each interval of an aggregated range
+enum class ThingSpeakAggregate
+{
+    Average,
+    Median,
+    Timescale      // First entry of each interval
+};
+
 typedef struct
 {
-    std::string fieldName;
-    int numDataPoints;
+    int64_t start;                    // UTC epoch seconds, inclusive
+    int64_t end;                      // UTC epoch seconds, inclusive
+    int resolutionMinutes;            // Minutes per aggregated entry (10, 15, 20, 30, 60, 240, 720
+                                      // or 1440). THINGSPEAK_RANGE_RAW for entries as captured
+    ThingSpeakAggregate aggregate;
+} ThingSpeakRange_t;
 
-    int entryId[MAX_THINGSPEAK_REQUEST_SIZE];
-    float xAxisData[MAX_THINGSPEAK_REQUEST_SIZE];
-    float yAxisData[MAX_THINGSPEAK_REQUEST_SIZE];
-    std::string timestamp[MAX_THINGSPEAK_REQUEST_SIZE];
+typedef struct
+{
+    std::string fieldNames[THINGSPEAK_NUM_FIELDS];   // fieldNames[N - 1] holds name of fieldN
+    ThingSpeakSeries series;                         // Every field of the feed
 } ThingSpeakFeedData_t;
 
+typedef struct
+{
+    int64_t entryId;          // Highest entry_id received. 0 if none received
+    int64_t createdAt;        // UTC epoch seconds of that entry
+} ThingSpeakFeedCursor_t;
+
+// Validators of the last response, sent back so an unchanged feed is answered
+// with 304 Not Modified instead of the full feed
+typedef struct
+{
+    std::string url;              // Request the validators were received for. Empty if none
+    std::string eTag;             // Empty if not sent
+    std::string lastModified;     // Empty if not sent
+} ThingSpeakValidators_t;
+
+typedef struct
+{
+    std::string channel;
+    std::string key;
+    bool validDataFetched;
+    bool notModified;             // Feed unchanged since the validators sent. No feed data
+    long statusCode;              // HTTP status of the response. 0 if no response
+    int64_t retryAfterSeconds;    // Delay requested by a Retry-After header. 0 if none
+
+    int64_t channelLastEntryId;   // Latest entry_id reported by ThingSpeak
+    ThingSpeakFeedCursor_t lastEntry;
+
+    ThingSpeakFeedData_t feedData;
+    ThingSpeakValidators_t validators;
+
+    // Set for results of Fetch(). Entries of aggregated ranges are numbered
+    // from 1 rather than carrying ThingSpeak entry IDs
+    bool rangeQuery;
+    ThingSpeakRange_t range;
+
+    // Measurements of the request, e.g. for diagnostics
+    double requestSeconds;        // Duration of the HTTP request. 0 if not requested
+    double parseSeconds;          // Duration of parsing the response
+    int64_t bytesDownloaded;      // Size of the response body received
+} ThingSpeakFetchResult_t;
+
+class ThingSpeakFeedParser;
+
 class ThingSpeak
 {
 public:
@@ -41,15 +132,36 @@ public:
                objectName(name), thingSpeakChannel(id), thingSpeakKey(key) {}
 
     int GetFieldData();
-    std::string const GetName();
-    std::string const GetChannel();
-    std::string const GetKey();
+    ThingSpeakFetchResult_t FetchFieldData() const;
+    std::string GetFieldDataUrl(ThingSpeakFeedCursor_t const & since) const;
+    ThingSpeakFetchResult_t ParseFieldData(cpr::Response const & response) const;
+    ThingSpeakFetchResult_t Fetch(int64_t start, int64_t end, int resolutionMinutes,
+                                  ThingSpeakAggregate aggregate = ThingSpeakAggregate::Average) const;
+    std::string GetRangeUrl(ThingSpeakRange_t const & range) const;
+    ThingSpeakFetchResult_t ParseRangeData(cpr::Response const & response,
+                                           ThingSpeakRange_t const & range) const;
+    ThingSpeakFetchResult_t ParsePublishedEntry(std::string_view payload) const;
+    bool ContinuesFieldData(ThingSpeakFetchResult_t const & result) const;
+    void SetFieldData(ThingSpeakFetchResult_t const & result);
+    void RestoreFieldData(ThingSpeakFetchResult_t const & result);
+    std::string const & GetName() const;
+    std::string const & GetChannel() const;
+    std::string const & GetKey() const;
     void SetName(std::string name);
     void SetChannel(std::string channel);
     void SetKey(std::string key);
-    ThingSpeakFeedData_t const * const GetTemperature();
-    ThingSpeakFeedData_t const * const GetHumidity();
-    bool const ValidData();
+    ThingSpeakFeedData_t const * GetFeedData() const;
+    std::string const & GetFieldName(ThingSpeakField field) const;
+    bool ValidData() const;
+    bool HasFieldData() const;
+    ThingSpeakFeedCursor_t GetLastEntry() const;
+    ThingSpeakValidators_t const & GetValidators() const;
+
+    static int GetRangeResolution(int resolutionMinutes);
+    static cpr::Header GetConditionalHeader(std::string const & url, ThingSpeakValidators_t const & validators);
+    static cpr::AcceptEncoding GetAcceptEncoding();
+    static void SetBaseUrl(std::string baseUrl);
+    static std::string const & GetBaseUrl();
 
 private:
     // Member Variables
@@ -57,13 +169,19 @@ private:
     std::string thingSpeakChannel;
 	std::string thingSpeakKey;
 
-    bool validDataFetched;
-    ThingSpeakFeedData_t temperatureData;
-    ThingSpeakFeedData_t humidityData;
+    bool validDataFetched = false;
+    ThingSpeakFeedCursor_t lastEntry = {0, 0};
+    ThingSpeakFeedData_t feedData = {};
+    ThingSpeakValidators_t validators = {};
 
     // Member Functions
-    json GetChannelData(uint32_t numEntries);
-	std::string BuildThingSpeakHttpGetUrl(uint32_t numRequests);
-    std::string ConvertUtcDateTimeToPstDateTime(std::string utcDateTimeStr);
-    int GetPstTimeOffset(void);
+    bool ParseChannelData(cpr::Response const & result, ThingSpeakFeedParser& parser) const;
+	std::string BuildThingSpeakHttpGetUrl(uint32_t numRequests, std::string const & start,
+                                          std::string const & end = "",
+                                          std::string const & aggregation = "") const;
+    ThingSpeakFetchResult_t ParseResponse(cpr::Response const & response, bool numberEntries) const;
+    void ClearFieldData();
+    void ApplyFieldData(ThingSpeakFetchResult_t const & result);
+    static void AppendFeedData(ThingSpeakFeedData_t& feedData,
+                               ThingSpeakFeedData_t const & newFeedData, int64_t afterEntryId);
 };
@@ -0,0 +1,590 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+#include "ThingSpeakAlerts.h"
+
+typedef struct
+{
+    char const * name;
+    ThingSpeakAlertKind kind;
+} ThingSpeakAlertKindName_t;
+
+// Names of the kinds in the rules file
+static ThingSpeakAlertKindName_t const alertKindNames[] =
+{
+    {"above", ThingSpeakAlertKind::Above},
+    {"below", ThingSpeakAlertKind::Below},
+    {"rate", ThingSpeakAlertKind::RateOfChange},
+    {"deviation", ThingSpeakAlertKind::Deviation},
+    {"stale", ThingSpeakAlertKind::Stale},
+};
+
+/**
+ * @brief Read the rules from a JSON file, replacing the current rules
+ * 
+ * @param filePath - Path of the rules file
+ * 
+ * @return bool - True if the file was read. False if it does not exist or
+ *                could not be parsed, leaving the rules unchanged
+ */
+bool ThingSpeakAlerts::LoadRules(std::filesystem::path const & filePath)
+{
+    std::ifstream rulesFile(filePath);
+    if (!rulesFile.is_open())
+    {
+        return false;
+    }
+
+    json rulesJson = json::parse(rulesFile, nullptr, false);
+    std::vector<ThingSpeakAlertRule_t> newRules;
+    if (rulesJson.is_discarded() || !ParseRules(rulesJson, newRules))
+    {
+        std::cerr << "[ERROR] Could not parse " << filePath.string() << std::endl;
+        return false;
+    }
+
+    SetRules(std::move(newRules));
+
+    return true;
+}
+
+/**
+ * @brief Replace the rules. Every channel is evaluated again from the
+ *        samples it holds on its next Update()
+ * 
+ * @param newRules - Rules to evaluate
+ */
+void ThingSpeakAlerts::SetRules(std::vector<ThingSpeakAlertRule_t> newRules)
+{
+    rules = std::move(newRules);
+    channels.clear();
+    pending.clear();
+    nextStaleTime = INT64_MAX;
+}
+
+/**
+ * @brief Returns the rules evaluated
+ * 
+ * @return std::vector<ThingSpeakAlertRule_t> const & - Rules, indexed by
+ *                                                      ThingSpeakAlertEvent_t::rule
+ */
+std::vector<ThingSpeakAlertRule_t> const & ThingSpeakAlerts::GetRules() const { return rules; }
+
+/**
+ * @brief Evaluate the samples a channel received since the last call. Only
+ *        objects holding the channel's latest data should be passed; objects
+ *        sharing a channel are evaluated once
+ * 
+ * @param thingSpeak - Object whose data was just updated
+ */
+void ThingSpeakAlerts::Update(ThingSpeak const & thingSpeak)
+{
+    if (rules.empty() || !thingSpeak.HasFieldData())
+    {
+        return;
+    }
+
+    ThingSpeakSeries const & series = thingSpeak.GetFeedData()->series;
+    std::string const & channel = thingSpeak.GetChannel();
+    int64_t firstHeldSample = series.NumAppended() - series.Size();
+
+    auto [entry, created] = channels.try_emplace(channel);
+    ThingSpeakAlertChannel_t& alertChannel = entry->second;
+    alertChannel.name = thingSpeak.GetName();
+
+    // Held samples are evaluated silently when the states are rebuilt
+    bool replay = created || (alertChannel.generation != series.Generation()) ||
+                  (alertChannel.numAppended > series.NumAppended());
+    std::vector<bool> wasActive;
+    if (replay)
+    {
+        for (auto const & state : alertChannel.states)
+        {
+            wasActive.push_back(state.active);
+        }
+
+        Reset(alertChannel, channel, series);
+    }
+
+    // Samples overwritten before they were seen are skipped
+    for (int64_t s = std::max(alertChannel.numAppended, firstHeldSample); s < series.NumAppended(); s++)
+    {
+        Evaluate(alertChannel, thingSpeak, s, static_cast<int>(s - firstHeldSample), !replay);
+    }
+    alertChannel.numAppended = series.NumAppended();
+
+    // Only the outcome of the replay is reported. Stale alerts are settled
+    // against the time of the last check, the replayed samples only telling
+    // when the newest entry was captured
+    if (replay)
+    {
+        for (size_t i = 0; i < alertChannel.states.size(); i++)
+        {
+            ThingSpeakAlertState_t& state = alertChannel.states[i];
+            ThingSpeakAlertRule_t const & rule = rules[state.rule];
+            bool previouslyActive = (i < wasActive.size()) && wasActive[i];
+            if (rule.kind == ThingSpeakAlertKind::Stale)
+            {
+                state.active = IsStale(alertChannel, rule, lastStaleCheck);
+                if (state.active != previouslyActive)
+                {
+                    Report(channel, alertChannel, state, "", std::numeric_limits<float>::quiet_NaN(), lastStaleCheck);
+                }
+                continue;
+            }
+
+            if (state.active == previouslyActive)
+            {
+                continue;
+            }
+
+            Report(channel, alertChannel, state, thingSpeak.GetFieldName(static_cast<ThingSpeakField>(rule.field)),
+                   (state.active ? state.raisedValue : std::numeric_limits<float>::quiet_NaN()),
+                   alertChannel.lastTimestamp);
+        }
+    }
+
+    ScheduleStale(alertChannel);
+}
+
+/**
+ * @brief Raise Stale alerts of channels without an entry within their
+ *        window. Channels are only scanned once the earliest deadline has
+ *        passed, so the call is cheap enough to make every frame
+ * 
+ * @param now - UTC epoch seconds
+ */
+void ThingSpeakAlerts::CheckStale(int64_t now)
+{
+    lastStaleCheck = now;
+    if (now < nextStaleTime)
+    {
+        return;
+    }
+
+    nextStaleTime = INT64_MAX;
+    for (auto& [channel, alertChannel] : channels)
+    {
+        for (auto& state : alertChannel.states)
+        {
+            ThingSpeakAlertRule_t const & rule = rules[state.rule];
+            if (rule.kind != ThingSpeakAlertKind::Stale)
+            {
+                continue;
+            }
+
+            bool stale = IsStale(alertChannel, rule, now);
+            if (stale != state.active)
+            {
+                state.active = stale;
+                Report(channel, alertChannel, state, "", std::numeric_limits<float>::quiet_NaN(), now);
+            }
+        }
+
+        ScheduleStale(alertChannel);
+    }
+}
+
+/**
+ * @brief Stop evaluating a channel, e.g. once no object uses it. Its active
+ *        alerts are dropped without being cleared
+ * 
+ * @param channel - ThingSpeak channel ID
+ */
+void ThingSpeakAlerts::Remove(std::string const & channel) { channels.erase(channel); }
+
+/**
+ * @brief Hand over the alerts raised and cleared since the last call
+ * 
+ * @param events - Cleared and filled with any events, oldest first
+ * 
+ * @return bool - True if at least one event was collected
+ */
+bool ThingSpeakAlerts::Collect(std::vector<ThingSpeakAlertEvent_t>& events)
+{
+    events.clear();
+    events.swap(pending);
+
+    return !events.empty();
+}
+
+/**
+ * @brief Get the alert states of a channel, e.g. to mark active alerts on
+ *        its plot
+ * 
+ * @param channel - ThingSpeak channel ID
+ * 
+ * @return ThingSpeakAlertChannel_t const * - States of the channel. Null if
+ *                                            the channel is not evaluated
+ */
+ThingSpeakAlertChannel_t const * ThingSpeakAlerts::GetChannel(std::string const & channel) const
+{
+    auto entry = channels.find(channel);
+
+    return ((entry != channels.end()) ? &entry->second : nullptr);
+}
+
+/**
+ * @brief Get the earliest time a Stale alert may be raised, e.g. to wake up
+ *        for CheckStale()
+ * 
+ * @return int64_t - UTC epoch seconds. INT64_MAX if none can be raised
+ */
+int64_t ThingSpeakAlerts::NextStaleTime() const { return nextStaleTime; }
+
+/**
+ * @brief Describe an event for a notification
+ * 
+ * @param event - Event collected from Collect()
+ * 
+ * @return std::string - E.g. "Freezer: Temperature 12.40 above 10.00"
+ */
+std::string ThingSpeakAlerts::Describe(ThingSpeakAlertEvent_t const & event) const
+{
+    ThingSpeakAlertRule_t const & rule = rules[event.rule];
+    std::string fieldName = event.fieldName.empty() ? ("Field " + std::to_string(rule.field)) : event.fieldName;
+    char description[256];
+
+    switch (rule.kind)
+    {
+        case ThingSpeakAlertKind::Above:
+        case ThingSpeakAlertKind::Below:
+        case ThingSpeakAlertKind::Deviation:
+            if (!event.raised)
+            {
+                snprintf(description, sizeof(description), "%s: %s back to %.2f",
+                         event.channelName.c_str(), fieldName.c_str(), event.value);
+            }
+            else if (rule.kind == ThingSpeakAlertKind::Deviation)
+            {
+                snprintf(description, sizeof(description), "%s: %s unusual at %.2f",
+                         event.channelName.c_str(), fieldName.c_str(), event.value);
+            }
+            else
+            {
+                snprintf(description, sizeof(description), "%s: %s %.2f %s %.2f",
+                         event.channelName.c_str(), fieldName.c_str(), event.value,
+                         ((rule.kind == ThingSpeakAlertKind::Above) ? "above" : "below"), rule.threshold);
+            }
+            break;
+        case ThingSpeakAlertKind::RateOfChange:
+            if (event.raised)
+            {
+                snprintf(description, sizeof(description), "%s: %s changed by %.2f within %lld min",
+                         event.channelName.c_str(), fieldName.c_str(), event.value,
+                         static_cast<long long>(rule.windowSeconds / 60));
+            }
+            else
+            {
+                snprintf(description, sizeof(description), "%s: %s steady again",
+                         event.channelName.c_str(), fieldName.c_str());
+            }
+            break;
+        case ThingSpeakAlertKind::Stale:
+        default:
+            if (event.raised)
+            {
+                snprintf(description, sizeof(description), "%s: no entry for %lld min",
+                         event.channelName.c_str(), static_cast<long long>(rule.windowSeconds / 60));
+            }
+            else
+            {
+                snprintf(description, sizeof(description), "%s: entries resumed", event.channelName.c_str());
+            }
+            break;
+    }
+
+    return description;
+}
+
+/**
+ * @brief Parse rules from the contents of a rules file, e.g.
+ * 
+ *            [{"name": "Freezer too warm", "channel": "1277292", "field": 1,
+ *              "kind": "above", "threshold": 10.0, "hysteresis": 1.0},
+ *             {"name": "Humidity spike", "field": 2, "kind": "rate",
+ *              "threshold": 15.0, "minutes": 10},
+ *             {"name": "Offline", "kind": "stale", "minutes": 30}]
+ * 
+ *        Invalid rules are reported and skipped
+ * 
+ * @param rulesJson - Array of rules
+ * @param rules - Filled with the valid rules
+ * 
+ * @return bool - True if rulesJson is an array. False otherwise
+ */
+bool ThingSpeakAlerts::ParseRules(json const & rulesJson, std::vector<ThingSpeakAlertRule_t>& rules)
+{
+    rules.clear();
+    if (!rulesJson.is_array())
+    {
+        return false;
+    }
+
+    for (auto const & ruleJson : rulesJson)
+    {
+        ThingSpeakAlertRule_t rule = {};
+        std::string kind;
+
+        try
+        {
+            rule.name = ruleJson.value("name", "");
+            rule.channel = ruleJson.value("channel", "");
+            rule.field = ruleJson.value("field", THINGSPEAK_LOWEST_FIELD_NUMBER);
+            rule.threshold = ruleJson.value("threshold", 0.0f);
+            rule.hysteresis = ruleJson.value("hysteresis", 0.0f);
+            rule.windowSeconds = ruleJson.value("minutes", static_cast<int64_t>(0)) * 60;
+            kind = ruleJson.value("kind", "");
+        }
+        catch (json::exception const & error)
+        {
+            std::cerr << "[ERROR] Invalid alert rule: " << error.what() << std::endl;
+            continue;
+        }
+
+        auto kindName = std::ranges::find_if(alertKindNames, [&kind](ThingSpeakAlertKindName_t const & k) {
+            return (kind == k.name);
+        });
+        if (kindName == std::end(alertKindNames))
+        {
+            std::cerr << "[ERROR] Alert rule \"" << rule.name << "\" has unknown kind \"" << kind << "\"" << std::endl;
+            continue;
+        }
+        rule.kind = kindName->kind;
+
+        bool windowed = (rule.kind == ThingSpeakAlertKind::RateOfChange) || (rule.kind == ThingSpeakAlertKind::Stale);
+        if ((rule.field < THINGSPEAK_LOWEST_FIELD_NUMBER) || (rule.field > THINGSPEAK_HIGHEST_FIELD_NUMBER) ||
+            (rule.hysteresis < 0.0f) || (windowed && (rule.windowSeconds <= 0)))
+        {
+            std::cerr << "[ERROR] Alert rule \"" << rule.name << "\" has an invalid field, hysteresis or window"
+                      << std::endl;
+            continue;
+        }
+
+        rules.push_back(rule);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Rebuild the states of a channel for the rules applying to it,
+ *        before its held samples are evaluated again
+ * 
+ * @param alertChannel - Channel to reset
+ * @param channel - ThingSpeak channel ID
+ * @param series - Series the states will be built from
+ */
+void ThingSpeakAlerts::Reset(ThingSpeakAlertChannel_t& alertChannel, std::string const & channel,
+                             ThingSpeakSeries const & series)
+{
+    alertChannel.states.clear();
+
+    for (int r = 0; r < static_cast<int>(rules.size()); r++)
+    {
+        if (!rules[r].channel.empty() && (rules[r].channel != channel))
+        {
+            continue;
+        }
+
+        ThingSpeakAlertState_t state = {};
+        state.rule = r;
+        state.raisedSample = -1;
+        state.raisedValue = std::numeric_limits<float>::quiet_NaN();
+        alertChannel.states.push_back(std::move(state));
+    }
+
+    alertChannel.generation = series.Generation();
+    alertChannel.numAppended = series.NumAppended() - series.Size();
+    alertChannel.lastTimestamp = 0;
+}
+
+/**
+ * @brief Evaluate every rule of a channel against a new sample
+ * 
+ * @param alertChannel - Channel the sample belongs to
+ * @param thingSpeak - Object holding the channel's series
+ * @param sampleNumber - Sample number of the sample
+ * @param index - Sample index of the sample
+ * @param report - Report alerts raised or cleared by the sample
+ */
+void ThingSpeakAlerts::Evaluate(ThingSpeakAlertChannel_t& alertChannel, ThingSpeak const & thingSpeak,
+                                int64_t sampleNumber, int index, bool report)
+{
+    ThingSpeakSeries const & series = thingSpeak.GetFeedData()->series;
+    std::string const & channel = thingSpeak.GetChannel();
+    int64_t timestamp = series.Timestamp(index);
+    alertChannel.lastTimestamp = std::max(alertChannel.lastTimestamp, timestamp);
+
+    for (auto& state : alertChannel.states)
+    {
+        ThingSpeakAlertRule_t const & rule = rules[state.rule];
+
+        // Any entry clears a Stale alert
+        if (rule.kind == ThingSpeakAlertKind::Stale)
+        {
+            if (report && state.active)
+            {
+                state.active = false;
+                Report(channel, alertChannel, state, "", std::numeric_limits<float>::quiet_NaN(), timestamp);
+            }
+            continue;
+        }
+
+        float value = series.Value(rule.field, index);
+        if (std::isnan(value))
+        {
+            continue;
+        }
+
+        bool raise = false;
+        bool clear = false;
+
+        switch (rule.kind)
+        {
+            case ThingSpeakAlertKind::Above:
+                raise = (value > rule.threshold);
+                clear = (value < (rule.threshold - rule.hysteresis));
+                break;
+            case ThingSpeakAlertKind::Below:
+                raise = (value < rule.threshold);
+                clear = (value > (rule.threshold + rule.hysteresis));
+                break;
+            case ThingSpeakAlertKind::RateOfChange:
+            {
+                // Values dominated by a newer one can never be the window's
+                // min/max again, so the fronts are always the min/max
+                while (!state.windowMin.empty() && (state.windowMin.back().value >= value))
+                {
+                    state.windowMin.pop_back();
+                }
+                state.windowMin.push_back({timestamp, value});
+                while (!state.windowMax.empty() && (state.windowMax.back().value <= value))
+                {
+                    state.windowMax.pop_back();
+                }
+                state.windowMax.push_back({timestamp, value});
+
+                while (state.windowMin.front().timestamp <= (timestamp - rule.windowSeconds))
+                {
+                    state.windowMin.pop_front();
+                }
+                while (state.windowMax.front().timestamp <= (timestamp - rule.windowSeconds))
+                {
+                    state.windowMax.pop_front();
+                }
+
+                // Reported as the change rather than the value
+                value = state.windowMax.front().value - state.windowMin.front().value;
+                raise = (value >= rule.threshold);
+                clear = (value < (rule.threshold - rule.hysteresis));
+                break;
+            }
+            case ThingSpeakAlertKind::Deviation:
+            {
+                // Compared against the values before it, so a spike does not
+                // widen its own deviation
+                if ((state.numValues >= THINGSPEAK_ALERT_DEVIATION_MIN_VALUES) && (state.m2 > 0.0))
+                {
+                    double deviation = std::sqrt(state.m2 / (state.numValues - 1));
+                    double distance = std::abs(value - state.mean) / deviation;
+                    raise = (distance > rule.threshold);
+                    clear = (distance < (rule.threshold - rule.hysteresis));
+                }
+
+                state.numValues++;
+                double delta = value - state.mean;
+                state.mean += delta / state.numValues;
+                state.m2 += delta * (value - state.mean);
+                break;
+            }
+            default:
+                break;
+        }
+
+        if (!state.active && raise)
+        {
+            state.active = true;
+            state.raisedSample = sampleNumber;
+            state.raisedValue = value;
+        }
+        else if (state.active && clear)
+        {
+            state.active = false;
+            state.raisedSample = -1;
+            state.raisedValue = std::numeric_limits<float>::quiet_NaN();
+        }
+        else
+        {
+            continue;
+        }
+
+        if (report)
+        {
+            Report(channel, alertChannel, state, thingSpeak.GetFieldName(static_cast<ThingSpeakField>(rule.field)),
+                   value, timestamp);
+        }
+    }
+}
+
+/**
+ * @brief Queue an event for the current state of an alert
+ * 
+ * @param channel - ThingSpeak channel ID
+ * @param alertChannel - Channel the alert belongs to
+ * @param state - Alert which was raised or cleared
+ * @param fieldName - Name the channel assigned to the rule's field
+ * @param value - See ThingSpeakAlertEvent_t::value
+ * @param timestamp - UTC epoch seconds of the value or check
+ */
+void ThingSpeakAlerts::Report(std::string const & channel, ThingSpeakAlertChannel_t const & alertChannel,
+                              ThingSpeakAlertState_t const & state, std::string const & fieldName,
+                              float value, int64_t timestamp)
+{
+    pending.push_back({state.rule, channel, alertChannel.name, fieldName, state.active, value, timestamp});
+}
+
+/**
+ * @brief Bring the earliest Stale deadline forward to the channel's, if
+ *        any of its Stale alerts may be raised
+ * 
+ * @param alertChannel - Channel whose newest entry may have changed
+ */
+void ThingSpeakAlerts::ScheduleStale(ThingSpeakAlertChannel_t const & alertChannel)
+{
+    if (alertChannel.lastTimestamp <= 0)
+    {
+        return;
+    }
+
+    for (auto const & state : alertChannel.states)
+    {
+        ThingSpeakAlertRule_t const & rule = rules[state.rule];
+        if ((rule.kind == ThingSpeakAlertKind::Stale) && !state.active)
+        {
+            nextStaleTime = std::min(nextStaleTime, (alertChannel.lastTimestamp + rule.windowSeconds + 1));
+        }
+    }
+}
+
+/**
+ * @brief Check whether a channel's newest entry is older than a Stale
+ *        rule allows
+ * 
+ * @param alertChannel - Channel to check
+ * @param rule - Stale rule applying to the channel
+ * @param now - UTC epoch seconds
+ * 
+ * @return bool - True if the alert should be active. False whenever the
+ *                channel has no entry yet
+ */
+bool ThingSpeakAlerts::IsStale(ThingSpeakAlertChannel_t const & alertChannel, ThingSpeakAlertRule_t const & rule,
+                               int64_t now) const
+{
+    return ((alertChannel.lastTimestamp > 0) && (now > 0) &&
+            ((now - alertChannel.lastTimestamp) > rule.windowSeconds));
+}
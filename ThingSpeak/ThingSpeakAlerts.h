@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <filesystem>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+
+#include "ThingSpeak.h"
+
+using json = nlohmann::json;
+
+#define THINGSPEAK_ALERT_DEVIATION_MIN_VALUES   30   // Values needed before the running deviation is trusted
+
+enum class ThingSpeakAlertKind
+{
+    Above,          // Value rises above the threshold
+    Below,          // Value falls below the threshold
+    RateOfChange,   // Values vary by at least the threshold within the window
+    Deviation,      // Value lies more than threshold standard deviations from the running mean
+    Stale           // No entry captured within the window
+};
+
+typedef struct
+{
+    std::string name;
+    std::string channel;       // Empty to apply the rule to every channel
+    int field;                 // ThingSpeak field number. Unused by Stale
+    ThingSpeakAlertKind kind;
+    float threshold;
+    float hysteresis;          // Distance back past the threshold before the alert clears
+    int64_t windowSeconds;     // Window of RateOfChange, timeout of Stale
+} ThingSpeakAlertRule_t;
+
+typedef struct
+{
+    int rule;                  // Index into GetRules()
+    std::string channel;
+    std::string channelName;
+    std::string fieldName;     // Empty for Stale
+    bool raised;               // False if the alert cleared
+    float value;               // Field value which raised/cleared the alert, the change within the
+                               // window for RateOfChange. NaN for Stale
+    int64_t timestamp;         // UTC epoch seconds of that value, or of the check for Stale
+} ThingSpeakAlertEvent_t;
+
+typedef struct
+{
+    int64_t timestamp;
+    float value;
+} ThingSpeakAlertSample_t;
+
+typedef struct
+{
+    int rule;                  // Index into GetRules()
+    bool active;
+    int64_t raisedSample;      // Sample number (see ThingSpeakSeries::NumAppended()) which raised
+                               // the alert. -1 if not active or raised by Stale
+    float raisedValue;         // See ThingSpeakAlertEvent_t::value
+
+    // RateOfChange: candidates for the window's min/max, oldest first. Each
+    // value is pushed and popped at most once
+    std::deque<ThingSpeakAlertSample_t> windowMin;
+    std::deque<ThingSpeakAlertSample_t> windowMax;
+
+    // Deviation: Welford running mean and sum of squared differences
+    int64_t numValues;
+    double mean;
+    double m2;
+} ThingSpeakAlertState_t;
+
+typedef struct
+{
+    std::string name;            // Name of the object the channel was last evaluated for
+    uint64_t generation;         // Series generation the states were built from
+    int64_t numAppended;         // Samples of the series already evaluated
+    int64_t lastTimestamp;       // UTC epoch seconds of the newest entry. 0 if none
+    std::vector<ThingSpeakAlertState_t> states;   // One per rule applying to the channel
+} ThingSpeakAlertChannel_t;
+
+/**
+ * Threshold, rate-of-change, deviation and stale-channel alerts, evaluated
+ * as entries are ingested.
+ * 
+ * Update() is called after a channel's data is updated, and only evaluates
+ * the samples appended since the previous call, following the series'
+ * NumAppended() count as ThingSpeakSeriesRollup does. Every rule keeps
+ * running state rather than rescanning history: monotonic deques give the
+ * min/max of a time window and Welford's algorithm the running mean and
+ * variance, so a new sample costs amortized O(1) per applicable rule.
+ * The first Update() of a channel, or one after its series was cleared,
+ * replays the held samples without reporting each transition; alerts still
+ * active afterwards are reported once. Alerts clear once the value is back
+ * past the threshold by the rule's hysteresis, so a value hovering around
+ * the threshold does not raise the alert repeatedly:
+ * 
+ *     thingSpeak.SetFieldData(result);
+ *     alerts.Update(thingSpeak);
+ *     alerts.CheckStale(now);
+ *     if (alerts.Collect(events)) { ... }
+ * 
+ * Not thread-safe; owned by the render loop.
+ */
+class ThingSpeakAlerts
+{
+public:
+    bool LoadRules(std::filesystem::path const & filePath);
+    void SetRules(std::vector<ThingSpeakAlertRule_t> newRules);
+    std::vector<ThingSpeakAlertRule_t> const & GetRules() const;
+
+    void Update(ThingSpeak const & thingSpeak);
+    void CheckStale(int64_t now);
+    void Remove(std::string const & channel);
+    bool Collect(std::vector<ThingSpeakAlertEvent_t>& events);
+
+    ThingSpeakAlertChannel_t const * GetChannel(std::string const & channel) const;
+    int64_t NextStaleTime() const;
+    std::string Describe(ThingSpeakAlertEvent_t const & event) const;
+
+    static bool ParseRules(json const & rulesJson, std::vector<ThingSpeakAlertRule_t>& rules);
+
+private:
+    // Member Variables
+    std::vector<ThingSpeakAlertRule_t> rules;
+    std::unordered_map<std::string, ThingSpeakAlertChannel_t> channels;
+    std::vector<ThingSpeakAlertEvent_t> pending;    // Not yet collected
+    int64_t nextStaleTime = INT64_MAX;             // Earliest a Stale rule may raise
+    int64_t lastStaleCheck = 0;                    // Time of the last CheckStale(). 0 if none
+
+    // Member Functions
+    void Reset(ThingSpeakAlertChannel_t& alertChannel, std::string const & channel,
+               ThingSpeakSeries const & series);
+    void Evaluate(ThingSpeakAlertChannel_t& alertChannel, ThingSpeak const & thingSpeak,
+                  int64_t sampleNumber, int index, bool report);
+    void Report(std::string const & channel, ThingSpeakAlertChannel_t const & alertChannel,
+                ThingSpeakAlertState_t const & state, std::string const & fieldName,
+                float value, int64_t timestamp);
+    void ScheduleStale(ThingSpeakAlertChannel_t const & alertChannel);
+    bool IsStale(ThingSpeakAlertChannel_t const & alertChannel, ThingSpeakAlertRule_t const & rule,
+                 int64_t now) const;
+};
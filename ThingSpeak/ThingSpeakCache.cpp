@@ -0,0 +1,669 @@
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <iostream>
+#include <system_error>
+#include <atomic>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "ThingSpeakCache.h"
+
+#define DEBUG_THINGSPEAK_CACHE false
+
+/**
+ * @brief Unmap the cache file, flushing any pending writes
+ * 
+ */
+ThingSpeakCache::~ThingSpeakCache() { Close(); }
+
+/**
+ * @brief Map the cache file of a channel. With read/write access, the file
+ *        is created if it does not exist, and a file written with a different
+ *        layout or left mid-write is discarded. With read-only access, the file must already
+ *        have been initialized by its writer
+ * 
+ * @param directory - Directory holding the cache files
+ * @param channel - ThingSpeak API channel the cache belongs to
+ * @param access - Whether this process writes the file or only follows it
+ * 
+ * @return bool - True if the cache is ready to use
+ */
+bool ThingSpeakCache::Open(std::filesystem::path const & directory, std::string const & channel,
+                           ThingSpeakCacheAccess access)
+{
+    Close();
+
+    bool readOnly = (access == ThingSpeakCacheAccess::ReadOnly);
+
+    std::error_code error;
+    if (!readOnly)
+    {
+        std::filesystem::create_directories(directory, error);
+    }
+
+    std::filesystem::path path = GetPath(directory, channel);
+    capacity = THINGSPEAK_SERIES_CAPACITY;
+    viewSize = GetFileSize(capacity);
+
+    // A file being followed may not have been created or sized yet
+    if (readOnly)
+    {
+        uintmax_t fileSize = std::filesystem::file_size(path, error);
+        if (error || (fileSize < viewSize))
+        {
+            return false;
+        }
+    }
+
+    #ifdef _WIN32
+    // Readers share the file with its writer, though never with a second writer
+    HANDLE file = readOnly ? ::CreateFileW(path.c_str(), GENERIC_READ, (FILE_SHARE_READ | FILE_SHARE_WRITE),
+                                           nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr)
+                           : ::CreateFileW(path.c_str(), (GENERIC_READ | GENERIC_WRITE), FILE_SHARE_READ,
+                                           nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        std::cerr << "[ERROR] Couldn't open cache " << path.string() << std::endl;
+        return false;
+    }
+
+    // Mapping extends the file to the full size; new space reads as zero
+    ULARGE_INTEGER size;
+    size.QuadPart = viewSize;
+    HANDLE mapping = ::CreateFileMappingW(file, nullptr, (readOnly ? PAGE_READONLY : PAGE_READWRITE),
+                                          size.HighPart, size.LowPart, nullptr);
+    void* address = (mapping != nullptr) ? ::MapViewOfFile(mapping, (readOnly ? FILE_MAP_READ : FILE_MAP_ALL_ACCESS),
+                                                           0, 0, viewSize)
+                                         : nullptr;
+    if (address == nullptr)
+    {
+        std::cerr << "[ERROR] Couldn't map cache " << path.string() << std::endl;
+        if (mapping != nullptr)
+        {
+            ::CloseHandle(mapping);
+        }
+        ::CloseHandle(file);
+        return false;
+    }
+
+    fileHandle = file;
+    mappingHandle = mapping;
+    #else
+    int file = readOnly ? ::open(path.c_str(), O_RDONLY)
+                        : ::open(path.c_str(), (O_RDWR | O_CREAT), 0644);
+    if (file < 0)
+    {
+        std::cerr << "[ERROR] Couldn't open cache " << path.string() << std::endl;
+        return false;
+    }
+
+    // Readers follow the file alongside its writer, though never a second
+    // writer. The lock is held until Close(), and taken before the file is
+    // resized so a rejected writer never touches it
+    if (!readOnly && (::flock(file, (LOCK_EX | LOCK_NB)) != 0))
+    {
+        std::cerr << "[ERROR] Cache " << path.string() << " is already written by another process" << std::endl;
+        ::close(file);
+        return false;
+    }
+
+    if (!readOnly && (::ftruncate(file, static_cast<off_t>(viewSize)) != 0))
+    {
+        std::cerr << "[ERROR] Couldn't open cache " << path.string() << std::endl;
+        ::close(file);
+        return false;
+    }
+
+    void* address = ::mmap(nullptr, viewSize, (readOnly ? PROT_READ : (PROT_READ | PROT_WRITE)),
+                           MAP_SHARED, file, 0);
+    if (address == MAP_FAILED)
+    {
+        std::cerr << "[ERROR] Couldn't map cache " << path.string() << std::endl;
+        ::close(file);
+        return false;
+    }
+
+    if (readOnly)
+    {
+        ::close(file);
+    }
+    else
+    {
+        lockedFile = file;
+    }
+    #endif
+
+    view = static_cast<uint8_t*>(address);
+    cacheChannel = channel;
+    cacheAccess = access;
+
+    if (readOnly)
+    {
+        // Layout is only ever fixed by the writer
+        if (!ValidHeader())
+        {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    ThingSpeakCacheHeader_t* header = Header();
+    if (!ValidHeader())
+    {
+        #if (DEBUG_THINGSPEAK_CACHE)
+        std::cout << "Initializing cache " << path.string() << std::endl;
+        #endif
+
+        Reset();
+        header->sequence = 0;
+    }
+
+    // A previous writer stopped mid-write. Once wrapped, it may have
+    // overwritten published samples, and the header's last entry may lag
+    // the samples stored, so the cache is discarded and fetched again
+    if ((header->sequence & 1) != 0)
+    {
+        std::cerr << "[ERROR] Cache " << path.string() << " was left mid-write, discarding it" << std::endl;
+
+        Reset();
+        header->sequence++;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Unmap the cache file. Does nothing if not open
+ * 
+ */
+void ThingSpeakCache::Close()
+{
+    if (view == nullptr)
+    {
+        return;
+    }
+
+    #ifdef _WIN32
+    ::FlushViewOfFile(view, 0);
+    ::UnmapViewOfFile(view);
+    ::CloseHandle(static_cast<HANDLE>(mappingHandle));
+    ::CloseHandle(static_cast<HANDLE>(fileHandle));
+    #else
+    ::msync(view, viewSize, MS_ASYNC);
+    ::munmap(view, viewSize);
+
+    // Closing the descriptor releases the writer's lock
+    if (lockedFile >= 0)
+    {
+        ::close(lockedFile);
+        lockedFile = -1;
+    }
+    #endif
+
+    view = nullptr;
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+    cacheChannel.clear();
+}
+
+/**
+ * @brief Determines if the cache file is mapped
+ * 
+ * @return True if the cache can be loaded from and stored to
+ */
+bool ThingSpeakCache::IsOpen() const { return (view != nullptr); }
+
+/**
+ * @brief Determines if the cache file is followed rather than written
+ * 
+ * @return True if opened with read-only access
+ */
+bool ThingSpeakCache::IsReadOnly() const { return (cacheAccess == ThingSpeakCacheAccess::ReadOnly); }
+
+/**
+ * @brief Returns the API channel of the mapped cache file
+ * 
+ * @return std::string const & - ThingSpeak API channel. Empty if not open
+ */
+std::string const & ThingSpeakCache::GetChannel() const { return cacheChannel; }
+
+/**
+ * @brief Get the newest entry stored. Cheap enough to poll for new data
+ * 
+ * @return int64_t - Entry ID of the newest entry. 0 if empty or not open
+ */
+int64_t ThingSpeakCache::GetLastEntryId() const
+{
+    if (!IsOpen())
+    {
+        return 0;
+    }
+
+    return std::atomic_ref<int64_t>(Header()->lastEntryId).load(std::memory_order_acquire);
+}
+
+/**
+ * @brief Get the number of samples ever stored, e.g. to estimate how far a
+ *        run of Read() calls has progressed
+ * 
+ * @return int64_t - Sample number following the newest sample. 0 if empty
+ *                   or not open
+ */
+int64_t ThingSpeakCache::GetNumAppended() const
+{
+    if (!IsOpen())
+    {
+        return 0;
+    }
+
+    return std::atomic_ref<int64_t>(Header()->numAppended).load(std::memory_order_acquire);
+}
+
+/**
+ * @brief Read all cached samples, in the form returned by a fetch so they
+ *        can be applied with ThingSpeak::RestoreFieldData(). The copy is
+ *        retried if the writer modified the file while it was being read
+ * 
+ * @param result - Filled with the cached field data of the channel
+ * 
+ * @return bool - True if the cache held at least one entry
+ */
+bool ThingSpeakCache::Load(ThingSpeakFetchResult_t& result) const
+{
+    if (!IsOpen())
+    {
+        return false;
+    }
+
+    ThingSpeakCacheHeader_t const * header = Header();
+    std::atomic_ref<uint64_t> sequence(const_cast<uint64_t&>(header->sequence));
+
+    for (int attempt = 0; attempt < THINGSPEAK_CACHE_READ_ATTEMPTS; attempt++)
+    {
+        uint64_t startSequence = sequence.load(std::memory_order_acquire);
+        if (startSequence & 1)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        if (!ValidHeader() || (header->lastEntryId <= 0))
+        {
+            return false;
+        }
+
+        result.channel = cacheChannel;
+        result.validDataFetched = true;
+        result.notModified = false;
+        result.rangeQuery = false;
+        result.statusCode = 0;
+        result.retryAfterSeconds = 0;
+        result.requestSeconds = 0.0;
+        result.parseSeconds = 0.0;
+        result.bytesDownloaded = 0;
+        result.channelLastEntryId = header->lastEntryId;
+        result.lastEntry = {header->lastEntryId, header->lastCreatedAt};
+
+        result.feedData.series.Clear();
+        LoadFeedData(result.feedData);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == startSequence)
+        {
+            return true;
+        }
+    }
+
+    #if (DEBUG_THINGSPEAK_CACHE)
+    std::cout << "Cache " << cacheChannel << " is busy, skipping read" << std::endl;
+    #endif
+
+    return false;
+}
+
+/**
+ * @brief Read a run of consecutive cached samples, oldest first, without
+ *        copying the whole cache. The copy is retried if the writer modified
+ *        the file while it was being read
+ * 
+ * @param nextSample - Sample number (see ThingSpeakSeries::NumAppended()) of
+ *                     the first sample to read. Samples overwritten since are
+ *                     skipped. Advanced past the samples read
+ * @param maxSamples - Most samples to read
+ * @param chunk - Cleared and filled with the samples read and the field names
+ * 
+ * @return bool - True if read, including when no samples follow nextSample.
+ *                False if the cache is not open, not valid or busy
+ */
+bool ThingSpeakCache::Read(int64_t& nextSample, int maxSamples, ThingSpeakFeedData_t& chunk) const
+{
+    if (!IsOpen())
+    {
+        return false;
+    }
+
+    ThingSpeakCacheHeader_t const * header = Header();
+    std::atomic_ref<uint64_t> sequence(const_cast<uint64_t&>(header->sequence));
+
+    for (int attempt = 0; attempt < THINGSPEAK_CACHE_READ_ATTEMPTS; attempt++)
+    {
+        uint64_t startSequence = sequence.load(std::memory_order_acquire);
+        if (startSequence & 1)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        if (!ValidHeader())
+        {
+            return false;
+        }
+
+        int64_t numAppended = header->numAppended;
+        int64_t firstSample = std::clamp(nextSample, (numAppended - std::min<int64_t>(numAppended, capacity)),
+                                         numAppended);
+        int64_t endSample = std::min((firstSample + maxSamples), numAppended);
+
+        chunk.series.Clear();
+        LoadFeedData(chunk, firstSample, endSample);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == startSequence)
+        {
+            nextSample = endSample;
+            return true;
+        }
+    }
+
+    #if (DEBUG_THINGSPEAK_CACHE)
+    std::cout << "Cache " << cacheChannel << " is busy, skipping read" << std::endl;
+    #endif
+
+    return false;
+}
+
+/**
+ * @brief Append entries received since the last call to the cache file.
+ *        The cache is emptied first if the object's data was reset
+ * 
+ * @param thingSpeak - Object holding the latest data of the cached channel
+ */
+void ThingSpeakCache::Store(ThingSpeak const & thingSpeak)
+{
+    if (!IsOpen() || IsReadOnly() || (thingSpeak.GetChannel() != cacheChannel))
+    {
+        return;
+    }
+
+    ThingSpeakCacheHeader_t* header = Header();
+    ThingSpeakFeedCursor_t lastEntry = thingSpeak.GetLastEntry();
+    if (lastEntry.entryId == header->lastEntryId)
+    {
+        return;
+    }
+
+    uint64_t sequence = BeginWrite();
+
+    // Channel was cleared on ThingSpeak; entry IDs restarted
+    if (lastEntry.entryId < header->lastEntryId)
+    {
+        Reset();
+    }
+
+    StoreFeedData(*thingSpeak.GetFeedData(), header->lastEntryId);
+
+    header->lastCreatedAt = lastEntry.createdAt;
+    std::atomic_ref<int64_t>(header->lastEntryId).store(lastEntry.entryId, std::memory_order_release);
+
+    EndWrite(sequence);
+}
+
+/**
+ * @brief Create path of the cache file used for a channel
+ * 
+ * @param directory - Directory holding the cache files
+ * @param channel - ThingSpeak API channel
+ * 
+ * @return std::filesystem::path - Path of the channel's cache file
+ */
+std::filesystem::path ThingSpeakCache::GetPath(std::filesystem::path const & directory,
+                                               std::string const & channel)
+{
+    // Channel IDs are numeric, though anything unsafe in a file name is replaced
+    std::string fileName = channel;
+    std::replace_if(fileName.begin(), fileName.end(),
+                    [](unsigned char c) { return !std::isalnum(c); }, '_');
+
+    return directory / (fileName + THINGSPEAK_CACHE_FILE_EXTENSION);
+}
+
+/**
+ * @brief Get the header at the start of the mapping
+ * 
+ * @return ThingSpeakCacheHeader_t* - Cache file header
+ */
+ThingSpeakCacheHeader_t* ThingSpeakCache::Header() const
+{
+    return reinterpret_cast<ThingSpeakCacheHeader_t*>(view);
+}
+
+/**
+ * @brief Get the entry ID column
+ * 
+ * @return int64_t* - Column of capacity entries
+ */
+int64_t* ThingSpeakCache::EntryIds() const
+{
+    return reinterpret_cast<int64_t*>(view + sizeof(ThingSpeakCacheHeader_t));
+}
+
+/**
+ * @brief Get the timestamp column (UTC epoch seconds)
+ * 
+ * @return int64_t* - Column of capacity entries
+ */
+int64_t* ThingSpeakCache::Timestamps() const { return EntryIds() + capacity; }
+
+/**
+ * @brief Get the value column of a field
+ * 
+ * @param field - Field index. 0 is field1
+ * 
+ * @return float* - Column of capacity entries
+ */
+float* ThingSpeakCache::Values(int field) const
+{
+    return reinterpret_cast<float*>(Timestamps() + capacity) + (static_cast<size_t>(field) * capacity);
+}
+
+/**
+ * @brief Get the column recording which fields each sample provided
+ * 
+ * @return uint8_t* - Column of capacity entries. Bit N set if field (N + 1)
+ *                    was provided
+ */
+uint8_t* ThingSpeakCache::ValidFields() const
+{
+    return reinterpret_cast<uint8_t*>(Values(THINGSPEAK_CACHE_NUM_FIELDS));
+}
+
+/**
+ * @brief Determines if the mapped file has the layout of this build
+ * 
+ * @return True if the header matches. False otherwise
+ */
+bool ThingSpeakCache::ValidHeader() const
+{
+    ThingSpeakCacheHeader_t const * header = Header();
+
+    return ((header->magic == THINGSPEAK_CACHE_MAGIC) &&
+            (header->version == THINGSPEAK_CACHE_VERSION) &&
+            (header->capacity == capacity) &&
+            (header->numFields == THINGSPEAK_CACHE_NUM_FIELDS));
+}
+
+/**
+ * @brief Mark the file as being written, so readers retry overlapping copies
+ * 
+ * @return uint64_t - Sequence number to pass to EndWrite()
+ */
+uint64_t ThingSpeakCache::BeginWrite()
+{
+    std::atomic_ref<uint64_t> sequence(Header()->sequence);
+
+    uint64_t writeSequence = sequence.load(std::memory_order_relaxed) + 1;
+    sequence.store(writeSequence, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    return writeSequence;
+}
+
+/**
+ * @brief Mark the write started by BeginWrite() as complete
+ * 
+ * @param writeSequence - Value returned by BeginWrite()
+ */
+void ThingSpeakCache::EndWrite(uint64_t writeSequence)
+{
+    std::atomic_ref<uint64_t>(Header()->sequence).store((writeSequence + 1), std::memory_order_release);
+}
+
+/**
+ * @brief Discard all cached samples and write a fresh header. The sequence
+ *        number is kept so readers notice the change
+ * 
+ */
+void ThingSpeakCache::Reset()
+{
+    ThingSpeakCacheHeader_t* header = Header();
+    uint64_t sequence = header->sequence;
+
+    memset(header, 0, sizeof(ThingSpeakCacheHeader_t));
+    header->sequence = sequence;
+    header->magic = THINGSPEAK_CACHE_MAGIC;
+    header->version = THINGSPEAK_CACHE_VERSION;
+    header->capacity = capacity;
+    header->numFields = THINGSPEAK_CACHE_NUM_FIELDS;
+}
+
+/**
+ * @brief Copy the cached samples into feed data, oldest first
+ * 
+ * @param feedData - Feed data to fill
+ */
+void ThingSpeakCache::LoadFeedData(ThingSpeakFeedData_t& feedData) const
+{
+    int64_t numAppended = Header()->numAppended;
+
+    LoadFeedData(feedData, (numAppended - std::min<int64_t>(numAppended, capacity)), numAppended);
+}
+
+/**
+ * @brief Copy a run of cached samples into feed data, oldest first
+ * 
+ * @param feedData - Feed data to fill
+ * @param firstSample - Sample number of the first sample to copy. Must
+ *                      still be held
+ * @param endSample - One past the sample number of the last sample to copy
+ */
+void ThingSpeakCache::LoadFeedData(ThingSpeakFeedData_t& feedData, int64_t firstSample, int64_t endSample) const
+{
+    ThingSpeakCacheHeader_t const * header = Header();
+    int64_t const * entryIds = EntryIds();
+    int64_t const * timestamps = Timestamps();
+    uint8_t const * validFields = ValidFields();
+
+    for (int f = 0; f < THINGSPEAK_CACHE_NUM_FIELDS; f++)
+    {
+        char const * fieldName = header->fieldNames[f];
+        feedData.fieldNames[f].assign(fieldName, strnlen(fieldName, THINGSPEAK_CACHE_FIELD_NAME_SIZE));
+    }
+
+    float fields[THINGSPEAK_CACHE_NUM_FIELDS];
+    for (int64_t i = firstSample; i < endSample; i++)
+    {
+        int slot = static_cast<int>(i % capacity);
+        for (int f = 0; f < THINGSPEAK_CACHE_NUM_FIELDS; f++)
+        {
+            fields[f] = Values(f)[slot];
+        }
+
+        feedData.series.Append(entryIds[slot], timestamps[slot], fields, validFields[slot]);
+    }
+}
+
+/**
+ * @brief Append samples which are newer than those cached
+ * 
+ * @param feedData - Latest feed data of the channel, sorted by entry ID
+ * @param afterEntryId - Only samples with a greater entry ID are appended
+ */
+void ThingSpeakCache::StoreFeedData(ThingSpeakFeedData_t const & feedData, int64_t afterEntryId)
+{
+    ThingSpeakCacheHeader_t* header = Header();
+    ThingSpeakSeries const & series = feedData.series;
+
+    for (int f = 0; f < THINGSPEAK_CACHE_NUM_FIELDS; f++)
+    {
+        char* fieldName = header->fieldNames[f];
+        memset(fieldName, 0, THINGSPEAK_CACHE_FIELD_NAME_SIZE);
+        memcpy(fieldName, feedData.fieldNames[f].data(),
+               std::min<size_t>(feedData.fieldNames[f].size(), (THINGSPEAK_CACHE_FIELD_NAME_SIZE - 1)));
+    }
+
+    // New samples are at the end of the series
+    int first = series.Size();
+    while ((first > 0) && (series.EntryId(first - 1) > afterEntryId))
+    {
+        first--;
+    }
+
+    int64_t* entryIds = EntryIds();
+    int64_t* timestamps = Timestamps();
+    uint8_t* validFields = ValidFields();
+
+    int64_t numAppended = header->numAppended;
+    for (int i = first; i < series.Size(); i++)
+    {
+        int slot = static_cast<int>(numAppended % capacity);
+        entryIds[slot] = series.EntryId(i);
+        timestamps[slot] = series.Timestamp(i);
+        validFields[slot] = static_cast<uint8_t>(series.ValidFields(i));
+        for (int f = 0; f < THINGSPEAK_CACHE_NUM_FIELDS; f++)
+        {
+            Values(f)[slot] = series.Value((f + THINGSPEAK_LOWEST_FIELD_NUMBER), i);
+        }
+        numAppended++;
+    }
+
+    // Publish samples only once their columns are written
+    header->numAppended = numAppended;
+}
+
+/**
+ * @brief Size of a cache file holding a given number of samples
+ * 
+ * @param capacity - Samples held
+ * 
+ * @return size_t - File size in bytes
+ */
+size_t ThingSpeakCache::GetFileSize(int capacity)
+{
+    size_t sampleSize = sizeof(int64_t) + sizeof(int64_t) +
+                        (THINGSPEAK_CACHE_NUM_FIELDS * sizeof(float)) + sizeof(uint8_t);
+
+    return sizeof(ThingSpeakCacheHeader_t) + (static_cast<size_t>(capacity) * sampleSize);
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <filesystem>
+
+#include "ThingSpeak.h"
+
+#define THINGSPEAK_CACHE_MAGIC             0x48435354   // "TSCH"
+#define THINGSPEAK_CACHE_VERSION           3
+#define THINGSPEAK_CACHE_NUM_FIELDS        THINGSPEAK_NUM_FIELDS
+#define THINGSPEAK_CACHE_FIELD_NAME_SIZE   64
+#define THINGSPEAK_CACHE_FILE_EXTENSION    ".tscache"
+#define THINGSPEAK_CACHE_READ_ATTEMPTS     100          // Reads retried while a writer is active
+
+enum class ThingSpeakCacheAccess
+{
+    ReadWrite,     // Owner of the file, e.g. the process fetching the channel
+    ReadOnly       // Follows a file written by another process
+};
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    int32_t capacity;                 // Samples held before wrapping
+    int32_t numFields;
+    uint64_t sequence;                // Odd while a write is in progress
+
+    int64_t lastEntryId;              // Newest entry stored. 0 if empty
+    int64_t lastCreatedAt;            // UTC epoch seconds of that entry
+
+    int64_t numAppended;              // Total samples ever appended
+    char fieldNames[THINGSPEAK_CACHE_NUM_FIELDS][THINGSPEAK_CACHE_FIELD_NAME_SIZE];
+} ThingSpeakCacheHeader_t;
+
+/**
+ * Persistent on-disk copy of one channel's field data.
+ * 
+ * The file is memory-mapped and laid out like ThingSpeakSeries: a header
+ * followed by shared entry ID and timestamp columns, one value column per
+ * field, and a column recording which fields each sample provided. Samples
+ * are only ever appended: the columns are written first and the header's
+ * sample count is bumped last. Once the columns are full, the oldest
+ * samples are overwritten in place, matching ThingSpeakSeries, so a file
+ * left mid-write by a crashed writer is discarded when next opened for
+ * writing. Restoring at startup copies
+ * straight out of the mapping, with no parsing involved. Read() copies a
+ * bounded run of samples instead, e.g. to stream the cache to a file.
+ * 
+ * One process may write a file while others follow it read-only; opening
+ * a file another writer holds fails. Writes are bracketed by the header's
+ * sequence number, and readers retry a copy which overlapped a write.
+ */
+class ThingSpeakCache
+{
+public:
+    ThingSpeakCache() = default;
+    ~ThingSpeakCache();
+
+    ThingSpeakCache(ThingSpeakCache const &) = delete;
+    ThingSpeakCache& operator=(ThingSpeakCache const &) = delete;
+
+    bool Open(std::filesystem::path const & directory, std::string const & channel,
+              ThingSpeakCacheAccess access = ThingSpeakCacheAccess::ReadWrite);
+    void Close();
+    bool IsOpen() const;
+    bool IsReadOnly() const;
+    std::string const & GetChannel() const;
+    int64_t GetLastEntryId() const;
+    int64_t GetNumAppended() const;
+
+    bool Load(ThingSpeakFetchResult_t& result) const;
+    bool Read(int64_t& nextSample, int maxSamples, ThingSpeakFeedData_t& chunk) const;
+    void Store(ThingSpeak const & thingSpeak);
+
+    static std::filesystem::path GetPath(std::filesystem::path const & directory,
+                                         std::string const & channel);
+
+private:
+    // Member Variables
+    std::string cacheChannel;
+    int capacity = 0;
+    ThingSpeakCacheAccess cacheAccess = ThingSpeakCacheAccess::ReadWrite;
+
+    void* fileHandle = nullptr;       // Platform file/mapping handles
+    void* mappingHandle = nullptr;
+    int lockedFile = -1;              // POSIX writer's descriptor, holding its lock. -1 if none
+    uint8_t* view = nullptr;
+    size_t viewSize = 0;
+
+    // Member Functions
+    ThingSpeakCacheHeader_t* Header() const;
+    int64_t* EntryIds() const;
+    int64_t* Timestamps() const;
+    float* Values(int field) const;
+    uint8_t* ValidFields() const;
+    bool ValidHeader() const;
+    uint64_t BeginWrite();
+    void EndWrite(uint64_t sequence);
+    void Reset();
+    void LoadFeedData(ThingSpeakFeedData_t& feedData) const;
+    void LoadFeedData(ThingSpeakFeedData_t& feedData, int64_t firstSample, int64_t endSample) const;
+    void StoreFeedData(ThingSpeakFeedData_t const & feedData, int64_t afterEntryId);
+    static size_t GetFileSize(int capacity);
+};
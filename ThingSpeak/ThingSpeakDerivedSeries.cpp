@@ -0,0 +1,365 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "ThingSpeakDerivedSeries.h"
+
+// Magnus coefficients over water, valid from -45 to 60 degrees Celsius
+#define THINGSPEAK_DEW_POINT_B   17.62
+#define THINGSPEAK_DEW_POINT_C   243.12   // Degrees Celsius
+
+/**
+ * @brief Pointwise dew point of the default definitions
+ * 
+ * @param sources - Temperature (Fahrenheit) and relative humidity (%)
+ * 
+ * @return float - Dew point in Fahrenheit
+ */
+static float ThingSpeakDerivedDewPoint(float const * sources)
+{
+    return ThingSpeakDerivedSeries::GetDewPoint(sources[0], sources[1]);
+}
+
+/**
+ * @brief Pointwise heat index of the default definitions
+ * 
+ * @param sources - Temperature (Fahrenheit) and relative humidity (%)
+ * 
+ * @return float - Heat index in Fahrenheit
+ */
+static float ThingSpeakDerivedHeatIndex(float const * sources)
+{
+    return ThingSpeakDerivedSeries::GetHeatIndex(sources[0], sources[1]);
+}
+
+// Columns follow ThingSpeakDerivedField
+static ThingSpeakDerivedDefinition_t const thingSpeakDefaultDefinitions[] = {
+    {"Dew Point", "Dew Point (Fahrenheit)", ThingSpeakDerivedKind::Pointwise,
+     {static_cast<int>(ThingSpeakField::Temperature), static_cast<int>(ThingSpeakField::Humidity)},
+     ThingSpeakDerivedDewPoint, 0},
+    {"Heat Index", "Heat Index (Fahrenheit)", ThingSpeakDerivedKind::Pointwise,
+     {static_cast<int>(ThingSpeakField::Temperature), static_cast<int>(ThingSpeakField::Humidity)},
+     ThingSpeakDerivedHeatIndex, 0},
+    {"Temperature 1h Average", "Temperature (Fahrenheit)", ThingSpeakDerivedKind::MovingAverage,
+     {static_cast<int>(ThingSpeakField::Temperature), 0}, nullptr, 3600},
+    {"Temperature 24h Average", "Temperature (Fahrenheit)", ThingSpeakDerivedKind::MovingAverage,
+     {static_cast<int>(ThingSpeakField::Temperature), 0}, nullptr, 86400},
+    {"Humidity 1h Average", "Relative Humidity (%)", ThingSpeakDerivedKind::MovingAverage,
+     {static_cast<int>(ThingSpeakField::Humidity), 0}, nullptr, 3600},
+    {"Humidity 24h Average", "Relative Humidity (%)", ThingSpeakDerivedKind::MovingAverage,
+     {static_cast<int>(ThingSpeakField::Humidity), 0}, nullptr, 86400}
+};
+
+/**
+ * @brief Create derived series of the default definitions; see
+ *        GetDefaultDefinitions()
+ * 
+ */
+ThingSpeakDerivedSeries::ThingSpeakDerivedSeries() :
+    ThingSpeakDerivedSeries(GetDefaultDefinitions()) {}
+
+/**
+ * @brief Create derived series. Nothing is computed until Update()
+ * 
+ * @param definitions - Series to derive, stored in columns 1 onwards in
+ *                      order. Only the first THINGSPEAK_MAX_DERIVED_SERIES
+ *                      are used
+ */
+ThingSpeakDerivedSeries::ThingSpeakDerivedSeries(std::span<ThingSpeakDerivedDefinition_t const> definitions) :
+    definitions(definitions.begin(),
+                definitions.begin() + std::min<size_t>(definitions.size(), THINGSPEAK_MAX_DERIVED_SERIES)),
+    windows(this->definitions.size())
+{
+    for (size_t i = 0; i < this->definitions.size(); i++)
+    {
+        feedData.fieldNames[i] = this->definitions[i].name;
+    }
+}
+
+/**
+ * @brief Bring the derived series in line with their source. Only entries
+ *        above the watermark are derived, unless samples were removed from
+ *        the source other than by wrapping
+ * 
+ * @param source - Series holding the source fields
+ * 
+ * @return bool - True if the derived series changed
+ */
+bool ThingSpeakDerivedSeries::Update(ThingSpeakSeries const & source)
+{
+    if (source.Revision() == sourceRevision)
+    {
+        return false;
+    }
+    sourceRevision = source.Revision();
+
+    if ((source.Generation() != sourceGeneration) || (source.Capacity() != feedData.series.Capacity()))
+    {
+        Rebuild(source);
+        return true;
+    }
+
+    // Entry IDs increase with every sample, so new entries are at the end
+    int first = source.Size();
+    while ((first > 0) && (source.EntryId(first - 1) > watermark))
+    {
+        first--;
+    }
+
+    for (int i = first; i < source.Size(); i++)
+    {
+        Derive(source, i);
+    }
+
+    // Samples must stay aligned with the source, e.g. if entries arrived
+    // out of order
+    if (feedData.series.Size() != source.Size())
+    {
+        Rebuild(source);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Discard the derived samples, so the next Update() derives the
+ *        whole source again
+ * 
+ */
+void ThingSpeakDerivedSeries::Invalidate()
+{
+    sourceRevision = 0;
+    sourceGeneration = 0;
+    feedData.series.Clear();
+}
+
+/**
+ * @brief Get the derived series. Column N holds the series of definition
+ *        N - 1, e.g. ThingSpeakDerivedField values for the defaults
+ * 
+ * @return ThingSpeakFeedData_t const& - Derived series, named after their
+ *                                       definitions
+ */
+ThingSpeakFeedData_t const & ThingSpeakDerivedSeries::GetFeedData() const
+{
+    return feedData;
+}
+
+/**
+ * @brief Get the definition of a derived series
+ * 
+ * @param column - Column of the derived feed, from 1 to NumDerived()
+ * 
+ * @return ThingSpeakDerivedDefinition_t const& - Definition of the series
+ */
+ThingSpeakDerivedDefinition_t const & ThingSpeakDerivedSeries::GetDefinition(int column) const
+{
+    return definitions[column - THINGSPEAK_LOWEST_FIELD_NUMBER];
+}
+
+/**
+ * @brief Get number of series derived
+ * 
+ * @return int - Number of definitions
+ */
+int ThingSpeakDerivedSeries::NumDerived() const
+{
+    return static_cast<int>(definitions.size());
+}
+
+/**
+ * @brief Get the highest source entry ID derived so far
+ * 
+ * @return int64_t - Entry ID. 0 if none derived
+ */
+int64_t ThingSpeakDerivedSeries::Watermark() const
+{
+    return watermark;
+}
+
+/**
+ * @brief Get the series derived by default: dew point and heat index from
+ *        temperature (field1, Fahrenheit) and humidity (field2, %), and the
+ *        1 hour and 24 hour moving averages of both
+ * 
+ * @return std::span<ThingSpeakDerivedDefinition_t const> - Definitions, in
+ *                                                          ThingSpeakDerivedField order
+ */
+std::span<ThingSpeakDerivedDefinition_t const> ThingSpeakDerivedSeries::GetDefaultDefinitions()
+{
+    return thingSpeakDefaultDefinitions;
+}
+
+/**
+ * @brief Calculate the dew point using the Magnus formula
+ * 
+ * @param temperature - Air temperature in Fahrenheit
+ * @param humidity - Relative humidity in %
+ * 
+ * @return float - Dew point in Fahrenheit. NaN if the humidity is not
+ *                 above 0%
+ */
+float ThingSpeakDerivedSeries::GetDewPoint(float temperature, float humidity)
+{
+    if (!(humidity > 0.0f))
+    {
+        return std::numeric_limits<float>::quiet_NaN();
+    }
+
+    double celsius = (temperature - 32.0) * 5.0 / 9.0;
+    double gamma = std::log(std::min(humidity, 100.0f) / 100.0) +
+                   ((THINGSPEAK_DEW_POINT_B * celsius) / (THINGSPEAK_DEW_POINT_C + celsius));
+    double dewPoint = (THINGSPEAK_DEW_POINT_C * gamma) / (THINGSPEAK_DEW_POINT_B - gamma);
+
+    return static_cast<float>((dewPoint * 9.0 / 5.0) + 32.0);
+}
+
+/**
+ * @brief Calculate the heat index as the US National Weather Service does:
+ *        Steadman's simple formula, or the Rothfusz regression with its
+ *        humidity adjustments once the result reaches 80 Fahrenheit
+ * 
+ * @param temperature - Air temperature in Fahrenheit
+ * @param humidity - Relative humidity in %
+ * 
+ * @return float - Heat index in Fahrenheit
+ */
+float ThingSpeakDerivedSeries::GetHeatIndex(float temperature, float humidity)
+{
+    double t = temperature;
+    double rh = std::clamp(humidity, 0.0f, 100.0f);
+
+    double heatIndex = 0.5 * (t + 61.0 + ((t - 68.0) * 1.2) + (rh * 0.094));
+    if (((heatIndex + t) / 2.0) < 80.0)
+    {
+        return static_cast<float>(heatIndex);
+    }
+
+    heatIndex = -42.379 + (2.04901523 * t) + (10.14333127 * rh) - (0.22475541 * t * rh) -
+                (0.00683783 * t * t) - (0.05481717 * rh * rh) + (0.00122874 * t * t * rh) +
+                (0.00085282 * t * rh * rh) - (0.00000199 * t * t * rh * rh);
+
+    if ((rh < 13.0) && (t >= 80.0) && (t <= 112.0))
+    {
+        heatIndex -= ((13.0 - rh) / 4.0) * std::sqrt((17.0 - std::abs(t - 95.0)) / 17.0);
+    }
+    else if ((rh > 85.0) && (t >= 80.0) && (t <= 87.0))
+    {
+        heatIndex += ((rh - 85.0) / 10.0) * ((87.0 - t) / 5.0);
+    }
+
+    return static_cast<float>(heatIndex);
+}
+
+/**
+ * @brief Derive every sample of the source again
+ * 
+ * @param source - Series holding the source fields
+ */
+void ThingSpeakDerivedSeries::Rebuild(ThingSpeakSeries const & source)
+{
+    sourceGeneration = source.Generation();
+    watermark = 0;
+
+    feedData.series.Clear();
+    feedData.series.SetCapacity(source.Capacity());
+    for (ThingSpeakDerivedWindow_t& window : windows)
+    {
+        window.values.clear();
+        window.sum = 0.0;
+    }
+
+    for (int i = 0; i < source.Size(); i++)
+    {
+        Derive(source, i);
+    }
+}
+
+/**
+ * @brief Append the derived values of a source sample
+ * 
+ * @param source - Series holding the source fields
+ * @param index - Sample index of the source sample
+ */
+void ThingSpeakDerivedSeries::Derive(ThingSpeakSeries const & source, int index)
+{
+    float values[THINGSPEAK_MAX_DERIVED_SERIES];
+    uint32_t validFields = 0;
+    int64_t timestamp = source.Timestamp(index);
+
+    for (size_t i = 0; i < definitions.size(); i++)
+    {
+        ThingSpeakDerivedDefinition_t const & definition = definitions[i];
+        float value = std::numeric_limits<float>::quiet_NaN();
+
+        if (definition.kind == ThingSpeakDerivedKind::Pointwise)
+        {
+            float sources[THINGSPEAK_MAX_DERIVED_SOURCES] = {};
+            bool sourcesProvided = true;
+            for (int s = 0; s < THINGSPEAK_MAX_DERIVED_SOURCES; s++)
+            {
+                if (definition.sourceFields[s] != 0)
+                {
+                    sources[s] = source.Value(definition.sourceFields[s], index);
+                    sourcesProvided &= !std::isnan(sources[s]);
+                }
+            }
+
+            if (sourcesProvided)
+            {
+                value = definition.function(sources);
+            }
+        }
+        else
+        {
+            value = Average(windows[i], definition.windowSeconds, timestamp,
+                            source.Value(definition.sourceFields[0], index));
+        }
+
+        values[i] = value;
+        if (!std::isnan(value))
+        {
+            validFields |= (1u << i);
+        }
+    }
+
+    feedData.series.Append(source.EntryId(index), timestamp, values, validFields);
+    watermark = std::max(watermark, source.EntryId(index));
+}
+
+/**
+ * @brief Add a value to a moving average and drop values which fell out
+ *        of its window
+ * 
+ * @param window - Trailing values of the average
+ * @param windowSeconds - Length of the window
+ * @param timestamp - UTC epoch seconds of the value
+ * @param value - Value to add. NaN if the sample did not provide the field
+ * 
+ * @return float - Mean of the values captured within windowSeconds up to
+ *                 timestamp. NaN if none
+ */
+float ThingSpeakDerivedSeries::Average(ThingSpeakDerivedWindow_t& window, int64_t windowSeconds,
+                                       int64_t timestamp, float value)
+{
+    if (!std::isnan(value))
+    {
+        window.values.emplace_back(timestamp, value);
+        window.sum += value;
+    }
+
+    while (!window.values.empty() && (window.values.front().first <= (timestamp - windowSeconds)))
+    {
+        window.sum -= window.values.front().second;
+        window.values.pop_front();
+    }
+
+    if (window.values.empty())
+    {
+        // Also discards rounding errors accumulated by the running sum
+        window.sum = 0.0;
+        return std::numeric_limits<float>::quiet_NaN();
+    }
+
+    return static_cast<float>(window.sum / static_cast<double>(window.values.size()));
+}
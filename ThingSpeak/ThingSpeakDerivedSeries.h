@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <deque>
+#include <span>
+
+#include "ThingSpeak.h"
+
+#define THINGSPEAK_MAX_DERIVED_SOURCES   2                      // Source fields of a pointwise series
+#define THINGSPEAK_MAX_DERIVED_SERIES    THINGSPEAK_NUM_FIELDS  // One per column of the derived feed
+
+// Value is the column of the derived feed the default series is stored in.
+// See ThingSpeakDerivedSeries::GetDefaultDefinitions()
+enum class ThingSpeakDerivedField
+{
+    DewPoint = 1,
+    HeatIndex,
+    Temperature1h,
+    Temperature24h,
+    Humidity1h,
+    Humidity24h
+};
+
+enum class ThingSpeakDerivedKind
+{
+    Pointwise,        // Function of the source fields of the same entry
+    MovingAverage     // Mean of the source field over a trailing time window
+};
+
+// Value of a pointwise series. sources[i] holds the value of sourceFields[i],
+// never NaN. Returns NaN if the entry has no value
+typedef float (*ThingSpeakDerivedFunction)(float const * sources);
+
+typedef struct
+{
+    std::string name;
+    std::string axisLabel;
+    ThingSpeakDerivedKind kind;
+    int sourceFields[THINGSPEAK_MAX_DERIVED_SOURCES];   // ThingSpeak field numbers. 0 if unused
+    ThingSpeakDerivedFunction function;                 // Pointwise only
+    int64_t windowSeconds;                              // MovingAverage only
+} ThingSpeakDerivedDefinition_t;
+
+/**
+ * Series computed from the fields of a ThingSpeakSeries, e.g. dew point
+ * from temperature and humidity, cached as a feed of their own.
+ * 
+ * Each definition is stored in a column of GetFeedData(), numbered from 1
+ * in the order declared. The derived feed holds one sample per source
+ * sample, with the same entry ID, timestamp and capacity, so sample j of
+ * both refers to the same entry and the derived feed plots exactly like
+ * the fetched one. Entries without the source fields hold NaN.
+ * 
+ * Nothing is computed until the first Update(). After that, only entries
+ * above the entry ID watermark of the last update are derived, so calling
+ * it every frame is cheap. Removing source samples other than by wrapping,
+ * e.g. restoring a cache, derives the whole series again:
+ * 
+ *     derivedSeries.Update(thingSpeak.GetFeedData()->series);
+ *     ThingSpeakSeries const & dewPoint = derivedSeries.GetFeedData().series;
+ */
+class ThingSpeakDerivedSeries
+{
+public:
+    ThingSpeakDerivedSeries();
+    explicit ThingSpeakDerivedSeries(std::span<ThingSpeakDerivedDefinition_t const> definitions);
+
+    bool Update(ThingSpeakSeries const & source);
+    void Invalidate();
+
+    ThingSpeakFeedData_t const & GetFeedData() const;
+    ThingSpeakDerivedDefinition_t const & GetDefinition(int column) const;
+    int NumDerived() const;
+    int64_t Watermark() const;
+
+    static std::span<ThingSpeakDerivedDefinition_t const> GetDefaultDefinitions();
+    static float GetDewPoint(float temperature, float humidity);
+    static float GetHeatIndex(float temperature, float humidity);
+
+private:
+    // Trailing values of a moving average's source field
+    typedef struct
+    {
+        std::deque<std::pair<int64_t, float>> values;   // Timestamp and value, oldest first
+        double sum;
+    } ThingSpeakDerivedWindow_t;
+
+    // Member Variables
+    std::vector<ThingSpeakDerivedDefinition_t> definitions;
+    std::vector<ThingSpeakDerivedWindow_t> windows;   // windows[N - 1] follows column N
+
+    ThingSpeakFeedData_t feedData = {};
+    int64_t watermark = 0;                            // Highest source entry ID derived. 0 if none
+    uint64_t sourceRevision = 0;
+    uint64_t sourceGeneration = 0;
+
+    // Member Functions
+    void Rebuild(ThingSpeakSeries const & source);
+    void Derive(ThingSpeakSeries const & source, int index);
+    float Average(ThingSpeakDerivedWindow_t& window, int64_t windowSeconds, int64_t timestamp, float value);
+};
@@ -0,0 +1,566 @@
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "ThingSpeakExporter.h"
+#include "ThingSpeakCache.h"
+#include "ThingSpeakTime.h"
+
+#define THINGSPEAK_EXPORT_CSV_LINE_SIZE   256   // Longest CSV line of a sample, with every field
+
+typedef struct
+{
+    std::ofstream file;
+    ThingSpeakExportFormat format;
+    std::vector<int> fieldNumbers;                  // Fields written, in column order
+    std::vector<ThingSpeakExportBlock_t> blocks;    // Columnar: one per chunk written
+    std::vector<char> buffer;                       // Reused for every chunk
+} ThingSpeakExportFile_t;
+
+/**
+ * @brief Choose the fields to export: those named by the channel, else
+ *        those the first samples provided, else every field
+ * 
+ * @param feedData - First chunk of the channel
+ * 
+ * @return std::vector<int> - Field numbers, ascending
+ */
+static std::vector<int> ThingSpeakExportGetFields(ThingSpeakFeedData_t const & feedData)
+{
+    std::vector<int> fieldNumbers;
+
+    for (int n = THINGSPEAK_LOWEST_FIELD_NUMBER; n <= THINGSPEAK_HIGHEST_FIELD_NUMBER; n++)
+    {
+        if (!feedData.fieldNames[n - THINGSPEAK_LOWEST_FIELD_NUMBER].empty())
+        {
+            fieldNumbers.push_back(n);
+        }
+    }
+
+    for (int n = THINGSPEAK_LOWEST_FIELD_NUMBER; fieldNumbers.empty() && (n <= THINGSPEAK_HIGHEST_FIELD_NUMBER); n++)
+    {
+        if (feedData.series.HasField(n))
+        {
+            fieldNumbers.push_back(n);
+        }
+    }
+
+    for (int n = THINGSPEAK_LOWEST_FIELD_NUMBER; fieldNumbers.empty() && (n <= THINGSPEAK_HIGHEST_FIELD_NUMBER); n++)
+    {
+        fieldNumbers.push_back(n);
+    }
+
+    return fieldNumbers;
+}
+
+/**
+ * @brief Create an export file and write its header
+ * 
+ * @param exportFile - File to open
+ * @param format - Format of the file
+ * @param filePath - Path to write to
+ * @param channel - ThingSpeak channel ID
+ * @param feedData - First chunk of the channel, giving the fields exported
+ * 
+ * @return bool - True if the file was created
+ */
+static bool ThingSpeakExportOpen(ThingSpeakExportFile_t& exportFile, ThingSpeakExportFormat format,
+                                 std::filesystem::path const & filePath, std::string const & channel,
+                                 ThingSpeakFeedData_t const & feedData)
+{
+    exportFile.file.open(filePath, (std::ios::binary | std::ios::trunc));
+    if (!exportFile.file.is_open())
+    {
+        return false;
+    }
+
+    exportFile.format = format;
+    exportFile.fieldNumbers = ThingSpeakExportGetFields(feedData);
+    exportFile.blocks.clear();
+
+    if (format == ThingSpeakExportFormat::Csv)
+    {
+        std::string header = "created_at,entry_id";
+        for (int n : exportFile.fieldNumbers)
+        {
+            header += ",field" + std::to_string(n);
+        }
+        header += "\n";
+
+        exportFile.file.write(header.data(), header.size());
+    }
+    else
+    {
+        ThingSpeakExportHeader_t header = {};
+        header.magic = THINGSPEAK_EXPORT_MAGIC;
+        header.version = THINGSPEAK_EXPORT_VERSION;
+        memcpy(header.channel, channel.data(), std::min(channel.size(), (sizeof(header.channel) - 1)));
+        header.numFields = static_cast<int32_t>(exportFile.fieldNumbers.size());
+        for (int f = 0; f < header.numFields; f++)
+        {
+            int n = exportFile.fieldNumbers[f];
+            std::string const & fieldName = feedData.fieldNames[n - THINGSPEAK_LOWEST_FIELD_NUMBER];
+
+            header.fieldNumbers[f] = n;
+            memcpy(header.fieldNames[f], fieldName.data(), std::min(fieldName.size(), (sizeof(header.fieldNames[f]) - 1)));
+        }
+
+        exportFile.file.write(reinterpret_cast<char const *>(&header), sizeof(header));
+    }
+
+    return static_cast<bool>(exportFile.file);
+}
+
+/**
+ * @brief Append a run of samples to an export file
+ * 
+ * @param exportFile - File opened by ThingSpeakExportOpen()
+ * @param series - Samples of the current chunk
+ * @param begin - Index of the first sample to write
+ * @param end - One past the index of the last sample to write
+ * 
+ * @return int64_t - Number of samples written
+ */
+static int64_t ThingSpeakExportWrite(ThingSpeakExportFile_t& exportFile, ThingSpeakSeries const & series,
+                                     int begin, int end)
+{
+    if (begin >= end)
+    {
+        return 0;
+    }
+
+    size_t numSamples = static_cast<size_t>(end - begin);
+    std::vector<char>& buffer = exportFile.buffer;
+
+    if (exportFile.format == ThingSpeakExportFormat::Csv)
+    {
+        buffer.resize(numSamples * THINGSPEAK_EXPORT_CSV_LINE_SIZE);
+        char* out = buffer.data();
+
+        for (int i = begin; i < end; i++)
+        {
+            // Same layout as ThingSpeak's CSV download
+            ThingSpeakFormatDateTime(series.Timestamp(i), out);
+            out += (THINGSPEAK_DATE_TIME_BUFFER_SIZE - 1);
+            memcpy(out, " UTC,", 5);
+            out += 5;
+            out = std::to_chars(out, (out + 20), series.EntryId(i)).ptr;
+
+            for (int n : exportFile.fieldNumbers)
+            {
+                *out++ = ',';
+                float value = series.Value(n, i);
+                if (!std::isnan(value))
+                {
+                    out = std::to_chars(out, (out + 20), value).ptr;
+                }
+            }
+            *out++ = '\n';
+        }
+
+        exportFile.file.write(buffer.data(), (out - buffer.data()));
+    }
+    else
+    {
+        // Identifier columns are padded so the value columns stay aligned
+        size_t idSize = numSamples * ((2 * sizeof(int64_t)) + sizeof(uint8_t));
+        size_t padding = (8 - (idSize % 8)) % 8;
+        size_t blockSize = idSize + padding + (exportFile.fieldNumbers.size() * numSamples * sizeof(float));
+        buffer.assign(blockSize, 0);
+
+        int64_t* entryIds = reinterpret_cast<int64_t*>(buffer.data());
+        int64_t* timestamps = entryIds + numSamples;
+        uint8_t* validFields = reinterpret_cast<uint8_t*>(timestamps + numSamples);
+        float* values = reinterpret_cast<float*>(buffer.data() + idSize + padding);
+
+        for (size_t s = 0; s < numSamples; s++)
+        {
+            int i = begin + static_cast<int>(s);
+            entryIds[s] = series.EntryId(i);
+            timestamps[s] = series.Timestamp(i);
+            validFields[s] = static_cast<uint8_t>(series.ValidFields(i));
+        }
+        for (int n : exportFile.fieldNumbers)
+        {
+            for (size_t s = 0; s < numSamples; s++)
+            {
+                *values++ = series.Value(n, (begin + static_cast<int>(s)));
+            }
+        }
+
+        ThingSpeakExportBlock_t block = {};
+        block.offset = static_cast<int64_t>(exportFile.file.tellp());
+        block.firstTimestamp = series.Timestamp(begin);
+        block.lastTimestamp = series.Timestamp(end - 1);
+        block.numSamples = static_cast<int32_t>(numSamples);
+        exportFile.blocks.push_back(block);
+
+        exportFile.file.write(buffer.data(), blockSize);
+    }
+
+    return static_cast<int64_t>(numSamples);
+}
+
+/**
+ * @brief Finish an export file, writing the block index of columnar files
+ * 
+ * @param exportFile - File opened by ThingSpeakExportOpen()
+ * 
+ * @return bool - True if everything was written
+ */
+static bool ThingSpeakExportClose(ThingSpeakExportFile_t& exportFile)
+{
+    if (exportFile.format == ThingSpeakExportFormat::Columnar)
+    {
+        ThingSpeakExportTrailer_t trailer = {};
+        trailer.indexOffset = static_cast<int64_t>(exportFile.file.tellp());
+        trailer.numBlocks = static_cast<int32_t>(exportFile.blocks.size());
+        trailer.magic = THINGSPEAK_EXPORT_MAGIC;
+
+        exportFile.file.write(reinterpret_cast<char const *>(exportFile.blocks.data()),
+                              (exportFile.blocks.size() * sizeof(ThingSpeakExportBlock_t)));
+        exportFile.file.write(reinterpret_cast<char const *>(&trailer), sizeof(trailer));
+    }
+
+    exportFile.file.close();
+
+    return !exportFile.file.fail();
+}
+
+/**
+ * @brief Find the samples of a chunk lying inside the exported range
+ * 
+ * @param series - Samples of the chunk, ordered by time
+ * @param start - UTC epoch seconds, inclusive
+ * @param end - UTC epoch seconds, inclusive
+ * 
+ * @return std::pair<int, int> - First index and one past the last index
+ */
+static std::pair<int, int> ThingSpeakExportGetRange(ThingSpeakSeries const & series, int64_t start, int64_t end)
+{
+    int first = 0;
+    int last = series.Size();
+
+    while ((first < last) && (series.Timestamp(first) < start))
+    {
+        first++;
+    }
+    while ((last > first) && (series.Timestamp(last - 1) > end))
+    {
+        last--;
+    }
+
+    return {first, last};
+}
+
+/**
+ * @brief Start exporting in the background
+ * 
+ * @param request - Channels, range, source and format to export
+ * 
+ * @return bool - True if started. False if an export is still running
+ */
+bool ThingSpeakExporter::Start(ThingSpeakExportRequest_t request)
+{
+    if (Busy())
+    {
+        return false;
+    }
+
+    // The previous worker has finished, so joins straight away
+    worker = std::jthread();
+
+    {
+        std::lock_guard<std::mutex> lock(progressMutex);
+        progress = {true, static_cast<int>(request.channels.size()), 0, 0, 0.0f, ""};
+    }
+
+    worker = std::jthread([this](std::stop_token stopToken, ThingSpeakExportRequest_t request) {
+        Run(stopToken, std::move(request));
+    }, std::move(request));
+
+    return true;
+}
+
+/**
+ * @brief Stop the export after the chunk being written. Files not complete
+ *        are removed
+ * 
+ */
+void ThingSpeakExporter::Cancel() { worker.request_stop(); }
+
+/**
+ * @brief Determine if an export is running
+ * 
+ * @return bool - True until every file of the last export is written
+ */
+bool ThingSpeakExporter::Busy() const
+{
+    std::lock_guard<std::mutex> lock(progressMutex);
+
+    return progress.running;
+}
+
+/**
+ * @brief Get the progress of the running or last export
+ * 
+ * @return ThingSpeakExportProgress_t - Copy of the progress
+ */
+ThingSpeakExportProgress_t ThingSpeakExporter::GetProgress() const
+{
+    std::lock_guard<std::mutex> lock(progressMutex);
+
+    return progress;
+}
+
+/**
+ * @brief Get the path of a channel's export file
+ * 
+ * @param directory - Directory receiving the export
+ * @param channel - ThingSpeak channel ID
+ * @param format - Format of the file
+ * 
+ * @return std::filesystem::path - E.g. "<directory>/1277292.csv"
+ */
+std::filesystem::path ThingSpeakExporter::GetPath(std::filesystem::path const & directory, std::string const & channel,
+                                                  ThingSpeakExportFormat format)
+{
+    return directory / (channel + ((format == ThingSpeakExportFormat::Csv) ? THINGSPEAK_EXPORT_CSV_EXTENSION
+                                                                          : THINGSPEAK_EXPORT_COLUMNAR_EXTENSION));
+}
+
+/**
+ * @brief Worker thread body. Exports each channel in turn
+ * 
+ * @param stopToken - Signalled by Cancel() or destruction
+ * @param request - Export to perform
+ */
+void ThingSpeakExporter::Run(std::stop_token stopToken, ThingSpeakExportRequest_t request)
+{
+    std::error_code error;
+    std::filesystem::create_directories(request.outputDirectory, error);
+    samplesWritten = 0;
+
+    int numExported = 0;
+    std::string status;
+
+    for (size_t c = 0; (c < request.channels.size()) && !stopToken.stop_requested(); c++)
+    {
+        ThingSpeakExportChannel_t const & channel = request.channels[c];
+        std::filesystem::path filePath = GetPath(request.outputDirectory, channel.channel, request.format);
+        std::filesystem::path tempPath = filePath;
+        tempPath += ".tmp";
+
+        bool exported = (request.source == ThingSpeakExportSource::Cache)
+                        ? ExportCache(stopToken, request, channel, tempPath)
+                        : ExportThingSpeak(stopToken, request, channel, tempPath);
+
+        if (exported && !stopToken.stop_requested())
+        {
+            std::filesystem::rename(tempPath, filePath, error);
+            exported = !error;
+        }
+        if (!exported || stopToken.stop_requested())
+        {
+            std::filesystem::remove(tempPath, error);
+        }
+
+        if (exported)
+        {
+            numExported++;
+        }
+        else if (!stopToken.stop_requested())
+        {
+            status = "Could not export " + channel.name + " (" + channel.channel + ")";
+            std::cerr << "[ERROR] " << status << std::endl;
+        }
+
+        ReportProgress(static_cast<int>(c + 1), 0.0f);
+    }
+
+    std::lock_guard<std::mutex> lock(progressMutex);
+    progress.running = false;
+    if (stopToken.stop_requested())
+    {
+        progress.status = "Export cancelled";
+    }
+    else if (status.empty())
+    {
+        progress.fraction = 1.0f;
+        progress.status = "Exported " + std::to_string(numExported) + " channels to " +
+                          request.outputDirectory.string();
+    }
+    else
+    {
+        progress.status = status;
+    }
+}
+
+/**
+ * @brief Export the samples a channel's on-disk cache holds within the range
+ * 
+ * @param stopToken - Signalled if the export is cancelled
+ * @param request - Export being performed
+ * @param channel - Channel to export
+ * @param filePath - File to write
+ * 
+ * @return bool - True if the file was written, holding no samples if the
+ *                channel has no cache yet
+ */
+bool ThingSpeakExporter::ExportCache(std::stop_token const & stopToken, ThingSpeakExportRequest_t const & request,
+                                     ThingSpeakExportChannel_t const & channel, std::filesystem::path const & filePath)
+{
+    ThingSpeakFeedData_t chunk = {{}, ThingSpeakSeries(THINGSPEAK_EXPORT_CHUNK_SIZE)};
+    ThingSpeakExportFile_t exportFile = {};
+
+    // Nothing was cached for the channel yet, so nothing is in range
+    if (!std::filesystem::exists(ThingSpeakCache::GetPath(request.cacheDirectory, channel.channel)))
+    {
+        return (ThingSpeakExportOpen(exportFile, request.format, filePath, channel.channel, chunk) &&
+                ThingSpeakExportClose(exportFile));
+    }
+
+    // Another process may be writing the cache; samples are copied out of
+    // the mapping one chunk at a time
+    ThingSpeakCache cache;
+    if (!cache.Open(request.cacheDirectory, channel.channel, ThingSpeakCacheAccess::ReadOnly))
+    {
+        return false;
+    }
+
+    int64_t nextSample = 0;
+    if (!cache.Read(nextSample, THINGSPEAK_EXPORT_CHUNK_SIZE, chunk) ||
+        !ThingSpeakExportOpen(exportFile, request.format, filePath, channel.channel, chunk))
+    {
+        return false;
+    }
+
+    // Numbered from the first sample held, as older samples were skipped.
+    // Samples stored meanwhile are exported too, capping the fraction at 1
+    int64_t firstSample = nextSample - chunk.series.Size();
+    int64_t endSample = std::max(cache.GetNumAppended(), nextSample);
+
+    while ((chunk.series.Size() > 0) && !stopToken.stop_requested())
+    {
+        std::pair<int, int> range = ThingSpeakExportGetRange(chunk.series, request.start, request.end);
+        samplesWritten += ThingSpeakExportWrite(exportFile, chunk.series, range.first, range.second);
+
+        // Samples are ordered by time, so none of the remaining ones is in range
+        if (range.second < chunk.series.Size())
+        {
+            break;
+        }
+
+        float channelFraction = static_cast<float>(nextSample - firstSample) / (endSample - firstSample);
+        ReportProgress(-1, std::min(channelFraction, 1.0f));
+
+        if (!cache.Read(nextSample, THINGSPEAK_EXPORT_CHUNK_SIZE, chunk))
+        {
+            exportFile.file.close();
+            return false;
+        }
+    }
+
+    return ThingSpeakExportClose(exportFile);
+}
+
+/**
+ * @brief Export the raw entries ThingSpeak holds for a channel within the
+ *        range. The range is requested in windows, each halved while its
+ *        response holds as many entries as a request may return
+ * 
+ * @param stopToken - Signalled if the export is cancelled
+ * @param request - Export being performed
+ * @param channel - Channel to export
+ * @param filePath - File to write
+ * 
+ * @return bool - True if the file was written
+ */
+bool ThingSpeakExporter::ExportThingSpeak(std::stop_token const & stopToken, ThingSpeakExportRequest_t const & request,
+                                          ThingSpeakExportChannel_t const & channel,
+                                          std::filesystem::path const & filePath)
+{
+    ThingSpeak thingSpeak(channel.name, channel.channel, channel.key);
+    ThingSpeakExportFile_t exportFile = {};
+    bool opened = false;
+
+    int64_t windowStart = request.start;
+    int64_t windowSpan = THINGSPEAK_EXPORT_WINDOW_S;
+
+    while ((windowStart <= request.end) && !stopToken.stop_requested())
+    {
+        int64_t windowEnd = std::min((windowStart + windowSpan - 1), request.end);
+        ThingSpeakFetchResult_t result = thingSpeak.Fetch(windowStart, windowEnd, THINGSPEAK_RANGE_RAW);
+        if (!result.validDataFetched)
+        {
+            break;
+        }
+
+        // A full response may be missing entries of the window
+        ThingSpeakSeries const & series = result.feedData.series;
+        if ((series.Size() >= MAX_THINGSPEAK_REQUEST_SIZE) && (windowSpan > THINGSPEAK_EXPORT_MIN_WINDOW_S))
+        {
+            windowSpan = std::max<int64_t>((windowSpan / 2), THINGSPEAK_EXPORT_MIN_WINDOW_S);
+            continue;
+        }
+
+        if (!opened)
+        {
+            opened = ThingSpeakExportOpen(exportFile, request.format, filePath, channel.channel, result.feedData);
+            if (!opened)
+            {
+                break;
+            }
+        }
+
+        std::pair<int, int> range = ThingSpeakExportGetRange(series, windowStart, windowEnd);
+        samplesWritten += ThingSpeakExportWrite(exportFile, series, range.first, range.second);
+
+        float channelFraction = static_cast<float>(windowEnd - request.start + 1) /
+                                static_cast<float>(request.end - request.start + 1);
+        ReportProgress(-1, channelFraction);
+
+        // Sparse windows grow back towards the initial span
+        windowStart = windowEnd + 1;
+        if (series.Size() < (MAX_THINGSPEAK_REQUEST_SIZE / 4))
+        {
+            windowSpan = std::min<int64_t>((windowSpan * 2), THINGSPEAK_EXPORT_WINDOW_S);
+        }
+    }
+
+    if (!opened)
+    {
+        return false;
+    }
+    if (windowStart <= request.end)
+    {
+        exportFile.file.close();
+        return false;
+    }
+
+    return ThingSpeakExportClose(exportFile);
+}
+
+/**
+ * @brief Publish the progress of the export. Called by the worker only
+ * 
+ * @param channelsDone - Channels finished. -1 to keep the current count
+ * @param channelFraction - Estimated share of the current channel done
+ */
+void ThingSpeakExporter::ReportProgress(int channelsDone, float channelFraction)
+{
+    std::lock_guard<std::mutex> lock(progressMutex);
+
+    if (channelsDone >= 0)
+    {
+        progress.channelsDone = channelsDone;
+    }
+
+    progress.samplesWritten = samplesWritten;
+    progress.fraction = (progress.numChannels > 0)
+                        ? ((progress.channelsDone + channelFraction) / progress.numChannels)
+                        : 1.0f;
+}
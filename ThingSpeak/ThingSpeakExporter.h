@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+
+#include "ThingSpeak.h"
+
+#define THINGSPEAK_EXPORT_MAGIC                0x58455354   // "TSEX"
+#define THINGSPEAK_EXPORT_VERSION              1
+#define THINGSPEAK_EXPORT_CHUNK_SIZE           4096         // Samples read from a cache and written at once
+#define THINGSPEAK_EXPORT_WINDOW_S             86400        // Span first requested from ThingSpeak
+#define THINGSPEAK_EXPORT_MIN_WINDOW_S         60           // Full responses are not split below this span
+#define THINGSPEAK_EXPORT_CSV_EXTENSION        ".csv"
+#define THINGSPEAK_EXPORT_COLUMNAR_EXTENSION   ".tsexport"
+
+enum class ThingSpeakExportFormat
+{
+    Csv,           // ThingSpeak's own CSV layout: created_at, entry_id, then each field
+    Columnar       // Blocks of binary columns, see ThingSpeakExportHeader_t
+};
+
+enum class ThingSpeakExportSource
+{
+    Cache,         // On-disk caches, holding the latest THINGSPEAK_SERIES_CAPACITY entries
+    ThingSpeak     // Raw entries requested from ThingSpeak, for ranges beyond the caches
+};
+
+typedef struct
+{
+    std::string name;
+    std::string channel;
+    std::string key;
+} ThingSpeakExportChannel_t;
+
+typedef struct
+{
+    std::vector<ThingSpeakExportChannel_t> channels;
+    ThingSpeakExportSource source;
+    ThingSpeakExportFormat format;
+    int64_t start;                            // UTC epoch seconds, inclusive
+    int64_t end;                              // UTC epoch seconds, inclusive
+    std::filesystem::path cacheDirectory;     // Caches read for ThingSpeakExportSource::Cache
+    std::filesystem::path outputDirectory;    // Receives one file per channel, named after it
+} ThingSpeakExportRequest_t;
+
+typedef struct
+{
+    bool running;
+    int numChannels;
+    int channelsDone;
+    int64_t samplesWritten;
+    float fraction;           // Estimated share of the export done, 0 to 1
+    std::string status;       // Last error, or a summary once finished. Empty while running
+} ThingSpeakExportProgress_t;
+
+// Columnar files hold a header, then blocks of up to one chunk of samples,
+// then an index of the blocks and a trailer locating it. Each block holds
+// numSamples entry IDs (int64), timestamps (int64) and provided-field
+// bitmaps (uint8), padded to 8 bytes, then numSamples floats per field in
+// fieldNumbers. Fields a sample did not provide hold NaN
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    char channel[32];
+    int32_t numFields;
+    int32_t fieldNumbers[THINGSPEAK_NUM_FIELDS];   // Columns of each block. First numFields used
+    char fieldNames[THINGSPEAK_NUM_FIELDS][64];    // Names the channel assigned to them
+} ThingSpeakExportHeader_t;
+
+typedef struct
+{
+    int64_t offset;           // Position of the block within the file
+    int64_t firstTimestamp;   // UTC epoch seconds of the block's first sample
+    int64_t lastTimestamp;
+    int32_t numSamples;
+    int32_t reserved;
+} ThingSpeakExportBlock_t;
+
+typedef struct
+{
+    int64_t indexOffset;      // Position of numBlocks ThingSpeakExportBlock_t
+    int32_t numBlocks;
+    uint32_t magic;
+} ThingSpeakExportTrailer_t;
+
+/**
+ * Exports the history of channels to files on a worker thread.
+ * 
+ * Samples are streamed in chunks of bounded size: from the on-disk caches
+ * THINGSPEAK_EXPORT_CHUNK_SIZE samples at a time, or from ThingSpeak one
+ * response at a time, walking the range in windows which are halved while
+ * a response is full. Each chunk is formatted into a reused buffer and
+ * written before the next is read, so memory use does not depend on the
+ * length of the range. Files are written next to their final name and
+ * renamed once complete, so a cancelled export leaves no partial file:
+ * 
+ *     exporter.Start(request);
+ *     ThingSpeakExportProgress_t progress = exporter.GetProgress();
+ *     ImGui::ProgressBar(progress.fraction);
+ * 
+ * Progress may be polled from any thread.
+ */
+class ThingSpeakExporter
+{
+public:
+    bool Start(ThingSpeakExportRequest_t request);
+    void Cancel();
+    bool Busy() const;
+    ThingSpeakExportProgress_t GetProgress() const;
+
+    static std::filesystem::path GetPath(std::filesystem::path const & directory, std::string const & channel,
+                                         ThingSpeakExportFormat format);
+
+private:
+    // Member Variables
+    mutable std::mutex progressMutex;
+    ThingSpeakExportProgress_t progress = {};
+    int64_t samplesWritten = 0;   // Only touched by the worker
+
+    std::jthread worker;     // Declared last, so it is joined before the progress is destroyed
+
+    // Member Functions
+    void Run(std::stop_token stopToken, ThingSpeakExportRequest_t request);
+    bool ExportCache(std::stop_token const & stopToken, ThingSpeakExportRequest_t const & request,
+                     ThingSpeakExportChannel_t const & channel, std::filesystem::path const & filePath);
+    bool ExportThingSpeak(std::stop_token const & stopToken, ThingSpeakExportRequest_t const & request,
+                          ThingSpeakExportChannel_t const & channel, std::filesystem::path const & filePath);
+    void ReportProgress(int channelsDone, float channelFraction);
+};
@@ -0,0 +1,295 @@
+#include <charconv>
+#include <iostream>
+
+#include "ThingSpeakFeedParser.h"
+#include "ThingSpeakTime.h"
+
+#define DEBUG_THINGSPEAK_FEED_PARSER false
+
+/**
+ * @brief Create a parser
+ * 
+ * @param onEntry - Called with every complete feed entry, in response order
+ * @param numberEntries - Number entries which have no entry ID rather than
+ *                        dropping them, e.g. for aggregated feeds
+ */
+ThingSpeakFeedParser::ThingSpeakFeedParser(EntryCallback onEntry, bool numberEntries) :
+    onEntry(std::move(onEntry)), numberEntries(numberEntries), numEntries(0), depth(0), section(Section::None), pendingSection(Section::None),
+    currentKey(Key::Other), currentField(0), validEntry(false), lastEntryId(0), entry{} {}
+
+/**
+ * @brief Parse a complete feeds.json response
+ * 
+ * @param text - Response body
+ * 
+ * @return bool - True if the response was a valid ThingSpeak JSON object
+ */
+bool ThingSpeakFeedParser::Parse(std::string_view text)
+{
+    return json::sax_parse(text.begin(), text.end(), this);
+}
+
+/**
+ * @brief Latest entry ID the channel reported
+ * 
+ * @return int64_t - Entry ID. 0 if the channel holds no entries
+ */
+int64_t ThingSpeakFeedParser::GetLastEntryId() const { return lastEntryId; }
+
+/**
+ * @brief Name the channel assigned to a field
+ * 
+ * @param fieldNumber - ThingSpeak field number [1, 8]
+ * 
+ * @return std::string const & - Field name. Empty if the field is unused
+ */
+std::string const & ThingSpeakFeedParser::GetFieldName(int fieldNumber) const
+{
+    return fieldNames[fieldNumber - THINGSPEAK_LOWEST_FIELD_NUMBER];
+}
+
+/* nlohmann::json SAX Interface */
+bool ThingSpeakFeedParser::null()
+{
+    // A null field is treated the same as a missing field
+    return (depth > 0);
+}
+
+bool ThingSpeakFeedParser::boolean(bool)
+{
+    return (depth > 0);
+}
+
+bool ThingSpeakFeedParser::number_integer(json::number_integer_t value)
+{
+    return Integer(value);
+}
+
+bool ThingSpeakFeedParser::number_unsigned(json::number_unsigned_t value)
+{
+    return Integer(static_cast<int64_t>(value));
+}
+
+bool ThingSpeakFeedParser::number_float(json::number_float_t value, json::string_t const &)
+{
+    if (InFeed() && (currentKey == Key::Field))
+    {
+        entry.fields[currentField] = static_cast<float>(value);
+        entry.validFields |= (1u << currentField);
+    }
+
+    return (depth > 0);
+}
+
+bool ThingSpeakFeedParser::string(json::string_t& value)
+{
+    if (InChannel() && (currentKey == Key::Field))
+    {
+        fieldNames[currentField] = value;
+    }
+    else if (InFeed() && (currentKey == Key::CreatedAt))
+    {
+        validEntry = ThingSpeakParseDateTime(value, entry.createdAt);
+    }
+    else if (InFeed() && (currentKey == Key::Field))
+    {
+        // ThingSpeak sends field values as strings (e.g. "72.5")
+        char const * first = value.data();
+        char const * last = value.data() + value.size();
+        while ((first != last) && (*first == ' '))
+        {
+            first++;
+        }
+
+        float fieldValue;
+        std::from_chars_result parsed = std::from_chars(first, last, fieldValue);
+        if (parsed.ec == std::errc())
+        {
+            entry.fields[currentField] = fieldValue;
+            entry.validFields |= (1u << currentField);
+        }
+        #if (DEBUG_THINGSPEAK_FEED_PARSER)
+        else
+        {
+            std::cout << "Ignoring non-numeric field value: " << value << std::endl;
+        }
+        #endif
+    }
+
+    return (depth > 0);
+}
+
+bool ThingSpeakFeedParser::binary(json::binary_t&)
+{
+    return (depth > 0);
+}
+
+bool ThingSpeakFeedParser::start_object(std::size_t)
+{
+    depth++;
+
+    if ((depth == 2) && (pendingSection == Section::Channel))
+    {
+        section = Section::Channel;
+    }
+    else if ((depth == 3) && (section == Section::Feeds))
+    {
+        entry = {};
+        validEntry = false;
+    }
+
+    currentKey = Key::Other;
+
+    return true;
+}
+
+bool ThingSpeakFeedParser::key(json::string_t& value)
+{
+    currentKey = Key::Other;
+
+    if (depth == 1)
+    {
+        if (value == "channel")
+        {
+            pendingSection = Section::Channel;
+        }
+        else if (value == "feeds")
+        {
+            pendingSection = Section::Feeds;
+        }
+        else
+        {
+            pendingSection = Section::None;
+        }
+    }
+    else if (InChannel() || InFeed())
+    {
+        // Field keys are "field1" through "field8"
+        bool fieldKey = ((value.size() == 6) && (value.compare(0, 5, "field") == 0) &&
+                         (value[5] >= ('0' + THINGSPEAK_LOWEST_FIELD_NUMBER)) &&
+                         (value[5] <= ('0' + THINGSPEAK_HIGHEST_FIELD_NUMBER)));
+        if (fieldKey)
+        {
+            currentKey = Key::Field;
+            currentField = value[5] - '0' - THINGSPEAK_LOWEST_FIELD_NUMBER;
+        }
+        else if (InFeed() && (value == "entry_id"))
+        {
+            currentKey = Key::EntryId;
+        }
+        else if (InFeed() && (value == "created_at"))
+        {
+            currentKey = Key::CreatedAt;
+        }
+        else if (InChannel() && (value == "last_entry_id"))
+        {
+            currentKey = Key::LastEntryId;
+        }
+    }
+
+    return true;
+}
+
+bool ThingSpeakFeedParser::end_object()
+{
+    if (InFeed() && validEntry && numberEntries && (entry.entryId <= 0))
+    {
+        entry.entryId = numEntries + 1;
+    }
+
+    if (InFeed() && validEntry && (entry.entryId > 0))
+    {
+        numEntries++;
+        onEntry(entry);
+    }
+    else if (InChannel())
+    {
+        section = Section::None;
+    }
+
+    depth--;
+    currentKey = Key::Other;
+
+    return true;
+}
+
+bool ThingSpeakFeedParser::start_array(std::size_t)
+{
+    depth++;
+
+    if ((depth == 2) && (pendingSection == Section::Feeds))
+    {
+        section = Section::Feeds;
+    }
+
+    // Top level must be an object. ThingSpeak replies "-1" or "[]" on errors
+    return (depth > 1);
+}
+
+bool ThingSpeakFeedParser::end_array()
+{
+    if ((depth == 2) && (section == Section::Feeds))
+    {
+        section = Section::None;
+    }
+
+    depth--;
+    currentKey = Key::Other;
+
+    return true;
+}
+
+bool ThingSpeakFeedParser::parse_error(std::size_t position, std::string const &,
+                                       nlohmann::detail::exception const & error)
+{
+    std::cerr << "[ERROR] Malformed ThingSpeak response at byte " << position << ".\n"
+              << "        " << error.what() << std::endl;
+
+    return false;
+}
+
+/**
+ * @brief Route an integer value to the entry or channel being parsed
+ * 
+ * @param value - Integer value of current key
+ * 
+ * @return bool - False if the value is not contained in the top level object
+ */
+bool ThingSpeakFeedParser::Integer(int64_t value)
+{
+    if (InFeed() && (currentKey == Key::EntryId))
+    {
+        entry.entryId = value;
+    }
+    else if (InFeed() && (currentKey == Key::Field))
+    {
+        entry.fields[currentField] = static_cast<float>(value);
+        entry.validFields |= (1u << currentField);
+    }
+    else if (InChannel() && (currentKey == Key::LastEntryId))
+    {
+        lastEntryId = value;
+    }
+
+    return (depth > 0);
+}
+
+/**
+ * @brief Determine if values being parsed belong to the channel object
+ * 
+ * @return bool - True if directly inside "channel"
+ */
+bool ThingSpeakFeedParser::InChannel() const
+{
+    return ((section == Section::Channel) && (depth == 2));
+}
+
+/**
+ * @brief Determine if values being parsed belong to a feed entry
+ * 
+ * @return bool - True if directly inside an element of "feeds"
+ */
+bool ThingSpeakFeedParser::InFeed() const
+{
+    return ((section == Section::Feeds) && (depth == 3));
+}
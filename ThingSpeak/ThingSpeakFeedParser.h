@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <functional>
+#include <nlohmann/json.hpp>
+
+#include "ThingSpeakSeries.h"
+
+typedef struct
+{
+    int64_t entryId;
+    int64_t createdAt;                      // UTC epoch seconds
+    uint32_t validFields;                   // Bit (N - 1) set if fieldN was provided
+    float fields[THINGSPEAK_NUM_FIELDS];    // fields[N - 1] holds value of fieldN
+} ThingSpeakFeedEntry_t;
+
+/**
+ * Streaming parser for ThingSpeak feeds.json responses.
+ * 
+ * Implements the nlohmann::json SAX interface so a response is decoded in a
+ * single pass without building a JSON document. Channel information is
+ * stored in the parser, while every feed entry is handed to the provided
+ * callback as soon as its closing brace is reached.
+ * 
+ * Feeds aggregated by ThingSpeak (average, median, timescale) carry no
+ * entry IDs. Parsers created with numberEntries number such entries 1, 2,
+ * 3, ... in response order instead of dropping them.
+ */
+class ThingSpeakFeedParser
+{
+public:
+    using json = nlohmann::json;
+    using EntryCallback = std::function<void(ThingSpeakFeedEntry_t const &)>;
+
+    explicit ThingSpeakFeedParser(EntryCallback onEntry, bool numberEntries = false);
+
+    bool Parse(std::string_view text);
+
+    int64_t GetLastEntryId() const;
+    std::string const & GetFieldName(int fieldNumber) const;
+
+    // nlohmann::json SAX interface
+    bool null();
+    bool boolean(bool value);
+    bool number_integer(json::number_integer_t value);
+    bool number_unsigned(json::number_unsigned_t value);
+    bool number_float(json::number_float_t value, json::string_t const & text);
+    bool string(json::string_t& value);
+    bool binary(json::binary_t& value);
+    bool start_object(std::size_t numElements);
+    bool key(json::string_t& value);
+    bool end_object();
+    bool start_array(std::size_t numElements);
+    bool end_array();
+    bool parse_error(std::size_t position, std::string const & lastToken,
+                     nlohmann::detail::exception const & error);
+
+private:
+    enum class Section
+    {
+        None,
+        Channel,
+        Feeds
+    };
+
+    enum class Key
+    {
+        Other,
+        EntryId,
+        CreatedAt,
+        LastEntryId,
+        Field
+    };
+
+    // Member Variables
+    EntryCallback onEntry;
+    bool numberEntries;     // Assign entry IDs to entries without one
+    int64_t numEntries;
+
+    int depth;
+    Section section;
+    Section pendingSection;
+    Key currentKey;
+    int currentField;
+    bool validEntry;
+
+    int64_t lastEntryId;
+    std::string fieldNames[THINGSPEAK_NUM_FIELDS];
+    ThingSpeakFeedEntry_t entry;
+
+    // Member Functions
+    bool Integer(int64_t value);
+    bool InChannel() const;
+    bool InFeed() const;
+};
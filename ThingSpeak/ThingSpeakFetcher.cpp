@@ -0,0 +1,284 @@
+#include <algorithm>
+#include <iostream>
+
+#include "ThingSpeakFetcher.h"
+
+#define DEBUG_THINGSPEAK_FETCHER false
+
+#define THINGSPEAK_FETCHER_CONNECT_TIMEOUT_MS   5000
+#define THINGSPEAK_FETCHER_REQUEST_TIMEOUT_MS   15000
+
+/**
+ * @brief Construct fetcher and start its worker thread
+ * 
+ * @param onResultsReady - Called on the worker thread each time new results
+ *                         are ready to Collect(). Must be thread-safe
+ */
+ThingSpeakFetcher::ThingSpeakFetcher(ResultsReadyCallback onResultsReady) :
+    resultsReady(std::move(onResultsReady)),
+    connectionPool(curl_share_init(), &curl_share_cleanup)
+{
+    // Only used by the worker thread, so no lock functions are needed
+    if (connectionPool != nullptr)
+    {
+        curl_share_setopt(connectionPool.get(), CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+        curl_share_setopt(connectionPool.get(), CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        curl_share_setopt(connectionPool.get(), CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    }
+    else
+    {
+        std::cerr << "[ERROR] Couldn't create connection pool. Connections are not reused" << std::endl;
+    }
+
+    worker = std::jthread([this](std::stop_token stopToken) { WorkerLoop(stopToken); });
+}
+
+/**
+ * @brief Stop worker thread. Requests which have not started are dropped
+ * 
+ */
+ThingSpeakFetcher::~ThingSpeakFetcher()
+{
+    worker.request_stop();
+    requestReady.notify_all();
+}
+
+/**
+ * @brief Queue a request for the latest data of a ThingSpeak object.
+ *        Duplicate requests for a channel already waiting are ignored
+ * 
+ * @param thingSpeak - Object whose channel should be fetched
+ */
+void ThingSpeakFetcher::Request(ThingSpeak const & thingSpeak)
+{
+    if (QueueRequest({ thingSpeak.GetName(), thingSpeak.GetChannel(), thingSpeak.GetKey(),
+                       thingSpeak.GetLastEntry(), thingSpeak.GetValidators(), false, {} }))
+    {
+        requestReady.notify_one();
+    }
+}
+
+/**
+ * @brief Queue a request for the entries of a time range of a ThingSpeak
+ *        object. The result has rangeQuery set. Duplicate requests for a
+ *        range already waiting are ignored
+ * 
+ * @param thingSpeak - Object whose channel should be fetched
+ * @param range - Range to fetch. The resolution must be one returned by
+ *                ThingSpeak::GetRangeResolution()
+ */
+void ThingSpeakFetcher::RequestRange(ThingSpeak const & thingSpeak, ThingSpeakRange_t const & range)
+{
+    if (QueueRequest({ thingSpeak.GetName(), thingSpeak.GetChannel(), thingSpeak.GetKey(),
+                       thingSpeak.GetLastEntry(), {}, true, range }))
+    {
+        requestReady.notify_one();
+    }
+}
+
+/**
+ * @brief Queue requests for several ThingSpeak objects at once. The worker
+ *        is woken a single time so all channels are fetched concurrently
+ * 
+ * @param thingSpeaks - Objects whose channels should be fetched
+ */
+void ThingSpeakFetcher::FetchAll(std::span<ThingSpeak* const> thingSpeaks)
+{
+    bool queued = false;
+
+    for (ThingSpeak* thingSpeak : thingSpeaks)
+    {
+        queued |= QueueRequest({ thingSpeak->GetName(), thingSpeak->GetChannel(), thingSpeak->GetKey(),
+                                 thingSpeak->GetLastEntry(), thingSpeak->GetValidators(), false, {} });
+    }
+
+    if (queued)
+    {
+        requestReady.notify_one();
+    }
+}
+
+/**
+ * @brief Hand over all results finished since the last call. Never blocks
+ *        on the network; only swaps the worker's result buffer
+ * 
+ * @param results - Cleared and filled with any finished results
+ * 
+ * @return bool - True if at least one result was collected
+ */
+bool ThingSpeakFetcher::Collect(std::vector<ThingSpeakFetchResult_t>& results)
+{
+    results.clear();
+
+    std::lock_guard<std::mutex> lock(resultMutex);
+    completedResults.swap(results);
+
+    return !results.empty();
+}
+
+/**
+ * @brief Determine if the worker has requests queued or in flight
+ * 
+ * @return bool - True if requests are outstanding
+ */
+bool ThingSpeakFetcher::Busy()
+{
+    std::lock_guard<std::mutex> lock(requestMutex);
+
+    return (fetchInProgress || !pendingRequests.empty());
+}
+
+/**
+ * @brief Add a request to the pending queue without waking the worker
+ * 
+ * @param request - Request to queue
+ * 
+ * @return bool - True if queued. False if already pending
+ */
+bool ThingSpeakFetcher::QueueRequest(ThingSpeakFetchRequest_t request)
+{
+    std::lock_guard<std::mutex> lock(requestMutex);
+
+    bool alreadyPending = std::any_of(pendingRequests.begin(), pendingRequests.end(),
+                                      [&request](ThingSpeakFetchRequest_t const & pending) {
+                                          if ((pending.channel != request.channel) ||
+                                              (pending.key != request.key) ||
+                                              (pending.rangeQuery != request.rangeQuery))
+                                          {
+                                              return false;
+                                          }
+
+                                          return (!request.rangeQuery ||
+                                                  ((pending.range.start == request.range.start) &&
+                                                   (pending.range.end == request.range.end) &&
+                                                   (pending.range.resolutionMinutes == request.range.resolutionMinutes) &&
+                                                   (pending.range.aggregate == request.range.aggregate)));
+                                      });
+    if (alreadyPending)
+    {
+        return false;
+    }
+
+    pendingRequests.push_back(std::move(request));
+
+    return true;
+}
+
+/**
+ * @brief Worker thread body. Takes every queued request as one batch,
+ *        performs the batch concurrently, and publishes the results for
+ *        the render loop to collect
+ * 
+ * @param stopToken - Signalled when the fetcher is destroyed
+ */
+void ThingSpeakFetcher::WorkerLoop(std::stop_token stopToken)
+{
+    std::vector<ThingSpeakFetchRequest_t> batch;
+
+    while (!stopToken.stop_requested())
+    {
+        {
+            std::unique_lock<std::mutex> lock(requestMutex);
+            fetchInProgress = false;
+
+            requestReady.wait(lock, stopToken, [this] { return !pendingRequests.empty(); });
+            if (stopToken.stop_requested())
+            {
+                break;
+            }
+
+            batch.assign(std::make_move_iterator(pendingRequests.begin()),
+                         std::make_move_iterator(pendingRequests.end()));
+            pendingRequests.clear();
+            fetchInProgress = true;
+        }
+
+        #if (DEBUG_THINGSPEAK_FETCHER)
+        std::cout << "Fetching " << batch.size() << " channel(s)" << std::endl;
+        #endif
+
+        std::vector<ThingSpeak> thingSpeaks;
+        thingSpeaks.reserve(batch.size());
+
+        // A session may only be added to a MultiPerform once
+        std::map<std::string, size_t> sessionsUsed;
+
+        cpr::MultiPerform multiPerform;
+        for (auto& request : batch)
+        {
+            ThingSpeak& thingSpeak = thingSpeaks.emplace_back(request.name,
+                                                              request.channel,
+                                                              request.key);
+
+            size_t& index = sessionsUsed[request.channel + "/" + request.key];
+            std::shared_ptr<cpr::Session>& session = GetSession(request, index++);
+            std::string url = (request.rangeQuery ? thingSpeak.GetRangeUrl(request.range) :
+                                                    thingSpeak.GetFieldDataUrl(request.lastEntry));
+            session->SetUrl(cpr::Url{url});
+
+            // Replaces the headers of the session's previous request
+            session->SetHeader(ThingSpeak::GetConditionalHeader(url, request.validators));
+
+            multiPerform.AddSession(session);
+        }
+
+        // Responses are returned in the order sessions were added
+        std::vector<cpr::Response> responses = multiPerform.Get();
+
+        std::vector<ThingSpeakFetchResult_t> results;
+        results.reserve(responses.size());
+        for (size_t i = 0; i < responses.size(); i++)
+        {
+            results.push_back(batch[i].rangeQuery ? thingSpeaks[i].ParseRangeData(responses[i], batch[i].range) :
+                                                    thingSpeaks[i].ParseFieldData(responses[i]));
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(resultMutex);
+            std::move(results.begin(), results.end(), std::back_inserter(completedResults));
+        }
+
+        if (resultsReady)
+        {
+            resultsReady();
+        }
+    }
+}
+
+/**
+ * @brief Get a persistent session used for a channel, creating it on
+ *        first use. Sessions take their connections from the shared pool,
+ *        avoiding a DNS lookup and TLS handshake on every refresh
+ * 
+ * @param request - Request the session will be used for
+ * @param index - Number of sessions of the channel already used by this batch
+ * 
+ * @return std::shared_ptr<cpr::Session>& - Session for the request's channel
+ */
+std::shared_ptr<cpr::Session>& ThingSpeakFetcher::GetSession(ThingSpeakFetchRequest_t const & request, size_t index)
+{
+    std::vector<std::shared_ptr<cpr::Session>>& channelSessions = sessions[request.channel + "/" + request.key];
+    if (channelSessions.size() <= index)
+    {
+        channelSessions.resize(index + 1);
+    }
+
+    std::shared_ptr<cpr::Session>& session = channelSessions[index];
+
+    if (session == nullptr)
+    {
+        session = std::make_shared<cpr::Session>();
+        session->SetConnectTimeout(cpr::ConnectTimeout{THINGSPEAK_FETCHER_CONNECT_TIMEOUT_MS});
+        session->SetTimeout(cpr::Timeout{THINGSPEAK_FETCHER_REQUEST_TIMEOUT_MS});
+        session->SetAcceptEncoding(ThingSpeak::GetAcceptEncoding());
+
+        // The MultiPerform's own connection cache is closed with it after
+        // every batch
+        if (connectionPool != nullptr)
+        {
+            curl_easy_setopt(session->GetCurlHolder()->handle, CURLOPT_SHARE, connectionPool.get());
+        }
+    }
+
+    return session;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <functional>
+#include <span>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <stop_token>
+#include <curl/curl.h>
+
+#include "ThingSpeak.h"
+
+typedef struct
+{
+    std::string name;
+    std::string channel;
+    std::string key;
+
+    ThingSpeakFeedCursor_t lastEntry;
+    ThingSpeakValidators_t validators;
+
+    bool rangeQuery;                  // Fetch range rather than entries after lastEntry
+    ThingSpeakRange_t range;
+} ThingSpeakFetchRequest_t;
+
+/**
+ * Background worker which owns all HTTP requests made to ThingSpeak.
+ * 
+ * Requests are queued from the render loop and serviced on a dedicated
+ * thread. Everything queued when the worker wakes up is issued at the same
+ * time through one cpr::MultiPerform, reusing a persistent cpr::Session per
+ * channel. Every session is attached to one curl share handle owning the
+ * connection cache, TLS sessions and DNS cache, so connections to
+ * ThingSpeak outlive each batch's MultiPerform and are reused by any
+ * channel's next request.
+ * Responses are requested compressed, and latest data requests are made
+ * conditional on the validators of the channel's last response, so polls
+ * of an unchanged channel return a bodyless 304.
+ * Range requests (see ThingSpeak::Fetch()) are serviced alongside latest
+ * data requests; a channel with several requests in one batch uses one
+ * session per request.
+ * Finished results are published into a buffer which the render loop swaps
+ * out with Collect(), so the UI never waits on the network. An optional
+ * callback is invoked on the worker thread whenever results are published,
+ * allowing an idle render loop to sleep until there is new data to draw.
+ */
+class ThingSpeakFetcher
+{
+public:
+    typedef std::function<void()> ResultsReadyCallback;
+
+    explicit ThingSpeakFetcher(ResultsReadyCallback onResultsReady = {});
+    ~ThingSpeakFetcher();
+
+    ThingSpeakFetcher(ThingSpeakFetcher const &) = delete;
+    ThingSpeakFetcher& operator=(ThingSpeakFetcher const &) = delete;
+
+    void Request(ThingSpeak const & thingSpeak);
+    void RequestRange(ThingSpeak const & thingSpeak, ThingSpeakRange_t const & range);
+    void FetchAll(std::span<ThingSpeak* const> thingSpeaks);
+    bool Collect(std::vector<ThingSpeakFetchResult_t>& results);
+    bool Busy();
+
+private:
+    // Member Variables
+    std::mutex requestMutex;
+    std::condition_variable_any requestReady;
+    std::deque<ThingSpeakFetchRequest_t> pendingRequests;
+    bool fetchInProgress = false;
+
+    std::mutex resultMutex;
+    std::vector<ThingSpeakFetchResult_t> completedResults;
+    ResultsReadyCallback resultsReady;
+
+    // Only accessed by the worker thread. The share handle is destroyed
+    // after the sessions attached to it
+    std::unique_ptr<CURLSH, decltype(&curl_share_cleanup)> connectionPool;
+    std::map<std::string, std::vector<std::shared_ptr<cpr::Session>>> sessions;
+
+    std::jthread worker;
+
+    // Member Functions
+    bool QueueRequest(ThingSpeakFetchRequest_t request);
+    void WorkerLoop(std::stop_token stopToken);
+    std::shared_ptr<cpr::Session>& GetSession(ThingSpeakFetchRequest_t const & request, size_t index);
+};
@@ -0,0 +1,931 @@
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netdb.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+#include <algorithm>
+#include <iterator>
+#include <fstream>
+#include <iostream>
+#include <nlohmann/json.hpp>
+
+#include "ThingSpeakMqttSubscriber.h"
+
+using json = nlohmann::json;
+
+#define DEBUG_THINGSPEAK_MQTT false
+
+#ifdef _WIN32
+typedef SOCKET ThingSpeakMqttSocket_t;
+#define THINGSPEAK_MQTT_SEND_FLAGS    0
+#else
+typedef int ThingSpeakMqttSocket_t;
+#define THINGSPEAK_MQTT_SEND_FLAGS    MSG_NOSIGNAL   // A dropped connection is reported, not raised as SIGPIPE
+#endif
+
+// MQTT 3.1.1 control packet types, in the upper nibble of the first byte
+#define THINGSPEAK_MQTT_CONNECT       0x10
+#define THINGSPEAK_MQTT_CONNACK       0x20
+#define THINGSPEAK_MQTT_PUBLISH       0x30
+#define THINGSPEAK_MQTT_PUBACK        0x40
+#define THINGSPEAK_MQTT_SUBSCRIBE     0x82   // Flags 0b0010 are required
+#define THINGSPEAK_MQTT_SUBACK        0x90
+#define THINGSPEAK_MQTT_UNSUBSCRIBE   0xA2   // Flags 0b0010 are required
+#define THINGSPEAK_MQTT_UNSUBACK      0xB0
+#define THINGSPEAK_MQTT_PINGREQ       0xC0
+#define THINGSPEAK_MQTT_PINGRESP      0xD0
+#define THINGSPEAK_MQTT_DISCONNECT    0xE0
+
+#define THINGSPEAK_MQTT_PROTOCOL_LEVEL      4      // MQTT 3.1.1
+#define THINGSPEAK_MQTT_FLAG_USERNAME       0x80
+#define THINGSPEAK_MQTT_FLAG_PASSWORD       0x40
+#define THINGSPEAK_MQTT_FLAG_CLEAN_SESSION  0x02
+#define THINGSPEAK_MQTT_SUBACK_FAILURE      0x80
+
+/**
+ * @brief Close a socket opened by ThingSpeakMqttSubscriber::Connect()
+ * 
+ * @param socket - Socket to close
+ */
+static void ThingSpeakMqttCloseSocket(ThingSpeakMqttSocket_t socket)
+{
+    #ifdef _WIN32
+    ::closesocket(socket);
+    #else
+    ::close(socket);
+    #endif
+}
+
+/**
+ * @brief Determine if the last socket call failed only because a
+ *        non-blocking socket was not ready
+ * 
+ * @return bool - True if the call should be retried once the socket is ready
+ */
+static bool ThingSpeakMqttWouldBlock()
+{
+    #ifdef _WIN32
+    int error = ::WSAGetLastError();
+    return ((error == WSAEWOULDBLOCK) || (error == WSAEINPROGRESS));
+    #else
+    return ((errno == EWOULDBLOCK) || (errno == EAGAIN) || (errno == EINPROGRESS));
+    #endif
+}
+
+/**
+ * @brief Wait for a socket to become readable or writable
+ * 
+ * @param socket - Socket to wait on
+ * @param write - Wait until writable rather than readable
+ * @param timeoutMs - Longest wait
+ * 
+ * @return int - Positive if ready, 0 on timeout, negative on error
+ */
+static int ThingSpeakMqttWaitSocket(ThingSpeakMqttSocket_t socket, bool write, int timeoutMs)
+{
+    fd_set readySet;
+    FD_ZERO(&readySet);
+    FD_SET(socket, &readySet);
+
+    // Failed connects are only reported through the exception set on Windows
+    fd_set errorSet = readySet;
+
+    timeval timeout = {(timeoutMs / 1000), ((timeoutMs % 1000) * 1000)};
+
+    int ready = ::select(static_cast<int>(socket + 1), (write ? nullptr : &readySet),
+                         (write ? &readySet : nullptr), &errorSet, &timeout);
+
+    return ((ready > 0) && FD_ISSET(socket, &errorSet)) ? -1 : ready;
+}
+
+/**
+ * @brief Append an MQTT UTF-8 string, prefixed with its 16-bit length
+ * 
+ * @param packet - Packet being built
+ * @param value - String to append. At most 65535 bytes
+ */
+static void ThingSpeakMqttAppendString(std::vector<uint8_t>& packet, std::string_view value)
+{
+    size_t length = std::min<size_t>(value.size(), UINT16_MAX);
+    packet.push_back(static_cast<uint8_t>(length >> 8));
+    packet.push_back(static_cast<uint8_t>(length & 0xFF));
+    packet.insert(packet.end(), value.begin(), (value.begin() + length));
+}
+
+/**
+ * @brief Append a 16-bit packet identifier, most significant byte first
+ * 
+ * @param packet - Packet being built
+ * @param packetId - Identifier to append
+ */
+static void ThingSpeakMqttAppendPacketId(std::vector<uint8_t>& packet, uint16_t packetId)
+{
+    packet.push_back(static_cast<uint8_t>(packetId >> 8));
+    packet.push_back(static_cast<uint8_t>(packetId & 0xFF));
+}
+
+/**
+ * @brief Prefix a packet's variable header and payload with its fixed
+ *        header: the type and flags, then the remaining length encoded 7
+ *        bits per byte
+ * 
+ * @param type - Packet type and flags, e.g. THINGSPEAK_MQTT_SUBSCRIBE
+ * @param body - Variable header and payload
+ * 
+ * @return std::vector<uint8_t> - Complete packet
+ */
+static std::vector<uint8_t> ThingSpeakMqttBuildPacket(uint8_t type, std::vector<uint8_t> const & body)
+{
+    std::vector<uint8_t> packet;
+    packet.reserve(body.size() + 5);
+    packet.push_back(type);
+
+    size_t remaining = body.size();
+    do
+    {
+        uint8_t encoded = static_cast<uint8_t>(remaining & 0x7F);
+        remaining >>= 7;
+        packet.push_back(encoded | ((remaining > 0) ? 0x80 : 0x00));
+    } while (remaining > 0);
+
+    packet.insert(packet.end(), body.begin(), body.end());
+
+    return packet;
+}
+
+/**
+ * @brief Construct subscriber and start its worker thread. Nothing is
+ *        connected until the first channel is subscribed
+ * 
+ * @param mqttConfig - Broker and device credentials, see LoadConfig()
+ * @param onResultsReady - Called on the worker thread each time new results
+ *                         are ready to Collect(). Must be thread-safe
+ */
+ThingSpeakMqttSubscriber::ThingSpeakMqttSubscriber(ThingSpeakMqttConfig_t mqttConfig,
+                                                   ResultsReadyCallback onResultsReady) :
+    config(std::move(mqttConfig)),
+    resultsReady(std::move(onResultsReady))
+{
+    #ifdef _WIN32
+    WSADATA wsaData;
+    ::WSAStartup(MAKEWORD(2, 2), &wsaData);
+    #endif
+
+    worker = std::jthread([this](std::stop_token stopToken) { WorkerLoop(stopToken); });
+}
+
+/**
+ * @brief Stop worker thread, disconnecting from the broker
+ * 
+ */
+ThingSpeakMqttSubscriber::~ThingSpeakMqttSubscriber()
+{
+    worker.request_stop();
+    subscriptionsChanged.notify_all();
+
+    // Joined before Winsock is released
+    if (worker.joinable())
+    {
+        worker.join();
+    }
+
+    #ifdef _WIN32
+    ::WSACleanup();
+    #endif
+}
+
+/**
+ * @brief Start delivering the entries published to an object's channel.
+ *        Subscribing an object whose channel/key is already subscribed
+ *        has no effect
+ * 
+ * @param thingSpeak - Object whose channel should be delivered
+ */
+void ThingSpeakMqttSubscriber::Subscribe(ThingSpeak const & thingSpeak)
+{
+    {
+        std::lock_guard<std::mutex> lock(subscriptionMutex);
+
+        std::vector<ThingSpeak>& subscribers = subscriptions[GetTopic(thingSpeak.GetChannel())];
+        bool alreadySubscribed = std::any_of(subscribers.begin(), subscribers.end(),
+                                             [&thingSpeak](ThingSpeak const & subscriber) {
+                                                 return (subscriber.GetKey() == thingSpeak.GetKey());
+                                             });
+        if (alreadySubscribed)
+        {
+            return;
+        }
+
+        // Only the channel and key are needed to parse what is published
+        subscribers.emplace_back(thingSpeak.GetName(), thingSpeak.GetChannel(), thingSpeak.GetKey());
+        subscriptionsSynced = false;
+    }
+
+    subscriptionsChanged.notify_all();
+}
+
+/**
+ * @brief Stop delivering the entries of a channel/key. The channel's topic
+ *        is unsubscribed once no key of it remains
+ * 
+ * @param channel - ThingSpeak channel ID
+ * @param key - ThingSpeak read key the channel was subscribed with
+ */
+void ThingSpeakMqttSubscriber::Unsubscribe(std::string const & channel, std::string const & key)
+{
+    {
+        std::lock_guard<std::mutex> lock(subscriptionMutex);
+
+        auto found = subscriptions.find(GetTopic(channel));
+        if (found == subscriptions.end())
+        {
+            return;
+        }
+
+        std::vector<ThingSpeak>& subscribers = found->second;
+        std::erase_if(subscribers, [&key](ThingSpeak const & subscriber) { return (subscriber.GetKey() == key); });
+        if (subscribers.empty())
+        {
+            subscriptions.erase(found);
+        }
+        subscriptionsSynced = false;
+    }
+
+    subscriptionsChanged.notify_all();
+}
+
+/**
+ * @brief Hand over all entries published since the last call. Never
+ *        blocks on the network; only swaps the worker's result buffer
+ * 
+ * @param results - Cleared and filled with one result per entry received
+ * 
+ * @return bool - True if at least one result was collected
+ */
+bool ThingSpeakMqttSubscriber::Collect(std::vector<ThingSpeakFetchResult_t>& results)
+{
+    results.clear();
+
+    std::lock_guard<std::mutex> lock(resultMutex);
+    completedResults.swap(results);
+
+    return !results.empty();
+}
+
+/**
+ * @brief Get the state of the connection to the broker
+ * 
+ * @return ThingSpeakTransportState - Current state
+ */
+ThingSpeakTransportState ThingSpeakMqttSubscriber::GetState() const { return state.load(); }
+
+/**
+ * @brief Describe the broker connected to, e.g. for diagnostics
+ * 
+ * @return std::string - "MQTT host:port"
+ */
+std::string ThingSpeakMqttSubscriber::GetDescription() const
+{
+    return ("MQTT " + config.host + ":" + std::to_string(config.port));
+}
+
+/**
+ * @brief Read the broker and device credentials from a JSON file, e.g.
+ *        {"clientId": "...", "username": "...", "password": "...",
+ *        "insecure": true}. The host, port and keepAliveSeconds keys are
+ *        optional. The connection is plain TCP, so the file is rejected
+ *        unless "insecure" opts in to sending the credentials unencrypted
+ * 
+ * @param filePath - Path of the configuration file
+ * @param config - Filled with the configuration read
+ * 
+ * @return bool - True if read. False if missing, incomplete or not opted
+ *                in to plain TCP, in which case channels are only polled
+ */
+bool ThingSpeakMqttSubscriber::LoadConfig(std::filesystem::path const & filePath,
+                                          ThingSpeakMqttConfig_t& config)
+{
+    std::ifstream configFile(filePath);
+    if (!configFile.is_open())
+    {
+        return false;
+    }
+
+    json configJson = json::parse(configFile, nullptr, false);
+    if (configJson.is_discarded() || !configJson.is_object())
+    {
+        std::cerr << "[ERROR] Could not parse " << filePath.string() << std::endl;
+        return false;
+    }
+
+    config.host = configJson.value("host", THINGSPEAK_MQTT_DEFAULT_HOST);
+    config.port = configJson.value("port", THINGSPEAK_MQTT_DEFAULT_PORT);
+    config.clientId = configJson.value("clientId", "");
+    config.username = configJson.value("username", "");
+    config.password = configJson.value("password", "");
+    config.keepAliveSeconds = std::clamp(configJson.value("keepAliveSeconds", THINGSPEAK_MQTT_KEEP_ALIVE_S),
+                                         10, UINT16_MAX);
+    config.insecure = configJson.value("insecure", false);
+
+    if (config.host.empty() || config.clientId.empty() ||
+        (config.port <= 0) || (config.port > UINT16_MAX))
+    {
+        std::cerr << "[ERROR] " << filePath.string() << " needs a clientId and a valid host/port" << std::endl;
+        return false;
+    }
+
+    if (!config.insecure)
+    {
+        std::cerr << "[ERROR] MQTT over TLS is not supported. Set \"insecure\": true in " << filePath.string()
+                  << " to send the credentials over plain TCP, or remove it to only poll over HTTPS" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Get the topic ThingSpeak publishes a channel's entries to
+ * 
+ * @param channel - ThingSpeak channel ID
+ * 
+ * @return std::string - Subscribe topic of the channel
+ */
+std::string ThingSpeakMqttSubscriber::GetTopic(std::string const & channel)
+{
+    return ("channels/" + channel + "/subscribe");
+}
+
+/**
+ * @brief Worker thread body. Connects while anything is subscribed, keeps
+ *        the connection's topics in line with the subscriptions, and
+ *        publishes the entries received for the render loop to collect
+ * 
+ * @param stopToken - Signalled when the subscriber is destroyed
+ */
+void ThingSpeakMqttSubscriber::WorkerLoop(std::stop_token stopToken)
+{
+    int backoffSeconds = THINGSPEAK_MQTT_MIN_BACKOFF_S;
+
+    while (!stopToken.stop_requested())
+    {
+        {
+            std::unique_lock<std::mutex> lock(subscriptionMutex);
+            subscriptionsChanged.wait(lock, stopToken, [this] { return !subscriptions.empty(); });
+            if (stopToken.stop_requested())
+            {
+                break;
+            }
+        }
+
+        state = ThingSpeakTransportState::Connecting;
+        if (Connect(stopToken))
+        {
+            state = ThingSpeakTransportState::Connected;
+            backoffSeconds = THINGSPEAK_MQTT_MIN_BACKOFF_S;
+
+            std::cerr << "[WARNING] Connected to " << GetDescription()
+                      << " over plain TCP. The MQTT credentials were sent unencrypted" << std::endl;
+
+            #if (DEBUG_THINGSPEAK_MQTT)
+            std::cout << "Connected to " << GetDescription() << std::endl;
+            #endif
+
+            auto keepAlive = std::chrono::seconds(config.keepAliveSeconds);
+            while (!stopToken.stop_requested())
+            {
+                if (!SyncSubscriptions())
+                {
+                    break;
+                }
+
+                // The broker drops clients silent for 1.5 keep alive periods
+                Clock::time_point now = Clock::now();
+                if (((now - lastSendTime) >= (keepAlive / 2)) &&
+                    !Send(ThingSpeakMqttBuildPacket(THINGSPEAK_MQTT_PINGREQ, {})))
+                {
+                    break;
+                }
+                if ((now - lastReceiveTime) >= (keepAlive + (keepAlive / 2)))
+                {
+                    std::cerr << "[ERROR] No response from " << GetDescription() << std::endl;
+                    break;
+                }
+
+                if (!Receive(THINGSPEAK_MQTT_POLL_MS))
+                {
+                    break;
+                }
+            }
+
+            if (stopToken.stop_requested())
+            {
+                Send(ThingSpeakMqttBuildPacket(THINGSPEAK_MQTT_DISCONNECT, {}));
+            }
+        }
+
+        Disconnect();
+        state = ThingSpeakTransportState::Disconnected;
+
+        if (stopToken.stop_requested())
+        {
+            break;
+        }
+
+        #if (DEBUG_THINGSPEAK_MQTT)
+        std::cout << "Reconnecting to " << GetDescription() << " in " << backoffSeconds << "s" << std::endl;
+        #endif
+
+        // Entries published meanwhile are backfilled over HTTP by the caller
+        {
+            std::unique_lock<std::mutex> lock(subscriptionMutex);
+            subscriptionsChanged.wait_for(lock, stopToken, std::chrono::seconds(backoffSeconds), [] { return false; });
+        }
+        backoffSeconds = std::min((backoffSeconds * 2), THINGSPEAK_MQTT_MAX_BACKOFF_S);
+    }
+}
+
+/**
+ * @brief Open a TCP connection to the broker and log in with the device
+ *        credentials. Every topic is resubscribed afterwards, since the
+ *        session is not kept by the broker
+ * 
+ * @param stopToken - Signalled when the subscriber is destroyed
+ * 
+ * @return bool - True once the broker accepted the connection
+ */
+bool ThingSpeakMqttSubscriber::Connect(std::stop_token const & stopToken)
+{
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+
+    addrinfo* addresses = nullptr;
+    std::string port = std::to_string(config.port);
+    if (::getaddrinfo(config.host.c_str(), port.c_str(), &hints, &addresses) != 0)
+    {
+        std::cerr << "[ERROR] Could not resolve " << config.host << std::endl;
+        return false;
+    }
+
+    for (addrinfo* address = addresses; (address != nullptr) && (socketHandle == -1); address = address->ai_next)
+    {
+        ThingSpeakMqttSocket_t newSocket = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        #ifdef _WIN32
+        if (newSocket == INVALID_SOCKET)
+        {
+            continue;
+        }
+        u_long nonBlocking = 1;
+        ::ioctlsocket(newSocket, FIONBIO, &nonBlocking);
+        #else
+        if (newSocket < 0)
+        {
+            continue;
+        }
+        ::fcntl(newSocket, F_SETFL, (::fcntl(newSocket, F_GETFL, 0) | O_NONBLOCK));
+        #endif
+
+        // Connected once writable, so a dead broker cannot stall shutdown
+        bool connected = (::connect(newSocket, address->ai_addr, static_cast<int>(address->ai_addrlen)) == 0);
+        if (!connected && ThingSpeakMqttWouldBlock())
+        {
+            int error = 0;
+            socklen_t errorLength = sizeof(error);
+            connected = (ThingSpeakMqttWaitSocket(newSocket, true, THINGSPEAK_MQTT_CONNECT_TIMEOUT_MS) > 0) &&
+                        (::getsockopt(newSocket, SOL_SOCKET, SO_ERROR,
+                                      reinterpret_cast<char*>(&error), &errorLength) == 0) &&
+                        (error == 0);
+        }
+
+        if (connected)
+        {
+            socketHandle = static_cast<intptr_t>(newSocket);
+        }
+        else
+        {
+            ThingSpeakMqttCloseSocket(newSocket);
+        }
+    }
+    ::freeaddrinfo(addresses);
+
+    if (socketHandle == -1)
+    {
+        std::cerr << "[ERROR] Could not connect to " << GetDescription() << std::endl;
+        return false;
+    }
+
+    std::vector<uint8_t> body;
+    ThingSpeakMqttAppendString(body, "MQTT");
+    body.push_back(THINGSPEAK_MQTT_PROTOCOL_LEVEL);
+    body.push_back(THINGSPEAK_MQTT_FLAG_CLEAN_SESSION |
+                   (config.username.empty() ? 0 : THINGSPEAK_MQTT_FLAG_USERNAME) |
+                   (config.password.empty() ? 0 : THINGSPEAK_MQTT_FLAG_PASSWORD));
+    ThingSpeakMqttAppendPacketId(body, static_cast<uint16_t>(config.keepAliveSeconds));
+    ThingSpeakMqttAppendString(body, config.clientId);
+    if (!config.username.empty())
+    {
+        ThingSpeakMqttAppendString(body, config.username);
+    }
+    if (!config.password.empty())
+    {
+        ThingSpeakMqttAppendString(body, config.password);
+    }
+
+    receiveBuffer.clear();
+    subscribedTopics.clear();
+    pendingSubscribes.clear();
+    connectAccepted = false;
+    lastReceiveTime = Clock::now();
+
+    if (!Send(ThingSpeakMqttBuildPacket(THINGSPEAK_MQTT_CONNECT, body)))
+    {
+        return false;
+    }
+
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(THINGSPEAK_MQTT_CONNECT_TIMEOUT_MS);
+    while (!connectAccepted && (Clock::now() < deadline) && !stopToken.stop_requested())
+    {
+        if (!Receive(THINGSPEAK_MQTT_POLL_MS))
+        {
+            return false;
+        }
+    }
+
+    if (!connectAccepted && !stopToken.stop_requested())
+    {
+        std::cerr << "[ERROR] No CONNACK from " << GetDescription() << std::endl;
+    }
+
+    // Topics are resubscribed by the next SyncSubscriptions()
+    {
+        std::lock_guard<std::mutex> lock(subscriptionMutex);
+        subscriptionsSynced = false;
+    }
+
+    return connectAccepted;
+}
+
+/**
+ * @brief Close the connection to the broker, if open
+ * 
+ */
+void ThingSpeakMqttSubscriber::Disconnect()
+{
+    if (socketHandle != -1)
+    {
+        ThingSpeakMqttCloseSocket(static_cast<ThingSpeakMqttSocket_t>(socketHandle));
+        socketHandle = -1;
+    }
+}
+
+/**
+ * @brief Subscribe to topics subscribed since the last call and unsubscribe
+ *        from those no longer wanted, one packet each
+ * 
+ * @return bool - False if the connection failed
+ */
+bool ThingSpeakMqttSubscriber::SyncSubscriptions()
+{
+    std::vector<std::string> added;
+    std::vector<std::string> removed;
+
+    {
+        std::lock_guard<std::mutex> lock(subscriptionMutex);
+        if (subscriptionsSynced)
+        {
+            return true;
+        }
+
+        for (auto const & [topic, subscribers] : subscriptions)
+        {
+            if (!subscribedTopics.contains(topic))
+            {
+                added.push_back(topic);
+            }
+        }
+        for (std::string const & topic : subscribedTopics)
+        {
+            if (!subscriptions.contains(topic))
+            {
+                removed.push_back(topic);
+            }
+        }
+        subscriptionsSynced = true;
+    }
+
+    if (!added.empty())
+    {
+        uint16_t packetId = NextPacketId();
+
+        std::vector<uint8_t> body;
+        ThingSpeakMqttAppendPacketId(body, packetId);
+        for (std::string const & topic : added)
+        {
+            ThingSpeakMqttAppendString(body, topic);
+            body.push_back(0);    // QoS 0; a lost entry is backfilled over HTTP
+            subscribedTopics.insert(topic);
+        }
+
+        if (!Send(ThingSpeakMqttBuildPacket(THINGSPEAK_MQTT_SUBSCRIBE, body)))
+        {
+            return false;
+        }
+        pendingSubscribes[packetId] = std::move(added);
+    }
+
+    if (!removed.empty())
+    {
+        std::vector<uint8_t> body;
+        ThingSpeakMqttAppendPacketId(body, NextPacketId());
+        for (std::string const & topic : removed)
+        {
+            ThingSpeakMqttAppendString(body, topic);
+            subscribedTopics.erase(topic);
+        }
+
+        if (!Send(ThingSpeakMqttBuildPacket(THINGSPEAK_MQTT_UNSUBSCRIBE, body)))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Write a complete packet to the broker
+ * 
+ * @param packet - Packet built by ThingSpeakMqttBuildPacket()
+ * 
+ * @return bool - False if the connection failed
+ */
+bool ThingSpeakMqttSubscriber::Send(std::vector<uint8_t> const & packet)
+{
+    size_t sent = 0;
+    while (sent < packet.size())
+    {
+        int numSent = ::send(static_cast<ThingSpeakMqttSocket_t>(socketHandle),
+                             reinterpret_cast<char const *>(packet.data() + sent),
+                             static_cast<int>(packet.size() - sent), THINGSPEAK_MQTT_SEND_FLAGS);
+        if (numSent > 0)
+        {
+            sent += static_cast<size_t>(numSent);
+        }
+        else if ((numSent < 0) && ThingSpeakMqttWouldBlock() &&
+                 (ThingSpeakMqttWaitSocket(static_cast<ThingSpeakMqttSocket_t>(socketHandle), true, THINGSPEAK_MQTT_CONNECT_TIMEOUT_MS) > 0))
+        {
+            continue;
+        }
+        else
+        {
+            std::cerr << "[ERROR] Lost connection to " << GetDescription() << std::endl;
+            return false;
+        }
+    }
+
+    lastSendTime = Clock::now();
+
+    return true;
+}
+
+/**
+ * @brief Wait for data from the broker, and handle every packet completed
+ *        by it
+ * 
+ * @param timeoutMs - Longest wait for data
+ * 
+ * @return bool - False if the connection failed or the stream is malformed
+ */
+bool ThingSpeakMqttSubscriber::Receive(int timeoutMs)
+{
+    int ready = ThingSpeakMqttWaitSocket(static_cast<ThingSpeakMqttSocket_t>(socketHandle), false, timeoutMs);
+    if (ready == 0)
+    {
+        return true;
+    }
+
+    char buffer[4096];
+    int numReceived = -1;
+    if (ready > 0)
+    {
+        numReceived = ::recv(static_cast<ThingSpeakMqttSocket_t>(socketHandle), buffer, sizeof(buffer), 0);
+        if ((numReceived < 0) && ThingSpeakMqttWouldBlock())
+        {
+            return true;
+        }
+    }
+    if (numReceived <= 0)
+    {
+        std::cerr << "[ERROR] Lost connection to " << GetDescription() << std::endl;
+        return false;
+    }
+
+    receiveBuffer.insert(receiveBuffer.end(), buffer, (buffer + numReceived));
+    lastReceiveTime = Clock::now();
+
+    // Handle each complete packet; a partial one waits for more data
+    size_t position = 0;
+    while ((receiveBuffer.size() - position) >= 2)
+    {
+        size_t remaining = 0;
+        size_t headerSize = 1;
+        bool lengthComplete = false;
+        for (int shift = 0; (shift < 28) && ((position + headerSize) < receiveBuffer.size()); shift += 7)
+        {
+            uint8_t encoded = receiveBuffer[position + headerSize];
+            remaining |= (static_cast<size_t>(encoded & 0x7F) << shift);
+            headerSize++;
+            if ((encoded & 0x80) == 0)
+            {
+                lengthComplete = true;
+                break;
+            }
+        }
+
+        if (!lengthComplete && (headerSize > 4))
+        {
+            std::cerr << "[ERROR] Malformed packet from " << GetDescription() << std::endl;
+            return false;
+        }
+        if (remaining > THINGSPEAK_MQTT_MAX_PACKET_SIZE)
+        {
+            std::cerr << "[ERROR] Oversized packet from " << GetDescription() << std::endl;
+            return false;
+        }
+        if (!lengthComplete || ((receiveBuffer.size() - position - headerSize) < remaining))
+        {
+            break;
+        }
+
+        std::span<uint8_t const> body(receiveBuffer.data() + position + headerSize, remaining);
+        if (!HandlePacket(receiveBuffer[position], body))
+        {
+            return false;
+        }
+        position += headerSize + remaining;
+    }
+    receiveBuffer.erase(receiveBuffer.begin(), (receiveBuffer.begin() + position));
+
+    return true;
+}
+
+/**
+ * @brief Act on a packet received from the broker
+ * 
+ * @param type - First byte of the packet: type and flags
+ * @param body - Variable header and payload
+ * 
+ * @return bool - False if the packet ends the connection
+ */
+bool ThingSpeakMqttSubscriber::HandlePacket(uint8_t type, std::span<uint8_t const> body)
+{
+    switch (type & 0xF0)
+    {
+        case THINGSPEAK_MQTT_CONNACK:
+        {
+            // Return code 0 accepts; 4 and 5 reject the credentials
+            uint8_t returnCode = (body.size() >= 2) ? body[1] : 0xFF;
+            if (returnCode != 0)
+            {
+                std::cerr << "[ERROR] " << GetDescription() << " refused the connection.\n"
+                          << "        Return code: " << static_cast<int>(returnCode) << std::endl;
+                return false;
+            }
+            connectAccepted = true;
+            break;
+        }
+        case THINGSPEAK_MQTT_PUBLISH:
+        {
+            int qos = (type >> 1) & 0x03;
+            if (body.size() < 2)
+            {
+                return false;
+            }
+            size_t topicLength = (static_cast<size_t>(body[0]) << 8) | body[1];
+            size_t payloadOffset = 2 + topicLength + ((qos > 0) ? 2 : 0);
+            if (payloadOffset > body.size())
+            {
+                return false;
+            }
+
+            std::string_view topic(reinterpret_cast<char const *>(body.data() + 2), topicLength);
+            std::string_view payload(reinterpret_cast<char const *>(body.data() + payloadOffset),
+                                     (body.size() - payloadOffset));
+            PublishEntry(topic, payload);
+
+            // Subscriptions are QoS 0, but acknowledge anything sent at QoS 1
+            if (qos == 1)
+            {
+                std::vector<uint8_t> ack(body.begin() + 2 + topicLength, body.begin() + 4 + topicLength);
+                return Send(ThingSpeakMqttBuildPacket(THINGSPEAK_MQTT_PUBACK, ack));
+            }
+            break;
+        }
+        case THINGSPEAK_MQTT_SUBACK:
+        {
+            if (body.size() < 2)
+            {
+                return false;
+            }
+            uint16_t packetId = static_cast<uint16_t>((body[0] << 8) | body[1]);
+            auto found = pendingSubscribes.find(packetId);
+            if (found == pendingSubscribes.end())
+            {
+                break;
+            }
+
+            // The device is not allowed to subscribe to channels refused here
+            for (size_t i = 2; (i < body.size()) && ((i - 2) < found->second.size()); i++)
+            {
+                if (body[i] == THINGSPEAK_MQTT_SUBACK_FAILURE)
+                {
+                    std::cerr << "[ERROR] " << GetDescription() << " refused subscription to "
+                              << found->second[i - 2] << std::endl;
+                }
+            }
+            pendingSubscribes.erase(found);
+            break;
+        }
+        default:
+            // PINGRESP and UNSUBACK only keep the connection alive
+            break;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Parse an entry published to a topic for every object subscribed
+ *        to it, and hand the results to the render loop
+ * 
+ * @param topic - Topic the entry was published to
+ * @param payload - JSON entry, see ThingSpeak::ParsePublishedEntry()
+ */
+void ThingSpeakMqttSubscriber::PublishEntry(std::string_view topic, std::string_view payload)
+{
+    std::vector<ThingSpeakFetchResult_t> results;
+
+    {
+        std::lock_guard<std::mutex> lock(subscriptionMutex);
+
+        auto found = subscriptions.find(std::string(topic));
+        if (found == subscriptions.end())
+        {
+            return;
+        }
+
+        for (ThingSpeak const & subscriber : found->second)
+        {
+            ThingSpeakFetchResult_t result = subscriber.ParsePublishedEntry(payload);
+            if (result.validDataFetched)
+            {
+                results.push_back(std::move(result));
+            }
+        }
+    }
+
+    #if (DEBUG_THINGSPEAK_MQTT)
+    std::cout << "Received " << payload.size() << " bytes on " << topic << std::endl;
+    #endif
+
+    if (results.empty())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(resultMutex);
+        std::move(results.begin(), results.end(), std::back_inserter(completedResults));
+    }
+
+    if (resultsReady)
+    {
+        resultsReady();
+    }
+}
+
+/**
+ * @brief Get an identifier for a SUBSCRIBE/UNSUBSCRIBE packet. 0 is not
+ *        a valid identifier and is skipped
+ * 
+ * @return uint16_t - Packet identifier
+ */
+uint16_t ThingSpeakMqttSubscriber::NextPacketId()
+{
+    uint16_t packetId = nextPacketId++;
+    if (nextPacketId == 0)
+    {
+        nextPacketId = 1;
+    }
+
+    return packetId;
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <filesystem>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <set>
+#include <span>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <stop_token>
+
+#include "ThingSpeak.h"
+#include "ThingSpeakTransport.h"
+
+#define THINGSPEAK_MQTT_DEFAULT_HOST         "mqtt3.thingspeak.com"
+#define THINGSPEAK_MQTT_DEFAULT_PORT         1883     // Plain TCP. TLS is not supported
+#define THINGSPEAK_MQTT_KEEP_ALIVE_S         60       // Pinged at half this while idle
+#define THINGSPEAK_MQTT_CONNECT_TIMEOUT_MS   5000     // TCP connect and CONNACK each
+#define THINGSPEAK_MQTT_POLL_MS              250      // Longest wait on the socket, bounding shutdown latency
+#define THINGSPEAK_MQTT_MIN_BACKOFF_S        1        // First reconnect after a dropped connection
+#define THINGSPEAK_MQTT_MAX_BACKOFF_S        120
+#define THINGSPEAK_MQTT_MAX_PACKET_SIZE      65536    // Larger packets are treated as a broken stream
+
+// Credentials of a ThingSpeak MQTT device, which must be allowed to
+// subscribe to every channel shown
+typedef struct
+{
+    std::string host;
+    int port;
+    std::string clientId;
+    std::string username;
+    std::string password;
+    int keepAliveSeconds;
+    bool insecure;          // Opted in to sending the credentials over plain TCP
+} ThingSpeakMqttConfig_t;
+
+/**
+ * ThingSpeakTransport subscribing to ThingSpeak's MQTT broker.
+ * 
+ * A single connection carries the subscribe topic of every channel
+ * (channels/<channel ID>/subscribe). Subscriptions may change at any time;
+ * the worker thread brings the connection's topics in line with them while
+ * it waits on the socket, and resubscribes all of them after reconnecting.
+ * Each PUBLISH is parsed straight into a one entry result for every object
+ * subscribed to the channel. Dropped connections are retried with
+ * exponential backoff. Implements the parts of MQTT 3.1.1 a QoS 0
+ * subscriber needs, over plain TCP:
+ * 
+ *     ThingSpeakMqttConfig_t config;
+ *     if (ThingSpeakMqttSubscriber::LoadConfig(filePath, config))
+ *     {
+ *         ThingSpeakMqttSubscriber subscriber(config, onResultsReady);
+ *         subscriber.Subscribe(thingSpeak);
+ *     }
+ */
+class ThingSpeakMqttSubscriber : public ThingSpeakTransport
+{
+public:
+    explicit ThingSpeakMqttSubscriber(ThingSpeakMqttConfig_t mqttConfig,
+                                      ResultsReadyCallback onResultsReady = {});
+    ~ThingSpeakMqttSubscriber() override;
+
+    ThingSpeakMqttSubscriber(ThingSpeakMqttSubscriber const &) = delete;
+    ThingSpeakMqttSubscriber& operator=(ThingSpeakMqttSubscriber const &) = delete;
+
+    void Subscribe(ThingSpeak const & thingSpeak) override;
+    void Unsubscribe(std::string const & channel, std::string const & key) override;
+    bool Collect(std::vector<ThingSpeakFetchResult_t>& results) override;
+    ThingSpeakTransportState GetState() const override;
+    std::string GetDescription() const override;
+
+    static bool LoadConfig(std::filesystem::path const & filePath, ThingSpeakMqttConfig_t& config);
+    static std::string GetTopic(std::string const & channel);
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    // Member Variables
+    ThingSpeakMqttConfig_t config;
+    ResultsReadyCallback resultsReady;
+    std::atomic<ThingSpeakTransportState> state = ThingSpeakTransportState::Disconnected;
+
+    // Objects subscribed to each topic, parsing the entries published to it
+    std::mutex subscriptionMutex;
+    std::condition_variable_any subscriptionsChanged;
+    std::map<std::string, std::vector<ThingSpeak>> subscriptions;
+    bool subscriptionsSynced = true;
+
+    std::mutex resultMutex;
+    std::vector<ThingSpeakFetchResult_t> completedResults;
+
+    // Only accessed by the worker thread
+    intptr_t socketHandle = -1;
+    std::vector<uint8_t> receiveBuffer;
+    std::set<std::string> subscribedTopics;
+    std::map<uint16_t, std::vector<std::string>> pendingSubscribes;   // Awaiting SUBACK, by packet ID
+    uint16_t nextPacketId = 1;
+    bool connectAccepted = false;
+    Clock::time_point lastSendTime;
+    Clock::time_point lastReceiveTime;
+
+    std::jthread worker;
+
+    // Member Functions
+    void WorkerLoop(std::stop_token stopToken);
+    bool Connect(std::stop_token const & stopToken);
+    void Disconnect();
+    bool SyncSubscriptions();
+    bool Send(std::vector<uint8_t> const & packet);
+    bool Receive(int timeoutMs);
+    bool HandlePacket(uint8_t type, std::span<uint8_t const> body);
+    void PublishEntry(std::string_view topic, std::string_view payload);
+    uint16_t NextPacketId();
+};
@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <iostream>
+
+#include "ThingSpeakRangeCache.h"
+
+#define DEBUG_THINGSPEAK_RANGE_CACHE false
+
+/**
+ * @brief Get the tiles covering a time range. Tiles not held, failed tiles
+ *        due for a retry and tiles which may have gained entries are
+ *        reported as missing and marked pending, so each is only reported
+ *        once until its result is inserted
+ * 
+ * @param channel - ThingSpeak API channel
+ * @param key - ThingSpeak API key
+ * @param start - UTC epoch seconds of the start of the range
+ * @param end - UTC epoch seconds of the end of the range
+ * @param resolutionMinutes - Resolution returned by ChooseResolution() or
+ *                            ThingSpeak::GetRangeResolution()
+ * @param aggregate - How the entries of each interval are combined
+ * @param now - Current UTC epoch seconds
+ * @param tiles - Cleared and filled with the tiles held, oldest first
+ * @param missing - Ranges to fetch are appended
+ */
+void ThingSpeakRangeCache::Require(std::string const & channel, std::string const & key,
+                                   int64_t start, int64_t end, int resolutionMinutes,
+                                   ThingSpeakAggregate aggregate, int64_t now,
+                                   std::vector<ThingSpeakRangeTile_t const *>& tiles,
+                                   std::vector<ThingSpeakRange_t>& missing)
+{
+    tiles.clear();
+
+    // Nothing exists after the present
+    end = std::min(end, now);
+    if (end < start)
+    {
+        return;
+    }
+
+    int64_t tileSeconds = GetTileSeconds(resolutionMinutes);
+    useCount++;
+
+    for (int64_t tileStart = (start / tileSeconds) * tileSeconds; tileStart <= end; tileStart += tileSeconds)
+    {
+        ThingSpeakRange_t range = {tileStart, (tileStart + tileSeconds - 1), resolutionMinutes, aggregate};
+        ThingSpeakRangeTile_t& tile = this->tiles[GetTileKey(channel, key, range)];
+
+        if (tile.lastUsed == 0)
+        {
+            tile.range = range;
+            tile.fetched = false;
+            tile.pending = false;
+            tile.expiresAt = 0;
+        }
+        tile.lastUsed = useCount;
+
+        if (!tile.pending && (now >= tile.expiresAt))
+        {
+            tile.pending = true;
+            missing.push_back(range);
+            #if (DEBUG_THINGSPEAK_RANGE_CACHE)
+            std::cout << "Requesting range tile " << tileStart << " of " << channel << std::endl;
+            #endif
+        }
+
+        if (tile.fetched)
+        {
+            tiles.push_back(&tile);
+        }
+    }
+
+    Evict();
+}
+
+/**
+ * @brief Store the result of a range request reported by Require()
+ * 
+ * @param result - Result of ThingSpeak::Fetch() or ThingSpeak::ParseRangeData()
+ * @param now - Current UTC epoch seconds
+ * 
+ * @return bool - True if the result was for a tile still held
+ */
+bool ThingSpeakRangeCache::Insert(ThingSpeakFetchResult_t const & result, int64_t now)
+{
+    auto found = tiles.find(GetTileKey(result.channel, result.key, result.range));
+    if (!result.rangeQuery || (found == tiles.end()))
+    {
+        return false;
+    }
+
+    ThingSpeakRangeTile_t& tile = found->second;
+    tile.pending = false;
+
+    if (!result.validDataFetched)
+    {
+        // Entries already held are kept until the retry succeeds
+        tile.expiresAt = now + THINGSPEAK_RANGE_RETRY_S;
+        return true;
+    }
+
+    tile.series = result.feedData.series;
+    tile.fetched = true;
+
+    // Complete tiles never change; others gain an entry each interval
+    int64_t refreshSeconds = std::max(static_cast<int64_t>(tile.range.resolutionMinutes) * 60,
+                                      static_cast<int64_t>(THINGSPEAK_RANGE_MIN_REFRESH_S));
+    tile.expiresAt = (tile.range.end < now) ? INT64_MAX : (now + refreshSeconds);
+
+    return true;
+}
+
+/**
+ * @brief Drop every tile, e.g. once a channel's data was cleared
+ * 
+ */
+void ThingSpeakRangeCache::Clear() { tiles.clear(); }
+
+/**
+ * @brief Number of tiles held, including tiles not yet fetched
+ * 
+ * @return int - Number of tiles
+ */
+int ThingSpeakRangeCache::Size() const { return static_cast<int>(tiles.size()); }
+
+/**
+ * @brief Choose the resolution to show a span of time at. Short spans use
+ *        raw entries; longer spans use the finest resolution ThingSpeak
+ *        supports that keeps the span within THINGSPEAK_RANGE_MAX_POINTS
+ * 
+ * @param spanSeconds - Length of the span shown
+ * 
+ * @return int - Minutes per entry. THINGSPEAK_RANGE_RAW for raw entries
+ */
+int ThingSpeakRangeCache::ChooseResolution(int64_t spanSeconds)
+{
+    if (spanSeconds <= THINGSPEAK_RANGE_RAW_MAX_SECONDS)
+    {
+        return THINGSPEAK_RANGE_RAW;
+    }
+
+    int64_t spanMinutes = spanSeconds / 60;
+    int64_t resolutionMinutes = (spanMinutes + THINGSPEAK_RANGE_MAX_POINTS - 1) / THINGSPEAK_RANGE_MAX_POINTS;
+
+    return ThingSpeak::GetRangeResolution(static_cast<int>(resolutionMinutes));
+}
+
+/**
+ * @brief Seconds covered by one tile at a resolution
+ * 
+ * @param resolutionMinutes - Minutes per entry. THINGSPEAK_RANGE_RAW for raw entries
+ * 
+ * @return int64_t - Tile length in seconds
+ */
+int64_t ThingSpeakRangeCache::GetTileSeconds(int resolutionMinutes)
+{
+    if (resolutionMinutes == THINGSPEAK_RANGE_RAW)
+    {
+        return THINGSPEAK_RANGE_RAW_TILE_SECONDS;
+    }
+
+    return (static_cast<int64_t>(resolutionMinutes) * 60 * THINGSPEAK_RANGE_TILE_ENTRIES);
+}
+
+/**
+ * @brief Drop the least recently used tiles beyond THINGSPEAK_RANGE_CACHE_MAX_TILES.
+ *        Tiles used by the latest Require() and pending tiles are kept
+ * 
+ */
+void ThingSpeakRangeCache::Evict()
+{
+    while (tiles.size() > THINGSPEAK_RANGE_CACHE_MAX_TILES)
+    {
+        auto oldest = tiles.end();
+        for (auto tile = tiles.begin(); tile != tiles.end(); tile++)
+        {
+            if (!tile->second.pending && (tile->second.lastUsed < useCount) &&
+                ((oldest == tiles.end()) || (tile->second.lastUsed < oldest->second.lastUsed)))
+            {
+                oldest = tile;
+            }
+        }
+
+        if (oldest == tiles.end())
+        {
+            return;
+        }
+        tiles.erase(oldest);
+    }
+}
+
+/**
+ * @brief Create the key a tile is held under
+ * 
+ * @param channel - ThingSpeak API channel
+ * @param key - ThingSpeak API key
+ * @param range - Range of the tile
+ * 
+ * @return std::string - Key unique to the channel, range and resolution
+ */
+std::string ThingSpeakRangeCache::GetTileKey(std::string const & channel, std::string const & key,
+                                             ThingSpeakRange_t const & range)
+{
+    return (channel + "/" + key + "/" + std::to_string(range.resolutionMinutes) + "/" +
+            std::to_string(static_cast<int>(range.aggregate)) + "/" + std::to_string(range.start));
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+
+#include "ThingSpeak.h"
+
+#define THINGSPEAK_RANGE_CACHE_MAX_TILES     64      // Tiles held before the least recently used is dropped
+#define THINGSPEAK_RANGE_RAW_TILE_SECONDS    21600   // Raw entries are fetched 6 hours at a time
+#define THINGSPEAK_RANGE_TILE_ENTRIES        720     // Aggregated entries per tile
+#define THINGSPEAK_RANGE_RAW_MAX_SECONDS     43200   // Longest span shown with raw entries
+#define THINGSPEAK_RANGE_MAX_POINTS          1500    // Aggregated entries aimed for across a span
+#define THINGSPEAK_RANGE_MIN_REFRESH_S       60      // Tiles reaching the present are refetched after their resolution, at least this often
+#define THINGSPEAK_RANGE_RETRY_S             30      // Failed tiles are requested again after this
+
+typedef struct
+{
+    ThingSpeakRange_t range;
+    ThingSpeakSeries series;          // Entries of the range. Empty until fetched
+    bool fetched;                     // At least one fetch of the tile succeeded
+    bool pending;                     // Request in flight
+    int64_t expiresAt;                // UTC epoch seconds after which the tile is requested again
+    uint64_t lastUsed;
+} ThingSpeakRangeTile_t;
+
+/**
+ * Client-side copy of time ranges fetched with ThingSpeak::Fetch().
+ * 
+ * Ranges are split into fixed tiles aligned to multiples of the tile
+ * length, so panning or zooming only requests tiles not yet held, and the
+ * same range of a channel is never downloaded twice at one resolution.
+ * Raw tiles cover THINGSPEAK_RANGE_RAW_TILE_SECONDS; aggregated tiles
+ * cover THINGSPEAK_RANGE_TILE_ENTRIES intervals of their resolution, so
+ * each is one modest request whatever the resolution. Tiles reaching the
+ * present are requested again once a new interval may have completed.
+ * At most THINGSPEAK_RANGE_CACHE_MAX_TILES are held; the least recently
+ * used tile is dropped first.
+ * 
+ * Not thread-safe; owned by the render loop, which hands the missing ranges
+ * reported by Require() to a ThingSpeakFetcher and returns the results
+ * with Insert():
+ * 
+ *     cache.Require(thingSpeak.GetChannel(), thingSpeak.GetKey(), start, end,
+ *                   ThingSpeakRangeCache::ChooseResolution(end - start),
+ *                   ThingSpeakAggregate::Average, now, tiles, missing);
+ */
+class ThingSpeakRangeCache
+{
+public:
+    void Require(std::string const & channel, std::string const & key,
+                 int64_t start, int64_t end, int resolutionMinutes, ThingSpeakAggregate aggregate,
+                 int64_t now, std::vector<ThingSpeakRangeTile_t const *>& tiles,
+                 std::vector<ThingSpeakRange_t>& missing);
+    bool Insert(ThingSpeakFetchResult_t const & result, int64_t now);
+    void Clear();
+    int Size() const;
+
+    static int ChooseResolution(int64_t spanSeconds);
+    static int64_t GetTileSeconds(int resolutionMinutes);
+
+private:
+    // Member Variables
+    std::map<std::string, ThingSpeakRangeTile_t> tiles;
+    uint64_t useCount = 0;
+
+    // Member Functions
+    void Evict();
+    static std::string GetTileKey(std::string const & channel, std::string const & key,
+                                  ThingSpeakRange_t const & range);
+};
\ No newline at end of file
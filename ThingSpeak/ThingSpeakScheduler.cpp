@@ -0,0 +1,311 @@
+#include <algorithm>
+#include <iostream>
+
+#include "ThingSpeakScheduler.h"
+
+#define DEBUG_THINGSPEAK_SCHEDULER false
+
+/**
+ * @brief Create an empty scheduler with randomly seeded jitter
+ * 
+ */
+ThingSpeakScheduler::ThingSpeakScheduler() : ThingSpeakScheduler(std::random_device{}()) {}
+
+/**
+ * @brief Create an empty scheduler
+ * 
+ * @param seed - Seed of the jitter applied to every delay
+ */
+ThingSpeakScheduler::ThingSpeakScheduler(uint32_t seed) : random(seed) {}
+
+/**
+ * @brief Start scheduling a channel. It is first due almost immediately,
+ *        spread out from other channels added at the same time. Does
+ *        nothing if the channel is already scheduled
+ * 
+ * @param channel - ThingSpeak API channel
+ * @param key - ThingSpeak API key
+ * @param now - Current time
+ */
+void ThingSpeakScheduler::Add(std::string const & channel, std::string const & key,
+                              ThingSpeakSchedulerClock::time_point now)
+{
+    std::string id = GetId(channel, key);
+    if (schedules.contains(id))
+    {
+        return;
+    }
+
+    ThingSpeakSchedule_t& schedule = schedules[id];
+    schedule.channel = channel;
+    schedule.key = key;
+    schedule.interval = std::chrono::seconds(THINGSPEAK_SCHEDULER_DEFAULT_INTERVAL_S);
+    schedule.consecutiveFailures = 0;
+
+    std::uniform_int_distribution<int> spread(0, THINGSPEAK_SCHEDULER_STARTUP_SPREAD_MS);
+    Reschedule(schedule, std::chrono::milliseconds(spread(random)), now);
+}
+
+/**
+ * @brief Stop scheduling a channel
+ * 
+ * @param channel - ThingSpeak API channel
+ * @param key - ThingSpeak API key
+ */
+void ThingSpeakScheduler::Remove(std::string const & channel, std::string const & key)
+{
+    // Its node left in the queue no longer matches a schedule and is skipped
+    schedules.erase(GetId(channel, key));
+}
+
+/**
+ * @brief Determines if a channel is being scheduled
+ * 
+ * @param channel - ThingSpeak API channel
+ * @param key - ThingSpeak API key
+ * 
+ * @return True if the channel is scheduled. False otherwise
+ */
+bool ThingSpeakScheduler::Contains(std::string const & channel, std::string const & key) const
+{
+    return schedules.contains(GetId(channel, key));
+}
+
+/**
+ * @brief Take the next channel which is due for a refresh. The channel is
+ *        not due again until its result is reported through OnResult(), or
+ *        the request is presumed lost
+ * 
+ * @param now - Current time
+ * @param schedule - Filled with the schedule of the due channel
+ * 
+ * @return bool - True if a channel was due. False otherwise
+ */
+bool ThingSpeakScheduler::PopDue(ThingSpeakSchedulerClock::time_point now, ThingSpeakSchedule_t& schedule)
+{
+    DiscardStaleNodes();
+    if (dueQueue.empty() || (dueQueue.top().dueTime > now))
+    {
+        return false;
+    }
+
+    ThingSpeakSchedule_t& dueSchedule = schedules[dueQueue.top().id];
+    dueQueue.pop();
+
+    Reschedule(dueSchedule, std::chrono::seconds(THINGSPEAK_SCHEDULER_IN_FLIGHT_S), now);
+    schedule = dueSchedule;
+
+    return true;
+}
+
+/**
+ * @brief Skip a refresh of a channel which was due, e.g. because it is not
+ *        currently displayed. It is due again after its usual interval
+ * 
+ * @param channel - ThingSpeak API channel
+ * @param key - ThingSpeak API key
+ * @param now - Current time
+ */
+void ThingSpeakScheduler::Postpone(std::string const & channel, std::string const & key,
+                                   ThingSpeakSchedulerClock::time_point now)
+{
+    auto found = schedules.find(GetId(channel, key));
+    if (found == schedules.end())
+    {
+        return;
+    }
+
+    Reschedule(found->second, Jitter(found->second.interval), now);
+}
+
+/**
+ * @brief Schedule the next refresh of a channel from the result of its
+ *        last fetch
+ * 
+ * @param result - Result of fetching the channel
+ * @param thingSpeak - Object the result was applied to
+ * @param now - Current time
+ */
+void ThingSpeakScheduler::OnResult(ThingSpeakFetchResult_t const & result, ThingSpeak const & thingSpeak,
+                                   ThingSpeakSchedulerClock::time_point now)
+{
+    auto found = schedules.find(GetId(result.channel, result.key));
+    if (found == schedules.end())
+    {
+        return;
+    }
+
+    ThingSpeakSchedule_t& schedule = found->second;
+
+    if (!result.validDataFetched)
+    {
+        bool throttled = (result.statusCode == static_cast<long>(HttpStatusCode::TooManyRequests)) ||
+                         (result.statusCode == static_cast<long>(HttpStatusCode::ServiceUnavailable));
+
+        int64_t delay = throttled ? THINGSPEAK_SCHEDULER_THROTTLE_BACKOFF_S
+                                  : THINGSPEAK_SCHEDULER_ERROR_BACKOFF_S;
+        int shift = std::min(schedule.consecutiveFailures, 16);
+        delay = std::min<int64_t>((delay << shift), THINGSPEAK_SCHEDULER_MAX_BACKOFF_S);
+        schedule.consecutiveFailures++;
+
+        ThingSpeakSchedulerClock::duration backoff = Jitter(std::chrono::seconds(delay));
+        backoff = std::max<ThingSpeakSchedulerClock::duration>(backoff,
+                                                               std::chrono::seconds(result.retryAfterSeconds));
+
+        #if (DEBUG_THINGSPEAK_SCHEDULER)
+        std::cout << "Channel " << schedule.channel << " failed " << schedule.consecutiveFailures
+                  << " time(s), retrying in "
+                  << std::chrono::duration_cast<std::chrono::seconds>(backoff).count() << "s" << std::endl;
+        #endif
+
+        Reschedule(schedule, backoff, now);
+        return;
+    }
+
+    schedule.consecutiveFailures = 0;
+    schedule.interval = LearnInterval(thingSpeak.GetFeedData()->series, schedule.interval);
+
+    // Due shortly after the next entry is expected, but never sooner than
+    // ThingSpeak can update. An overdue entry is checked for again after a
+    // full interval, so a sensor which stopped reporting is not hammered
+    std::chrono::seconds delay = schedule.interval;
+    ThingSpeakFeedCursor_t lastEntry = thingSpeak.GetLastEntry();
+    if (lastEntry.entryId > 0)
+    {
+        int64_t currentTime = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        int64_t expectedTime = lastEntry.createdAt + schedule.interval.count() +
+                               THINGSPEAK_SCHEDULER_REPORT_LAG_S;
+
+        if (expectedTime > currentTime)
+        {
+            delay = std::chrono::seconds(std::clamp<int64_t>((expectedTime - currentTime),
+                                                              THINGSPEAK_SCHEDULER_MIN_INTERVAL_S,
+                                                              schedule.interval.count()));
+        }
+    }
+
+    #if (DEBUG_THINGSPEAK_SCHEDULER)
+    std::cout << "Channel " << schedule.channel << " updates every " << schedule.interval.count()
+              << "s, next refresh in " << delay.count() << "s" << std::endl;
+    #endif
+
+    Reschedule(schedule, Jitter(delay), now);
+}
+
+/**
+ * @brief Get the time the next channel is due. Used to decide how long the
+ *        caller may sleep
+ * 
+ * @return ThingSpeakSchedulerClock::time_point - Due time of the next
+ *         channel. time_point::max() if nothing is scheduled
+ */
+ThingSpeakSchedulerClock::time_point ThingSpeakScheduler::NextDueTime()
+{
+    DiscardStaleNodes();
+
+    return (dueQueue.empty() ? ThingSpeakSchedulerClock::time_point::max() : dueQueue.top().dueTime);
+}
+
+/**
+ * @brief Move a channel to a new position in the queue
+ * 
+ * @param schedule - Schedule of the channel
+ * @param delay - Time from now until the channel is due
+ * @param now - Current time
+ */
+void ThingSpeakScheduler::Reschedule(ThingSpeakSchedule_t& schedule, ThingSpeakSchedulerClock::duration delay,
+                                     ThingSpeakSchedulerClock::time_point now)
+{
+    // Any node already queued for the channel becomes stale
+    schedule.generation = nextGeneration++;
+    schedule.dueTime = now + delay;
+
+    dueQueue.push({schedule.dueTime, GetId(schedule.channel, schedule.key), schedule.generation});
+}
+
+/**
+ * @brief Pop nodes left behind by removed or rescheduled channels
+ * 
+ */
+void ThingSpeakScheduler::DiscardStaleNodes()
+{
+    while (!dueQueue.empty())
+    {
+        QueueNode_t const & node = dueQueue.top();
+
+        auto found = schedules.find(node.id);
+        if ((found != schedules.end()) && (found->second.generation == node.generation))
+        {
+            return;
+        }
+
+        dueQueue.pop();
+    }
+}
+
+/**
+ * @brief Randomly lengthen or shorten a delay so channels do not stay in step
+ * 
+ * @param delay - Nominal delay
+ * 
+ * @return ThingSpeakSchedulerClock::duration - Jittered delay
+ */
+ThingSpeakSchedulerClock::duration ThingSpeakScheduler::Jitter(ThingSpeakSchedulerClock::duration delay)
+{
+    std::uniform_real_distribution<double> scale((1.0 - THINGSPEAK_SCHEDULER_JITTER),
+                                                 (1.0 + THINGSPEAK_SCHEDULER_JITTER));
+
+    return std::chrono::duration_cast<ThingSpeakSchedulerClock::duration>(delay * scale(random));
+}
+
+/**
+ * @brief Estimate how often a channel reports from the spacing of its most
+ *        recent entries. The median is used so gaps from a sensor being
+ *        offline do not skew the estimate
+ * 
+ * @param series - Field data of the channel
+ * @param fallback - Returned if too few entries are held
+ * 
+ * @return std::chrono::seconds - Estimated time between entries
+ */
+std::chrono::seconds ThingSpeakScheduler::LearnInterval(ThingSpeakSeries const & series,
+                                                        std::chrono::seconds fallback)
+{
+    int64_t spacings[THINGSPEAK_SCHEDULER_NUM_SPACINGS];
+    int numSpacings = 0;
+
+    for (int i = (series.Size() - 1); (i > 0) && (numSpacings < THINGSPEAK_SCHEDULER_NUM_SPACINGS); i--)
+    {
+        int64_t spacing = series.Timestamp(i) - series.Timestamp(i - 1);
+        if (spacing > 0)
+        {
+            spacings[numSpacings++] = spacing;
+        }
+    }
+
+    if (numSpacings == 0)
+    {
+        return fallback;
+    }
+
+    std::nth_element(spacings, (spacings + (numSpacings / 2)), (spacings + numSpacings));
+    int64_t interval = std::clamp<int64_t>(spacings[numSpacings / 2],
+                                           THINGSPEAK_SCHEDULER_MIN_INTERVAL_S,
+                                           THINGSPEAK_SCHEDULER_MAX_INTERVAL_S);
+
+    return std::chrono::seconds(interval);
+}
+
+/**
+ * @brief Create the identifier a channel is scheduled under
+ * 
+ * @param channel - ThingSpeak API channel
+ * @param key - ThingSpeak API key
+ * 
+ * @return std::string - Identifier of the channel
+ */
+std::string ThingSpeakScheduler::GetId(std::string const & channel, std::string const & key)
+{
+    return (channel + "/" + key);
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+#include <queue>
+#include <chrono>
+#include <random>
+
+#include "ThingSpeak.h"
+
+#define THINGSPEAK_SCHEDULER_DEFAULT_INTERVAL_S   300    // Used until a channel's rate is learned
+#define THINGSPEAK_SCHEDULER_MIN_INTERVAL_S       15     // ThingSpeak's fastest update rate
+#define THINGSPEAK_SCHEDULER_MAX_INTERVAL_S       3600
+#define THINGSPEAK_SCHEDULER_REPORT_LAG_S         5      // Allowance for an entry to reach ThingSpeak
+#define THINGSPEAK_SCHEDULER_NUM_SPACINGS         16     // Entries used to learn a channel's rate
+#define THINGSPEAK_SCHEDULER_IN_FLIGHT_S          60     // Retry if a request never completes
+#define THINGSPEAK_SCHEDULER_ERROR_BACKOFF_S      15     // First retry after a failed request
+#define THINGSPEAK_SCHEDULER_THROTTLE_BACKOFF_S   60     // First retry after a 429/503
+#define THINGSPEAK_SCHEDULER_MAX_BACKOFF_S        1800
+#define THINGSPEAK_SCHEDULER_JITTER               0.1    // Delays vary by up to +/-10%
+#define THINGSPEAK_SCHEDULER_STARTUP_SPREAD_MS    2000   // Channels added together start this far apart at most
+
+typedef std::chrono::steady_clock ThingSpeakSchedulerClock;
+
+typedef struct
+{
+    std::string channel;
+    std::string key;
+
+    ThingSpeakSchedulerClock::time_point dueTime;
+    std::chrono::seconds interval;     // Learned spacing between the channel's entries
+    int consecutiveFailures;
+    uint64_t generation;               // Matches the channel's live node in the queue
+} ThingSpeakSchedule_t;
+
+/**
+ * Decides when each ThingSpeak channel is next refreshed.
+ * 
+ * Channels are kept in a priority queue ordered by their next due time.
+ * After a successful fetch, a channel is due shortly after its next entry
+ * is expected, based on the median spacing of its recent created_at
+ * timestamps. Failed fetches are retried with exponential backoff, starting
+ * later when ThingSpeak reports throttling (429/503) and honoring its
+ * Retry-After header. Every delay is jittered so channels drift apart
+ * rather than refreshing in bursts. Not thread-safe; owned by the render
+ * loop, which hands due channels to a ThingSpeakFetcher.
+ */
+class ThingSpeakScheduler
+{
+public:
+    ThingSpeakScheduler();
+    explicit ThingSpeakScheduler(uint32_t seed);
+
+    void Add(std::string const & channel, std::string const & key,
+             ThingSpeakSchedulerClock::time_point now);
+    void Remove(std::string const & channel, std::string const & key);
+    bool Contains(std::string const & channel, std::string const & key) const;
+
+    bool PopDue(ThingSpeakSchedulerClock::time_point now, ThingSpeakSchedule_t& schedule);
+    void Postpone(std::string const & channel, std::string const & key,
+                  ThingSpeakSchedulerClock::time_point now);
+    void OnResult(ThingSpeakFetchResult_t const & result, ThingSpeak const & thingSpeak,
+                  ThingSpeakSchedulerClock::time_point now);
+
+    ThingSpeakSchedulerClock::time_point NextDueTime();
+
+private:
+    typedef struct
+    {
+        ThingSpeakSchedulerClock::time_point dueTime;
+        std::string id;
+        uint64_t generation;
+    } QueueNode_t;
+
+    struct QueueNodeLater
+    {
+        bool operator()(QueueNode_t const & a, QueueNode_t const & b) const
+        {
+            return (a.dueTime > b.dueTime);
+        }
+    };
+
+    // Member Variables
+    std::map<std::string, ThingSpeakSchedule_t> schedules;
+    std::priority_queue<QueueNode_t, std::vector<QueueNode_t>, QueueNodeLater> dueQueue;
+    uint64_t nextGeneration = 1;
+    std::mt19937 random;
+
+    // Member Functions
+    void Reschedule(ThingSpeakSchedule_t& schedule, ThingSpeakSchedulerClock::duration delay,
+                    ThingSpeakSchedulerClock::time_point now);
+    void DiscardStaleNodes();
+    ThingSpeakSchedulerClock::duration Jitter(ThingSpeakSchedulerClock::duration delay);
+    static std::chrono::seconds LearnInterval(ThingSpeakSeries const & series,
+                                              std::chrono::seconds fallback);
+    static std::string GetId(std::string const & channel, std::string const & key);
+};
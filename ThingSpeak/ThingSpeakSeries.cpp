@@ -0,0 +1,295 @@
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <assert.h>
+
+#include "ThingSpeakSeries.h"
+
+static_assert(THINGSPEAK_NUM_FIELDS <= 8, "Validity of a sample's fields is stored in 8 bits");
+
+// Series are filled by the fetcher thread, so revisions are drawn atomically
+static std::atomic<uint64_t> nextRevision = 1;
+
+/**
+ * @brief Create an empty series. Storage is allocated as samples arrive
+ * 
+ * @param capacity - Maximum number of samples held before the oldest
+ *                   samples are overwritten
+ */
+ThingSpeakSeries::ThingSpeakSeries(int capacity) :
+    capacity(std::max(capacity, 1)), head(0), revision(0), generation(0), numAppended(0), presentFields(0) {}
+
+/**
+ * @brief Append a sample, overwriting the oldest sample if full
+ * 
+ * @param entryId - ThingSpeak entry ID of the sample
+ * @param timestamp - UTC epoch seconds the sample was captured
+ * @param fields - Field values of the sample. fields[N - 1] holds fieldN
+ * @param validFields - Bit (N - 1) set if fieldN was provided. Values of
+ *                      other fields are ignored
+ */
+void ThingSpeakSeries::Append(int64_t entryId, int64_t timestamp, float const * fields, uint32_t validFields)
+{
+    revision = nextRevision.fetch_add(1, std::memory_order_relaxed);
+    numAppended++;
+
+    float const missing = std::numeric_limits<float>::quiet_NaN();
+    bool full = (Size() == capacity);
+
+    // Back-fill the column of a field provided for the first time
+    uint32_t newFields = validFields & ~presentFields & ((1u << THINGSPEAK_NUM_FIELDS) - 1);
+    for (int f = 0; f < THINGSPEAK_NUM_FIELDS; f++)
+    {
+        if (newFields & (1u << f))
+        {
+            values[f].assign(entryIds.size(), missing);
+        }
+    }
+    presentFields |= newFields;
+
+    int slot = head;
+    if (!full)
+    {
+        slot = Size();
+        entryIds.push_back(entryId);
+        timestamps.push_back(timestamp);
+        sampleFields.push_back(static_cast<uint8_t>(validFields));
+    }
+    else
+    {
+        entryIds[slot] = entryId;
+        timestamps[slot] = timestamp;
+        sampleFields[slot] = static_cast<uint8_t>(validFields);
+
+        head = ((head + 1) == capacity) ? 0 : (head + 1);
+    }
+
+    for (int f = 0; f < THINGSPEAK_NUM_FIELDS; f++)
+    {
+        if (!(presentFields & (1u << f)))
+        {
+            continue;
+        }
+
+        float value = (validFields & (1u << f)) ? fields[f] : missing;
+        if (!full)
+        {
+            values[f].push_back(value);
+        }
+        else
+        {
+            values[f][slot] = value;
+        }
+    }
+}
+
+/**
+ * @brief Remove all samples. Capacity is unchanged
+ * 
+ */
+void ThingSpeakSeries::Clear()
+{
+    revision = nextRevision.fetch_add(1, std::memory_order_relaxed);
+    generation = revision;
+
+    head = 0;
+    numAppended = 0;
+    presentFields = 0;
+    entryIds.clear();
+    timestamps.clear();
+    sampleFields.clear();
+    for (auto& column : values)
+    {
+        column.clear();
+    }
+}
+
+/**
+ * @brief Change the maximum number of samples held. If reduced below the
+ *        current size, the oldest samples are discarded
+ * 
+ * @param newCapacity - Maximum number of samples to hold
+ */
+void ThingSpeakSeries::SetCapacity(int newCapacity)
+{
+    newCapacity = std::max(newCapacity, 1);
+    revision = nextRevision.fetch_add(1, std::memory_order_relaxed);
+
+    int numDropped = std::max(Size() - newCapacity, 0);
+
+    // Unwrap so the oldest sample is stored first
+    auto unwrap = [this, numDropped](auto& column) {
+        if (column.empty())
+        {
+            return;
+        }
+        std::rotate(column.begin(), column.begin() + head, column.end());
+        column.erase(column.begin(), column.begin() + numDropped);
+    };
+
+    unwrap(entryIds);
+    unwrap(timestamps);
+    unwrap(sampleFields);
+    for (auto& column : values)
+    {
+        unwrap(column);
+    }
+    head = 0;
+
+    capacity = newCapacity;
+}
+
+/**
+ * @brief Number of samples held
+ * 
+ * @return int - Number of samples
+ */
+int ThingSpeakSeries::Size() const { return static_cast<int>(entryIds.size()); }
+
+/**
+ * @brief Maximum number of samples held
+ * 
+ * @return int - Capacity of series
+ */
+int ThingSpeakSeries::Capacity() const { return capacity; }
+
+/**
+ * @brief Slot of the oldest sample within the raw columns. Used as the
+ *        offset argument of ImPlot plotting functions
+ * 
+ * @return int - Offset of oldest sample
+ */
+int ThingSpeakSeries::Offset() const { return head; }
+
+/**
+ * @brief Identifies the current contents of the series. Used by caches
+ *        derived from the series to detect when they are stale
+ * 
+ * @return uint64_t - Revision of the samples held. 0 if never modified
+ */
+uint64_t ThingSpeakSeries::Revision() const { return revision; }
+
+/**
+ * @brief Identifies the samples the series was filled with since it was
+ *        last cleared. Used by caches which are updated incrementally as
+ *        samples are appended, to detect when they must be rebuilt
+ * 
+ * @return uint64_t - Generation of the samples held. 0 if never cleared
+ */
+uint64_t ThingSpeakSeries::Generation() const { return generation; }
+
+/**
+ * @brief Number of samples appended since the series was last cleared,
+ *        including those since overwritten. The sample at index 0 was the
+ *        (NumAppended() - Size())th appended
+ * 
+ * @return int64_t - Number of samples appended
+ */
+int64_t ThingSpeakSeries::NumAppended() const { return numAppended; }
+
+/**
+ * @brief Determines if any sample held provided a field
+ * 
+ * @param fieldNumber - ThingSpeak field number (1 for field1)
+ * 
+ * @return True if the field has a value column. False otherwise
+ */
+bool ThingSpeakSeries::HasField(int fieldNumber) const
+{
+    int f = fieldNumber - THINGSPEAK_LOWEST_FIELD_NUMBER;
+
+    return ((f >= 0) && (f < THINGSPEAK_NUM_FIELDS) && (presentFields & (1u << f)));
+}
+
+/**
+ * @brief Get entry ID of a sample
+ * 
+ * @param index - Sample index. 0 is the oldest sample
+ * 
+ * @return int64_t - ThingSpeak entry ID
+ */
+int64_t ThingSpeakSeries::EntryId(int index) const { return entryIds[Slot(index)]; }
+
+/**
+ * @brief Get Date/Time a sample was captured
+ * 
+ * @param index - Sample index. 0 is the oldest sample
+ * 
+ * @return int64_t - UTC epoch seconds
+ */
+int64_t ThingSpeakSeries::Timestamp(int index) const { return timestamps[Slot(index)]; }
+
+/**
+ * @brief Get the fields provided by a sample
+ * 
+ * @param index - Sample index. 0 is the oldest sample
+ * 
+ * @return uint32_t - Bit (N - 1) set if the sample provided fieldN
+ */
+uint32_t ThingSpeakSeries::ValidFields(int index) const { return sampleFields[Slot(index)]; }
+
+/**
+ * @brief Get a field value of a sample
+ * 
+ * @param fieldNumber - ThingSpeak field number (1 for field1)
+ * @param index - Sample index. 0 is the oldest sample
+ * 
+ * @return float - Field value. NaN if the sample did not provide the field
+ */
+float ThingSpeakSeries::Value(int fieldNumber, int index) const
+{
+    if (!HasField(fieldNumber))
+    {
+        return std::numeric_limits<float>::quiet_NaN();
+    }
+
+    return values[fieldNumber - THINGSPEAK_LOWEST_FIELD_NUMBER][Slot(index)];
+}
+
+/**
+ * @brief Raw entry ID column. May be wrapped; see Offset()
+ * 
+ * @return int64_t const* - Entry ID column
+ */
+int64_t const * ThingSpeakSeries::EntryIds() const { return entryIds.data(); }
+
+/**
+ * @brief Raw timestamp column (UTC epoch seconds). May be wrapped; see Offset()
+ * 
+ * @return int64_t const* - Timestamp column
+ */
+int64_t const * ThingSpeakSeries::Timestamps() const { return timestamps.data(); }
+
+/**
+ * @brief Raw value column of a field. May be wrapped; see Offset()
+ * 
+ * @param fieldNumber - ThingSpeak field number (1 for field1)
+ * 
+ * @return float const* - Field value column. nullptr if no sample held
+ *                        provided the field
+ */
+float const * ThingSpeakSeries::Values(int fieldNumber) const
+{
+    if (!HasField(fieldNumber))
+    {
+        return nullptr;
+    }
+
+    return values[fieldNumber - THINGSPEAK_LOWEST_FIELD_NUMBER].data();
+}
+
+/**
+ * @brief Convert a sample index into its slot within the raw columns
+ * 
+ * @param index - Sample index. 0 is the oldest sample
+ * 
+ * @return int - Slot within columns
+ */
+int ThingSpeakSeries::Slot(int index) const
+{
+    assert((index >= 0) && (index < Size()));
+
+    int slot = head + index;
+
+    return ((slot >= capacity) ? (slot - capacity) : slot);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#define THINGSPEAK_SERIES_CAPACITY   8000   // Matches ThingSpeak's per-request limit
+
+#define THINGSPEAK_LOWEST_FIELD_NUMBER    1
+#define THINGSPEAK_HIGHEST_FIELD_NUMBER   8
+#define THINGSPEAK_NUM_FIELDS             (THINGSPEAK_HIGHEST_FIELD_NUMBER - THINGSPEAK_LOWEST_FIELD_NUMBER + 1)
+
+/**
+ * Growable ring buffer holding every field of a ThingSpeak feed as
+ * contiguous columns.
+ * 
+ * Entry IDs and timestamps are shared by all fields. Each of the eight
+ * fields has its own value column, allocated once a sample first provides
+ * that field; samples without a value for a field hold NaN there, and a
+ * per-sample bitmap records which fields were provided.
+ * 
+ * Columns grow on demand up to the configured capacity. Once full, new
+ * samples overwrite the oldest in O(1). Index 0 always refers to the oldest
+ * sample held. The raw columns may be wrapped; pass Offset() along with the
+ * column pointer to ImPlot so it reads them in order without copying:
+ * 
+ *     ImPlot::PlotLine(label, series.Values(fieldNumber), series.Size(),
+ *                      1.0, 0.0, ImPlotLineFlags_SkipNaN, series.Offset());
+ */
+class ThingSpeakSeries
+{
+public:
+    ThingSpeakSeries() : ThingSpeakSeries(THINGSPEAK_SERIES_CAPACITY) {}
+    explicit ThingSpeakSeries(int capacity);
+
+    void Append(int64_t entryId, int64_t timestamp, float const * fields, uint32_t validFields);
+    void Clear();
+    void SetCapacity(int capacity);
+
+    int Size() const;
+    int Capacity() const;
+    int Offset() const;
+    uint64_t Revision() const;
+    uint64_t Generation() const;
+    int64_t NumAppended() const;
+    bool HasField(int fieldNumber) const;
+
+    int64_t EntryId(int index) const;
+    int64_t Timestamp(int index) const;
+    uint32_t ValidFields(int index) const;
+    float Value(int fieldNumber, int index) const;
+
+    int64_t const * EntryIds() const;
+    int64_t const * Timestamps() const;
+    float const * Values(int fieldNumber) const;
+
+private:
+    // Member Variables
+    int capacity;
+    int head;   // Slot holding the oldest sample once the buffer has wrapped
+    uint64_t revision;   // Changes whenever samples change. Unique across series
+    uint64_t generation;   // Changes whenever samples are removed other than by wrapping
+    int64_t numAppended;   // Samples appended since the series was last cleared
+    uint32_t presentFields;   // Bit (N - 1) set if fieldN has a value column
+
+    std::vector<int64_t> entryIds;
+    std::vector<int64_t> timestamps;   // UTC epoch seconds
+    std::vector<uint8_t> sampleFields; // Bit (N - 1) set if sample provided fieldN
+    std::vector<float> values[THINGSPEAK_NUM_FIELDS];   // values[N - 1] holds fieldN
+
+    // Member Functions
+    int Slot(int index) const;
+};
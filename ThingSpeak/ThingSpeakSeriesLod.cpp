@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <cmath>
+
+#include "ThingSpeakSeriesLod.h"
+
+/**
+ * @brief Bring the envelope up to date with the series and visible range.
+ *        Does nothing if neither changed since the last call
+ * 
+ * @param series - Series to reduce
+ * @param rollup - Aggregates of the field to plot, up to date with the series
+ * @param xMin - Left X-axis limit of the plot, in samples
+ * @param xMax - Right X-axis limit of the plot, in samples
+ * @param numBuckets - Number of envelope buckets. Normally the plot width
+ *                     in pixels
+ */
+void ThingSpeakSeriesLod::Update(ThingSpeakSeries const & series, ThingSpeakSeriesRollup const & rollup,
+                                 double xMin, double xMax, int numBuckets)
+{
+    if (rollup.GetField() != field)
+    {
+        valid = false;
+        field = rollup.GetField();
+    }
+
+    int numDataPoints = series.Size();
+    numBuckets = std::max(numBuckets, 1);
+
+    // Include one sample past each edge so the line reaches the plot border
+    int first = 0;
+    int last = numDataPoints - 1;
+    if ((numDataPoints > 0) && std::isfinite(xMin) && std::isfinite(xMax))
+    {
+        first = static_cast<int>(std::clamp(std::floor(xMin) - 1.0, 0.0, static_cast<double>(last)));
+        last = static_cast<int>(std::clamp(std::ceil(xMax) + 1.0, 0.0, static_cast<double>(last)));
+    }
+
+    uint64_t revision = series.Revision();
+    if (valid && (envelopeRevision == revision) && (envelopeFirst == first) &&
+        (envelopeLast == last) && (envelopeBuckets == numBuckets))
+    {
+        return;
+    }
+
+    BuildEnvelope(series, rollup, first, last, numBuckets);
+
+    valid = true;
+    numBuilds++;
+    envelopeRevision = revision;
+    envelopeFirst = first;
+    envelopeLast = last;
+    envelopeBuckets = numBuckets;
+}
+
+/**
+ * @brief Force the envelope to be rebuilt on the next Update()
+ * 
+ */
+void ThingSpeakSeriesLod::Invalidate() { valid = false; }
+
+/**
+ * @brief Number of points in the envelope
+ * 
+ * @return int - Number of points
+ */
+int ThingSpeakSeriesLod::Size() const { return static_cast<int>(xs.size()); }
+
+/**
+ * @brief Identifies the current envelope. Changes whenever the envelope is
+ *        rebuilt, so anything derived from it can be kept until then
+ * 
+ * @return uint64_t - Revision of the envelope
+ */
+uint64_t ThingSpeakSeriesLod::Revision() const { return numBuilds; }
+
+/**
+ * @brief X coordinates (sample indices) of the envelope
+ * 
+ * @return double const* - X coordinates, in increasing order
+ */
+double const * ThingSpeakSeriesLod::Xs() const { return xs.data(); }
+
+/**
+ * @brief Y coordinates (field values) of the envelope
+ * 
+ * @return double const* - Y coordinates
+ */
+double const * ThingSpeakSeriesLod::Ys() const { return ys.data(); }
+
+/**
+ * @brief Rebuild the envelope over a range of samples. Ranges with no more
+ *        than two samples per bucket are copied unreduced
+ * 
+ * @param series - Series to reduce
+ * @param rollup - Aggregates of the plotted field
+ * @param first - First sample index to include
+ * @param last - Last sample index to include
+ * @param numBuckets - Number of buckets to reduce the range into
+ */
+void ThingSpeakSeriesLod::BuildEnvelope(ThingSpeakSeries const & series, ThingSpeakSeriesRollup const & rollup,
+                                        int first, int last, int numBuckets)
+{
+    xs.clear();
+    ys.clear();
+
+    int numDataPoints = last - first + 1;
+    if ((series.Size() == 0) || (numDataPoints <= 0))
+    {
+        return;
+    }
+
+    if (numDataPoints <= (2 * numBuckets))
+    {
+        for (int i = first; i <= last; i++)
+        {
+            AppendPoint(i, series.Value(field, i));
+        }
+        return;
+    }
+
+    for (int b = 0; b < numBuckets; b++)
+    {
+        int begin = first + static_cast<int>((static_cast<int64_t>(numDataPoints) * b) / numBuckets);
+        int end = first + static_cast<int>((static_cast<int64_t>(numDataPoints) * (b + 1)) / numBuckets);
+
+        ThingSpeakRollupSummary_t bucket = rollup.Query(series, begin, end);
+        if (bucket.numValues == 0)
+        {
+            continue;
+        }
+
+        // Emit extremes in sample order so the line does not double back
+        int lowIndex = std::min(bucket.minIndex, bucket.maxIndex);
+        int highIndex = std::max(bucket.minIndex, bucket.maxIndex);
+        float lowValue = (lowIndex == bucket.minIndex) ? bucket.minValue : bucket.maxValue;
+        float highValue = (highIndex == bucket.maxIndex) ? bucket.maxValue : bucket.minValue;
+
+        AppendPoint(lowIndex, lowValue);
+        if (highIndex != lowIndex)
+        {
+            AppendPoint(highIndex, highValue);
+        }
+    }
+}
+
+/**
+ * @brief Add a point to the envelope
+ * 
+ * @param index - Sample index of the point
+ * @param value - Field value of the point
+ */
+void ThingSpeakSeriesLod::AppendPoint(int index, float value)
+{
+    xs.push_back(static_cast<double>(index));
+    ys.push_back(static_cast<double>(value));
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "ThingSpeakSeries.h"
+#include "ThingSpeakSeriesRollup.h"
+
+/**
+ * Level-of-detail view of one field of a ThingSpeakSeries for plotting.
+ * 
+ * Reduces the visible range of a field to a min/max envelope with one
+ * bucket per pixel, so the number of segments drawn is bounded by the plot
+ * width rather than by the history held. Both extremes of every bucket are
+ * kept, so short spikes remain visible at any zoom level.
+ * 
+ * Each envelope bucket is reduced from the field's ThingSpeakSeriesRollup,
+ * which is maintained incrementally as samples arrive, so no pass over the
+ * whole series is made when new data is received. The envelope itself is
+ * only rebuilt when the series, visible range or plot width change. Points
+ * are plotted at x = sample index:
+ * 
+ *     rollup.Update(series, fieldNumber);
+ *     lod.Update(series, rollup, limits.X.Min, limits.X.Max, plotWidth);
+ *     ImPlot::PlotLine(label, lod.Xs(), lod.Ys(), lod.Size(), ImPlotLineFlags_SkipNaN);
+ */
+class ThingSpeakSeriesLod
+{
+public:
+    void Update(ThingSpeakSeries const & series, ThingSpeakSeriesRollup const & rollup,
+                double xMin, double xMax, int numBuckets);
+    void Invalidate();
+
+    int Size() const;
+    uint64_t Revision() const;
+    double const * Xs() const;
+    double const * Ys() const;
+
+private:
+    // Member Variables
+    bool valid = false;
+    int field = THINGSPEAK_LOWEST_FIELD_NUMBER;   // Field of the series the envelope follows
+    uint64_t envelopeRevision = 0;
+    int envelopeFirst = 0;
+    int envelopeLast = 0;
+    int envelopeBuckets = 0;
+    uint64_t numBuilds = 0;                       // Envelopes built, identifying the current one
+
+    std::vector<double> xs;
+    std::vector<double> ys;
+
+    // Member Functions
+    void BuildEnvelope(ThingSpeakSeries const & series, ThingSpeakSeriesRollup const & rollup,
+                       int first, int last, int numBuckets);
+    void AppendPoint(int index, float value);
+};
\ No newline at end of file
@@ -0,0 +1,288 @@
+#include <algorithm>
+#include <cmath>
+
+#include "ThingSpeakSeriesRollup.h"
+
+// Seconds covered by a bucket of each level
+static int64_t const rollupResolutions[THINGSPEAK_ROLLUP_NUM_LEVELS] = {60, 3600, 86400};
+
+/**
+ * @brief Fold a single value into a summary
+ * 
+ * @param summary - Summary to update
+ * @param index - Sample index of the value
+ * @param value - Field value. NaN values are excluded
+ */
+static void ThingSpeakRollupAddValue(ThingSpeakRollupSummary_t& summary, int index, float value)
+{
+    if (std::isnan(value))
+    {
+        return;
+    }
+
+    if ((summary.numValues == 0) || (value < summary.minValue))
+    {
+        summary.minValue = value;
+        summary.minIndex = index;
+    }
+    if ((summary.numValues == 0) || (value > summary.maxValue))
+    {
+        summary.maxValue = value;
+        summary.maxIndex = index;
+    }
+
+    summary.sum += value;
+    summary.numValues++;
+}
+
+/**
+ * @brief Fold a bucket lying entirely inside the queried range into a summary
+ * 
+ * @param summary - Summary to update
+ * @param bucket - Bucket to add
+ * @param firstHeldSample - Sample number of the series' sample at index 0
+ */
+static void ThingSpeakRollupAddBucket(ThingSpeakRollupSummary_t& summary,
+                                      ThingSpeakRollupBucket_t const & bucket, int64_t firstHeldSample)
+{
+    if (bucket.numValues == 0)
+    {
+        return;
+    }
+
+    if ((summary.numValues == 0) || (bucket.minValue < summary.minValue))
+    {
+        summary.minValue = bucket.minValue;
+        summary.minIndex = static_cast<int>(bucket.minSample - firstHeldSample);
+    }
+    if ((summary.numValues == 0) || (bucket.maxValue > summary.maxValue))
+    {
+        summary.maxValue = bucket.maxValue;
+        summary.maxIndex = static_cast<int>(bucket.maxSample - firstHeldSample);
+    }
+
+    summary.sum += bucket.sum;
+    summary.numValues += bucket.numValues;
+}
+
+/**
+ * @brief Bring the buckets up to date with the series. Only samples
+ *        appended since the last call are added, unless the series was
+ *        cleared or a different field is requested
+ * 
+ * @param series - Series to aggregate
+ * @param fieldNumber - ThingSpeak field number of the series to aggregate
+ */
+void ThingSpeakSeriesRollup::Update(ThingSpeakSeries const & series, int fieldNumber)
+{
+    if (fieldNumber != field)
+    {
+        valid = false;
+        field = fieldNumber;
+    }
+
+    int64_t firstHeldSample = series.NumAppended() - series.Size();
+
+    if (!valid || (generation != series.Generation()) || (numAppended > series.NumAppended()))
+    {
+        for (auto& level : levels)
+        {
+            level.clear();
+        }
+
+        valid = true;
+        generation = series.Generation();
+        numAppended = firstHeldSample;
+    }
+
+    // Samples overwritten before they were seen are skipped
+    for (int64_t s = std::max(numAppended, firstHeldSample); s < series.NumAppended(); s++)
+    {
+        int index = static_cast<int>(s - firstHeldSample);
+        Append(s, series.Timestamp(index), series.Value(field, index));
+    }
+    numAppended = series.NumAppended();
+
+    Evict(firstHeldSample);
+}
+
+/**
+ * @brief Force the buckets to be rebuilt on the next Update()
+ * 
+ */
+void ThingSpeakSeriesRollup::Invalidate() { valid = false; }
+
+/**
+ * @brief Summarize the field over a range of samples
+ * 
+ * @param series - Series the buckets were last updated from
+ * @param begin - First sample index of the range
+ * @param end - One past the last sample index of the range
+ * 
+ * @return ThingSpeakRollupSummary_t - Min, max, sum and number of values
+ */
+ThingSpeakRollupSummary_t ThingSpeakSeriesRollup::Query(ThingSpeakSeries const & series, int begin, int end) const
+{
+    ThingSpeakRollupSummary_t summary = {0, 0.0f, 0.0f, -1, -1, 0.0};
+
+    begin = std::max(begin, 0);
+    end = std::min(end, series.Size());
+    if (!valid || (begin >= end))
+    {
+        return summary;
+    }
+
+    int64_t firstHeldSample = series.NumAppended() - series.Size();
+    QueryLevel(series, (THINGSPEAK_ROLLUP_NUM_LEVELS - 1),
+               (firstHeldSample + begin), (firstHeldSample + end), summary);
+
+    return summary;
+}
+
+/**
+ * @brief Returns the field the buckets aggregate
+ * 
+ * @return int - ThingSpeak field number
+ */
+int ThingSpeakSeriesRollup::GetField() const { return field; }
+
+/**
+ * @brief Number of buckets held by a level
+ * 
+ * @param level - Level of buckets. 0 is the finest
+ * 
+ * @return int - Number of buckets
+ */
+int ThingSpeakSeriesRollup::NumBuckets(int level) const { return static_cast<int>(levels[level].size()); }
+
+/**
+ * @brief Seconds covered by each bucket of a level
+ * 
+ * @param level - Level of buckets. 0 is the finest
+ * 
+ * @return int64_t - Bucket resolution in seconds
+ */
+int64_t ThingSpeakSeriesRollup::GetResolution(int level) { return rollupResolutions[level]; }
+
+/**
+ * @brief Add a sample to the newest bucket of each level, or start a new
+ *        bucket once the sample falls in the next minute/hour/day
+ * 
+ * @param sampleNumber - Sample number of the sample
+ * @param timestamp - UTC epoch seconds the sample was captured
+ * @param value - Field value of the sample. NaN if not provided
+ */
+void ThingSpeakSeriesRollup::Append(int64_t sampleNumber, int64_t timestamp, float value)
+{
+    bool hasValue = !std::isnan(value);
+
+    for (int k = 0; k < THINGSPEAK_ROLLUP_NUM_LEVELS; k++)
+    {
+        std::deque<ThingSpeakRollupBucket_t>& level = levels[k];
+        int64_t key = timestamp / rollupResolutions[k];
+
+        // Buckets only ever cover consecutive samples
+        if (level.empty() || (level.back().key != key) ||
+            ((level.back().firstSample + level.back().numSamples) != sampleNumber))
+        {
+            level.push_back({key, sampleNumber, 0, 0, 0.0f, 0.0f, -1, -1, 0.0});
+        }
+
+        ThingSpeakRollupBucket_t& bucket = level.back();
+        bucket.numSamples++;
+        if (!hasValue)
+        {
+            continue;
+        }
+
+        if ((bucket.numValues == 0) || (value < bucket.minValue))
+        {
+            bucket.minValue = value;
+            bucket.minSample = sampleNumber;
+        }
+        if ((bucket.numValues == 0) || (value > bucket.maxValue))
+        {
+            bucket.maxValue = value;
+            bucket.maxSample = sampleNumber;
+        }
+        bucket.sum += value;
+        bucket.numValues++;
+    }
+}
+
+/**
+ * @brief Drop buckets whose samples have all been overwritten. A bucket
+ *        whose older samples were overwritten is kept, but is never used
+ *        whole by a query
+ * 
+ * @param firstHeldSample - Sample number of the series' sample at index 0
+ */
+void ThingSpeakSeriesRollup::Evict(int64_t firstHeldSample)
+{
+    for (auto& level : levels)
+    {
+        while (!level.empty() && ((level.front().firstSample + level.front().numSamples) <= firstHeldSample))
+        {
+            level.pop_front();
+        }
+    }
+}
+
+/**
+ * @brief Summarize a range of samples using the buckets of a level. Buckets
+ *        only partially inside the range are summarized from the next finer
+ *        level, or from raw samples below the finest level
+ * 
+ * @param series - Series the buckets were last updated from
+ * @param level - Level of buckets to use. -1 for raw samples
+ * @param begin - Sample number of the first sample of the range
+ * @param end - One past the sample number of the last sample of the range
+ * @param summary - Summary to add the range to
+ */
+void ThingSpeakSeriesRollup::QueryLevel(ThingSpeakSeries const & series, int level, int64_t begin, int64_t end,
+                                        ThingSpeakRollupSummary_t& summary) const
+{
+    int64_t firstHeldSample = series.NumAppended() - series.Size();
+
+    if (level < 0)
+    {
+        for (int64_t s = begin; s < end; s++)
+        {
+            int index = static_cast<int>(s - firstHeldSample);
+            ThingSpeakRollupAddValue(summary, index, series.Value(field, index));
+        }
+        return;
+    }
+
+    std::deque<ThingSpeakRollupBucket_t> const & buckets = levels[level];
+
+    // Start from the bucket holding the first sample of the range
+    auto bucket = std::upper_bound(buckets.begin(), buckets.end(), begin,
+                                   [](int64_t sample, ThingSpeakRollupBucket_t const & b) {
+                                       return (sample < b.firstSample);
+                                   });
+    if (bucket != buckets.begin())
+    {
+        bucket--;
+    }
+
+    for (; (bucket != buckets.end()) && (bucket->firstSample < end); bucket++)
+    {
+        int64_t bucketEnd = bucket->firstSample + bucket->numSamples;
+        if (bucketEnd <= begin)
+        {
+            continue;
+        }
+
+        // Partially overwritten buckets start before the first held sample
+        if ((bucket->firstSample >= begin) && (bucketEnd <= end))
+        {
+            ThingSpeakRollupAddBucket(summary, *bucket, firstHeldSample);
+        }
+        else
+        {
+            QueryLevel(series, (level - 1), std::max(begin, bucket->firstSample),
+                       std::min(end, bucketEnd), summary);
+        }
+    }
+}
\ No newline at end of file
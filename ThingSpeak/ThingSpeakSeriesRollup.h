@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+
+#include "ThingSpeakSeries.h"
+
+#define THINGSPEAK_ROLLUP_NUM_LEVELS   3   // Minute, hour and day buckets
+
+typedef struct
+{
+    int64_t key;             // Timestamp of the bucket's samples divided by the level's resolution
+    int64_t firstSample;     // Sample number (see ThingSpeakSeries::NumAppended()) of the first sample
+    int32_t numSamples;
+    int32_t numValues;       // Samples which provided the field
+    float minValue;
+    float maxValue;
+    int64_t minSample;       // Sample number of minValue
+    int64_t maxSample;       // Sample number of maxValue
+    double sum;
+} ThingSpeakRollupBucket_t;
+
+typedef struct
+{
+    int numValues;           // Samples in the range which provided the field. 0 if none
+    float minValue;
+    float maxValue;
+    int minIndex;            // Sample index of minValue. -1 if no values
+    int maxIndex;            // Sample index of maxValue. -1 if no values
+    double sum;
+} ThingSpeakRollupSummary_t;
+
+/**
+ * Minute, hour and day aggregates of one field of a ThingSpeakSeries.
+ * 
+ * Each level holds a bucket per calendar minute/hour/day (UTC) containing
+ * samples, with the min, max, sum and number of the field's values. Since
+ * samples are ordered by time, every bucket covers a contiguous run of
+ * samples. Buckets are maintained incrementally: Update() only folds in
+ * samples appended since the previous call and drops buckets whose samples
+ * have all been overwritten, so an incoming entry costs O(1) per level.
+ * 
+ * Query() summarizes a range of sample indices from the coarsest buckets
+ * lying entirely inside it, descending to finer levels and finally raw
+ * samples only at the edges of the range. Its cost is therefore bounded by
+ * the number of buckets spanned rather than the number of samples:
+ * 
+ *     rollup.Update(series, fieldNumber);
+ *     ThingSpeakRollupSummary_t visible = rollup.Query(series, first, last + 1);
+ */
+class ThingSpeakSeriesRollup
+{
+public:
+    void Update(ThingSpeakSeries const & series, int fieldNumber);
+    void Invalidate();
+
+    ThingSpeakRollupSummary_t Query(ThingSpeakSeries const & series, int begin, int end) const;
+    int GetField() const;
+    int NumBuckets(int level) const;
+
+    static int64_t GetResolution(int level);
+
+private:
+    // Member Variables
+    bool valid = false;
+    int field = THINGSPEAK_LOWEST_FIELD_NUMBER;   // Field of the series the buckets follow
+    uint64_t generation = 0;
+    int64_t numAppended = 0;                      // Samples of the series folded into the buckets
+
+    std::deque<ThingSpeakRollupBucket_t> levels[THINGSPEAK_ROLLUP_NUM_LEVELS];   // levels[0] holds minutes
+
+    // Member Functions
+    void Append(int64_t sampleNumber, int64_t timestamp, float value);
+    void Evict(int64_t firstHeldSample);
+    void QueryLevel(ThingSpeakSeries const & series, int level, int64_t begin, int64_t end,
+                    ThingSpeakRollupSummary_t& summary) const;
+};
\ No newline at end of file
@@ -0,0 +1,395 @@
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+
+#include "ThingSpeakSeriesStats.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define THINGSPEAK_STATS_X86   true
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define THINGSPEAK_STATS_AVX2_TARGET
+#else
+#define THINGSPEAK_STATS_AVX2_TARGET   __attribute__((target("avx2")))
+#endif
+#else
+#define THINGSPEAK_STATS_X86   false
+#endif
+
+/**
+ * @brief Statistics accumulated over no values
+ * 
+ * @return ThingSpeakSeriesStats_t - Empty statistics, ready to merge into
+ */
+static ThingSpeakSeriesStats_t ThingSpeakEmptyStats()
+{
+    return {0, FLT_MAX, -FLT_MAX, 0.0, 0.0};
+}
+
+/**
+ * @brief Accumulate values one at a time. Also finishes the values left
+ *        over by the vector kernels
+ * 
+ * @param values - Contiguous values. NaN values are skipped
+ * @param numValues - Number of values
+ * @param stats - Statistics to accumulate into
+ */
+static void ThingSpeakStatsScalar(float const * values, int numValues, ThingSpeakSeriesStats_t& stats)
+{
+    for (int i = 0; i < numValues; i++)
+    {
+        float value = values[i];
+        if (std::isnan(value))
+        {
+            continue;
+        }
+
+        stats.numValues++;
+        stats.minValue = std::min(value, stats.minValue);
+        stats.maxValue = std::max(value, stats.maxValue);
+        stats.sum += value;
+        stats.sumSquares += static_cast<double>(value) * value;
+    }
+}
+
+#if (THINGSPEAK_STATS_X86)
+/**
+ * @brief Accumulate values 4 at a time with SSE2. NaN lanes are replaced
+ *        by values which leave the min/max/sums unchanged rather than
+ *        branched around
+ * 
+ * @param values - Contiguous values. NaN values are skipped
+ * @param numValues - Number of values
+ * @param stats - Statistics to accumulate into
+ */
+static void ThingSpeakStatsSse2(float const * values, int numValues, ThingSpeakSeriesStats_t& stats)
+{
+    __m128 const highest = _mm_set1_ps(FLT_MAX);
+    __m128 const lowest = _mm_set1_ps(-FLT_MAX);
+    __m128 minimum = highest;
+    __m128 maximum = lowest;
+    __m128d sumLow = _mm_setzero_pd();
+    __m128d sumHigh = _mm_setzero_pd();
+    __m128d squaresLow = _mm_setzero_pd();
+    __m128d squaresHigh = _mm_setzero_pd();
+    __m128i counts = _mm_setzero_si128();
+
+    int i = 0;
+    for (; (i + 4) <= numValues; i += 4)
+    {
+        __m128 value = _mm_loadu_ps(values + i);
+        __m128 valid = _mm_cmpord_ps(value, value);
+        __m128 validValue = _mm_and_ps(valid, value);
+
+        minimum = _mm_min_ps(minimum, _mm_or_ps(validValue, _mm_andnot_ps(valid, highest)));
+        maximum = _mm_max_ps(maximum, _mm_or_ps(validValue, _mm_andnot_ps(valid, lowest)));
+        counts = _mm_sub_epi32(counts, _mm_castps_si128(valid));   // Valid lanes are all ones, i.e. -1
+
+        // Summed as doubles; float sums of squares lose the deviation
+        __m128d low = _mm_cvtps_pd(validValue);
+        __m128d high = _mm_cvtps_pd(_mm_movehl_ps(validValue, validValue));
+        sumLow = _mm_add_pd(sumLow, low);
+        sumHigh = _mm_add_pd(sumHigh, high);
+        squaresLow = _mm_add_pd(squaresLow, _mm_mul_pd(low, low));
+        squaresHigh = _mm_add_pd(squaresHigh, _mm_mul_pd(high, high));
+    }
+
+    alignas(16) float minimums[4];
+    alignas(16) float maximums[4];
+    alignas(16) double sums[2];
+    alignas(16) double squares[2];
+    alignas(16) int32_t numValid[4];
+    _mm_store_ps(minimums, minimum);
+    _mm_store_ps(maximums, maximum);
+    _mm_store_pd(sums, _mm_add_pd(sumLow, sumHigh));
+    _mm_store_pd(squares, _mm_add_pd(squaresLow, squaresHigh));
+    _mm_store_si128(reinterpret_cast<__m128i*>(numValid), counts);
+
+    stats.numValues += (numValid[0] + numValid[1]) + (numValid[2] + numValid[3]);
+    stats.minValue = std::min({stats.minValue, minimums[0], minimums[1], minimums[2], minimums[3]});
+    stats.maxValue = std::max({stats.maxValue, maximums[0], maximums[1], maximums[2], maximums[3]});
+    stats.sum += sums[0] + sums[1];
+    stats.sumSquares += squares[0] + squares[1];
+
+    ThingSpeakStatsScalar((values + i), (numValues - i), stats);
+}
+
+/**
+ * @brief Accumulate values 8 at a time with AVX2. See ThingSpeakStatsSse2()
+ * 
+ * @param values - Contiguous values. NaN values are skipped
+ * @param numValues - Number of values
+ * @param stats - Statistics to accumulate into
+ */
+THINGSPEAK_STATS_AVX2_TARGET
+static void ThingSpeakStatsAvx2(float const * values, int numValues, ThingSpeakSeriesStats_t& stats)
+{
+    __m256 const highest = _mm256_set1_ps(FLT_MAX);
+    __m256 const lowest = _mm256_set1_ps(-FLT_MAX);
+    __m256 minimum = highest;
+    __m256 maximum = lowest;
+    __m256d sumLow = _mm256_setzero_pd();
+    __m256d sumHigh = _mm256_setzero_pd();
+    __m256d squaresLow = _mm256_setzero_pd();
+    __m256d squaresHigh = _mm256_setzero_pd();
+    __m256i counts = _mm256_setzero_si256();
+
+    int i = 0;
+    for (; (i + 8) <= numValues; i += 8)
+    {
+        __m256 value = _mm256_loadu_ps(values + i);
+        __m256 valid = _mm256_cmp_ps(value, value, _CMP_ORD_Q);
+        __m256 validValue = _mm256_and_ps(valid, value);
+
+        minimum = _mm256_min_ps(minimum, _mm256_blendv_ps(highest, value, valid));
+        maximum = _mm256_max_ps(maximum, _mm256_blendv_ps(lowest, value, valid));
+        counts = _mm256_sub_epi32(counts, _mm256_castps_si256(valid));
+
+        __m256d low = _mm256_cvtps_pd(_mm256_castps256_ps128(validValue));
+        __m256d high = _mm256_cvtps_pd(_mm256_extractf128_ps(validValue, 1));
+        sumLow = _mm256_add_pd(sumLow, low);
+        sumHigh = _mm256_add_pd(sumHigh, high);
+        squaresLow = _mm256_add_pd(squaresLow, _mm256_mul_pd(low, low));
+        squaresHigh = _mm256_add_pd(squaresHigh, _mm256_mul_pd(high, high));
+    }
+
+    alignas(32) float minimums[8];
+    alignas(32) float maximums[8];
+    alignas(32) double sums[4];
+    alignas(32) double squares[4];
+    alignas(32) int32_t numValid[8];
+    _mm256_store_ps(minimums, minimum);
+    _mm256_store_ps(maximums, maximum);
+    _mm256_store_pd(sums, _mm256_add_pd(sumLow, sumHigh));
+    _mm256_store_pd(squares, _mm256_add_pd(squaresLow, squaresHigh));
+    _mm256_store_si256(reinterpret_cast<__m256i*>(numValid), counts);
+
+    stats.numValues += (numValid[0] + numValid[1] + numValid[2] + numValid[3]) +
+                       (numValid[4] + numValid[5] + numValid[6] + numValid[7]);
+    stats.minValue = std::min(stats.minValue, *std::min_element(minimums, (minimums + 8)));
+    stats.maxValue = std::max(stats.maxValue, *std::max_element(maximums, (maximums + 8)));
+    stats.sum += (sums[0] + sums[1]) + (sums[2] + sums[3]);
+    stats.sumSquares += (squares[0] + squares[1]) + (squares[2] + squares[3]);
+
+    ThingSpeakStatsScalar((values + i), (numValues - i), stats);
+}
+#endif
+
+/**
+ * @brief Determine if the CPU and OS support a kernel
+ * 
+ * @param kernel - Kernel to check
+ * 
+ * @return bool - True if the kernel may be used
+ */
+static bool ThingSpeakStatsKernelSupported(ThingSpeakStatsKernel kernel)
+{
+    #if (THINGSPEAK_STATS_X86)
+    switch (kernel)
+    {
+        case ThingSpeakStatsKernel::Avx2:
+        {
+            #ifdef _MSC_VER
+            // AVX2 also needs the OS to save the YMM registers (XCR0 bits 1-2)
+            int info[4];
+            __cpuid(info, 0);
+            if (info[0] < 7)
+            {
+                return false;
+            }
+            __cpuid(info, 1);
+            bool osSavesYmm = ((info[2] & (1 << 27)) != 0) && ((info[2] & (1 << 28)) != 0) &&
+                              ((_xgetbv(0) & 0x6) == 0x6);
+            __cpuidex(info, 7, 0);
+            return (osSavesYmm && ((info[1] & (1 << 5)) != 0));
+            #else
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+            #endif
+        }
+        default:
+            // SSE2 is part of every x86-64 CPU
+            return true;
+    }
+    #else
+    return (kernel == ThingSpeakStatsKernel::Scalar);
+    #endif
+}
+
+/**
+ * @brief Kernel used by every statistics call. Chosen on first use
+ * 
+ * @return std::atomic<ThingSpeakStatsKernel>& - Kernel in use
+ */
+static std::atomic<ThingSpeakStatsKernel>& ThingSpeakStatsKernelInUse()
+{
+    static std::atomic<ThingSpeakStatsKernel> kernel =
+        ThingSpeakStatsKernelSupported(ThingSpeakStatsKernel::Avx2) ? ThingSpeakStatsKernel::Avx2 :
+        ThingSpeakStatsKernelSupported(ThingSpeakStatsKernel::Sse2) ? ThingSpeakStatsKernel::Sse2 :
+                                                                      ThingSpeakStatsKernel::Scalar;
+
+    return kernel;
+}
+
+/**
+ * @brief Summarize a range of sample indices of a field
+ * 
+ * @param series - Series holding the field
+ * @param fieldNumber - ThingSpeak field number (1 for field1)
+ * @param begin - Index of the first sample
+ * @param end - Index one past the last sample. Clamped to the series
+ * 
+ * @return ThingSpeakSeriesStats_t - Statistics of the values within the range
+ */
+ThingSpeakSeriesStats_t ThingSpeakGetSeriesStats(ThingSpeakSeries const & series, int fieldNumber,
+                                                 int begin, int end)
+{
+    ThingSpeakSeriesStats_t stats = ThingSpeakEmptyStats();
+
+    float const * values = series.Values(fieldNumber);
+    begin = std::max(begin, 0);
+    end = std::min(end, series.Size());
+    if ((values == nullptr) || (begin >= end))
+    {
+        return stats;
+    }
+
+    // Index 0 is held at Offset(); the range may wrap past the last slot
+    int first = series.Offset() + begin;
+    if (first >= series.Capacity())
+    {
+        first -= series.Capacity();
+    }
+    int numValues = end - begin;
+    int numUnwrapped = std::min(numValues, (series.Capacity() - first));
+
+    ThingSpeakMergeStats(stats, ThingSpeakGetStats((values + first), numUnwrapped));
+    if (numUnwrapped < numValues)
+    {
+        ThingSpeakMergeStats(stats, ThingSpeakGetStats(values, (numValues - numUnwrapped)));
+    }
+
+    return stats;
+}
+
+/**
+ * @brief Summarize contiguous values with the kernel in use
+ * 
+ * @param values - Contiguous values. NaN values are skipped
+ * @param numValues - Number of values
+ * 
+ * @return ThingSpeakSeriesStats_t - Statistics of the values
+ */
+ThingSpeakSeriesStats_t ThingSpeakGetStats(float const * values, int numValues)
+{
+    ThingSpeakSeriesStats_t stats = ThingSpeakEmptyStats();
+
+    switch (ThingSpeakStatsKernelInUse().load(std::memory_order_relaxed))
+    {
+        #if (THINGSPEAK_STATS_X86)
+        case ThingSpeakStatsKernel::Avx2: ThingSpeakStatsAvx2(values, numValues, stats); break;
+        case ThingSpeakStatsKernel::Sse2: ThingSpeakStatsSse2(values, numValues, stats); break;
+        #endif
+        default:                          ThingSpeakStatsScalar(values, numValues, stats); break;
+    }
+
+    return stats;
+}
+
+/**
+ * @brief Combine the statistics of two sets of values, e.g. of several
+ *        series plotted together
+ * 
+ * @param stats - Statistics to update
+ * @param other - Statistics to combine into them
+ */
+void ThingSpeakMergeStats(ThingSpeakSeriesStats_t& stats, ThingSpeakSeriesStats_t const & other)
+{
+    stats.numValues += other.numValues;
+    stats.minValue = std::min(stats.minValue, other.minValue);
+    stats.maxValue = std::max(stats.maxValue, other.maxValue);
+    stats.sum += other.sum;
+    stats.sumSquares += other.sumSquares;
+}
+
+/**
+ * @brief Mean of the values summarized
+ * 
+ * @param stats - Statistics of the values
+ * 
+ * @return double - Mean. 0 if no values
+ */
+double ThingSpeakGetMean(ThingSpeakSeriesStats_t const & stats)
+{
+    return ((stats.numValues > 0) ? (stats.sum / stats.numValues) : 0.0);
+}
+
+/**
+ * @brief Sample standard deviation of the values summarized
+ * 
+ * @param stats - Statistics of the values
+ * 
+ * @return double - Standard deviation. 0 if fewer than 2 values
+ */
+double ThingSpeakGetStdDev(ThingSpeakSeriesStats_t const & stats)
+{
+    if (stats.numValues < 2)
+    {
+        return 0.0;
+    }
+
+    // Rounding may leave a constant series slightly negative
+    double squaredDeviations = stats.sumSquares - ((stats.sum * stats.sum) / stats.numValues);
+
+    return std::sqrt(std::max(squaredDeviations, 0.0) / (stats.numValues - 1));
+}
+
+/**
+ * @brief Get the kernel statistics are computed with
+ * 
+ * @return ThingSpeakStatsKernel - Widest kernel supported, unless overridden
+ *                                 by ThingSpeakSetStatsKernel()
+ */
+ThingSpeakStatsKernel ThingSpeakGetStatsKernel()
+{
+    return ThingSpeakStatsKernelInUse().load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Override the kernel statistics are computed with, e.g. to compare
+ *        kernels in a benchmark
+ * 
+ * @param kernel - Kernel to use
+ * 
+ * @return bool - True if set. False if the CPU does not support the kernel
+ */
+bool ThingSpeakSetStatsKernel(ThingSpeakStatsKernel kernel)
+{
+    if (!ThingSpeakStatsKernelSupported(kernel))
+    {
+        return false;
+    }
+
+    ThingSpeakStatsKernelInUse().store(kernel, std::memory_order_relaxed);
+
+    return true;
+}
+
+/**
+ * @brief Get the name of a kernel, e.g. for diagnostics
+ * 
+ * @param kernel - Kernel to name
+ * 
+ * @return char const* - "Scalar", "SSE2" or "AVX2"
+ */
+char const * ThingSpeakGetStatsKernelName(ThingSpeakStatsKernel kernel)
+{
+    switch (kernel)
+    {
+        case ThingSpeakStatsKernel::Avx2: return "AVX2";
+        case ThingSpeakStatsKernel::Sse2: return "SSE2";
+        default:                          return "Scalar";
+    }
+}
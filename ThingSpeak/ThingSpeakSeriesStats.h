@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+#include "ThingSpeakSeries.h"
+
+enum class ThingSpeakStatsKernel
+{
+    Scalar,
+    Sse2,      // 4 values per step
+    Avx2       // 8 values per step
+};
+
+typedef struct
+{
+    int numValues;           // Values which were not NaN. 0 if none
+    float minValue;          // FLT_MAX if no values
+    float maxValue;          // -FLT_MAX if no values
+    double sum;
+    double sumSquares;
+} ThingSpeakSeriesStats_t;
+
+// Statistics of the values of a field within a range of sample indices
+// [begin, end), skipping the NaN gaps of samples without the field. A
+// wrapped range is summarized as its two contiguous runs of the column.
+// Values are scanned with the widest kernel the CPU supports, chosen once
+// at startup, and summed in double precision so the deviation holds up
+// over a full series:
+//
+//     ThingSpeakSeriesStats_t stats = ThingSpeakGetSeriesStats(series, fieldNumber, first, last + 1);
+//     double deviation = ThingSpeakGetStdDev(stats);
+ThingSpeakSeriesStats_t ThingSpeakGetSeriesStats(ThingSpeakSeries const & series, int fieldNumber,
+                                                 int begin, int end);
+ThingSpeakSeriesStats_t ThingSpeakGetStats(float const * values, int numValues);
+void ThingSpeakMergeStats(ThingSpeakSeriesStats_t& stats, ThingSpeakSeriesStats_t const & other);
+double ThingSpeakGetMean(ThingSpeakSeriesStats_t const & stats);
+double ThingSpeakGetStdDev(ThingSpeakSeriesStats_t const & stats);
+
+ThingSpeakStatsKernel ThingSpeakGetStatsKernel();
+bool ThingSpeakSetStatsKernel(ThingSpeakStatsKernel kernel);
+char const * ThingSpeakGetStatsKernelName(ThingSpeakStatsKernel kernel);
@@ -0,0 +1,234 @@
+#include <iostream>
+#include <stdexcept>
+
+#include "ThingSpeakTime.h"
+
+#define SECONDS_PER_MINUTE    60
+#define SECONDS_PER_HOUR      3600
+#define SECONDS_PER_DAY       86400
+
+/**
+ * @brief Convert a civil (proleptic Gregorian) date into days since the
+ *        Unix epoch
+ * 
+ * @param year - Year (e.g. 2024)
+ * @param month - Month [1, 12]
+ * @param day - Day of month [1, 31]
+ * 
+ * @return int64_t - Days since 1970-01-01
+ */
+static int64_t DaysFromCivil(int64_t year, unsigned month, unsigned day)
+{
+    year -= (month <= 2);
+
+    int64_t const era = ((year >= 0) ? year : (year - 399)) / 400;
+    unsigned const yearOfEra = static_cast<unsigned>(year - (era * 400));
+    unsigned const dayOfYear = (153 * ((month > 2) ? (month - 3) : (month + 9)) + 2) / 5 + day - 1;
+    unsigned const dayOfEra = (yearOfEra * 365) + (yearOfEra / 4) - (yearOfEra / 100) + dayOfYear;
+
+    return (era * 146097) + static_cast<int64_t>(dayOfEra) - 719468;
+}
+
+/**
+ * @brief Convert days since the Unix epoch into a civil (proleptic
+ *        Gregorian) date
+ * 
+ * @param days - Days since 1970-01-01
+ * @param year - Resulting year
+ * @param month - Resulting month [1, 12]
+ * @param day - Resulting day of month [1, 31]
+ */
+static void CivilFromDays(int64_t days, int64_t& year, unsigned& month, unsigned& day)
+{
+    days += 719468;
+
+    int64_t const era = ((days >= 0) ? days : (days - 146096)) / 146097;
+    unsigned const dayOfEra = static_cast<unsigned>(days - (era * 146097));
+    unsigned const yearOfEra = (dayOfEra - (dayOfEra / 1460) + (dayOfEra / 36524)
+                                - (dayOfEra / 146096)) / 365;
+    unsigned const dayOfYear = dayOfEra - ((365 * yearOfEra) + (yearOfEra / 4) - (yearOfEra / 100));
+    unsigned const monthIndex = ((5 * dayOfYear) + 2) / 153;
+
+    day = dayOfYear - (((153 * monthIndex) + 2) / 5) + 1;
+    month = (monthIndex < 10) ? (monthIndex + 3) : (monthIndex - 9);
+    year = static_cast<int64_t>(yearOfEra) + (era * 400) + (month <= 2);
+}
+
+/**
+ * @brief Parse a fixed width group of decimal digits
+ * 
+ * @param text - Digits to parse
+ * @param value - Resulting value
+ * 
+ * @return bool - True if every character was a digit
+ */
+static bool ParseDigits(std::string_view text, unsigned& value)
+{
+    value = 0;
+
+    for (char c : text)
+    {
+        if ((c < '0') || (c > '9'))
+        {
+            return false;
+        }
+        value = (value * 10) + static_cast<unsigned>(c - '0');
+    }
+
+    return true;
+}
+
+/**
+ * @brief Write a zero padded decimal number of fixed width
+ * 
+ * @param buffer - Destination. Advanced past the written digits
+ * @param value - Value to write
+ * @param width - Number of digits to write
+ */
+static void FormatDigits(char*& buffer, unsigned value, int width)
+{
+    for (int i = (width - 1); i >= 0; i--)
+    {
+        buffer[i] = static_cast<char>('0' + (value % 10));
+        value /= 10;
+    }
+
+    buffer += width;
+}
+
+/**
+ * @brief Parse a UTC Date/Time string provided by ThingSpeak into epoch
+ *        seconds without allocating
+ * 
+ * @param dateTime - UTC Date/Time string (e.g. "2024-12-24T07:10:39Z")
+ * @param epochSeconds - Resulting seconds since 1970-01-01 00:00:00 UTC
+ * 
+ * @return bool - True if the string was a valid Date/Time
+ */
+bool ThingSpeakParseDateTime(std::string_view dateTime, int64_t& epochSeconds)
+{
+    // Layout: YYYY-MM-DDTHH:MM:SS followed by an optional 'Z'
+    if ((dateTime.size() < 19) ||
+        ((dateTime.size() > 19) && ((dateTime.size() != 20) || (dateTime[19] != 'Z'))))
+    {
+        return false;
+    }
+
+    bool validSeparators = ((dateTime[4] == '-') && (dateTime[7] == '-') &&
+                            ((dateTime[10] == 'T') || (dateTime[10] == ' ')) &&
+                            (dateTime[13] == ':') && (dateTime[16] == ':'));
+    if (!validSeparators)
+    {
+        return false;
+    }
+
+    unsigned year, month, day, hour, minute, second;
+    bool validDigits = (ParseDigits(dateTime.substr(0, 4), year) &&
+                        ParseDigits(dateTime.substr(5, 2), month) &&
+                        ParseDigits(dateTime.substr(8, 2), day) &&
+                        ParseDigits(dateTime.substr(11, 2), hour) &&
+                        ParseDigits(dateTime.substr(14, 2), minute) &&
+                        ParseDigits(dateTime.substr(17, 2), second));
+    if (!validDigits || (month < 1) || (month > 12) || (day < 1) || (day > 31) ||
+        (hour > 23) || (minute > 59) || (second > 60))
+    {
+        return false;
+    }
+
+    epochSeconds = (DaysFromCivil(year, month, day) * SECONDS_PER_DAY)
+                   + (hour * SECONDS_PER_HOUR) + (minute * SECONDS_PER_MINUTE) + second;
+
+    return true;
+}
+
+/**
+ * @brief Format epoch seconds as "YYYY-MM-DD HH:MM:SS" without allocating
+ * 
+ * @param epochSeconds - Seconds since 1970-01-01 00:00:00
+ * @param buffer - Destination of at least THINGSPEAK_DATE_TIME_BUFFER_SIZE
+ *                 characters. Result is null terminated
+ * @param separator - Character placed between date and time
+ */
+void ThingSpeakFormatDateTime(int64_t epochSeconds, char* buffer, char separator)
+{
+    int64_t days = epochSeconds / SECONDS_PER_DAY;
+    int64_t secondOfDay = epochSeconds % SECONDS_PER_DAY;
+    if (secondOfDay < 0)
+    {
+        secondOfDay += SECONDS_PER_DAY;
+        days--;
+    }
+
+    int64_t year;
+    unsigned month, day;
+    CivilFromDays(days, year, month, day);
+
+    FormatDigits(buffer, static_cast<unsigned>(year), 4);
+    *buffer++ = '-';
+    FormatDigits(buffer, month, 2);
+    *buffer++ = '-';
+    FormatDigits(buffer, day, 2);
+    *buffer++ = separator;
+    FormatDigits(buffer, static_cast<unsigned>(secondOfDay / SECONDS_PER_HOUR), 2);
+    *buffer++ = ':';
+    FormatDigits(buffer, static_cast<unsigned>((secondOfDay % SECONDS_PER_HOUR) / SECONDS_PER_MINUTE), 2);
+    *buffer++ = ':';
+    FormatDigits(buffer, static_cast<unsigned>(secondOfDay % SECONDS_PER_MINUTE), 2);
+    *buffer = '\0';
+}
+
+/**
+ * @brief Locate THINGSPEAK_LOCAL_TIME_ZONE. Falls back to the zone of this
+ *        machine if the time zone database does not contain it
+ * 
+ */
+ThingSpeakTimeZone::ThingSpeakTimeZone() :
+    zone(nullptr), cachedBegin(0), cachedEnd(0), cachedOffset(0)
+{
+    try
+    {
+        zone = std::chrono::locate_zone(THINGSPEAK_LOCAL_TIME_ZONE);
+    }
+    catch (std::runtime_error const & error)
+    {
+        std::cerr << "[ERROR] Could not locate time zone " << THINGSPEAK_LOCAL_TIME_ZONE << ".\n"
+                  << "        " << error.what() << std::endl;
+
+        zone = std::chrono::current_zone();
+    }
+}
+
+/**
+ * @brief Convert UTC epoch seconds to local epoch seconds using the UTC
+ *        offset in effect at that time
+ * 
+ * @param epochSeconds - Seconds since 1970-01-01 00:00:00 UTC
+ * 
+ * @return int64_t - Local seconds since 1970-01-01 00:00:00
+ */
+int64_t ThingSpeakTimeZone::ToLocal(int64_t epochSeconds)
+{
+    if ((epochSeconds < cachedBegin) || (epochSeconds >= cachedEnd))
+    {
+        std::chrono::sys_seconds utcTimePoint{std::chrono::seconds{epochSeconds}};
+        std::chrono::sys_info info = zone->get_info(utcTimePoint);
+
+        cachedBegin = info.begin.time_since_epoch().count();
+        cachedEnd = info.end.time_since_epoch().count();
+        cachedOffset = info.offset.count();
+    }
+
+    return (epochSeconds + cachedOffset);
+}
+
+/**
+ * @brief Format UTC epoch seconds as local "YYYY-MM-DD HH:MM:SS"
+ * 
+ * @param epochSeconds - Seconds since 1970-01-01 00:00:00 UTC
+ * @param buffer - Destination of at least THINGSPEAK_DATE_TIME_BUFFER_SIZE
+ *                 characters. Result is null terminated
+ */
+void ThingSpeakTimeZone::FormatLocal(int64_t epochSeconds, char* buffer)
+{
+    ThingSpeakFormatDateTime(ToLocal(epochSeconds), buffer);
+}
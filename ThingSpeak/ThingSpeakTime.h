@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <chrono>
+
+#define THINGSPEAK_LOCAL_TIME_ZONE        "America/Los_Angeles"
+#define THINGSPEAK_DATE_TIME_BUFFER_SIZE  20    // "YYYY-MM-DD HH:MM:SS" + null terminator
+
+bool ThingSpeakParseDateTime(std::string_view dateTime, int64_t& epochSeconds);
+void ThingSpeakFormatDateTime(int64_t epochSeconds, char* buffer, char separator = ' ');
+
+/**
+ * Converts UTC epoch timestamps to local time of THINGSPEAK_LOCAL_TIME_ZONE.
+ * 
+ * The zone is located once on construction. The UTC offset is resolved per
+ * timestamp, so historical points get the daylight savings offset that was
+ * in effect when they were captured. The most recent offset period is
+ * cached, making repeated conversions of nearby timestamps O(1).
+ * 
+ * Not thread safe; each thread should own its own instance.
+ */
+class ThingSpeakTimeZone
+{
+public:
+    ThingSpeakTimeZone();
+
+    int64_t ToLocal(int64_t epochSeconds);
+    void FormatLocal(int64_t epochSeconds, char* buffer);
+
+private:
+    // Member Variables
+    std::chrono::time_zone const * zone;
+
+    int64_t cachedBegin;
+    int64_t cachedEnd;
+    int64_t cachedOffset;
+};
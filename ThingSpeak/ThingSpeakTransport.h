@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+
+#include "ThingSpeak.h"
+
+enum class ThingSpeakTransportState
+{
+    Disconnected,      // Not connected. Retried after a backoff
+    Connecting,
+    Connected          // Subscribed channels are being delivered
+};
+
+/**
+ * Channel transport pushing new entries as ThingSpeak receives them,
+ * rather than waiting to be polled.
+ * 
+ * Subscribed channels are delivered as ThingSpeakFetchResult_t holding a
+ * single entry each (see ThingSpeak::ParsePublishedEntry()), collected by
+ * the render loop the same way as ThingSpeakFetcher results. Entries
+ * published while disconnected are not delivered once reconnected, so
+ * results are only applied when ThingSpeak::ContinuesFieldData() holds;
+ * otherwise the channel is backfilled over HTTP first:
+ * 
+ *     transport.Subscribe(thingSpeak);
+ *     if (transport.Collect(results)) { ... }
+ * 
+ * Implementations own their connection on a worker thread, so no member
+ * blocks on the network. An optional callback is invoked on that thread
+ * whenever results are published.
+ */
+class ThingSpeakTransport
+{
+public:
+    typedef std::function<void()> ResultsReadyCallback;
+
+    virtual ~ThingSpeakTransport() = default;
+
+    virtual void Subscribe(ThingSpeak const & thingSpeak) = 0;
+    virtual void Unsubscribe(std::string const & channel, std::string const & key) = 0;
+    virtual bool Collect(std::vector<ThingSpeakFetchResult_t>& results) = 0;
+    virtual ThingSpeakTransportState GetState() const = 0;
+    virtual std::string GetDescription() const = 0;
+};
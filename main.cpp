@@ -7,12 +7,24 @@
 #include <d3d12.h>
 #include <dxgi1_4.h>
 #include <dwmapi.h>
+#include <shellapi.h>
+#include <shlobj.h>
 #include <tchar.h>
 #include <string>
 #include <fstream>
 #include <filesystem>
 #include <algorithm>
 #include <ranges>
+#include <span>
+#include <cmath>
+#include <cfloat>
+#include <cstdio>
+#include <chrono>
+#include <memory>
+#include <map>
+#include <unordered_set>
+#include <mutex>
+#include <thread>
 
 #include "Imgui/imgui.h"
 #include "Imgui/imgui_impl_win32.h"
@@ -22,12 +34,39 @@
 #include "Resources/resource.h"
 
 #include "ThingSpeak/ThingSpeak.h"
+#include "ThingSpeak/ThingSpeakFetcher.h"
+#include "ThingSpeak/ThingSpeakCache.h"
+#include "ThingSpeak/ThingSpeakScheduler.h"
+#include "ThingSpeak/ThingSpeakSeriesLod.h"
+#include "ThingSpeak/ThingSpeakRangeCache.h"
+#include "ThingSpeak/ThingSpeakAlerts.h"
+#include "ThingSpeak/ThingSpeakExporter.h"
+#include "ThingSpeak/ThingSpeakMqttSubscriber.h"
+
+#include "HomeMonitor.h"
+#include "HomeMonitorProfiler.h"
+#include "HomeMonitorFontAtlas.h"
+#include "HomeMonitorIndex.h"
 
 #define DEBUG_HOMEMONITOR       false
 #define HOMEMONITOR_USE_VSYNC   false
 
 #define MAX_HOMEMONITOR_USER_INPUT_SIZE   30
 
+#define HOMEMONITOR_IDLE_FPS_CAP             10    // Frame rate limit while not interacting
+#define HOMEMONITOR_INTERACTION_TIMEOUT_MS   250   // Render at full rate this long after input
+#define HOMEMONITOR_SETTLE_FRAMES            3     // Frames drawn after an event before sleeping
+
+#define HOMEMONITOR_SHARED_CACHE_POLL_MS     5000  // Collector's cache files are checked this often
+
+#define HOMEMONITOR_FONT_SIZE                16.0f
+
+#define HOMEMONITOR_NOTIFY_ICON_ID           1     // Tray icon showing alert notifications
+#define HOMEMONITOR_WM_TRAY_ICON             (WM_APP + 1)   // Mouse events of the tray icon
+#define HOMEMONITOR_TRAY_MENU_OPEN           1
+#define HOMEMONITOR_TRAY_MENU_EXIT           2
+#define HOMEMONITOR_OCCLUDED_POLL_MS         250   // Occluded swap chain is tested this often
+
 #if (DEBUG_HOMEMONITOR)
 #include <iostream>
 #else
@@ -129,40 +168,11 @@ extern IMGUI_IMPL_API LRESULT ImGui_ImplWin32_WndProcHandler(HWND hWnd, UINT msg
 // Win32 API - Declarations
 void Win32RegisterAndCreateWindow(HWND& hwnd, WNDCLASSEXW& windowClass);
 
-// HomeMonitor Global Definitions
-struct HomeMonitorAssignedColor_t
-{
-    unsigned int rgba;   // RGBA Color. E.g. (255, 255, 255, 0)
-    ImVec4 rgb;          // RGB Color. E.g. (1.0, 1.0, 1.0, 0.0)
-
-    bool operator==(const HomeMonitorAssignedColor_t& color) const
-    {
-        bool sameRgba = (rgba == color.rgba);
-        bool sameRgb = ((rgb.x == color.rgb.x) && (rgb.y == color.rgb.y)
-                        && (rgb.z == color.rgb.z) && (rgb.w == color.rgb.w));
-
-        return (sameRgba && sameRgb);
-    }
-};
-
-struct HomeMonitorColorOption_t
-{
-    HomeMonitorAssignedColor_t color;
-    bool available;
-};
-
-struct HomeMonitor_t
-{
-    ThingSpeak thingSpeak;
-    HomeMonitorAssignedColor_t assignedColor;
-
-    // Display properties
-    bool displayData;
-};
-
 // HomeMonitor Global Declarations
 bool darkMode = false;
 
+// Colors handed out first. Once all are in use, further colors are
+// generated; see HomeMonitorGenerateColor()
 static std::vector<HomeMonitorColorOption_t> colorOptions =
 {
     // Blue
@@ -181,31 +191,187 @@ std::string basePath = "D:\\06_PersonalProjects\\HomeMonitorV2";
 std::string fontFilePath = basePath + "\\Fonts\\Roboto-Regular.ttf";
 std::string thingSpeakFilePath = basePath + "\\ThingSpeak\\ThingSpeakObjects.json";
 
+// Per-user files, see HomeMonitorSetDataPaths()
+std::filesystem::path cacheDirectoryPath;
+std::filesystem::path performanceTraceFilePath;
+std::filesystem::path startupTraceFilePath;
+std::filesystem::path alertRulesFilePath;
+std::filesystem::path exportDirectoryPath;
+std::filesystem::path mqttConfigFilePath;
+
+static HomeMonitorProfiler homeMonitorProfiler;
+static HomeMonitorFontAtlas homeMonitorFontAtlas;
+
+// Lookup of homeMonitors by name and channel. Rebuilt whenever objects are
+// added, removed or edited
+static HomeMonitorIndex homeMonitorIndex;
+
+// Rules evaluated as entries arrive. The tray icon is added with the first
+// notification
+static ThingSpeakAlerts thingSpeakAlerts;
+bool notifyIconAdded = false;
+bool showPerformanceHud = false;
+
+// Minimizing hides the window behind the tray icon and releases the D3D12
+// device until it is restored. Data collection and alerts carry on
+bool minimizeToTray = true;
+static bool trayMode = false;            // Window hidden and GPU resources released
+static bool trayModeRequested = false;   // Set by WndProc, applied by the render loop
+
+// Started with --shared-cache: HomeMonitorCollector fetches the data, and
+// this instance only follows its cache files
+bool sharedCacheMode = false;
+std::chrono::steady_clock::time_point nextCachePollTime;
+
+// Caches mapped by any object, by channel. Objects on the same channel
+// share its cache, as a file can only have one writer. Also used by the
+// startup loader thread
+std::mutex openCachesMutex;
+std::map<std::string, std::weak_ptr<ThingSpeakCache>> openCaches;
+
+// Viewers show the latest entries by entry ID, or the time range chosen in
+// Viewer Properties, fetched on demand and aggregated by ThingSpeak
+static char const * historyOptions[] = {"Latest Entries", "Last Day", "Last Week", "Last 30 Days"};
+static int64_t const historySpans[] = {0, 86400, 604800, 2592000};   // Seconds shown by each option
+int viewerHistory = 0;
+bool fitVisibleRange = true;   // Y-axis autoscales to the samples within the X-axis range
+bool showDerivedSeries = true;   // Viewers of dew point, heat index and moving averages
+static ThingSpeakRangeCache thingSpeakRangeCache;
+
+// History is exported in the background from the caches or ThingSpeak
+static char const * exportSourceOptions[] = {"On-Disk Cache", "ThingSpeak"};
+static char const * exportFormatOptions[] = {"CSV", "Columnar"};
+static char const * exportRangeOptions[] = {"Last Day", "Last Week", "Last 30 Days", "Last 90 Days", "Last Year"};
+static int64_t const exportRangeSpans[] = {86400, 604800, 2592000, 7776000, 31536000};
+static ThingSpeakExporter thingSpeakExporter;
+
+// Pushes new entries as they are published when MQTT credentials are
+// configured. Null otherwise, leaving channels to be polled
+static std::unique_ptr<ThingSpeakTransport> thingSpeakTransport;
+
+typedef struct
+{
+    ThingSpeakSeries const * series;
+    int fieldNumber;
+} HomeMonitorRangeGetterData_t;
+
+// ThingSpeak objects read and restored from their caches by a background
+// thread at startup, handed to the render loop as each becomes ready
+typedef struct
+{
+    std::mutex mutex;
+    std::vector<HomeMonitor_t> loaded;    // Not yet picked up by the render loop
+    bool configLoaded;
+    HomeMonitorProfilerClock::time_point configLoadedTime;
+    bool finished;
+} HomeMonitorStartupLoad_t;
+
+// Set until every configured object has been picked up. Viewers show a
+// placeholder meanwhile
+bool homeMonitorsLoading = true;
+
 // HomeMonitor Window Creation
-void HomeMonitorCreateViewerPropertiesWindow(std::vector<HomeMonitor_t>& homeMonitors);
-void HomeMonitorCreateAddThingSpeakObjectWindow(std::vector<HomeMonitor_t>& homeMonitors);
+void HomeMonitorCreateViewerPropertiesWindow(std::vector<HomeMonitor_t>& homeMonitors,
+                                             ThingSpeakScheduler& thingSpeakScheduler,
+                                             ThingSpeakFetcher& thingSpeakFetcher);
+void HomeMonitorCreateAddThingSpeakObjectWindow(std::vector<HomeMonitor_t>& homeMonitors,
+                                                ThingSpeakScheduler& thingSpeakScheduler);
 void HomeMonitorCreateThingSpeakViewerWindow(std::string name,
                                              std::string xAxisLabel,
                                              std::string yAxisLabel,
-                                             ThingSpeakField field,
-                                             std::vector<HomeMonitor_t>& homeMonitors);
+                                             HomeMonitorPlotSeries_t plotSeries,
+                                             std::vector<HomeMonitor_t>& homeMonitors,
+                                             ThingSpeakFetcher& thingSpeakFetcher);
+int HomeMonitorPlotHistory(std::string const & name,
+                           std::string const & yAxisLabel,
+                           ImVec2 plotWindowSize,
+                           ThingSpeakField field,
+                           int64_t span,
+                           bool spanChanged,
+                           HomeMonitorView_t visibleHomeMonitors,
+                           ThingSpeakFetcher& thingSpeakFetcher);
+ImPlotPoint HomeMonitorGetRangePoint(int index, void* data);
+
+// HomeMonitor Data Functions
+void HomeMonitorRequestFieldData(std::vector<HomeMonitor_t>& homeMonitors,
+                                 ThingSpeakFetcher& thingSpeakFetcher);
+void HomeMonitorRequestDueFieldData(std::vector<HomeMonitor_t>& homeMonitors,
+                                    ThingSpeakScheduler& thingSpeakScheduler,
+                                    ThingSpeakFetcher& thingSpeakFetcher);
+void HomeMonitorCollectFieldData(std::vector<HomeMonitor_t>& homeMonitors,
+                                 ThingSpeakScheduler& thingSpeakScheduler,
+                                 ThingSpeakFetcher& thingSpeakFetcher);
+void HomeMonitorCollectPushedData(std::vector<HomeMonitor_t>& homeMonitors,
+                                  ThingSpeakScheduler& thingSpeakScheduler,
+                                  ThingSpeakFetcher& thingSpeakFetcher);
+void HomeMonitorApplyFieldData(HomeMonitor_t& homeMonitor, ThingSpeakFetchResult_t const & result,
+                               std::vector<HomeMonitor_t> const & homeMonitors,
+                               ThingSpeakScheduler& thingSpeakScheduler);
+void HomeMonitorLoadObjects(std::stop_token stopToken, HomeMonitorStartupLoad_t& startupLoad,
+                            HANDLE loadedEvent);
+bool HomeMonitorAdoptLoadedObjects(HomeMonitorStartupLoad_t& startupLoad,
+                                   std::vector<HomeMonitor_t>& homeMonitors,
+                                   ThingSpeakScheduler& thingSpeakScheduler);
+void HomeMonitorLoadCache(HomeMonitor_t& homeMonitor);
+void HomeMonitorLoadFont(ImGuiIO& io);
+void HomeMonitorSetDataPaths();
+bool HomeMonitorReadSharedCaches(std::vector<HomeMonitor_t>& homeMonitors);
+void HomeMonitorUpdateAlerts(HomeMonitor_t const & homeMonitor, std::vector<HomeMonitor_t> const & homeMonitors);
+void HomeMonitorRemoveUnusedAlerts(std::string const & channel, std::vector<HomeMonitor_t> const & homeMonitors);
+void HomeMonitorUnsubscribeUnused(std::string const & channel, std::string const & key);
+bool HomeMonitorNotifyAlerts(HWND hwnd);
+void HomeMonitorShowNotification(HWND hwnd, std::string const & title, std::string const & text);
+bool HomeMonitorUpdateData(std::vector<HomeMonitor_t>& homeMonitors, HomeMonitorStartupLoad_t& startupLoad,
+                           ThingSpeakScheduler& thingSpeakScheduler, ThingSpeakFetcher& thingSpeakFetcher,
+                           HWND hwnd);
+
+// HomeMonitor Tray Functions
+NOTIFYICONDATAW HomeMonitorGetNotifyIcon(HWND hwnd);
+void HomeMonitorEnterTrayMode(HWND hwnd);
+bool HomeMonitorLeaveTrayMode(HWND hwnd);
+void HomeMonitorShowTrayMenu(HWND hwnd);
+void HomeMonitorInitRenderer();
+void HomeMonitorDrawAlertMarkers(ThingSpeakField field, HomeMonitor_t const & homeMonitor);
+int64_t HomeMonitorGetEpochSeconds();
+
+// HomeMonitor Frame Pacing Functions
+bool HomeMonitorWaitForEvents(HANDLE fetchCompleteEvent,
+                              std::chrono::steady_clock::time_point wakeTime);
 
 // HomeMonitor Graph Functions
 void HomeMonitorGraphStyleLight();
 void HomeMonitorGraphStyleDark();
 
-bool HomeMonitorSetColor(HomeMonitor_t& homeMonitor);
+void HomeMonitorSetColor(HomeMonitor_t& homeMonitor);
+HomeMonitorAssignedColor_t HomeMonitorGenerateColor(int index);
 void HomeMonitorReleaseColor(HomeMonitorAssignedColor_t& color);
 void HomeMonitorDrawVerticalCursor();
 void HomeMonitorDrawHorizontalLine();
-
-std::pair<int, int> HomeMonitorGetClosestPointToMouse(ThingSpeakField field,
-                                                      std::vector<HomeMonitor_t>& homeMonitors);
-std::pair<float, float> HomeMonitorGetYAxisBoundaries(ThingSpeakField field,
-                                                      std::vector<HomeMonitor_t>& homeMonitors);
+void HomeMonitorDrawVisibilityCheckbox(HomeMonitor_t& homeMonitor);
+void HomeMonitorDrawExportControls(std::vector<HomeMonitor_t> const & homeMonitors);
 
 int main(int argc, char** argv)
 {
+    HomeMonitorSetDataPaths();
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument(argv[i]);
+        if (argument == "--shared-cache")
+        {
+            sharedCacheMode = true;
+        }
+        else if ((argument == "--base-url") && ((i + 1) < argc))
+        {
+            // e.g. a HomeMonitorMockServer, paired with the objects file it wrote
+            ThingSpeak::SetBaseUrl(argv[++i]);
+        }
+        else if ((argument == "--objects") && ((i + 1) < argc))
+        {
+            thingSpeakFilePath = argv[++i];
+        }
+    }
+
     HWND hwnd;
     WNDCLASSEXW windowClass;
     Win32RegisterAndCreateWindow(hwnd, windowClass);
@@ -222,6 +388,7 @@ int main(int argc, char** argv)
     // Show the window
     ::ShowWindow(hwnd, SW_SHOWDEFAULT);
     ::UpdateWindow(hwnd);
+    homeMonitorProfiler.MarkStartup(HomeMonitorStartupStage::Window);
 
     // Setup context
     IMGUI_CHECKVERSION();
@@ -262,68 +429,100 @@ int main(int argc, char** argv)
     // Setup Platform/Renderer backends
     ImGui_ImplWin32_Init(hwnd);
 
-    ImGui_ImplDX12_InitInfo init_info = {};
-    init_info.Device = g_pd3dDevice;
-    init_info.CommandQueue = g_pd3dCommandQueue;
-    init_info.NumFramesInFlight = APP_NUM_FRAMES_IN_FLIGHT;
-    init_info.RTVFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
-    init_info.DSVFormat = DXGI_FORMAT_UNKNOWN;
-    init_info.SrvDescriptorHeap = g_pd3dSrvDescHeap;
-    init_info.SrvDescriptorAllocFn = [](ImGui_ImplDX12_InitInfo*,
-                                        D3D12_CPU_DESCRIPTOR_HANDLE* out_cpu_handle,
-                                        D3D12_GPU_DESCRIPTOR_HANDLE* out_gpu_handle) {
-                                            return g_pd3dSrvDescHeapAlloc.Alloc(out_cpu_handle,
-                                                                                out_gpu_handle);
-                                        };
-    init_info.SrvDescriptorFreeFn = [](ImGui_ImplDX12_InitInfo*,
-                                       D3D12_CPU_DESCRIPTOR_HANDLE cpu_handle,
-                                       D3D12_GPU_DESCRIPTOR_HANDLE gpu_handle) {
-                                            return g_pd3dSrvDescHeapAlloc.Free(cpu_handle,
-                                                                               gpu_handle);
-                                       };
-    ImGui_ImplDX12_Init(&init_info);
+    HomeMonitorInitRenderer();
 
     // Load font
-    io.Fonts->AddFontFromFileTTF(fontFilePath.c_str(), 16.0f);
-
-    // Initialize ThingSpeak structures
-    std::ifstream thingSpeakObjectsFile(thingSpeakFilePath);
-    if (!thingSpeakObjectsFile.is_open())
+    HomeMonitorLoadFont(io);
+    homeMonitorProfiler.MarkStartup(HomeMonitorStartupStage::Backends);
+
+    // Network requests are serviced in the background. The event wakes the
+    // render loop when results or loaded objects arrive. Declared first so it
+    // outlives the worker and the loader
+    std::unique_ptr<void, decltype(&::CloseHandle)> fetchCompleteEvent(
+        ::CreateEventW(nullptr, FALSE, FALSE, nullptr), &::CloseHandle);
+    HANDLE fetchCompleteEventHandle = fetchCompleteEvent.get();
+
+    ThingSpeakFetcher thingSpeakFetcher([fetchCompleteEventHandle] {
+        ::SetEvent(fetchCompleteEventHandle);
+    });
+
+    // Each channel is refreshed on its own schedule, unless the collector
+    // is doing so. Channels are added as they are loaded
+    ThingSpeakScheduler thingSpeakScheduler;
+
+    // New entries are pushed over one MQTT connection if credentials are
+    // configured. Polling continues alongside, backfilling entries missed
+    // while disconnected. Not used with --shared-cache, which follows the
+    // collector's caches instead
+    ThingSpeakMqttConfig_t mqttConfig;
+    if (!sharedCacheMode && ThingSpeakMqttSubscriber::LoadConfig(mqttConfigFilePath, mqttConfig))
     {
-        std::cerr << "Could not open " << thingSpeakFilePath << std::endl;
-        return -1;
+        thingSpeakTransport = std::make_unique<ThingSpeakMqttSubscriber>(mqttConfig, [fetchCompleteEventHandle] {
+            ::SetEvent(fetchCompleteEventHandle);
+        });
     }
 
-    json thingSpeakObjectsJson;
-    thingSpeakObjectsFile >> thingSpeakObjectsJson;
-
-    thingSpeakObjectsFile.close();
-
+    // The first frame is presented while the objects file and caches are
+    // still being read. Each object is shown, and its channel scheduled, as
+    // soon as its cache is restored
     std::vector<HomeMonitor_t> homeMonitors;
-    for (auto& thingSpeakObject : thingSpeakObjectsJson)
-    {
-        HomeMonitor_t homeMonitor;
+    HomeMonitorStartupLoad_t startupLoad = {};
 
-        homeMonitor.thingSpeak = { thingSpeakObject["name"],
-                                   thingSpeakObject["channel"],
-                                   thingSpeakObject["key"]      };
-
-        HomeMonitorSetColor(homeMonitor);
+    // Alerts are optional; the rules file only lists a few rules
+    thingSpeakAlerts.LoadRules(alertRulesFilePath);
 
-        homeMonitors.push_back(homeMonitor);
-    }
+    std::jthread startupLoader(HomeMonitorLoadObjects, std::ref(startupLoad), fetchCompleteEventHandle);
 
-    std::string fieldName;
-    int totalDataPoints;
+    nextCachePollTime = std::chrono::steady_clock::now() +
+                        std::chrono::milliseconds(HOMEMONITOR_SHARED_CACHE_POLL_MS);
 
-    int result;
-    auto pollingDelay = std::chrono::steady_clock::now();
+    // Frame pacing state
+    auto lastInteractionTime = std::chrono::steady_clock::now();
+    auto nextFrameTime = lastInteractionTime;
+    int settleFrames = HOMEMONITOR_SETTLE_FRAMES;
+    bool itemHovered = false;
 
     // Start rendering loop
     bool done = false;
 
     while (!done)
     {
+        // Render at full rate while the user is interacting. Otherwise, cap
+        // the frame rate while something on screen may still change, and
+        // sleep until input, new data or the next poll when nothing can
+        auto now = std::chrono::steady_clock::now();
+        bool interacting = ((now - lastInteractionTime) <
+                            std::chrono::milliseconds(HOMEMONITOR_INTERACTION_TIMEOUT_MS));
+        bool suspended = trayMode || g_SwapChainOccluded;
+        if (!interacting || suspended)
+        {
+            bool redrawNeeded = !suspended &&
+                                ((settleFrames > 0) || itemHovered || thingSpeakFetcher.Busy() ||
+                                 thingSpeakExporter.Busy());
+            auto pollTime = (sharedCacheMode ? nextCachePollTime : thingSpeakScheduler.NextDueTime());
+
+            // Nothing to draw, but the swap chain is tested until visible again
+            if (!trayMode && g_SwapChainOccluded)
+            {
+                pollTime = std::min(pollTime, (now + std::chrono::milliseconds(HOMEMONITOR_OCCLUDED_POLL_MS)));
+            }
+
+            // Channels going quiet wake the loop too, to raise Stale alerts
+            int64_t staleDelay = thingSpeakAlerts.NextStaleTime() - HomeMonitorGetEpochSeconds();
+            if (staleDelay < std::chrono::duration_cast<std::chrono::seconds>(pollTime - now).count())
+            {
+                pollTime = now + std::chrono::seconds(std::max<int64_t>(staleDelay, 0));
+            }
+
+            if (HomeMonitorWaitForEvents(fetchCompleteEventHandle,
+                                         (redrawNeeded ? nextFrameTime : pollTime)))
+            {
+                settleFrames = HOMEMONITOR_SETTLE_FRAMES;
+            }
+        }
+        nextFrameTime = std::chrono::steady_clock::now() +
+                        std::chrono::milliseconds(1000 / HOMEMONITOR_IDLE_FPS_CAP);
+
         // Poll and handle messages (inputs, window resize, etc.)
         // 
         // See the WndProc() function below for for procedure to
@@ -337,21 +536,38 @@ int main(int argc, char** argv)
             {
                 done = true;
             }
+
+            lastInteractionTime = std::chrono::steady_clock::now();
+            settleFrames = HOMEMONITOR_SETTLE_FRAMES;
         }
         if (done)
         {
             break;
         }
 
-        // Handle window screen locked
-        if (g_SwapChainOccluded &&
-            g_pSwapChain->Present(0, DXGI_PRESENT_TEST) == DXGI_STATUS_OCCLUDED)
+        // Minimized to the tray, or restored from it
+        if (trayModeRequested && !trayMode)
+        {
+            HomeMonitorEnterTrayMode(hwnd);
+        }
+        else if (!trayModeRequested && trayMode && HomeMonitorLeaveTrayMode(hwnd))
+        {
+            settleFrames = HOMEMONITOR_SETTLE_FRAMES;
+        }
+
+        // Hidden or screen locked. No frame is drawn, but data is still
+        // collected and alerts raised
+        if (trayMode ||
+            (g_SwapChainOccluded && (g_pSwapChain->Present(0, DXGI_PRESENT_TEST) == DXGI_STATUS_OCCLUDED)))
         {
-            ::Sleep(10);
+            HomeMonitorUpdateData(homeMonitors, startupLoad, thingSpeakScheduler, thingSpeakFetcher, hwnd);
             continue;
         }
         g_SwapChainOccluded = false;
 
+        // Frame time excludes sleeping between frames
+        homeMonitorProfiler.BeginFrame();
+
         // Start the Dear ImGui frame
         ImGui_ImplDX12_NewFrame();
         ImGui_ImplWin32_NewFrame();
@@ -360,42 +576,71 @@ int main(int argc, char** argv)
         // Create docking space
         ImGui::DockSpaceOverViewport(0, ImGui::GetMainViewport());
 
+        // Pick up objects loaded and data fetched since the last frame
+        if (HomeMonitorUpdateData(homeMonitors, startupLoad, thingSpeakScheduler, thingSpeakFetcher, hwnd))
+        {
+            settleFrames = HOMEMONITOR_SETTLE_FRAMES;
+        }
+
         // Create HomeMonitor control windows
-        HomeMonitorCreateViewerPropertiesWindow(homeMonitors);
-        HomeMonitorCreateAddThingSpeakObjectWindow(homeMonitors);
+        HomeMonitorCreateViewerPropertiesWindow(homeMonitors, thingSpeakScheduler, thingSpeakFetcher);
+        HomeMonitorCreateAddThingSpeakObjectWindow(homeMonitors, thingSpeakScheduler);
+
+        // Create Homemonitor plotting windows
+        HomeMonitorCreateThingSpeakViewerWindow("Humidity",
+                                                "Entry ID", "Relative Humidity (%)",
+                                                HomeMonitorGetFieldSeries(ThingSpeakField::Humidity),
+                                                homeMonitors, thingSpeakFetcher);
+        HomeMonitorCreateThingSpeakViewerWindow("Temperature",
+                                                "Entry ID", "Temperature (Fahrenheit)",
+                                                HomeMonitorGetFieldSeries(ThingSpeakField::Temperature),
+                                                homeMonitors, thingSpeakFetcher);
 
-        // Refresh data periodically
-        if (std::chrono::steady_clock::now() > pollingDelay)
+        // Remaining fields only get a viewer once a channel publishes them
+        for (int fieldNumber = static_cast<int>(ThingSpeakField::Field3);
+             fieldNumber <= THINGSPEAK_HIGHEST_FIELD_NUMBER; fieldNumber++)
         {
-            auto currentTime = std::chrono::system_clock::now();
-            std::time_t refreshTime = std::chrono::system_clock::to_time_t(currentTime);
-            std::cout << "\nRefreshing data at " << std::ctime(&refreshTime) << std::endl;
+            ThingSpeakField field = static_cast<ThingSpeakField>(fieldNumber);
+            std::string fieldName = HomeMonitorGetFieldName(field, homeMonitors);
+            if (!fieldName.empty())
+            {
+                HomeMonitorCreateThingSpeakViewerWindow(fieldName, "Entry ID", fieldName,
+                                                        HomeMonitorGetFieldSeries(field),
+                                                        homeMonitors, thingSpeakFetcher);
+            }
+        }
 
-            for (auto& homeMonitor : homeMonitors)
+        // Derived from the fields above. Nothing is computed until a
+        // viewer is first shown
+        if (showDerivedSeries)
+        {
+            std::span<ThingSpeakDerivedDefinition_t const> definitions =
+                ThingSpeakDerivedSeries::GetDefaultDefinitions();
+            for (int i = 0; i < static_cast<int>(definitions.size()); i++)
             {
-                if (homeMonitor.displayData)
-                {
-                    homeMonitor.displayData = false;
-                    result = homeMonitor.thingSpeak.GetFieldData();
-                    homeMonitor.displayData = true;
-                }
+                ThingSpeakDerivedDefinition_t const & definition = definitions[i];
+                int column = i + THINGSPEAK_LOWEST_FIELD_NUMBER;
+                HomeMonitorCreateThingSpeakViewerWindow(definition.name, "Entry ID", definition.axisLabel,
+                                                        {column, true}, homeMonitors, thingSpeakFetcher);
             }
+        }
 
-            pollingDelay = std::chrono::steady_clock::now() + std::chrono::minutes(5);
+        if (showPerformanceHud)
+        {
+            homeMonitorProfiler.Draw(&showPerformanceHud, performanceTraceFilePath);
         }
 
-        // Create Homemonitor plotting windows
-        HomeMonitorCreateThingSpeakViewerWindow("Humidity",
-                                                "Entry ID", "Relative Humidity (%)",
-                                                ThingSpeakField::Humidity, homeMonitors);
-        HomeMonitorCreateThingSpeakViewerWindow("Temperature",
-                                                "Entry ID", "Temperature (Fahrenheit)",
-                                                ThingSpeakField::Temperature, homeMonitors);
+        // Keep drawing while hover and active states may still animate
+        itemHovered = ImGui::IsAnyItemHovered() || ImGui::IsAnyItemActive();
 
         // Rendering
         ImGui::Render();
 
-        FrameContext* frameCtx = WaitForNextFrameResources();
+        FrameContext* frameCtx;
+        {
+            HomeMonitorScopedTimer waitTimer(homeMonitorProfiler, HomeMonitorFrameStage::Wait);
+            frameCtx = WaitForNextFrameResources();
+        }
         UINT backBufferIdx = g_pSwapChain->GetCurrentBackBufferIndex();
         frameCtx->CommandAllocator->Reset();
 
@@ -431,32 +676,67 @@ int main(int argc, char** argv)
 
         g_pd3dCommandQueue->ExecuteCommandLists(1, (ID3D12CommandList* const*)&g_pd3dCommandList);
 
-        // Update and Render additional Platform Windows
-        if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
+        HRESULT hr;
         {
-            ImGui::UpdatePlatformWindows();
-            ImGui::RenderPlatformWindowsDefault();
-        }
+            // Additional Platform Windows are presented as they are rendered
+            HomeMonitorScopedTimer presentTimer(homeMonitorProfiler, HomeMonitorFrameStage::Present);
 
-        // Present
-        HRESULT hr;
-        #if (HOMEMONITOR_USE_VSYNC)
-        hr = g_pSwapChain->Present(1, 0);
-        #else
-        hr = g_pSwapChain->Present(0, 0);
-        #endif
+            // Update and Render additional Platform Windows
+            if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
+            {
+                ImGui::UpdatePlatformWindows();
+                ImGui::RenderPlatformWindowsDefault();
+            }
+
+            // Present
+            #if (HOMEMONITOR_USE_VSYNC)
+            hr = g_pSwapChain->Present(1, 0);
+            #else
+            hr = g_pSwapChain->Present(0, 0);
+            #endif
+        }
         g_SwapChainOccluded = (hr == DXGI_STATUS_OCCLUDED);
 
         UINT64 fenceValue = g_fenceLastSignaledValue + 1;
         g_pd3dCommandQueue->Signal(g_fence, fenceValue);
         g_fenceLastSignaledValue = fenceValue;
         frameCtx->FenceValue = fenceValue;
+
+        homeMonitorProfiler.EndFrame();
+        homeMonitorProfiler.MarkStartup(HomeMonitorStartupStage::FirstFrame);
+        if (homeMonitorProfiler.StartupComplete())
+        {
+            homeMonitorProfiler.LogStartup(startupTraceFilePath);
+        }
+
+        settleFrames = std::max(settleFrames - 1, 0);
     }
 
-    WaitForLastSubmittedFrame();
+    // Nothing is left on the GPU when exiting from the tray
+    if (!trayMode)
+    {
+        WaitForLastSubmittedFrame();
+    }
 
-    // Cleanup
-    ImGui_ImplDX12_Shutdown();
+    // Milestones not reached before exiting are left empty
+    homeMonitorProfiler.LogStartup(startupTraceFilePath);
+
+    // Cleanup. The transport's callback signals an event about to be closed
+    thingSpeakTransport.reset();
+
+    if (notifyIconAdded)
+    {
+        NOTIFYICONDATAW notifyIcon = {};
+        notifyIcon.cbSize = sizeof(notifyIcon);
+        notifyIcon.hWnd = hwnd;
+        notifyIcon.uID = HOMEMONITOR_NOTIFY_ICON_ID;
+        ::Shell_NotifyIconW(NIM_DELETE, &notifyIcon);
+    }
+
+    if (!trayMode)
+    {
+        ImGui_ImplDX12_Shutdown();
+    }
     ImGui_ImplWin32_Shutdown();
     ImPlot::DestroyContext();
     ImGui::DestroyContext();
@@ -472,11 +752,13 @@ int main(int argc, char** argv)
  * @brief Create "Viewer Properties" window of HomeMonitor GUI
  * 
  *  @param homeMonitors - Collection of HomeMonitor objects to render
+ *  @param thingSpeakScheduler - Schedule of edited objects' channels
+ *  @param thingSpeakFetcher - Background fetcher used to refresh data
  */
-void HomeMonitorCreateViewerPropertiesWindow(std::vector<HomeMonitor_t>& homeMonitors)
+void HomeMonitorCreateViewerPropertiesWindow(std::vector<HomeMonitor_t>& homeMonitors,
+                                             ThingSpeakScheduler& thingSpeakScheduler,
+                                             ThingSpeakFetcher& thingSpeakFetcher)
 {
-    int result;
-
     ImGui::Begin("Viewer Properties");
 
     ImGui::Text("General Actions");
@@ -500,51 +782,56 @@ void HomeMonitorCreateViewerPropertiesWindow(std::vector<HomeMonitor_t>& homeMon
 
     if (ImGui::Button("Refresh Data", ImVec2(100, 0)))
     {
-        for (auto& homeMonitor : homeMonitors)
+        if (sharedCacheMode)
         {
-            if (homeMonitor.displayData)
-            {
-                homeMonitor.displayData = false;
-                result = homeMonitor.thingSpeak.GetFieldData();
-                homeMonitor.displayData = true;
-            }
+            HomeMonitorReadSharedCaches(homeMonitors);
+        }
+        else
+        {
+            HomeMonitorRequestFieldData(homeMonitors, thingSpeakFetcher);
         }
     }
 
+    if (thingSpeakFetcher.Busy())
+    {
+        ImGui::SameLine();
+        ImGui::Text("Fetching...");
+    }
+    ImGui::Dummy(ImVec2(0.0f, 5.0f));
+
+    ImGui::SetNextItemWidth(160.0f);
+    ImGui::Combo("History", &viewerHistory, historyOptions, IM_ARRAYSIZE(historyOptions));
+    ImGui::Checkbox("Fit Y-Axis to Visible Range", &fitVisibleRange);
+    ImGui::Checkbox("Show Derived Series", &showDerivedSeries);
+
     HomeMonitorDrawHorizontalLine();
 
     ImGui::Text("Toggle Plot Visibility");
     ImGui::Dummy(ImVec2(0.0f, 10.0f));
 
-    for (auto& homeMonitor : homeMonitors)
-    {
-        ImVec4 color;
-        if (homeMonitor.displayData)
-        {
-            color = homeMonitor.assignedColor.rgb;
-        }
-        else
-        {
-            color = ImVec4(0.8f, 0.8f, 0.8f, 1.0f);
-        }
-        ImVec4 colorOnHover = ImVec4(color.x, color.y, color.z, (color.w * 0.5));
-
-        ImGui::PushStyleColor(ImGuiCol_CheckMark, ImVec4(0, 0, 0, 0));
-        ImGui::PushStyleColor(ImGuiCol_FrameBg, color);
-        ImGui::PushStyleColor(ImGuiCol_FrameBgActive, color);
-        ImGui::PushStyleColor(ImGuiCol_FrameBgHovered, colorOnHover);
+    // Only the rows scrolled into view are submitted, however many objects
+    // are monitored
+    int numHomeMonitors = static_cast<int>(homeMonitors.size());
+    float rowHeight = ImGui::GetFrameHeightWithSpacing();
+    int numRowsShown = std::min(numHomeMonitors, HOMEMONITOR_VISIBILITY_LIST_ROWS);
 
-        std::string checkBoxName = homeMonitor.thingSpeak.GetName();
-        if (!homeMonitor.thingSpeak.ValidData())
+    if (numHomeMonitors > 0)
+    {
+        if (ImGui::BeginChild("##plotVisibility", ImVec2(0.0f, (numRowsShown * rowHeight))))
         {
-            checkBoxName += "\n(Error fetching data)";
+            ImGuiListClipper clipper;
+            clipper.Begin(numHomeMonitors, rowHeight);
+            while (clipper.Step())
+            {
+                for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++)
+                {
+                    ImGui::PushID(row);
+                    HomeMonitorDrawVisibilityCheckbox(homeMonitors[row]);
+                    ImGui::PopID();
+                }
+            }
         }
-        ImGui::Checkbox(checkBoxName.c_str(), &homeMonitor.displayData);
-
-        ImGui::PopStyleColor();
-        ImGui::PopStyleColor();
-        ImGui::PopStyleColor();
-        ImGui::PopStyleColor();
+        ImGui::EndChild();
     }
 
     // Only allow edits/removals if there are objects to modify
@@ -554,23 +841,37 @@ void HomeMonitorCreateViewerPropertiesWindow(std::vector<HomeMonitor_t>& homeMon
 
         static int selected = 0;
         static int lastSelection = -1;
-        char names[10][MAX_HOMEMONITOR_USER_INPUT_SIZE];
-        const char* options[10];
 
-        int dropdownItem;
-        for (dropdownItem = 0; dropdownItem < homeMonitors.size(); dropdownItem++)
-        {
-            strncpy(names[dropdownItem],
-                    homeMonitors[dropdownItem].thingSpeak.GetName().c_str(),
-                    MAX_HOMEMONITOR_USER_INPUT_SIZE);
-            options[dropdownItem] = names[dropdownItem];
-        }
+        // Objects may have been removed since the last frame
+        selected = std::min(selected, (numHomeMonitors - 1));
 
-        if (ImGui::Combo(" ", &selected, options, dropdownItem))
+        if (ImGui::BeginCombo(" ", homeMonitors[selected].thingSpeak.GetName().c_str()))
         {
-            #if (DEBUG_HOMEMONITOR)
-            std::cout << "Current Index = " << selected << std::endl;
-            #endif
+            ImGuiListClipper clipper;
+            clipper.Begin(numHomeMonitors);
+            clipper.IncludeItemByIndex(selected);   // So the selection can be focused
+            while (clipper.Step())
+            {
+                for (int item = clipper.DisplayStart; item < clipper.DisplayEnd; item++)
+                {
+                    ImGui::PushID(item);
+                    if (ImGui::Selectable(homeMonitors[item].thingSpeak.GetName().c_str(), (item == selected)))
+                    {
+                        selected = item;
+
+                        #if (DEBUG_HOMEMONITOR)
+                        std::cout << "Current Index = " << selected << std::endl;
+                        #endif
+                    }
+                    if (item == selected)
+                    {
+                        ImGui::SetItemDefaultFocus();
+                    }
+                    ImGui::PopID();
+                }
+            }
+
+            ImGui::EndCombo();
         }
 
         ImGui::Dummy(ImVec2(0.0f, 10.0f));
@@ -579,7 +880,6 @@ void HomeMonitorCreateViewerPropertiesWindow(std::vector<HomeMonitor_t>& homeMon
 
         ImGui::Dummy(ImVec2(0.0f, 10.0f));
 
-        auto homeMonitor = homeMonitors[selected];
         static char nameInputBuffer[MAX_HOMEMONITOR_USER_INPUT_SIZE];
         ImGui::Text("Name", ImVec2(160, 0));
         ImGui::SetNextItemWidth(160.0f);
@@ -617,11 +917,33 @@ void HomeMonitorCreateViewerPropertiesWindow(std::vector<HomeMonitor_t>& homeMon
 
         ImGui::Dummy(ImVec2(0.0f, 10.0f));
 
+        // Saving rewrites the objects file, which would drop objects not loaded yet
+        ImGui::BeginDisabled(homeMonitorsLoading);
+
         if (ImGui::Button("Save", ImVec2(75, 0)))
         {
+            std::string previousChannel = homeMonitors[selected].thingSpeak.GetChannel();
+            std::string previousKey = homeMonitors[selected].thingSpeak.GetKey();
             homeMonitors[selected].thingSpeak.SetName(std::string(nameInputBuffer));
             homeMonitors[selected].thingSpeak.SetChannel(std::string(channelInputBuffer));
             homeMonitors[selected].thingSpeak.SetKey(std::string(keyInputBuffer));
+            HomeMonitorLoadCache(homeMonitors[selected]);
+            homeMonitorIndex.Rebuild(homeMonitors);
+            HomeMonitorRemoveUnusedAlerts(previousChannel, homeMonitors);
+            HomeMonitorUpdateAlerts(homeMonitors[selected], homeMonitors);
+            HomeMonitorUnsubscribeUnused(previousChannel, previousKey);
+
+            // Schedules of channels no longer used are dropped once due
+            if (!sharedCacheMode)
+            {
+                thingSpeakScheduler.Add(homeMonitors[selected].thingSpeak.GetChannel(),
+                                        homeMonitors[selected].thingSpeak.GetKey(),
+                                        std::chrono::steady_clock::now());
+            }
+            if (thingSpeakTransport)
+            {
+                thingSpeakTransport->Subscribe(homeMonitors[selected].thingSpeak);
+            }
 
             json newFileContent;
 
@@ -645,7 +967,12 @@ void HomeMonitorCreateViewerPropertiesWindow(std::vector<HomeMonitor_t>& homeMon
         {
             HomeMonitorReleaseColor(homeMonitors[selected].assignedColor);
 
+            std::string removedChannel = homeMonitors[selected].thingSpeak.GetChannel();
+            std::string removedKey = homeMonitors[selected].thingSpeak.GetKey();
             homeMonitors.erase(homeMonitors.begin() + selected);
+            homeMonitorIndex.Rebuild(homeMonitors);
+            HomeMonitorRemoveUnusedAlerts(removedChannel, homeMonitors);
+            HomeMonitorUnsubscribeUnused(removedChannel, removedKey);
 
             json newFileContent;
 
@@ -663,17 +990,36 @@ void HomeMonitorCreateViewerPropertiesWindow(std::vector<HomeMonitor_t>& homeMon
             outputFile.close();
 
             selected = 0;
+            lastSelection = -1;
         }
+
+        ImGui::EndDisabled();
     } 
 
-    #if (DEBUG_HOMEMONITOR)
+    HomeMonitorDrawHorizontalLine();
+
+    HomeMonitorDrawExportControls(homeMonitors);
+
     HomeMonitorDrawHorizontalLine();
 
     ImGuiIO& io = ImGui::GetIO();
     ImGui::Text("System Diagnostics");
     ImGui::BulletText("Averaging %.1f FPS\n(Equal to %.3f ms/frame)",
                       io.Framerate, (1000.0f / io.Framerate));
-    #endif
+    if (thingSpeakTransport)
+    {
+        ThingSpeakTransportState state = thingSpeakTransport->GetState();
+        ImGui::BulletText("Push: %s (%s)", thingSpeakTransport->GetDescription().c_str(),
+                          (state == ThingSpeakTransportState::Connected) ? "Connected" :
+                          (state == ThingSpeakTransportState::Connecting) ? "Connecting" : "Disconnected");
+    }
+    else
+    {
+        ImGui::BulletText("Push: Off, polling only");
+    }
+    ImGui::BulletText("Statistics kernel: %s", ThingSpeakGetStatsKernelName(ThingSpeakGetStatsKernel()));
+    ImGui::Checkbox("Show Performance HUD", &showPerformanceHud);
+    ImGui::Checkbox("Minimize to Tray", &minimizeToTray);
 
     ImGui::End();   // Viewer Properties
 }
@@ -682,8 +1028,10 @@ void HomeMonitorCreateViewerPropertiesWindow(std::vector<HomeMonitor_t>& homeMon
  * @brief Create "Add ThingSpeak Object" window of HomeMonitor GUI
  * 
  * @param homeMonitors - Collection of HomeMonitor objects to render
+ * @param thingSpeakScheduler - Schedules the initial fetch of added objects
  */
-void HomeMonitorCreateAddThingSpeakObjectWindow(std::vector<HomeMonitor_t>& homeMonitors)
+void HomeMonitorCreateAddThingSpeakObjectWindow(std::vector<HomeMonitor_t>& homeMonitors,
+                                                ThingSpeakScheduler& thingSpeakScheduler)
 {
     static bool errorOccurred = false;
     ImGui::Begin("Add ThingSpeak Object");
@@ -736,15 +1084,11 @@ void HomeMonitorCreateAddThingSpeakObjectWindow(std::vector<HomeMonitor_t>& home
         {
             std::string chosenName(nameInputBuffer);
 
-            for (auto& homeMonitor : homeMonitors)
+            if (homeMonitorIndex.FindName(chosenName) != -1)
             {
-                if (chosenName == homeMonitor.thingSpeak.GetName())
-                {
-                    messageIfError = (chosenName + " already exists");
-                    
-                    valid = false;
-                    break;
-                }
+                messageIfError = (chosenName + " already exists");
+
+                valid = false;
             }
         }
 
@@ -757,49 +1101,52 @@ void HomeMonitorCreateAddThingSpeakObjectWindow(std::vector<HomeMonitor_t>& home
                                        channelInputBuffer,
                                        keyInputBuffer      };
 
-            valid = HomeMonitorSetColor(homeMonitor);
-            if (valid)
+            HomeMonitorSetColor(homeMonitor);
+            HomeMonitorLoadCache(homeMonitor);
+
+            // Due straight away, so initial data is fetched. The collector
+            // picks up the object from the saved file instead
+            if (!sharedCacheMode)
             {
-                if (homeMonitor.displayData)
-                {
-                    homeMonitor.displayData = false;
-                    homeMonitor.thingSpeak.GetFieldData();
-                    homeMonitor.displayData = true;
-                }
+                thingSpeakScheduler.Add(homeMonitor.thingSpeak.GetChannel(),
+                                        homeMonitor.thingSpeak.GetKey(),
+                                        std::chrono::steady_clock::now());
+            }
+            if (thingSpeakTransport)
+            {
+                thingSpeakTransport->Subscribe(homeMonitor.thingSpeak);
+            }
 
-                homeMonitors.push_back(homeMonitor);
+            homeMonitors.push_back(homeMonitor);
+            homeMonitorIndex.Rebuild(homeMonitors);
+            HomeMonitorUpdateAlerts(homeMonitors.back(), homeMonitors);
 
-                // Store in file for future use
-                std::ifstream inputFile(thingSpeakFilePath);
-                if (!inputFile.is_open())
-                {
-                    std::cerr << "Could not open " << thingSpeakFilePath << std::endl;
-                    assert(!"Could not open ThingSpeak object JSON file");
-                }
+            // Store in file for future use
+            std::ifstream inputFile(thingSpeakFilePath);
+            if (!inputFile.is_open())
+            {
+                std::cerr << "Could not open " << thingSpeakFilePath << std::endl;
+                assert(!"Could not open ThingSpeak object JSON file");
+            }
 
-                json thingSpeakObjectsJson;
-                inputFile >> thingSpeakObjectsJson;
+            json thingSpeakObjectsJson;
+            inputFile >> thingSpeakObjectsJson;
 
-                inputFile.close();
+            inputFile.close();
 
-                thingSpeakObjectsJson.push_back({
-                    {"name", nameInputBuffer},
-                    {"channel", channelInputBuffer},
-                    {"key", keyInputBuffer}
-                });
+            thingSpeakObjectsJson.push_back({
+                {"name", nameInputBuffer},
+                {"channel", channelInputBuffer},
+                {"key", keyInputBuffer}
+            });
 
-                std::ofstream outputFile(thingSpeakFilePath);
-                outputFile << thingSpeakObjectsJson.dump(4);
-                outputFile.close();
+            std::ofstream outputFile(thingSpeakFilePath);
+            outputFile << thingSpeakObjectsJson.dump(4);
+            outputFile.close();
 
-                memset(nameInputBuffer, 0, sizeof(nameInputBuffer));
-                memset(channelInputBuffer, 0, sizeof(channelInputBuffer));
-                memset(keyInputBuffer, 0, sizeof(keyInputBuffer));
-            }
-            else
-            {
-                messageIfError = "Maximum number of objects added";
-            }
+            memset(nameInputBuffer, 0, sizeof(nameInputBuffer));
+            memset(channelInputBuffer, 0, sizeof(channelInputBuffer));
+            memset(keyInputBuffer, 0, sizeof(keyInputBuffer));
         }
 
         if (!valid)
@@ -832,41 +1179,96 @@ void HomeMonitorCreateAddThingSpeakObjectWindow(std::vector<HomeMonitor_t>& home
  * @param name - Graph name
  * @param xAxisLabel - Label to use for X-Axis
  * @param yAxisLabel - Label to use for Y-Axis
- * @param field - ThingSpeak field to use
+ * @param plotSeries - ThingSpeak field, or series derived from the fields,
+ *                     to plot
  * @param homeMonitors - Collection of HomeMonitor objects to render
+ * @param thingSpeakFetcher - Background fetcher used to request history
  */
 void HomeMonitorCreateThingSpeakViewerWindow(std::string name,
                                              std::string xAxisLabel,
                                              std::string yAxisLabel,
-                                             ThingSpeakField field,
-                                             std::vector<HomeMonitor_t>& homeMonitors)
+                                             HomeMonitorPlotSeries_t plotSeries,
+                                             std::vector<HomeMonitor_t>& homeMonitors,
+                                             ThingSpeakFetcher& thingSpeakFetcher)
 {
-    ImVec2 maxWindowSize(-1, -1);
+    int fieldNumber = plotSeries.fieldNumber;
+    int plotIndex = HomeMonitorGetPlotIndex(plotSeries);
 
-    std::string windowName(name + " Viewer");
-    ImGui::Begin(windowName.c_str());
+    // Field names come from the channel, so the window is identified by its
+    // field number to keep its layout if the name changes
+    std::string windowName(name + " Viewer###" + (plotSeries.derived ? "Derived" : "Field") +
+                           std::to_string(fieldNumber) + "Viewer");
 
-    ImPlot::PushStyleVar(ImPlotStyleVar_LineWeight, 2.5f);
-    if (ImPlot::BeginPlot(name.c_str(), maxWindowSize))
+    // Nothing is plotted, or derived, while collapsed or behind another tab
+    if (!ImGui::Begin(windowName.c_str()))
     {
-        ImPlot::SetupAxes(xAxisLabel.c_str(), yAxisLabel.c_str());
+        ImGui::End();
+        return;
+    }
 
-        std::vector<HomeMonitor_t> visibleHomeMonitors;
-        for (auto& homeMonitor : homeMonitors)
+    // Reused by every viewer, so no allocations are made once warmed up
+    static std::vector<HomeMonitor_t*> visibleHomeMonitorStorage;
+    visibleHomeMonitorStorage.clear();
+    for (auto& homeMonitor : homeMonitors)
+    {
+        if (!homeMonitor.displayData || !homeMonitor.thingSpeak.HasFieldData())
         {
-            if (homeMonitor.displayData && homeMonitor.thingSpeak.ValidData())
-            {
-                visibleHomeMonitors.push_back(homeMonitor);
-            }
+            continue;
+        }
+
+        // Derived on first view, then only for entries arriving since. Shared
+        // by every derived viewer, so each entry is derived once
+        if (plotSeries.derived)
+        {
+            homeMonitor.derivedSeries.Update(homeMonitor.thingSpeak.GetFeedData()->series);
         }
 
+        if (HomeMonitorGetPlotData(homeMonitor, plotSeries)->series.HasField(fieldNumber))
+        {
+            visibleHomeMonitorStorage.push_back(&homeMonitor);
+        }
+    }
+    HomeMonitorView_t visibleHomeMonitors(visibleHomeMonitorStorage);
+
+    // Autoscaling, decimation and the statistics below all query these
+    HomeMonitorUpdateRollups(plotSeries, visibleHomeMonitors);
+
+    // The time axis is reset to the chosen span whenever it is changed.
+    // Derived series are only held for the entries fetched, so are not
+    // shown over history ranges
+    static int lastHistory[HOMEMONITOR_NUM_PLOT_SERIES] = {};
+    int64_t historySpan = (plotSeries.derived ? 0 : historySpans[viewerHistory]);
+    bool historyChanged = (lastHistory[plotIndex] != viewerHistory);
+    lastHistory[plotIndex] = viewerHistory;
+    int historyResolution = THINGSPEAK_RANGE_RAW;
+
+    // X-axis range shown by the previous frame. Empty until first plotted
+    static ImPlotRange lastXRanges[HOMEMONITOR_NUM_PLOT_SERIES];
+
+    // Leave a line below the plot for the statistics of the visible range
+    ImVec2 plotWindowSize(-1, -ImGui::GetTextLineHeightWithSpacing());
+    ImPlotRect plotLimits;
+
+    ImPlot::PushStyleVar(ImPlotStyleVar_LineWeight, 2.5f);
+    if (historySpan > 0)
+    {
+        historyResolution = HomeMonitorPlotHistory(name, yAxisLabel, plotWindowSize,
+                                                   static_cast<ThingSpeakField>(fieldNumber),
+                                                   historySpan, historyChanged,
+                                                   visibleHomeMonitors, thingSpeakFetcher);
+    }
+    else if (ImPlot::BeginPlot(name.c_str(), plotWindowSize))
+    {
+        ImPlot::SetupAxes(xAxisLabel.c_str(), yAxisLabel.c_str());
+
         if (visibleHomeMonitors.size() > 0)
         {
             // Do not specify axis limits if no plots are visible.
             // Otherwise, Imgui will not be able to redisplay data when enabled
             float const margin = 0.5;
-            std::pair<float, float> xLimits = {0, (MAX_THINGSPEAK_REQUEST_SIZE - 1)};
-            std::pair<float, float> yLimits = HomeMonitorGetYAxisBoundaries(field, homeMonitors);
+            std::pair<float, float> xLimits = HomeMonitorGetXAxisBoundaries(plotSeries, visibleHomeMonitors);
+            std::pair<float, float> yLimits = HomeMonitorGetYAxisBoundaries(plotSeries, visibleHomeMonitors,
+                                                                            NAN, NAN);
 
             ImPlot::SetupAxisLimitsConstraints(ImAxis_X1,
                                                xLimits.first,
@@ -874,58 +1276,97 @@ void HomeMonitorCreateThingSpeakViewerWindow(std::string name,
             ImPlot::SetupAxisLimitsConstraints(ImAxis_Y1,
                                                yLimits.first - margin,
                                                yLimits.second + margin);
+
+            // Limits must be set up before the current ones are known, so
+            // the Y-axis follows the X-axis range of the previous frame
+            ImPlotRange const & lastXRange = lastXRanges[plotIndex];
+            if (fitVisibleRange && (lastXRange.Size() > 0.0))
+            {
+                std::pair<float, float> visibleYLimits =
+                    HomeMonitorGetYAxisBoundaries(plotSeries, visibleHomeMonitors, lastXRange.Min, lastXRange.Max);
+                if (visibleYLimits.first <= visibleYLimits.second)
+                {
+                    ImPlot::SetupAxisLimits(ImAxis_Y1,
+                                            visibleYLimits.first - margin,
+                                            visibleYLimits.second + margin,
+                                            ImPlotCond_Always);
+                }
+            }
         }
 
         ThingSpeakFeedData_t const * dataset;
+        ThingSpeakSeriesLod* lod;
+
+        plotLimits = ImPlot::GetPlotLimits();
+        lastXRanges[plotIndex] = plotLimits.X;
+        ImVec2 plotSize = ImPlot::GetPlotSize();
 
-        for (auto& homeMonitor : visibleHomeMonitors)
+        for (HomeMonitor_t* homeMonitor : visibleHomeMonitors)
         {
-            if (field == ThingSpeakField::Temperature)
-            {
-                dataset = homeMonitor.thingSpeak.GetTemperature();
-            }
-            else
+            dataset = HomeMonitorGetPlotData(*homeMonitor, plotSeries);
+            lod = &homeMonitor->plotLods[plotIndex];
+
+            // Only rebuilt when the data, axis limits or plot width change
+            lod->Update(dataset->series, homeMonitor->fieldRollups[plotIndex],
+                        plotLimits.X.Min, plotLimits.X.Max, static_cast<int>(plotSize.x));
+
+            // Entries which did not provide the field break the line. Geometry
+            // is only tessellated again once the envelope, limits or style change
+            ImPlot::PushStyleColor(0, homeMonitor->assignedColor.rgb);
+            homeMonitor->plotGeometries[plotIndex].PlotLine(
+                homeMonitor->thingSpeak.GetName().c_str(), lod->Xs(), lod->Ys(), lod->Size(),
+                (ImPlotLegendFlags_NoButtons | ImPlotLineFlags_SkipNaN), lod->Revision());
+            ImPlot::PopStyleColor();
+
+            // Alert rules only watch fields as fetched
+            if (!plotSeries.derived)
             {
-                dataset = homeMonitor.thingSpeak.GetHumidity();
+                HomeMonitorDrawAlertMarkers(static_cast<ThingSpeakField>(fieldNumber), *homeMonitor);
             }
+        }
 
-            ImPlot::PushStyleColor(0, homeMonitor.assignedColor.rgb);
-            ImPlot::PlotLine(homeMonitor.thingSpeak.GetName().c_str(),
-                             dataset->xAxisData, dataset->yAxisData,
-                             dataset->numDataPoints,ImPlotLegendFlags_NoButtons);
-            ImPlot::PopStyleColor();
+        // Placeholder until the first channel's data streams in
+        bool anyFieldData = std::ranges::any_of(visibleHomeMonitors, [](HomeMonitor_t const * homeMonitor) {
+            return homeMonitor->thingSpeak.HasFieldData();
+        });
+        if (!anyFieldData && (homeMonitorsLoading || thingSpeakFetcher.Busy()))
+        {
+            ImPlot::PlotText("Loading...", ((plotLimits.X.Min + plotLimits.X.Max) / 2.0),
+                             ((plotLimits.Y.Min + plotLimits.Y.Max) / 2.0));
         }
 
         if (ImPlot::IsPlotHovered())
         {
             HomeMonitorDrawVerticalCursor();
 
+            ImVec2 pixelsPerUnit(static_cast<float>(plotSize.x / plotLimits.X.Size()),
+                                 static_cast<float>(plotSize.y / plotLimits.Y.Size()));
+
             std::pair<int, int> closestIndicies =
-                HomeMonitorGetClosestPointToMouse(field, visibleHomeMonitors);
+                HomeMonitorGetClosestPointToMouse(plotSeries, visibleHomeMonitors,
+                                                  ImPlot::GetPlotMousePos(), pixelsPerUnit);
 
             if (closestIndicies.first != -1)
             {
-                auto homeMonitor = visibleHomeMonitors[closestIndicies.first];
-                auto entryId = closestIndicies.second;
+                HomeMonitor_t const & homeMonitor = *visibleHomeMonitors[closestIndicies.first];
+                auto index = closestIndicies.second;
 
-                if (field == ThingSpeakField::Temperature)
-                {
-                    dataset = homeMonitor.thingSpeak.GetTemperature();
-                }
-                else
-                {
-                    dataset = homeMonitor.thingSpeak.GetHumidity();
-                }
+                dataset = HomeMonitorGetPlotData(homeMonitor, plotSeries);
 
                 ImGui::BeginTooltip();
                 ImGui::Text("Trendline: %s", homeMonitor.thingSpeak.GetName().c_str());
-                ImGui::Text("Entry ID: %d", entryId);
-                ImGui::Text("%s: %.2f", name.c_str(), dataset->yAxisData[entryId]);
-                ImGui::Text("Date/Time Captured (PST): %s", dataset->timestamp[entryId].c_str());
+                ImGui::Text("Entry ID: %lld", dataset->series.EntryId(index));
+                ImGui::Text("%s: %.2f", name.c_str(), dataset->series.Value(fieldNumber, index));
+                // Only the hovered point is ever converted to local time
+                static ThingSpeakTimeZone localTimeZone;
+                char dateTime[THINGSPEAK_DATE_TIME_BUFFER_SIZE];
+                localTimeZone.FormatLocal(dataset->series.Timestamp(index), dateTime);
+
+                ImGui::Text("Date/Time Captured (PST): %s", dateTime);
                 ImGui::EndTooltip();
 
-                float xPoint[] = {static_cast<float>(entryId)};
-                float yPoint[] = {dataset->yAxisData[entryId]};
+                float xPoint[] = {static_cast<float>(index)};
+                float yPoint[] = {dataset->series.Value(fieldNumber, index)};
                 ImPlot::PushStyleColor(ImPlotCol_Line, ImVec4(1.0, 0.0, 0.0, 1.0));
                 ImPlot::PushStyleColor(ImPlotCol_MarkerOutline, ImVec4(0.7, 0.0, 0.0, 1.0));
                 ImPlot::PlotScatter("Closest Point", xPoint, yPoint,
@@ -938,18 +1379,1049 @@ void HomeMonitorCreateThingSpeakViewerWindow(std::string name,
         ImPlot::EndPlot();
     }
     ImPlot::PopStyleVar();
-    ImGui::End();
-}
 
-/**
- * @brief Assign a unique color for a HomeMonitor object
- * 
+    if (historySpan > 0)
+    {
+        if (historyResolution == THINGSPEAK_RANGE_RAW)
+        {
+            ImGui::Text("Raw entries");
+        }
+        else
+        {
+            ImGui::Text("Server aggregated: %d minute averages", historyResolution);
+        }
+    }
+    else
+    {
+        // Statistics of the visible range, scanned with the SIMD kernels
+        bool firstStats = true;
+        for (HomeMonitor_t const * homeMonitor : visibleHomeMonitors)
+        {
+            ThingSpeakSeriesStats_t stats =
+                HomeMonitorGetVisibleStats(plotSeries, *homeMonitor, plotLimits.X.Min, plotLimits.X.Max);
+            if (stats.numValues == 0)
+            {
+                continue;
+            }
+
+            if (!firstStats)
+            {
+                ImGui::SameLine(0.0f, 20.0f);
+            }
+            firstStats = false;
+
+            ImGui::TextColored(homeMonitor->assignedColor.rgb, "%s: Mean %.2f  SD %.2f  Min %.2f  Max %.2f",
+                               homeMonitor->thingSpeak.GetName().c_str(), ThingSpeakGetMean(stats),
+                               ThingSpeakGetStdDev(stats), stats.minValue, stats.maxValue);
+        }
+    }
+
+    ImGui::End();
+}
+
+/**
+ * @brief Plot a time range of every visible HomeMonitor object on a time
+ *        axis. Long ranges are shown at a resolution aggregated by
+ *        ThingSpeak. Parts of the range which are not held yet are
+ *        requested in the background and appear once fetched. Hovering
+ *        shows the point nearest the cursor, as in the entry ID plot
+ * 
+ * @param name - Graph name
+ * @param yAxisLabel - Label to use for Y-Axis
+ * @param plotWindowSize - Size of the plot
+ * @param field - ThingSpeak field to plot
+ * @param span - Seconds shown up to the present once the span is chosen
+ * @param spanChanged - Reset the axis to the span, e.g. after a new choice
+ * @param visibleHomeMonitors - HomeMonitor objects to plot
+ * @param thingSpeakFetcher - Background fetcher used to request ranges
+ * 
+ * @return int - Minutes per plotted entry. THINGSPEAK_RANGE_RAW for raw entries
+ */
+int HomeMonitorPlotHistory(std::string const & name,
+                           std::string const & yAxisLabel,
+                           ImVec2 plotWindowSize,
+                           ThingSpeakField field,
+                           int64_t span,
+                           bool spanChanged,
+                           HomeMonitorView_t visibleHomeMonitors,
+                           ThingSpeakFetcher& thingSpeakFetcher)
+{
+    int fieldNumber = static_cast<int>(field);
+    int64_t now = HomeMonitorGetEpochSeconds();
+    int resolution = THINGSPEAK_RANGE_RAW;
+
+    if (!ImPlot::BeginPlot(name.c_str(), plotWindowSize))
+    {
+        return resolution;
+    }
+
+    ImPlot::SetupAxes("Date/Time (UTC)", yAxisLabel.c_str(), ImPlotAxisFlags_None, ImPlotAxisFlags_AutoFit);
+    ImPlot::SetupAxisScale(ImAxis_X1, ImPlotScale_Time);
+    ImPlot::SetupAxisLimits(ImAxis_X1, static_cast<double>(now - span), static_cast<double>(now),
+                            (spanChanged ? ImPlotCond_Always : ImPlotCond_Once));
+
+    ImPlotRect plotLimits = ImPlot::GetPlotLimits();
+    int64_t start = static_cast<int64_t>(std::floor(plotLimits.X.Min));
+    int64_t end = static_cast<int64_t>(std::ceil(plotLimits.X.Max));
+    resolution = ThingSpeakRangeCache::ChooseResolution(end - start);
+
+    // Reused by every viewer, so no allocations are made once warmed up
+    static std::vector<ThingSpeakRangeTile_t const *> tiles;
+    static std::vector<ThingSpeakRange_t> missing;
+    static std::vector<ThingSpeakSeries const *> plottedSeries;   // Every tile plotted, for hovering
+    static std::vector<HomeMonitor_t const *> plottedOwners;      // Object of each plotted series
+    plottedSeries.clear();
+    plottedOwners.clear();
+
+    for (HomeMonitor_t* homeMonitor : visibleHomeMonitors)
+    {
+        missing.clear();
+        thingSpeakRangeCache.Require(homeMonitor->thingSpeak.GetChannel(), homeMonitor->thingSpeak.GetKey(),
+                                     start, end, resolution, ThingSpeakAggregate::Average, now, tiles, missing);
+        for (ThingSpeakRange_t const & range : missing)
+        {
+            thingSpeakFetcher.RequestRange(homeMonitor->thingSpeak, range);
+        }
+
+        // Tiles share the object's label, so they form one legend entry
+        ImPlot::PushStyleColor(0, homeMonitor->assignedColor.rgb);
+        for (ThingSpeakRangeTile_t const * tile : tiles)
+        {
+            HomeMonitorRangeGetterData_t data = {&tile->series, fieldNumber};
+            ImPlot::PlotLineG(homeMonitor->thingSpeak.GetName().c_str(), HomeMonitorGetRangePoint,
+                              &data, tile->series.Size(),
+                              (ImPlotLegendFlags_NoButtons | ImPlotLineFlags_SkipNaN));
+
+            plottedSeries.push_back(&tile->series);
+            plottedOwners.push_back(homeMonitor);
+        }
+        ImPlot::PopStyleColor();
+    }
+
+    if (ImPlot::IsPlotHovered())
+    {
+        ImVec2 plotSize = ImPlot::GetPlotSize();
+        ImVec2 pixelsPerUnit(static_cast<float>(plotSize.x / plotLimits.X.Size()),
+                             static_cast<float>(plotSize.y / plotLimits.Y.Size()));
+
+        std::pair<int, int> closestIndicies =
+            HomeMonitorGetClosestPointByTime(plottedSeries, fieldNumber, ImPlot::GetPlotMousePos(), pixelsPerUnit);
+
+        if (closestIndicies.first != -1)
+        {
+            ThingSpeakSeries const & series = *plottedSeries[closestIndicies.first];
+            auto index = closestIndicies.second;
+
+            ImGui::BeginTooltip();
+            ImGui::Text("Trendline: %s", plottedOwners[closestIndicies.first]->thingSpeak.GetName().c_str());
+            ImGui::Text("%s: %.2f", name.c_str(), series.Value(fieldNumber, index));
+            static ThingSpeakTimeZone localTimeZone;
+            char dateTime[THINGSPEAK_DATE_TIME_BUFFER_SIZE];
+            localTimeZone.FormatLocal(series.Timestamp(index), dateTime);
+
+            ImGui::Text("Date/Time Captured (PST): %s", dateTime);
+            ImGui::EndTooltip();
+
+            double xPoint[] = {static_cast<double>(series.Timestamp(index))};
+            double yPoint[] = {static_cast<double>(series.Value(fieldNumber, index))};
+            ImPlot::PushStyleColor(ImPlotCol_Line, ImVec4(1.0, 0.0, 0.0, 1.0));
+            ImPlot::PushStyleColor(ImPlotCol_MarkerOutline, ImVec4(0.7, 0.0, 0.0, 1.0));
+            ImPlot::PlotScatter("Closest Point", xPoint, yPoint,
+                                IM_ARRAYSIZE(xPoint), ImPlotLegendFlags_NoButtons);
+            ImPlot::PopStyleColor(2);
+        }
+    }
+
+    ImPlot::EndPlot();
+
+    return resolution;
+}
+
+/**
+ * @brief ImPlot getter plotting a series by timestamp
+ * 
+ * @param index - Sample index
+ * @param data - HomeMonitorRangeGetterData_t of the series to plot
+ * 
+ * @return ImPlotPoint - UTC epoch seconds and field value of the sample
+ */
+ImPlotPoint HomeMonitorGetRangePoint(int index, void* data)
+{
+    HomeMonitorRangeGetterData_t const * range = static_cast<HomeMonitorRangeGetterData_t const *>(data);
+
+    return ImPlotPoint(static_cast<double>(range->series->Timestamp(index)),
+                       static_cast<double>(range->series->Value(range->fieldNumber, index)));
+}
+
+/**
+ * @brief Queue a background refresh for every visible HomeMonitor object
+ * 
+ * @param homeMonitors - Collection of HomeMonitor objects to refresh
+ * @param thingSpeakFetcher - Background fetcher servicing the requests
+ */
+void HomeMonitorRequestFieldData(std::vector<HomeMonitor_t>& homeMonitors,
+                                 ThingSpeakFetcher& thingSpeakFetcher)
+{
+    std::vector<ThingSpeak*> thingSpeaks;
+
+    for (auto& homeMonitor : homeMonitors)
+    {
+        if (homeMonitor.displayData)
+        {
+            thingSpeaks.push_back(&homeMonitor.thingSpeak);
+        }
+    }
+
+    // Issue all requests as a single concurrent batch
+    thingSpeakFetcher.FetchAll(thingSpeaks);
+}
+
+/**
+ * @brief Queue a background refresh for every channel whose schedule is
+ *        due. Channels of hidden HomeMonitor objects are skipped until
+ *        their next interval
+ * 
+ * @param homeMonitors - Collection of HomeMonitor objects to refresh
+ * @param thingSpeakScheduler - Schedule of every channel
+ * @param thingSpeakFetcher - Background fetcher servicing the requests
+ */
+void HomeMonitorRequestDueFieldData(std::vector<HomeMonitor_t>& homeMonitors,
+                                    ThingSpeakScheduler& thingSpeakScheduler,
+                                    ThingSpeakFetcher& thingSpeakFetcher)
+{
+    auto now = std::chrono::steady_clock::now();
+    if (thingSpeakScheduler.NextDueTime() > now)
+    {
+        return;
+    }
+
+    std::vector<ThingSpeak*> thingSpeaks;
+    ThingSpeakSchedule_t schedule;
+
+    while (thingSpeakScheduler.PopDue(now, schedule))
+    {
+        std::vector<int> const & users = homeMonitorIndex.FindChannel(schedule.channel, schedule.key);
+        bool used = !users.empty();
+        bool displayed = false;
+
+        for (int index : users)
+        {
+            HomeMonitor_t& homeMonitor = homeMonitors[index];
+            if (homeMonitor.displayData)
+            {
+                thingSpeaks.push_back(&homeMonitor.thingSpeak);
+                displayed = true;
+                break;
+            }
+        }
+
+        // Objects may have been edited/removed since the channel was scheduled
+        if (!used)
+        {
+            thingSpeakScheduler.Remove(schedule.channel, schedule.key);
+        }
+        else if (!displayed)
+        {
+            thingSpeakScheduler.Postpone(schedule.channel, schedule.key, now);
+        }
+    }
+
+    if (thingSpeaks.empty())
+    {
+        return;
+    }
+
+    auto currentTime = std::chrono::system_clock::now();
+    std::time_t refreshTime = std::chrono::system_clock::to_time_t(currentTime);
+    std::cout << "\nRefreshing " << thingSpeaks.size() << " channel(s) at "
+              << std::ctime(&refreshTime) << std::endl;
+
+    // Channels due together are still issued as a single concurrent batch
+    thingSpeakFetcher.FetchAll(thingSpeaks);
+}
+
+/**
+ * @brief Apply data finished by the background fetcher to matching
+ *        HomeMonitor objects, and schedule each channel's next refresh.
+ *        Returns immediately if nothing is ready
+ * 
+ * @param homeMonitors - Collection of HomeMonitor objects to update
+ * @param thingSpeakScheduler - Schedule of every channel
+ * @param thingSpeakFetcher - Background fetcher to collect results from
+ */
+void HomeMonitorCollectFieldData(std::vector<HomeMonitor_t>& homeMonitors,
+                                 ThingSpeakScheduler& thingSpeakScheduler,
+                                 ThingSpeakFetcher& thingSpeakFetcher)
+{
+    static std::vector<ThingSpeakFetchResult_t> results;
+
+    if (!thingSpeakFetcher.Collect(results))
+    {
+        return;
+    }
+
+    for (auto& result : results)
+    {
+        // History is kept apart from the latest entries, and not scheduled
+        if (result.rangeQuery)
+        {
+            thingSpeakRangeCache.Insert(result, HomeMonitorGetEpochSeconds());
+            continue;
+        }
+
+        // Objects may have been edited/removed while the request was in flight
+        for (int index : homeMonitorIndex.FindChannel(result.channel, result.key))
+        {
+            HomeMonitorApplyFieldData(homeMonitors[index], result, homeMonitors, thingSpeakScheduler);
+        }
+    }
+}
+
+/**
+ * @brief Apply entries pushed by the transport to matching HomeMonitor
+ *        objects. An entry following one the object did not receive, e.g.
+ *        while the transport was disconnected, is dropped and the object
+ *        backfilled over HTTP instead; the backfill returns it as well.
+ *        Returns immediately if nothing is ready
+ * 
+ * @param homeMonitors - Collection of HomeMonitor objects to update
+ * @param thingSpeakScheduler - Schedule of every channel
+ * @param thingSpeakFetcher - Background fetcher requesting backfills
+ */
+void HomeMonitorCollectPushedData(std::vector<HomeMonitor_t>& homeMonitors,
+                                  ThingSpeakScheduler& thingSpeakScheduler,
+                                  ThingSpeakFetcher& thingSpeakFetcher)
+{
+    static std::vector<ThingSpeakFetchResult_t> results;
+
+    if (!thingSpeakTransport || !thingSpeakTransport->Collect(results))
+    {
+        return;
+    }
+
+    for (auto& result : results)
+    {
+        for (int index : homeMonitorIndex.FindChannel(result.channel, result.key))
+        {
+            HomeMonitor_t& homeMonitor = homeMonitors[index];
+
+            // Already received, e.g. by a backfill racing the push
+            if (result.lastEntry.entryId <= homeMonitor.thingSpeak.GetLastEntry().entryId)
+            {
+                continue;
+            }
+
+            // Duplicate requests for the channel are ignored by the fetcher
+            if (!homeMonitor.thingSpeak.ContinuesFieldData(result))
+            {
+                thingSpeakFetcher.Request(homeMonitor.thingSpeak);
+                continue;
+            }
+
+            HomeMonitorApplyFieldData(homeMonitor, result, homeMonitors, thingSpeakScheduler);
+        }
+    }
+}
+
+/**
+ * @brief Apply a fetched or pushed result to a HomeMonitor object, storing
+ *        it in the object's cache, scheduling the channel's next refresh
+ *        and evaluating alerts. A pushed entry reschedules the refresh too,
+ *        so channels are only polled while pushes stop arriving
+ * 
+ * @param homeMonitor - Object using the result's channel
+ * @param result - Result for the object's channel
+ * @param homeMonitors - Collection holding the object
+ * @param thingSpeakScheduler - Schedule of every channel
+ */
+void HomeMonitorApplyFieldData(HomeMonitor_t& homeMonitor, ThingSpeakFetchResult_t const & result,
+                               std::vector<HomeMonitor_t> const & homeMonitors,
+                               ThingSpeakScheduler& thingSpeakScheduler)
+{
+    auto ingestStartTime = HomeMonitorProfilerClock::now();
+
+    homeMonitor.thingSpeak.SetFieldData(result);
+
+    if (homeMonitor.cache)
+    {
+        homeMonitor.cache->Store(homeMonitor.thingSpeak);
+    }
+
+    homeMonitorProfiler.RecordFetch(result, homeMonitor.thingSpeak.GetName(),
+                                    (HomeMonitorProfilerClock::now() - ingestStartTime));
+    homeMonitorProfiler.MarkStartup(HomeMonitorStartupStage::FirstFetch);
+    if (homeMonitor.thingSpeak.HasFieldData())
+    {
+        homeMonitorProfiler.MarkStartup(HomeMonitorStartupStage::FirstData);
+    }
+
+    thingSpeakScheduler.OnResult(result, homeMonitor.thingSpeak,
+                                 std::chrono::steady_clock::now());
+    HomeMonitorUpdateAlerts(homeMonitor, homeMonitors);
+}
+
+/**
+ * @brief Startup loader thread body. Reads the configured ThingSpeak objects
+ *        and restores each from its cache, handing them to the render loop
+ *        one at a time. A missing objects file leaves the list empty, so
+ *        objects can still be added from the GUI
+ * 
+ * @param stopToken - Signalled if the application exits while loading
+ * @param startupLoad - Objects handed to the render loop
+ * @param loadedEvent - Event signalled whenever objects are handed over
+ */
+void HomeMonitorLoadObjects(std::stop_token stopToken, HomeMonitorStartupLoad_t& startupLoad,
+                            HANDLE loadedEvent)
+{
+    json thingSpeakObjectsJson = json::array();
+
+    std::ifstream thingSpeakObjectsFile(thingSpeakFilePath);
+    if (thingSpeakObjectsFile.is_open())
+    {
+        thingSpeakObjectsJson = json::parse(thingSpeakObjectsFile, nullptr, false);
+        if (thingSpeakObjectsJson.is_discarded() || !thingSpeakObjectsJson.is_array())
+        {
+            std::cerr << "[ERROR] Could not parse " << thingSpeakFilePath << std::endl;
+            thingSpeakObjectsJson = json::array();
+        }
+    }
+    else
+    {
+        std::cerr << "[ERROR] Could not open " << thingSpeakFilePath << std::endl;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(startupLoad.mutex);
+        startupLoad.configLoaded = true;
+        startupLoad.configLoadedTime = HomeMonitorProfilerClock::now();
+    }
+
+    for (auto& thingSpeakObject : thingSpeakObjectsJson)
+    {
+        if (stopToken.stop_requested())
+        {
+            break;
+        }
+
+        HomeMonitor_t homeMonitor;
+
+        homeMonitor.thingSpeak = { thingSpeakObject.value("name", ""),
+                                   thingSpeakObject.value("channel", ""),
+                                   thingSpeakObject.value("key", "")      };
+
+        // Show cached data straight away; only newer entries are fetched
+        HomeMonitorLoadCache(homeMonitor);
+
+        {
+            std::lock_guard<std::mutex> lock(startupLoad.mutex);
+            startupLoad.loaded.push_back(std::move(homeMonitor));
+        }
+        ::SetEvent(loadedEvent);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(startupLoad.mutex);
+        startupLoad.finished = true;
+    }
+    ::SetEvent(loadedEvent);
+}
+
+/**
+ * @brief Add objects handed over by the startup loader since the last call,
+ *        assigning their colors and scheduling their channels. Objects named
+ *        like one added from the GUI meanwhile are dropped
+ * 
+ * @param startupLoad - Objects handed over by the startup loader
+ * @param homeMonitors - Collection of HomeMonitor objects to add to
+ * @param thingSpeakScheduler - Schedule of every object's channel
+ * 
+ * @return bool - True if any object was added
+ */
+bool HomeMonitorAdoptLoadedObjects(HomeMonitorStartupLoad_t& startupLoad,
+                                   std::vector<HomeMonitor_t>& homeMonitors,
+                                   ThingSpeakScheduler& thingSpeakScheduler)
+{
+    std::vector<HomeMonitor_t> loaded;
+    bool finished;
+    {
+        std::lock_guard<std::mutex> lock(startupLoad.mutex);
+        loaded.swap(startupLoad.loaded);
+        finished = startupLoad.finished;
+
+        if (startupLoad.configLoaded)
+        {
+            homeMonitorProfiler.MarkStartup(HomeMonitorStartupStage::Config, startupLoad.configLoadedTime);
+        }
+    }
+
+    // Names are checked against the index as of the last call and the
+    // objects adopted in this one, so the index is only rebuilt once
+    size_t firstAdded = homeMonitors.size();
+    std::unordered_set<std::string> addedNames;
+    for (auto& homeMonitor : loaded)
+    {
+        std::string const & name = homeMonitor.thingSpeak.GetName();
+        if ((homeMonitorIndex.FindName(name) != -1) || !addedNames.insert(name).second)
+        {
+            continue;
+        }
+
+        HomeMonitorSetColor(homeMonitor);
+
+        if (!sharedCacheMode)
+        {
+            thingSpeakScheduler.Add(homeMonitor.thingSpeak.GetChannel(),
+                                    homeMonitor.thingSpeak.GetKey(),
+                                    std::chrono::steady_clock::now());
+        }
+        if (thingSpeakTransport)
+        {
+            thingSpeakTransport->Subscribe(homeMonitor.thingSpeak);
+        }
+
+        if (homeMonitor.thingSpeak.HasFieldData())
+        {
+            homeMonitorProfiler.MarkStartup(HomeMonitorStartupStage::FirstData);
+        }
+
+        homeMonitors.push_back(std::move(homeMonitor));
+    }
+
+    bool added = (homeMonitors.size() > firstAdded);
+    if (added)
+    {
+        homeMonitorIndex.Rebuild(homeMonitors);
+        for (size_t i = firstAdded; i < homeMonitors.size(); i++)
+        {
+            HomeMonitorUpdateAlerts(homeMonitors[i], homeMonitors);
+        }
+    }
+
+    if (finished)
+    {
+        homeMonitorProfiler.MarkStartup(HomeMonitorStartupStage::Caches);
+        homeMonitorsLoading = false;
+    }
+
+    return added;
+}
+
+/**
+ * @brief Map the cache file of a HomeMonitor object's channel, and restore
+ *        its data from the cache if none has been received yet. Does
+ *        nothing if the cache of the current channel is already mapped.
+ *        The cache of another object on the same channel is reused. In
+ *        shared cache mode, the file is mapped read-only
+ * 
+ * @param homeMonitor - HomeMonitor object to load cached data into
+ */
+void HomeMonitorLoadCache(HomeMonitor_t& homeMonitor)
+{
+    ThingSpeak& thingSpeak = homeMonitor.thingSpeak;
+
+    if (!homeMonitor.cache || (homeMonitor.cache->GetChannel() != thingSpeak.GetChannel()))
+    {
+        std::lock_guard<std::mutex> lock(openCachesMutex);
+
+        // Not reused in place, as copies of the object may share the old cache
+        std::weak_ptr<ThingSpeakCache>& openCache = openCaches[thingSpeak.GetChannel()];
+        homeMonitor.cache = openCache.lock();
+        if (!homeMonitor.cache)
+        {
+            homeMonitor.cache = std::make_shared<ThingSpeakCache>();
+            ThingSpeakCacheAccess access = (sharedCacheMode ? ThingSpeakCacheAccess::ReadOnly
+                                                            : ThingSpeakCacheAccess::ReadWrite);
+            if (!homeMonitor.cache->Open(cacheDirectoryPath, thingSpeak.GetChannel(), access))
+            {
+                homeMonitor.cache.reset();
+                return;
+            }
+            openCache = homeMonitor.cache;
+        }
+    }
+
+    if (thingSpeak.HasFieldData())
+    {
+        return;
+    }
+
+    ThingSpeakFetchResult_t cachedData;
+    if (homeMonitor.cache->Load(cachedData))
+    {
+        thingSpeak.RestoreFieldData(cachedData);
+    }
+}
+
+/**
+ * @brief Load the UI font, preferring the copy embedded in the executable
+ *        over Fonts/ on disk. The atlas baked from it is cached alongside
+ *        the channel caches, so only the first launch rasterizes it
+ * 
+ * @param io - Dear ImGui IO holding the font atlas
+ */
+void HomeMonitorLoadFont(ImGuiIO& io)
+{
+    void const * fontData = nullptr;
+    int fontDataSize = 0;
+    std::vector<char> fontFileData;
+
+    // Resources are mapped with the executable, so no file is read
+    HRSRC fontResource = ::FindResource(nullptr, MAKEINTRESOURCE(IDR_FONT_ROBOTO_REGULAR), RT_RCDATA);
+    HGLOBAL fontHandle = (fontResource != nullptr) ? ::LoadResource(nullptr, fontResource) : nullptr;
+    if (fontHandle != nullptr)
+    {
+        fontData = ::LockResource(fontHandle);
+        fontDataSize = static_cast<int>(::SizeofResource(nullptr, fontResource));
+    }
+
+    if ((fontData == nullptr) || (fontDataSize <= 0))
+    {
+        std::ifstream fontFile(fontFilePath, std::ios::binary);
+        fontFileData.assign(std::istreambuf_iterator<char>(fontFile), std::istreambuf_iterator<char>());
+        fontData = fontFileData.data();
+        fontDataSize = static_cast<int>(fontFileData.size());
+    }
+
+    if ((fontDataSize <= 0) ||
+        (homeMonitorFontAtlas.AddFont(io.Fonts, fontData, fontDataSize, HOMEMONITOR_FONT_SIZE,
+                                      HomeMonitorFontAtlas::GetGlyphRanges(), cacheDirectoryPath) == nullptr))
+    {
+        std::cerr << "[ERROR] Could not load " << fontFilePath << std::endl;
+        io.Fonts->AddFontDefault();
+    }
+
+    #if (DEBUG_HOMEMONITOR)
+    std::cout << "Font atlas " << (homeMonitorFontAtlas.Restored() ? "restored" : "built") << std::endl;
+    #endif
+}
+
+/**
+ * @brief Place the files HomeMonitor writes, and the configuration holding
+ *        credentials, in %LOCALAPPDATA%\HomeMonitorV2 rather than next to
+ *        the sources. Falls back to the executable's directory if the
+ *        folder is unavailable
+ * 
+ */
+void HomeMonitorSetDataPaths()
+{
+    std::filesystem::path dataDirectory;
+
+    PWSTR localAppData = nullptr;
+    if (SUCCEEDED(::SHGetKnownFolderPath(FOLDERID_LocalAppData, KF_FLAG_CREATE, nullptr, &localAppData)))
+    {
+        dataDirectory = std::filesystem::path(localAppData) / "HomeMonitorV2";
+    }
+    ::CoTaskMemFree(localAppData);
+
+    // The font atlas is cached before any channel cache creates the folder
+    std::error_code error;
+    if (!dataDirectory.empty())
+    {
+        std::filesystem::create_directories((dataDirectory / "Cache"), error);
+    }
+    if (dataDirectory.empty() || error)
+    {
+        std::cerr << "[ERROR] Could not create " << dataDirectory.string() << ", using the executable's directory"
+                  << std::endl;
+
+        wchar_t executablePath[MAX_PATH];
+        DWORD length = ::GetModuleFileNameW(nullptr, executablePath, MAX_PATH);
+        dataDirectory = std::filesystem::path(std::wstring(executablePath, length)).parent_path();
+    }
+
+    cacheDirectoryPath = dataDirectory / "Cache";
+    performanceTraceFilePath = dataDirectory / "PerformanceTrace.csv";
+    startupTraceFilePath = dataDirectory / "StartupTrace.csv";
+    alertRulesFilePath = dataDirectory / "ThingSpeakAlerts.json";
+    exportDirectoryPath = dataDirectory / "Exports";
+    mqttConfigFilePath = dataDirectory / "ThingSpeakMqtt.json";
+}
+
+/**
+ * @brief Get the current time as used by ThingSpeak timestamps
+ * 
+ * @return int64_t - UTC epoch seconds
+ */
+int64_t HomeMonitorGetEpochSeconds()
+{
+    auto sinceEpoch = std::chrono::system_clock::now().time_since_epoch();
+
+    return std::chrono::duration_cast<std::chrono::seconds>(sinceEpoch).count();
+}
+
+/**
+ * @brief Apply entries the collector has cached since the last call. Cache
+ *        files the collector has not created yet are retried on each call
+ * 
+ * @param homeMonitors - Collection of HomeMonitor objects to update
+ * 
+ * @return bool - True if any object received new data
+ */
+bool HomeMonitorReadSharedCaches(std::vector<HomeMonitor_t>& homeMonitors)
+{
+    bool updated = false;
+
+    for (auto& homeMonitor : homeMonitors)
+    {
+        ThingSpeak& thingSpeak = homeMonitor.thingSpeak;
+
+        if (!homeMonitor.cache)
+        {
+            HomeMonitorLoadCache(homeMonitor);
+            HomeMonitorUpdateAlerts(homeMonitor, homeMonitors);
+            updated |= thingSpeak.HasFieldData();
+            continue;
+        }
+
+        // Only the header is read unless the collector stored something new
+        if (homeMonitor.cache->GetLastEntryId() == thingSpeak.GetLastEntry().entryId)
+        {
+            continue;
+        }
+
+        ThingSpeakFetchResult_t cachedData;
+        if (homeMonitor.cache->Load(cachedData))
+        {
+            thingSpeak.RestoreFieldData(cachedData);
+            HomeMonitorUpdateAlerts(homeMonitor, homeMonitors);
+            updated = true;
+        }
+    }
+
+    nextCachePollTime = std::chrono::steady_clock::now() +
+                        std::chrono::milliseconds(HOMEMONITOR_SHARED_CACHE_POLL_MS);
+
+    return updated;
+}
+
+/**
+ * @brief Evaluate alerts against entries a HomeMonitor object just received.
+ *        Objects sharing a channel hold the same entries, so only the first
+ *        object of each channel is evaluated
+ * 
+ * @param homeMonitor - Object whose data was just updated
+ * @param homeMonitors - Collection holding the object
+ */
+void HomeMonitorUpdateAlerts(HomeMonitor_t const & homeMonitor, std::vector<HomeMonitor_t> const & homeMonitors)
+{
+    std::vector<int> const & users = homeMonitorIndex.FindChannel(homeMonitor.thingSpeak.GetChannel(),
+                                                                  homeMonitor.thingSpeak.GetKey());
+    if (!users.empty() && (&homeMonitors[users.front()] == &homeMonitor))
+    {
+        thingSpeakAlerts.Update(homeMonitor.thingSpeak);
+    }
+}
+
+/**
+ * @brief Stop evaluating alerts of a channel once no object uses it, so it
+ *        is not reported as stale
+ * 
+ * @param channel - ThingSpeak channel ID of an edited or removed object
+ * @param homeMonitors - Collection of HomeMonitor objects after the edit
+ */
+void HomeMonitorRemoveUnusedAlerts(std::string const & channel, std::vector<HomeMonitor_t> const & homeMonitors)
+{
+    // Only made after an edit, so the scan is not worth an index
+    if (std::ranges::none_of(homeMonitors, [&channel](HomeMonitor_t const & homeMonitor) {
+            return (homeMonitor.thingSpeak.GetChannel() == channel);
+        }))
+    {
+        thingSpeakAlerts.Remove(channel);
+    }
+}
+
+/**
+ * @brief Stop pushing the entries of a channel/key once no object uses it
+ * 
+ * @param channel - ThingSpeak channel ID of an edited or removed object
+ * @param key - ThingSpeak read key the object used
+ */
+void HomeMonitorUnsubscribeUnused(std::string const & channel, std::string const & key)
+{
+    if (thingSpeakTransport && homeMonitorIndex.FindChannel(channel, key).empty())
+    {
+        thingSpeakTransport->Unsubscribe(channel, key);
+    }
+}
+
+/**
+ * @brief Check for channels gone quiet and show a notification for alerts
+ *        raised since the last call. Alerts raised together are combined
+ *        into one notification
+ * 
+ * @param hwnd - Window owning the tray icon
+ * 
+ * @return bool - True if any alert was raised or cleared
+ */
+bool HomeMonitorNotifyAlerts(HWND hwnd)
+{
+    static std::vector<ThingSpeakAlertEvent_t> events;
+
+    thingSpeakAlerts.CheckStale(HomeMonitorGetEpochSeconds());
+    if (!thingSpeakAlerts.Collect(events))
+    {
+        return false;
+    }
+
+    std::string title;
+    std::string text;
+    int numRaised = 0;
+    for (auto const & event : events)
+    {
+        #if (DEBUG_HOMEMONITOR)
+        std::cout << "Alert " << (event.raised ? "raised: " : "cleared: ")
+                  << thingSpeakAlerts.Describe(event) << std::endl;
+        #endif
+
+        if (!event.raised)
+        {
+            continue;
+        }
+
+        title = thingSpeakAlerts.GetRules()[event.rule].name;
+        text += (text.empty() ? "" : "\n") + thingSpeakAlerts.Describe(event);
+        numRaised++;
+    }
+
+    if (numRaised > 1)
+    {
+        title = std::to_string(numRaised) + " alerts";
+    }
+    if (numRaised > 0)
+    {
+        HomeMonitorShowNotification(hwnd, title, text);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Show a notification from the tray icon, adding the icon first if
+ *        needed. Shown as a toast on Windows 10 and later
+ * 
+ * @param hwnd - Window owning the tray icon
+ * @param title - Title of the notification. UTF-8
+ * @param text - Body of the notification. UTF-8, truncated to fit
+ */
+void HomeMonitorShowNotification(HWND hwnd, std::string const & title, std::string const & text)
+{
+    NOTIFYICONDATAW notifyIcon = HomeMonitorGetNotifyIcon(hwnd);
+    notifyIcon.uFlags |= NIF_INFO;
+    notifyIcon.dwInfoFlags = NIIF_WARNING;
+
+    auto copyWide = [](std::string const & utf8, wchar_t* destination, size_t destinationSize) {
+        std::wstring wide(::MultiByteToWideChar(CP_UTF8, 0, utf8.c_str(), -1, nullptr, 0), L'\0');
+        ::MultiByteToWideChar(CP_UTF8, 0, utf8.c_str(), -1, wide.data(), static_cast<int>(wide.size()));
+        wcsncpy_s(destination, destinationSize, wide.c_str(), _TRUNCATE);
+    };
+    copyWide(title, notifyIcon.szInfoTitle, ARRAYSIZE(notifyIcon.szInfoTitle));
+    copyWide(text, notifyIcon.szInfo, ARRAYSIZE(notifyIcon.szInfo));
+
+    if (!notifyIconAdded)
+    {
+        notifyIconAdded = ::Shell_NotifyIconW(NIM_ADD, &notifyIcon);
+    }
+    else
+    {
+        ::Shell_NotifyIconW(NIM_MODIFY, &notifyIcon);
+    }
+}
+
+/**
+ * @brief Pick up loaded objects and fetched or pushed data, refresh the
+ *        channels which are due and raise alerts. Makes no ImGui calls, so
+ *        it also runs while no frame is drawn, e.g. in tray mode
+ * 
+ * @param homeMonitors - Collection of HomeMonitor objects
+ * @param startupLoad - Objects loaded in the background at startup
+ * @param thingSpeakScheduler - Schedule of every channel
+ * @param thingSpeakFetcher - Background fetcher servicing the requests
+ * @param hwnd - Window owning the tray icon
+ * 
+ * @return bool - True if anything shown on screen may have changed
+ */
+bool HomeMonitorUpdateData(std::vector<HomeMonitor_t>& homeMonitors, HomeMonitorStartupLoad_t& startupLoad,
+                           ThingSpeakScheduler& thingSpeakScheduler, ThingSpeakFetcher& thingSpeakFetcher,
+                           HWND hwnd)
+{
+    bool changed = false;
+
+    if (homeMonitorsLoading)
+    {
+        changed |= HomeMonitorAdoptLoadedObjects(startupLoad, homeMonitors, thingSpeakScheduler);
+    }
+    HomeMonitorCollectFieldData(homeMonitors, thingSpeakScheduler, thingSpeakFetcher);
+    HomeMonitorCollectPushedData(homeMonitors, thingSpeakScheduler, thingSpeakFetcher);
+
+    // Refresh channels which are due, or pick up what the collector fetched
+    if (!sharedCacheMode)
+    {
+        HomeMonitorRequestDueFieldData(homeMonitors, thingSpeakScheduler, thingSpeakFetcher);
+    }
+    else if (std::chrono::steady_clock::now() >= nextCachePollTime)
+    {
+        changed |= HomeMonitorReadSharedCaches(homeMonitors);
+    }
+
+    // Alerts raised by the data picked up above, or by channels going quiet
+    changed |= HomeMonitorNotifyAlerts(hwnd);
+
+    return changed;
+}
+
+/**
+ * @brief Describe the tray icon shared by notifications and tray mode.
+ *        Clicks on the icon are sent to the window as HOMEMONITOR_WM_TRAY_ICON
+ * 
+ * @param hwnd - Window owning the tray icon
+ * 
+ * @return NOTIFYICONDATAW - Icon, tooltip and callback of the tray icon
+ */
+NOTIFYICONDATAW HomeMonitorGetNotifyIcon(HWND hwnd)
+{
+    NOTIFYICONDATAW notifyIcon = {};
+    notifyIcon.cbSize = sizeof(notifyIcon);
+    notifyIcon.hWnd = hwnd;
+    notifyIcon.uID = HOMEMONITOR_NOTIFY_ICON_ID;
+    notifyIcon.uFlags = (NIF_ICON | NIF_TIP | NIF_MESSAGE);
+    notifyIcon.uCallbackMessage = HOMEMONITOR_WM_TRAY_ICON;
+    notifyIcon.hIcon = static_cast<HICON>(::LoadImage(GetModuleHandle(nullptr), MAKEINTRESOURCE(IDI_ICON),
+                                                       IMAGE_ICON, 0, 0, LR_DEFAULTCOLOR));
+    wcscpy_s(notifyIcon.szTip, L"HomeMonitor");
+
+    return notifyIcon;
+}
+
+/**
+ * @brief Hide the window behind the tray icon and release every GPU
+ *        resource: the renderer backend's objects and font texture, the
+ *        swap chain and its render targets, the command allocators and
+ *        the device itself. The render loop then only wakes for new data,
+ *        polls and alerts
+ * 
+ * @param hwnd - Window to hide
+ */
+void HomeMonitorEnterTrayMode(HWND hwnd)
+{
+    WaitForLastSubmittedFrame();
+
+    // Also destroys the platform windows of viewports dragged out of the main
+    // window. They are recreated by the first frame after restoring
+    ImGui_ImplDX12_Shutdown();
+    CleanupDeviceD3D();
+
+    ::ShowWindow(hwnd, SW_HIDE);
+    if (!notifyIconAdded)
+    {
+        NOTIFYICONDATAW notifyIcon = HomeMonitorGetNotifyIcon(hwnd);
+        notifyIconAdded = ::Shell_NotifyIconW(NIM_ADD, &notifyIcon);
+    }
+
+    trayMode = true;
+}
+
+/**
+ * @brief Show the window again and recreate the GPU resources released by
+ *        HomeMonitorEnterTrayMode(). The font atlas is kept in memory, so
+ *        only its texture is uploaded again
+ * 
+ * @param hwnd - Window to show
+ * 
+ * @return bool - True once the window can be drawn. False if the device
+ *                could not be created, leaving the window in the tray
+ */
+bool HomeMonitorLeaveTrayMode(HWND hwnd)
+{
+    // Shown first, as the swap chain takes the size of the client area
+    ::ShowWindow(hwnd, SW_RESTORE);
+    ::SetForegroundWindow(hwnd);
+
+    if (!CreateDeviceD3D(hwnd))
+    {
+        std::cerr << "[ERROR] Could not recreate the Direct3D device" << std::endl;
+        CleanupDeviceD3D();
+        ::ShowWindow(hwnd, SW_HIDE);
+        trayModeRequested = true;
+        return false;
+    }
+
+    HomeMonitorInitRenderer();
+    trayMode = false;
+
+    return true;
+}
+
+/**
+ * @brief Show the context menu of the tray icon at the cursor
+ * 
+ * @param hwnd - Window owning the tray icon
+ */
+void HomeMonitorShowTrayMenu(HWND hwnd)
+{
+    HMENU menu = ::CreatePopupMenu();
+    ::AppendMenuW(menu, MF_STRING, HOMEMONITOR_TRAY_MENU_OPEN, L"Open HomeMonitor");
+    ::AppendMenuW(menu, MF_SEPARATOR, 0, nullptr);
+    ::AppendMenuW(menu, MF_STRING, HOMEMONITOR_TRAY_MENU_EXIT, L"Exit");
+
+    // Without focus, the menu would not close when clicking elsewhere
+    POINT cursor;
+    ::GetCursorPos(&cursor);
+    ::SetForegroundWindow(hwnd);
+    UINT command = ::TrackPopupMenu(menu, (TPM_RETURNCMD | TPM_RIGHTBUTTON | TPM_NONOTIFY),
+                                    cursor.x, cursor.y, 0, hwnd, nullptr);
+    ::DestroyMenu(menu);
+
+    if (command == HOMEMONITOR_TRAY_MENU_OPEN)
+    {
+        trayModeRequested = false;
+    }
+    else if (command == HOMEMONITOR_TRAY_MENU_EXIT)
+    {
+        ::PostQuitMessage(0);
+    }
+}
+
+/**
+ * @brief Block the render loop until there is a reason to draw a frame.
+ *        Returns early on any window message, including user input
+ * 
+ * @param fetchCompleteEvent - Event signalled when fetched data is ready
+ * @param wakeTime - Latest time to wake up, e.g. the next polling deadline
+ * 
+ * @return bool - True if woken by the fetch event. False otherwise
+ */
+bool HomeMonitorWaitForEvents(HANDLE fetchCompleteEvent,
+                              std::chrono::steady_clock::time_point wakeTime)
+{
+    auto remaining = std::chrono::ceil<std::chrono::milliseconds>(
+        wakeTime - std::chrono::steady_clock::now());
+    if (remaining.count() <= 0)
+    {
+        return false;
+    }
+
+    // MWMO_INPUTAVAILABLE also returns for messages already in the queue
+    DWORD timeout = static_cast<DWORD>(std::min<int64_t>(remaining.count(), INFINITE - 1));
+    DWORD result = ::MsgWaitForMultipleObjectsEx(1, &fetchCompleteEvent, timeout,
+                                                 QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+
+    return (result == WAIT_OBJECT_0);
+}
+
+/**
+ * @brief Assign a unique color for a HomeMonitor object. A new color is
+ *        generated if every existing option is in use
+ * 
  * @param homeMonitor - Object to assign the color to
- * @return bool - True if a color is 
  */
-bool HomeMonitorSetColor(HomeMonitor_t& homeMonitor)
+void HomeMonitorSetColor(HomeMonitor_t& homeMonitor)
 {
-    bool colorSelected = false;
+    if (std::ranges::none_of(colorOptions, [](HomeMonitorColorOption_t const & option) {
+            return option.available;
+        }))
+    {
+        colorOptions.push_back({HomeMonitorGenerateColor(static_cast<int>(colorOptions.size())), true});
+    }
 
     for (auto& option : colorOptions)
     {
@@ -963,14 +2435,37 @@ bool HomeMonitorSetColor(HomeMonitor_t& homeMonitor)
             homeMonitor.assignedColor.rgba = option.color.rgba;
             homeMonitor.assignedColor.rgb = option.color.rgb;
 
-            colorSelected = true;
             option.available = false;
 
             break;
         }
     }
+}
+
+/**
+ * @brief Generate a color for palettes larger than the predefined options.
+ *        Hues are spaced by the golden angle, so consecutive colors stay
+ *        far apart however many are generated, and saturation and value
+ *        cycle through a few levels to separate colors of similar hue
+ * 
+ * @param index - Position of the color within the palette
+ * 
+ * @return HomeMonitorAssignedColor_t - Generated color
+ */
+HomeMonitorAssignedColor_t HomeMonitorGenerateColor(int index)
+{
+    static float const saturations[] = {0.85f, 0.55f, 0.70f};
+    static float const values[] = {0.80f, 0.95f, 0.65f};
 
-    return colorSelected;
+    float hue = std::fmod((0.61f + (index * 0.381966f)), 1.0f);
+    int level = (index / 5) % IM_ARRAYSIZE(saturations);
+
+    HomeMonitorAssignedColor_t color;
+    color.rgb.w = 1.0f;
+    ImGui::ColorConvertHSVtoRGB(hue, saturations[level], values[level], color.rgb.x, color.rgb.y, color.rgb.z);
+    color.rgba = ImGui::ColorConvertFloat4ToU32(color.rgb);
+
+    return color;
 }
 
 /**
@@ -998,140 +2493,211 @@ void HomeMonitorReleaseColor(HomeMonitorAssignedColor_t& color)
 }
 
 /**
- * @brief Draw vertical bar at cursor on plot this function is called within
+ * @brief Draw the checkbox toggling the visibility of an object's plots,
+ *        filled with the object's color. Always one row high, so lists of
+ *        checkboxes can be clipped
  * 
+ * @param homeMonitor - Object to toggle
  */
-void HomeMonitorDrawVerticalCursor()
+void HomeMonitorDrawVisibilityCheckbox(HomeMonitor_t& homeMonitor)
 {
-    ImDrawList* drawList = ImPlot::GetPlotDrawList();
-    ImPlotPoint mouse    = ImPlot::GetPlotMousePos();
-    mouse.x              = std::round(mouse.x);
-    float  rectLeft      = ImPlot::PlotToPixels(mouse.x - 0.25 * 1.5, mouse.y).x;
-    float  rectRight     = ImPlot::PlotToPixels(mouse.x + 0.25 * 1.5, mouse.y).x;
-    float  rectTop       = ImPlot::GetPlotPos().y;
-    float  rectBottom    = rectTop + ImPlot::GetPlotSize().y;
-
-    ImPlot::PushPlotClipRect();
-    drawList->AddRectFilled(ImVec2(rectLeft, rectTop),
-                            ImVec2(rectRight, rectBottom),
-                            IM_COL32(255, 0, 0, 32));
-    ImPlot::PopPlotClipRect();
-}
+    ImVec4 color;
+    if (homeMonitor.displayData)
+    {
+        color = homeMonitor.assignedColor.rgb;
+    }
+    else
+    {
+        color = ImVec4(0.8f, 0.8f, 0.8f, 1.0f);
+    }
+    ImVec4 colorOnHover = ImVec4(color.x, color.y, color.z, (color.w * 0.5));
 
-/**
- * @brief Draw horizontal line with spacing above/below.
- *        Used to visually separate sections of GUI
- * 
- */
-void HomeMonitorDrawHorizontalLine()
-{
-    float const spacing = 10.0;
-    float const margin  = 20.0;
+    ImGui::PushStyleColor(ImGuiCol_CheckMark, ImVec4(0, 0, 0, 0));
+    ImGui::PushStyleColor(ImGuiCol_FrameBg, color);
+    ImGui::PushStyleColor(ImGuiCol_FrameBgActive, color);
+    ImGui::PushStyleColor(ImGuiCol_FrameBgHovered, colorOnHover);
 
-    ImGui::Dummy(ImVec2(0.0f, spacing));
+    ImGui::Checkbox(homeMonitor.thingSpeak.GetName().c_str(), &homeMonitor.displayData);
 
-    ImDrawList* drawList = ImGui::GetWindowDrawList();
-    ImVec2 start = ImGui::GetCursorScreenPos();
-    ImVec2 end = ImVec2((start.x + ImGui::GetWindowWidth() - margin), start.y);
-    drawList->AddLine(start, end, IM_COL32(128, 128, 128, 60), 0.5f);
+    ImGui::PopStyleColor();
+    ImGui::PopStyleColor();
+    ImGui::PopStyleColor();
+    ImGui::PopStyleColor();
 
-    ImGui::Dummy(ImVec2(0.0f, spacing));
+    if (!homeMonitor.thingSpeak.ValidData())
+    {
+        ImGui::SameLine();
+        ImGui::TextDisabled("(Error fetching data)");
+    }
 }
 
 /**
- * @brief Determine the closest point to the cursor from the set of points
- *        currently marked visible in the graph
+ * @brief Draw the controls exporting the history of every channel, and the
+ *        progress of a running export
  * 
- * @param homeMonitors - Collection of HomeMonitor objects to traverse
- * @param field - Type of field data to search
- * @return std::pair<int, int> - Pair containing:
- *                               (1) The HomeMonitor object with the nearest point,
- *                               (2) The index of the closest point from the
- *                                   points stored in the HomeMonitor object
- *                               Or a negative pair {-1, -1} if not point exists
+ * @param homeMonitors - Collection of HomeMonitor objects whose channels are exported
  */
-std::pair<int, int> HomeMonitorGetClosestPointToMouse(ThingSpeakField field,
-                                                      std::vector<HomeMonitor_t>& homeMonitors)
+void HomeMonitorDrawExportControls(std::vector<HomeMonitor_t> const & homeMonitors)
 {
-    int xDistanceRounded;
-    float yDistance;
-    float yMinDistance = FLT_MAX;
+    static int exportSource = 0;
+    static int exportFormat = 0;
+    static int exportRange = 2;
 
-    std::pair<int, int> closestValue = {-1, -1};
-    ThingSpeakFeedData_t const * dataset;
+    ImGui::Text("Export History");
+    ImGui::Dummy(ImVec2(0.0f, 10.0f));
 
-    ImPlotPoint mousePos = ImPlot::GetPlotMousePos();
+    bool exporting = thingSpeakExporter.Busy();
+    ImGui::BeginDisabled(exporting);
+    ImGui::SetNextItemWidth(160.0f);
+    ImGui::Combo("Source", &exportSource, exportSourceOptions, IM_ARRAYSIZE(exportSourceOptions));
+    ImGui::SetNextItemWidth(160.0f);
+    ImGui::Combo("Format", &exportFormat, exportFormatOptions, IM_ARRAYSIZE(exportFormatOptions));
+    ImGui::SetNextItemWidth(160.0f);
+    ImGui::Combo("Range", &exportRange, exportRangeOptions, IM_ARRAYSIZE(exportRangeOptions));
+    ImGui::EndDisabled();
+    ImGui::Dummy(ImVec2(0.0f, 5.0f));
 
-    for (int i = 0; i < homeMonitors.size(); i++)
+    ThingSpeakExportProgress_t progress = thingSpeakExporter.GetProgress();
+    if (exporting)
     {
-        if (field == ThingSpeakField::Temperature)
-        {
-            dataset = homeMonitors[i].thingSpeak.GetTemperature();
-        }
-        else
+        char overlay[64];
+        snprintf(overlay, sizeof(overlay), "%d/%d channels, %lld entries", progress.channelsDone,
+                 progress.numChannels, static_cast<long long>(progress.samplesWritten));
+        ImGui::ProgressBar(progress.fraction, ImVec2(-1.0f, 0.0f), overlay);
+
+        if (ImGui::Button("Cancel", ImVec2(100, 0)))
         {
-            dataset = homeMonitors[i].thingSpeak.GetHumidity();
+            thingSpeakExporter.Cancel();
         }
+        return;
+    }
 
-        for (int j = 0; j < dataset->numDataPoints; j++)
+    ImGui::BeginDisabled(homeMonitors.empty());
+    if (ImGui::Button("Export", ImVec2(100, 0)))
+    {
+        ThingSpeakExportRequest_t request = {};
+        request.source = static_cast<ThingSpeakExportSource>(exportSource);
+        request.format = static_cast<ThingSpeakExportFormat>(exportFormat);
+        request.end = HomeMonitorGetEpochSeconds();
+        request.start = request.end - exportRangeSpans[exportRange];
+        request.cacheDirectory = cacheDirectoryPath;
+        request.outputDirectory = exportDirectoryPath;
+
+        // Objects sharing a channel are exported once
+        for (auto const & homeMonitor : homeMonitors)
         {
-            xDistanceRounded = std::abs(std::round(mousePos.x - dataset->xAxisData[j]));
-            if (xDistanceRounded != 0)
-            {
-                // Data point is not in the same column as cursor
-                continue;
-            }
-
-            yDistance = std::abs(mousePos.y - dataset->yAxisData[j]);
-            if (yDistance < yMinDistance)
+            ThingSpeak const & thingSpeak = homeMonitor.thingSpeak;
+            if (std::ranges::none_of(request.channels, [&thingSpeak](ThingSpeakExportChannel_t const & channel) {
+                    return (channel.channel == thingSpeak.GetChannel());
+                }))
             {
-                closestValue.first = i;
-                closestValue.second = j;
-
-                yMinDistance = yDistance;
+                request.channels.push_back({thingSpeak.GetName(), thingSpeak.GetChannel(), thingSpeak.GetKey()});
             }
         }
+
+        thingSpeakExporter.Start(std::move(request));
     }
+    ImGui::EndDisabled();
 
-    return closestValue;
+    if (!progress.status.empty())
+    {
+        ImGui::TextWrapped("%s", progress.status.c_str());
+    }
 }
 
 /**
- * @brief Determine upper and lower Y-axis (vertical) boundaries based on
- *        visible data
+ * @brief Mark the active alerts of a HomeMonitor object's field on the plot
+ *        this function is called within: the threshold of Above/Below rules
+ *        and the entry which raised each alert
  * 
- * @return std::pair<float, float> - Min, Max Y-Axis boundaries
+ * @param field - ThingSpeak field being plotted
+ * @param homeMonitor - Object being plotted
  */
-std::pair<float, float> HomeMonitorGetYAxisBoundaries(ThingSpeakField field,
-                                                      std::vector<HomeMonitor_t>& homeMonitors)
+void HomeMonitorDrawAlertMarkers(ThingSpeakField field, HomeMonitor_t const & homeMonitor)
 {
-    float yMin = FLT_MAX;
-    float yMax = FLT_MIN;
+    ThingSpeakAlertChannel_t const * alertChannel = thingSpeakAlerts.GetChannel(homeMonitor.thingSpeak.GetChannel());
+    if (alertChannel == nullptr)
+    {
+        return;
+    }
 
-    ThingSpeakFeedData_t const * dataset;
+    int fieldNumber = static_cast<int>(field);
+    ThingSpeakSeries const & series = homeMonitor.thingSpeak.GetFeedData()->series;
+    int64_t firstHeldSample = series.NumAppended() - series.Size();
+    ImVec4 const alertColor(0.9f, 0.1f, 0.1f, 1.0f);
 
-    for (auto& homeMonitor : homeMonitors)
+    for (auto const & state : alertChannel->states)
     {
-        if (homeMonitor.displayData)
+        ThingSpeakAlertRule_t const & rule = thingSpeakAlerts.GetRules()[state.rule];
+        if (!state.active || (rule.kind == ThingSpeakAlertKind::Stale) || (rule.field != fieldNumber))
         {
-            if (field == ThingSpeakField::Temperature)
-            {
-                dataset = homeMonitor.thingSpeak.GetTemperature();
-            }
-            else
-            {
-                dataset = homeMonitor.thingSpeak.GetHumidity();
-            }
+            continue;
+        }
 
-            for (int i = 0; i < dataset->numDataPoints; i++)
-            {
-                yMin = std::min(dataset->yAxisData[i], yMin);
-                yMax = std::max(dataset->yAxisData[i], yMax);
-            }
+        ImPlot::PushStyleColor(ImPlotCol_Line, alertColor);
+        ImPlot::PushStyleColor(ImPlotCol_MarkerFill, alertColor);
+
+        if ((rule.kind == ThingSpeakAlertKind::Above) || (rule.kind == ThingSpeakAlertKind::Below))
+        {
+            double threshold[] = {rule.threshold};
+            ImPlot::PlotInfLines("##AlertThreshold", threshold, IM_ARRAYSIZE(threshold),
+                                 ImPlotInfLinesFlags_Horizontal);
+            ImPlot::TagY(threshold[0], alertColor, "%s", rule.name.c_str());
+        }
+
+        // The raising entry may have been overwritten since
+        if (state.raisedSample >= firstHeldSample)
+        {
+            int index = static_cast<int>(state.raisedSample - firstHeldSample);
+            float xPoint[] = {static_cast<float>(index)};
+            float yPoint[] = {series.Value(fieldNumber, index)};
+            ImPlot::SetNextMarkerStyle(ImPlotMarker_Diamond, 6.0f);
+            ImPlot::PlotScatter("##AlertRaised", xPoint, yPoint, IM_ARRAYSIZE(xPoint));
         }
+
+        ImPlot::PopStyleColor(2);
     }
+}
+
+/**
+ * @brief Draw vertical bar at cursor on plot this function is called within
+ * 
+ */
+void HomeMonitorDrawVerticalCursor()
+{
+    ImDrawList* drawList = ImPlot::GetPlotDrawList();
+    ImPlotPoint mouse    = ImPlot::GetPlotMousePos();
+    mouse.x              = std::round(mouse.x);
+    float  rectLeft      = ImPlot::PlotToPixels(mouse.x - 0.25 * 1.5, mouse.y).x;
+    float  rectRight     = ImPlot::PlotToPixels(mouse.x + 0.25 * 1.5, mouse.y).x;
+    float  rectTop       = ImPlot::GetPlotPos().y;
+    float  rectBottom    = rectTop + ImPlot::GetPlotSize().y;
+
+    ImPlot::PushPlotClipRect();
+    drawList->AddRectFilled(ImVec2(rectLeft, rectTop),
+                            ImVec2(rectRight, rectBottom),
+                            IM_COL32(255, 0, 0, 32));
+    ImPlot::PopPlotClipRect();
+}
+
+/**
+ * @brief Draw horizontal line with spacing above/below.
+ *        Used to visually separate sections of GUI
+ * 
+ */
+void HomeMonitorDrawHorizontalLine()
+{
+    float const spacing = 10.0;
+    float const margin  = 20.0;
+
+    ImGui::Dummy(ImVec2(0.0f, spacing));
 
-    return {yMin, yMax};
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    ImVec2 start = ImGui::GetCursorScreenPos();
+    ImVec2 end = ImVec2((start.x + ImGui::GetWindowWidth() - margin), start.y);
+    drawList->AddLine(start, end, IM_COL32(128, 128, 128, 60), 0.5f);
+
+    ImGui::Dummy(ImVec2(0.0f, spacing));
 }
 
 /**
@@ -1212,6 +2778,12 @@ LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
     switch (msg)
     {
         case WM_SIZE:
+            // Released while minimized to the tray; see HomeMonitorEnterTrayMode()
+            if ((wParam == SIZE_MINIMIZED) && minimizeToTray)
+            {
+                trayModeRequested = true;
+            }
+
             // Attempt to resize frame to be rendered in swapchain
             if (g_pd3dDevice != nullptr && wParam != SIZE_MINIMIZED)
             {
@@ -1232,6 +2804,24 @@ LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
                 returnZero = true;
             }
             break;
+        case HOMEMONITOR_WM_TRAY_ICON:
+            // Clicking the icon or one of its notifications restores the window
+            switch (LOWORD(lParam))
+            {
+                case WM_LBUTTONUP:
+                case NIN_BALLOONUSERCLICK:
+                    trayModeRequested = false;
+                    if (!trayMode)
+                    {
+                        ::ShowWindow(hWnd, SW_RESTORE);
+                        ::SetForegroundWindow(hWnd);
+                    }
+                    break;
+                case WM_RBUTTONUP:
+                    HomeMonitorShowTrayMenu(hWnd);
+                    break;
+            }
+            return 0;
         case WM_DESTROY:
             ::PostQuitMessage(0);
             return 0;
@@ -1240,6 +2830,35 @@ LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
     return ((returnZero) ? 0 : (::DefWindowProcW(hWnd, msg, wParam, lParam)));
 }
 
+/**
+ * @brief Initialize the Dear ImGui DX12 renderer backend with the current
+ *        device. Called at startup and whenever the device is recreated
+ * 
+ */
+void HomeMonitorInitRenderer()
+{
+    ImGui_ImplDX12_InitInfo init_info = {};
+    init_info.Device = g_pd3dDevice;
+    init_info.CommandQueue = g_pd3dCommandQueue;
+    init_info.NumFramesInFlight = APP_NUM_FRAMES_IN_FLIGHT;
+    init_info.RTVFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
+    init_info.DSVFormat = DXGI_FORMAT_UNKNOWN;
+    init_info.SrvDescriptorHeap = g_pd3dSrvDescHeap;
+    init_info.SrvDescriptorAllocFn = [](ImGui_ImplDX12_InitInfo*,
+                                        D3D12_CPU_DESCRIPTOR_HANDLE* out_cpu_handle,
+                                        D3D12_GPU_DESCRIPTOR_HANDLE* out_gpu_handle) {
+                                            return g_pd3dSrvDescHeapAlloc.Alloc(out_cpu_handle,
+                                                                                out_gpu_handle);
+                                        };
+    init_info.SrvDescriptorFreeFn = [](ImGui_ImplDX12_InitInfo*,
+                                       D3D12_CPU_DESCRIPTOR_HANDLE cpu_handle,
+                                       D3D12_GPU_DESCRIPTOR_HANDLE gpu_handle) {
+                                            return g_pd3dSrvDescHeapAlloc.Free(cpu_handle,
+                                                                               gpu_handle);
+                                       };
+    ImGui_ImplDX12_Init(&init_info);
+}
+
 /* WndProc Handler Helper Functions */
 bool CreateDeviceD3D(HWND hWnd)
 {
@@ -1382,8 +3001,11 @@ void CleanupDeviceD3D()
     if (g_hSwapChainWaitableObject != nullptr)
     {
         CloseHandle(g_hSwapChainWaitableObject);
+        g_hSwapChainWaitableObject = nullptr;
     }
+    g_SwapChainOccluded = false;
 
+    // Fence values restart from 0 with the next device; see HomeMonitorLeaveTrayMode()
     for (UINT i = 0; i < APP_NUM_FRAMES_IN_FLIGHT; i++)
     {
         if (g_frameContext[i].CommandAllocator)
@@ -1391,7 +3013,10 @@ void CleanupDeviceD3D()
             g_frameContext[i].CommandAllocator->Release();
             g_frameContext[i].CommandAllocator = nullptr;
         }
+        g_frameContext[i].FenceValue = 0;
     }    
+    g_frameIndex = 0;
+    g_fenceLastSignaledValue = 0;
 
     if (g_pd3dCommandQueue)
     {
@@ -1410,6 +3035,7 @@ void CleanupDeviceD3D()
     }
     if (g_pd3dSrvDescHeap)
     {
+        g_pd3dSrvDescHeapAlloc.Destroy();
         g_pd3dSrvDescHeap->Release();
         g_pd3dSrvDescHeap = nullptr;
     }